@@ -20,9 +20,11 @@
 #include "System/Debug.hpp"
 #include "System/Half.hpp"
 #include "System/Memory.hpp"
+#include "System/RoutineTelemetry.hpp"
 #include "Vulkan/VkImage.hpp"
 #include "Vulkan/VkImageView.hpp"
 
+#include <type_traits>
 #include <utility>
 
 #if defined(__i386__) || defined(__x86_64__)
@@ -40,28 +42,9 @@ static rr::RValue<rr::Int> PackFields(const rr::Int4 &ints, const sw::int4 shift
 	       (rr::Int(ints.w) << shifts[3]);
 }
 
-Blitter::Blitter()
-    : blitMutex()
-    , blitCache(1024)
-    , cornerUpdateMutex()
-    , cornerUpdateCache(64)  // We only need one of these per format
-{
-}
-
-Blitter::~Blitter()
+// Clamps normalized clear values to the representable range, like clear() does.
+static const void *ClampClearValue(const void *pixel, const vk::Format &viewFormat, VkImageAspectFlagBits aspect, VkClearValue &clampedPixel)
 {
-}
-
-void Blitter::clear(const void *pixel, vk::Format format, vk::Image *dest, const vk::Format &viewFormat, const VkImageSubresourceRange &subresourceRange, const VkRect2D *renderArea)
-{
-	VkImageAspectFlagBits aspect = static_cast<VkImageAspectFlagBits>(subresourceRange.aspectMask);
-	vk::Format dstFormat = viewFormat.getAspectFormat(aspect);
-	if(dstFormat == VK_FORMAT_UNDEFINED)
-	{
-		return;
-	}
-
-	VkClearValue clampedPixel;
 	if(viewFormat.isSignedNormalized() || viewFormat.isUnsignedNormalized())
 	{
 		const float minValue = viewFormat.isSignedNormalized() ? -1.0f : 0.0f;
@@ -85,12 +68,119 @@ void Blitter::clear(const void *pixel, vk::Format format, vk::Image *dest, const
 		}
 	}
 
+	return pixel;
+}
+
+// Packs the clear value into a single 8, 16, or 32-bit texel of the given format, if supported.
+static bool PackClearValue(const void *clearValue, vk::Format clearFormat, const vk::Format &viewFormat, uint32_t &packed)
+{
+	if(clearFormat != VK_FORMAT_R32G32B32A32_SFLOAT &&
+	   clearFormat != VK_FORMAT_D32_SFLOAT &&
+	   clearFormat != VK_FORMAT_S8_UINT)
+	{
+		return false;
+	}
+
+	union ClearValue
+	{
+		struct
+		{
+			float r;
+			float g;
+			float b;
+			float a;
+		};
+
+		float rgb[3];
+
+		float d;
+		uint32_t d_as_u32;
+
+		uint32_t s;
+	};
+
+	const ClearValue &c = *reinterpret_cast<const ClearValue *>(clearValue);
+
+	switch(viewFormat)
+	{
+	case VK_FORMAT_R5G6B5_UNORM_PACK16:
+		packed = ((uint16_t)(31 * c.b + 0.5f) << 0) |
+		         ((uint16_t)(63 * c.g + 0.5f) << 5) |
+		         ((uint16_t)(31 * c.r + 0.5f) << 11);
+		break;
+	case VK_FORMAT_B5G6R5_UNORM_PACK16:
+		packed = ((uint16_t)(31 * c.r + 0.5f) << 0) |
+		         ((uint16_t)(63 * c.g + 0.5f) << 5) |
+		         ((uint16_t)(31 * c.b + 0.5f) << 11);
+		break;
+	case VK_FORMAT_A8B8G8R8_UINT_PACK32:
+	case VK_FORMAT_A8B8G8R8_UNORM_PACK32:
+	case VK_FORMAT_R8G8B8A8_UNORM:
+		packed = ((uint32_t)(255 * c.a + 0.5f) << 24) |
+		         ((uint32_t)(255 * c.b + 0.5f) << 16) |
+		         ((uint32_t)(255 * c.g + 0.5f) << 8) |
+		         ((uint32_t)(255 * c.r + 0.5f) << 0);
+		break;
+	case VK_FORMAT_B8G8R8A8_UNORM:
+		packed = ((uint32_t)(255 * c.a + 0.5f) << 24) |
+		         ((uint32_t)(255 * c.r + 0.5f) << 16) |
+		         ((uint32_t)(255 * c.g + 0.5f) << 8) |
+		         ((uint32_t)(255 * c.b + 0.5f) << 0);
+		break;
+	case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+		packed = R11G11B10F(c.rgb);
+		break;
+	case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32:
+		packed = RGB9E5(c.rgb);
+		break;
+	case VK_FORMAT_D32_SFLOAT:
+		ASSERT(clearFormat == VK_FORMAT_D32_SFLOAT);
+		packed = c.d_as_u32;  // float reinterpreted as uint32
+		break;
+	case VK_FORMAT_S8_UINT:
+		ASSERT(clearFormat == VK_FORMAT_S8_UINT);
+		packed = static_cast<uint8_t>(c.s);
+		break;
+	default:
+		return false;
+	}
+
+	return true;
+}
+
+Blitter::Blitter()
+    : blitMutex()
+    , blitCache(1024, RoutineKind::Blit)
+    , resolveMutex()
+    , resolveCache(64, RoutineKind::Resolve)  // One per format and destination layout
+    , cornerUpdateMutex()
+    , cornerUpdateCache(64, RoutineKind::CornerUpdate)  // We only need one of these per format
+{
+}
+
+Blitter::~Blitter()
+{
+}
+
+void Blitter::clear(const void *pixel, vk::Format format, vk::Image *dest, const vk::Format &viewFormat, const VkImageSubresourceRange &subresourceRange, const VkRect2D *renderArea)
+{
+	VkImageAspectFlagBits aspect = static_cast<VkImageAspectFlagBits>(subresourceRange.aspectMask);
+	vk::Format dstFormat = viewFormat.getAspectFormat(aspect);
+	if(dstFormat == VK_FORMAT_UNDEFINED)
+	{
+		return;
+	}
+
+	VkClearValue clampedPixel;
+	pixel = ClampClearValue(pixel, viewFormat, aspect, clampedPixel);
+
 	if(fastClear(pixel, format, dest, dstFormat, subresourceRange, renderArea))
 	{
 		return;
 	}
 
 	State state(format, dstFormat, 1, dest->getSampleCount(), Options{ 0xF });
+	state.destTiled = dest->hasTiledLayout();
 	auto blitRoutine = getBlitRoutine(state);
 	if(!blitRoutine)
 	{
@@ -167,82 +257,30 @@ void Blitter::clear(const void *pixel, vk::Format format, vk::Image *dest, const
 	dest->contentsChanged(subresourceRange);
 }
 
-bool Blitter::fastClear(const void *clearValue, vk::Format clearFormat, vk::Image *dest, const vk::Format &viewFormat, const VkImageSubresourceRange &subresourceRange, const VkRect2D *renderArea)
+bool Blitter::GetClearPattern(const void *clearValue, vk::Format clearFormat, const vk::Format &viewFormat, VkImageAspectFlagBits aspect, uint32_t &packed)
 {
-	if(clearFormat != VK_FORMAT_R32G32B32A32_SFLOAT &&
-	   clearFormat != VK_FORMAT_D32_SFLOAT &&
-	   clearFormat != VK_FORMAT_S8_UINT)
+	vk::Format dstFormat = viewFormat.getAspectFormat(aspect);
+	if(dstFormat == VK_FORMAT_UNDEFINED)
 	{
 		return false;
 	}
 
-	union ClearValue
-	{
-		struct
-		{
-			float r;
-			float g;
-			float b;
-			float a;
-		};
-
-		float rgb[3];
-
-		float d;
-		uint32_t d_as_u32;
-
-		uint32_t s;
-	};
+	VkClearValue clampedPixel;
+	clearValue = ClampClearValue(clearValue, viewFormat, aspect, clampedPixel);
 
-	const ClearValue &c = *reinterpret_cast<const ClearValue *>(clearValue);
+	return PackClearValue(clearValue, clearFormat, dstFormat, packed);
+}
 
+bool Blitter::fastClear(const void *clearValue, vk::Format clearFormat, vk::Image *dest, const vk::Format &viewFormat, const VkImageSubresourceRange &subresourceRange, const VkRect2D *renderArea)
+{
 	uint32_t packed = 0;
-
-	VkImageAspectFlagBits aspect = static_cast<VkImageAspectFlagBits>(subresourceRange.aspectMask);
-	switch(viewFormat)
+	if(!PackClearValue(clearValue, clearFormat, viewFormat, packed))
 	{
-	case VK_FORMAT_R5G6B5_UNORM_PACK16:
-		packed = ((uint16_t)(31 * c.b + 0.5f) << 0) |
-		         ((uint16_t)(63 * c.g + 0.5f) << 5) |
-		         ((uint16_t)(31 * c.r + 0.5f) << 11);
-		break;
-	case VK_FORMAT_B5G6R5_UNORM_PACK16:
-		packed = ((uint16_t)(31 * c.r + 0.5f) << 0) |
-		         ((uint16_t)(63 * c.g + 0.5f) << 5) |
-		         ((uint16_t)(31 * c.b + 0.5f) << 11);
-		break;
-	case VK_FORMAT_A8B8G8R8_UINT_PACK32:
-	case VK_FORMAT_A8B8G8R8_UNORM_PACK32:
-	case VK_FORMAT_R8G8B8A8_UNORM:
-		packed = ((uint32_t)(255 * c.a + 0.5f) << 24) |
-		         ((uint32_t)(255 * c.b + 0.5f) << 16) |
-		         ((uint32_t)(255 * c.g + 0.5f) << 8) |
-		         ((uint32_t)(255 * c.r + 0.5f) << 0);
-		break;
-	case VK_FORMAT_B8G8R8A8_UNORM:
-		packed = ((uint32_t)(255 * c.a + 0.5f) << 24) |
-		         ((uint32_t)(255 * c.r + 0.5f) << 16) |
-		         ((uint32_t)(255 * c.g + 0.5f) << 8) |
-		         ((uint32_t)(255 * c.b + 0.5f) << 0);
-		break;
-	case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
-		packed = R11G11B10F(c.rgb);
-		break;
-	case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32:
-		packed = RGB9E5(c.rgb);
-		break;
-	case VK_FORMAT_D32_SFLOAT:
-		ASSERT(clearFormat == VK_FORMAT_D32_SFLOAT);
-		packed = c.d_as_u32;  // float reinterpreted as uint32
-		break;
-	case VK_FORMAT_S8_UINT:
-		ASSERT(clearFormat == VK_FORMAT_S8_UINT);
-		packed = static_cast<uint8_t>(c.s);
-		break;
-	default:
 		return false;
 	}
 
+	VkImageAspectFlagBits aspect = static_cast<VkImageAspectFlagBits>(subresourceRange.aspectMask);
+
 	VkImageSubresource subres = {
 		subresourceRange.aspectMask,
 		subresourceRange.baseMipLevel,
@@ -273,6 +311,14 @@ bool Blitter::fastClear(const void *clearValue, vk::Format clearFormat, vk::Imag
 			extent.depth = 1;  // The 3D image is instead interpreted as a 2D image with layers
 		}
 
+		VkExtent2D clearExtent = area.extent;
+		if(dest->hasTiledLayout())
+		{
+			// Clear entire slices at once, including the padding of partial tiles.
+			ASSERT(!renderArea);
+			clearExtent = { static_cast<uint32_t>(slicePitchBytes / viewFormat.bytes()), 1 };
+		}
+
 		for(subres.arrayLayer = subresourceRange.baseArrayLayer; subres.arrayLayer <= lastLayer; subres.arrayLayer++)
 		{
 			for(uint32_t depth = 0; depth < extent.depth; depth++)
@@ -287,26 +333,26 @@ bool Blitter::fastClear(const void *clearValue, vk::Format clearFormat, vk::Imag
 					switch(viewFormat.bytes())
 					{
 					case 4:
-						for(uint32_t i = 0; i < area.extent.height; i++)
+						for(uint32_t i = 0; i < clearExtent.height; i++)
 						{
 							ASSERT(d < dest->end());
-							sw::clear((uint32_t *)d, packed, area.extent.width);
+							sw::clear((uint32_t *)d, packed, clearExtent.width);
 							d += rowPitchBytes;
 						}
 						break;
 					case 2:
-						for(uint32_t i = 0; i < area.extent.height; i++)
+						for(uint32_t i = 0; i < clearExtent.height; i++)
 						{
 							ASSERT(d < dest->end());
-							sw::clear((uint16_t *)d, static_cast<uint16_t>(packed), area.extent.width);
+							sw::clear((uint16_t *)d, static_cast<uint16_t>(packed), clearExtent.width);
 							d += rowPitchBytes;
 						}
 						break;
 					case 1:
-						for(uint32_t i = 0; i < area.extent.height; i++)
+						for(uint32_t i = 0; i < clearExtent.height; i++)
 						{
 							ASSERT(d < dest->end());
-							memset(d, packed, area.extent.width);
+							memset(d, packed, clearExtent.width);
 							d += rowPitchBytes;
 						}
 						break;
@@ -1489,9 +1535,21 @@ Int Blitter::ComputeOffset(Int &x, Int &y, Int &pitchB, int bytes)
 	return y * pitchB + x * bytes;
 }
 
-Int Blitter::ComputeOffset(Int &x, Int &y, Int &z, Int &sliceB, Int &pitchB, int bytes)
+Int Blitter::ComputeOffset(Int &x, Int &y, Int &pitchB, int bytes, bool tiled)
+{
+	if(!tiled)
+	{
+		return ComputeOffset(x, y, pitchB, bytes);
+	}
+
+	// See vk::Image::hasTiledLayout()
+	constexpr int mask = TEXEL_TILE_SIZE - 1;
+	return (y & ~mask) * pitchB + (((x & ~mask) + (y & mask)) * TEXEL_TILE_SIZE + (x & mask)) * bytes;
+}
+
+Int Blitter::ComputeOffset(Int &x, Int &y, Int &z, Int &sliceB, Int &pitchB, int bytes, bool tiled)
 {
-	return z * sliceB + y * pitchB + x * bytes;
+	return z * sliceB + ComputeOffset(x, y, pitchB, bytes, tiled);
 }
 
 Float4 Blitter::sample(Pointer<Byte> &source, Float &x, Float &y, Float &z,
@@ -1517,32 +1575,9 @@ Float4 Blitter::sample(Pointer<Byte> &source, Float &x, Float &y, Float &z,
 			Z = Clamp(Z, 0, sDepth - 1);
 		}
 
-		Pointer<Byte> s = source + ComputeOffset(X, Y, Z, sSliceB, sPitchB, srcBytes);
+		Pointer<Byte> s = source + ComputeOffset(X, Y, Z, sSliceB, sPitchB, srcBytes, state.srcTiled);
 
-		color = readFloat4(s, state);
-
-		if(state.srcSamples > 1)  // Resolve multisampled source
-		{
-			if(state.allowSRGBConversion && state.sourceFormat.isSRGBformat())  // sRGB -> RGB
-			{
-				ApplyScaleAndClamp(color, state);
-				preScaled = true;
-			}
-			Float4 accum = color;
-			for(int sample = 1; sample < state.srcSamples; sample++)
-			{
-				s += sSliceB;
-				color = readFloat4(s, state);
-
-				if(state.allowSRGBConversion && state.sourceFormat.isSRGBformat())  // sRGB -> RGB
-				{
-					ApplyScaleAndClamp(color, state);
-					preScaled = true;
-				}
-				accum += color;
-			}
-			color = accum * Float4(1.0f / static_cast<float>(state.srcSamples));
-		}
+		color = readAveraged(s, sSliceB, state, preScaled);
 	}
 	else  // Bilinear filtering
 	{
@@ -1575,14 +1610,14 @@ Float4 Blitter::sample(Pointer<Byte> &source, Float &x, Float &y, Float &z,
 			Int Z1 = Z0 + 1;
 			Z1 = IfThenElse(Z1 >= sDepth, Z0, Z1);
 
-			Pointer<Byte> s000 = source + ComputeOffset(X0, Y0, Z0, sSliceB, sPitchB, srcBytes);
-			Pointer<Byte> s010 = source + ComputeOffset(X1, Y0, Z0, sSliceB, sPitchB, srcBytes);
-			Pointer<Byte> s100 = source + ComputeOffset(X0, Y1, Z0, sSliceB, sPitchB, srcBytes);
-			Pointer<Byte> s110 = source + ComputeOffset(X1, Y1, Z0, sSliceB, sPitchB, srcBytes);
-			Pointer<Byte> s001 = source + ComputeOffset(X0, Y0, Z1, sSliceB, sPitchB, srcBytes);
-			Pointer<Byte> s011 = source + ComputeOffset(X1, Y0, Z1, sSliceB, sPitchB, srcBytes);
-			Pointer<Byte> s101 = source + ComputeOffset(X0, Y1, Z1, sSliceB, sPitchB, srcBytes);
-			Pointer<Byte> s111 = source + ComputeOffset(X1, Y1, Z1, sSliceB, sPitchB, srcBytes);
+			Pointer<Byte> s000 = source + ComputeOffset(X0, Y0, Z0, sSliceB, sPitchB, srcBytes, state.srcTiled);
+			Pointer<Byte> s010 = source + ComputeOffset(X1, Y0, Z0, sSliceB, sPitchB, srcBytes, state.srcTiled);
+			Pointer<Byte> s100 = source + ComputeOffset(X0, Y1, Z0, sSliceB, sPitchB, srcBytes, state.srcTiled);
+			Pointer<Byte> s110 = source + ComputeOffset(X1, Y1, Z0, sSliceB, sPitchB, srcBytes, state.srcTiled);
+			Pointer<Byte> s001 = source + ComputeOffset(X0, Y0, Z1, sSliceB, sPitchB, srcBytes, state.srcTiled);
+			Pointer<Byte> s011 = source + ComputeOffset(X1, Y0, Z1, sSliceB, sPitchB, srcBytes, state.srcTiled);
+			Pointer<Byte> s101 = source + ComputeOffset(X0, Y1, Z1, sSliceB, sPitchB, srcBytes, state.srcTiled);
+			Pointer<Byte> s111 = source + ComputeOffset(X1, Y1, Z1, sSliceB, sPitchB, srcBytes, state.srcTiled);
 
 			Float4 c000 = readFloat4(s000, state);
 			Float4 c010 = readFloat4(s010, state);
@@ -1622,10 +1657,10 @@ Float4 Blitter::sample(Pointer<Byte> &source, Float &x, Float &y, Float &z,
 		}
 		else
 		{
-			Pointer<Byte> s00 = source + ComputeOffset(X0, Y0, Z0, sSliceB, sPitchB, srcBytes);
-			Pointer<Byte> s01 = source + ComputeOffset(X1, Y0, Z0, sSliceB, sPitchB, srcBytes);
-			Pointer<Byte> s10 = source + ComputeOffset(X0, Y1, Z0, sSliceB, sPitchB, srcBytes);
-			Pointer<Byte> s11 = source + ComputeOffset(X1, Y1, Z0, sSliceB, sPitchB, srcBytes);
+			Pointer<Byte> s00 = source + ComputeOffset(X0, Y0, Z0, sSliceB, sPitchB, srcBytes, state.srcTiled);
+			Pointer<Byte> s01 = source + ComputeOffset(X1, Y0, Z0, sSliceB, sPitchB, srcBytes, state.srcTiled);
+			Pointer<Byte> s10 = source + ComputeOffset(X0, Y1, Z0, sSliceB, sPitchB, srcBytes, state.srcTiled);
+			Pointer<Byte> s11 = source + ComputeOffset(X1, Y1, Z0, sSliceB, sPitchB, srcBytes, state.srcTiled);
 
 			Float4 c00 = readFloat4(s00, state);
 			Float4 c01 = readFloat4(s01, state);
@@ -1656,6 +1691,63 @@ Float4 Blitter::sample(Pointer<Byte> &source, Float &x, Float &y, Float &z,
 	return color;
 }
 
+Float4 Blitter::readAveraged(Pointer<Byte> element, Int &sSliceB, const State &state, bool &preScaled)
+{
+	Float4 color = readFloat4(element, state);
+
+	if(state.srcSamples > 1)  // Resolve multisampled source
+	{
+		if(state.allowSRGBConversion && state.sourceFormat.isSRGBformat())  // sRGB -> RGB
+		{
+			ApplyScaleAndClamp(color, state);
+			preScaled = true;
+		}
+		Float4 accum = color;
+		for(int sample = 1; sample < state.srcSamples; sample++)
+		{
+			element += sSliceB;
+			color = readFloat4(element, state);
+
+			if(state.allowSRGBConversion && state.sourceFormat.isSRGBformat())  // sRGB -> RGB
+			{
+				ApplyScaleAndClamp(color, state);
+				preScaled = true;
+			}
+			accum += color;
+		}
+		color = accum * Float4(1.0f / static_cast<float>(state.srcSamples));
+	}
+
+	return color;
+}
+
+void Blitter::CopyTexel(Pointer<Byte> source, Pointer<Byte> dest, int bytes)
+{
+	switch(bytes)
+	{
+	case 1:
+		*dest = *source;
+		break;
+	case 2:
+		*Pointer<Short>(dest) = *Pointer<Short>(source);
+		break;
+	case 4:
+		*Pointer<Int>(dest) = *Pointer<Int>(source);
+		break;
+	case 8:
+		*Pointer<Int2>(dest) = *Pointer<Int2>(source);
+		break;
+	case 16:
+		*Pointer<Int4>(dest) = *Pointer<Int4>(source);
+		break;
+	default:
+		for(int i = 0; i < bytes; i++)
+		{
+			dest[i] = source[i];
+		}
+	}
+}
+
 Blitter::BlitRoutineType Blitter::generate(const State &state)
 {
 	BlitFunction function;
@@ -1726,7 +1818,7 @@ Blitter::BlitRoutineType Blitter::generate(const State &state)
 				For(Int i = x0d, i < x1d, i++)
 				{
 					Float x = state.clearOperation ? RValue<Float>(x0) : x0 + Float(i) * w;
-					Pointer<Byte> d = destLine + i * dstBytes;
+					Pointer<Byte> d = state.destTiled ? destSlice + ComputeOffset(i, j, dPitchB, dstBytes, true) : destLine + i * dstBytes;
 
 					if(hasConstantColorI)
 					{
@@ -1759,7 +1851,7 @@ Blitter::BlitRoutineType Blitter::generate(const State &state)
 							Z = Clamp(Z, 0, sDepth - 1);
 						}
 
-						Pointer<Byte> s = source + ComputeOffset(X, Y, Z, sSliceB, sPitchB, srcBytes);
+						Pointer<Byte> s = source + ComputeOffset(X, Y, Z, sSliceB, sPitchB, srcBytes, state.srcTiled);
 
 						// When both formats are true integer types, we don't go to float to avoid losing precision
 						Int4 color = readInt4(s, state);
@@ -1796,6 +1888,7 @@ Blitter::BlitRoutineType Blitter::getBlitRoutine(const State &state)
 
 	if(!blitRoutine)
 	{
+		RoutineTelemetry::ScopedCompile compile(RoutineKind::Blit);
 		blitRoutine = generate(state);
 		blitCache.add(state, blitRoutine);
 	}
@@ -1803,6 +1896,224 @@ Blitter::BlitRoutineType Blitter::getBlitRoutine(const State &state)
 	return blitRoutine;
 }
 
+Blitter::ResolveRoutineType Blitter::generateResolve(const State &state)
+{
+	ResolveFunction function;
+	{
+		Pointer<Byte> resolve(function.Arg<0>());
+
+		Pointer<Byte> source = *Pointer<Pointer<Byte>>(resolve + OFFSET(ResolveData, source));
+		Pointer<Byte> dest = *Pointer<Pointer<Byte>>(resolve + OFFSET(ResolveData, dest));
+		Int sPitchB = *Pointer<Int>(resolve + OFFSET(ResolveData, sPitchB));
+		Int sSliceB = *Pointer<Int>(resolve + OFFSET(ResolveData, sSliceB));
+		Int dPitchB = *Pointer<Int>(resolve + OFFSET(ResolveData, dPitchB));
+
+		Int x0 = *Pointer<Int>(resolve + OFFSET(ResolveData, x0));
+		Int y0 = *Pointer<Int>(resolve + OFFSET(ResolveData, y0));
+		Int x0d = *Pointer<Int>(resolve + OFFSET(ResolveData, x0d));
+		Int y0d = *Pointer<Int>(resolve + OFFSET(ResolveData, y0d));
+		Int width = *Pointer<Int>(resolve + OFFSET(ResolveData, width));
+		Int height = *Pointer<Int>(resolve + OFFSET(ResolveData, height));
+
+		Pointer<Byte> sampleEquality = *Pointer<Pointer<Byte>>(resolve + OFFSET(ResolveData, sampleEquality));
+		Int sampleEqualityPitchB = *Pointer<Int>(resolve + OFFSET(ResolveData, sampleEqualityPitchB));
+		Int useSampleEquality = *Pointer<Int>(resolve + OFFSET(ResolveData, useSampleEquality));
+
+		// Like blits, integer formats resolve to the first sample.
+		bool intSrc = state.sourceFormat.isUnnormalizedInteger();
+		int bytes = state.sourceFormat.bytes();
+
+		// 8-bit normalized four-sample formats are resolved a SIMD row of pixels at a time,
+		// using the same rounding of the average as fastResolve().
+		bool packedBytes = false;
+		switch(state.sourceFormat)
+		{
+		case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_B8G8R8A8_UNORM:
+		case VK_FORMAT_A8B8G8R8_UNORM_PACK32:
+			packedBytes = (state.srcSamples == 4);
+			break;
+		default:
+			break;
+		}
+
+		// Averages 4-byte values byte-wise, rounding up like _mm_avg_epu8().
+		auto averageByte4 = [](const auto &x, const auto &y) {
+			using T = std::decay_t<decltype(x)>;
+			return T((x & y) + (((x ^ y) >> 1) & T(0x7F7F7F7F)) + ((x ^ y) & T(0x01010101)));
+		};
+
+		auto writePixels = [&](RValue<UInt4> color, Int xd, Int yd) {
+			if(!state.destTiled)
+			{
+				*Pointer<UInt4>(dest + ComputeOffset(xd, yd, dPitchB, bytes), 4) = color;
+			}
+			else
+			{
+				for(int l = 0; l < 4; l++)
+				{
+					Int x = xd + l;
+					*Pointer<UInt>(dest + ComputeOffset(x, yd, dPitchB, bytes, true)) = Extract(color, l);
+				}
+			}
+		};
+
+		// Copies the first sample of a row of pixels.
+		auto copyRow = [&](Pointer<Byte> sourceLine, Int xd, Int yd, Int count) {
+			Int i = 0;
+
+			if(bytes == 4)
+			{
+				While(i + 4 <= count)
+				{
+					writePixels(*Pointer<UInt4>(sourceLine + i * bytes, 4), xd + i, yd);
+					i += 4;
+				}
+			}
+
+			While(i < count)
+			{
+				Int x = xd + i;
+				CopyTexel(sourceLine + i * bytes, dest + ComputeOffset(x, yd, dPitchB, bytes, state.destTiled), bytes);
+				i++;
+			}
+		};
+
+		// Averages the samples of a row of pixels, except those whose uniform bit is set.
+		auto resolveRow = [&](Pointer<Byte> sourceLine, Int xd, Int yd, Int count, Int uniformBits) {
+			Int i = 0;
+
+			if(packedBytes)
+			{
+				While(i + 4 <= count)
+				{
+					Pointer<Byte> s = sourceLine + i * bytes;
+					UInt4 color = *Pointer<UInt4>(s, 4);
+
+					If(((uniformBits >> i) & 0xF) != 0xF)
+					{
+						UInt4 c1 = *Pointer<UInt4>(s + sSliceB, 4);
+						UInt4 c2 = *Pointer<UInt4>(s + 2 * sSliceB, 4);
+						UInt4 c3 = *Pointer<UInt4>(s + 3 * sSliceB, 4);
+						color = averageByte4(averageByte4(color, c1), averageByte4(c2, c3));
+					}
+
+					writePixels(color, xd + i, yd);
+					i += 4;
+				}
+			}
+
+			While(i < count)
+			{
+				Int x = xd + i;
+				Pointer<Byte> s = sourceLine + i * bytes;
+				Pointer<Byte> d = dest + ComputeOffset(x, yd, dPitchB, bytes, state.destTiled);
+
+				If(((uniformBits >> i) & 1) != 0)
+				{
+					// All samples are identical, so the first one is the average.
+					CopyTexel(s, d, bytes);
+				}
+				Else
+				{
+					if(packedBytes)
+					{
+						UInt c0 = *Pointer<UInt>(s);
+						UInt c1 = *Pointer<UInt>(s + sSliceB);
+						UInt c2 = *Pointer<UInt>(s + 2 * sSliceB);
+						UInt c3 = *Pointer<UInt>(s + 3 * sSliceB);
+						*Pointer<UInt>(d) = averageByte4(averageByte4(c0, c1), averageByte4(c2, c3));
+					}
+					else
+					{
+						bool preScaled = false;
+						Float4 color = readAveraged(s, sSliceB, state, preScaled);
+						ApplyScaleAndClamp(color, state, preScaled);
+						write(color, d, state);
+					}
+				}
+
+				i++;
+			}
+		};
+
+		// Process the region by sample equality tiles, so each tile's bits are only
+		// read and tested once.
+		Int j = 0;
+		While(j < height)
+		{
+			Int y = y0 + j;
+			Int rows = Min(Int(HIZ_TILE_HEIGHT) - (y & (HIZ_TILE_HEIGHT - 1)), height - j);
+			Pointer<Byte> equalityLine = sampleEquality + (y / HIZ_TILE_HEIGHT) * sampleEqualityPitchB;
+
+			Int i = 0;
+			While(i < width)
+			{
+				Int x = x0 + i;
+				Int columns = Min(Int(HIZ_TILE_WIDTH) - (x & (HIZ_TILE_WIDTH - 1)), width - i);
+
+				Int bits = 0;
+				Bool uniformTile = intSrc;
+
+				if(!intSrc)
+				{
+					If(useSampleEquality != 0)
+					{
+						bits = *Pointer<Int>(equalityLine + (x / HIZ_TILE_WIDTH) * sizeof(uint32_t));
+
+						Int rowMask = ((1 << columns) - 1) << (x & (HIZ_TILE_WIDTH - 1));
+						Int tileMask = rowMask << ((y & (HIZ_TILE_HEIGHT - 1)) * HIZ_TILE_WIDTH);
+						For(Int r = 1, r < rows, r++)
+						{
+							tileMask |= tileMask << HIZ_TILE_WIDTH;
+						}
+
+						uniformTile = ((bits & tileMask) == tileMask);
+					}
+				}
+
+				For(Int r = 0, r < rows, r++)
+				{
+					Pointer<Byte> sourceLine = source + (y + r) * sPitchB + x * bytes;
+					Int xd = x0d + i;
+					Int yd = y0d + j + r;
+
+					If(uniformTile)
+					{
+						copyRow(sourceLine, xd, yd, columns);
+					}
+					Else
+					{
+						Int rowShift = ((y + r) & (HIZ_TILE_HEIGHT - 1)) * HIZ_TILE_WIDTH + (x & (HIZ_TILE_WIDTH - 1));
+						resolveRow(sourceLine, xd, yd, columns, bits >> rowShift);
+					}
+				}
+
+				i += columns;
+			}
+
+			j += rows;
+		}
+	}
+
+	return function("ResolveRoutine");
+}
+
+Blitter::ResolveRoutineType Blitter::getResolveRoutine(const State &state)
+{
+	marl::lock lock(resolveMutex);
+	auto resolveRoutine = resolveCache.lookup(state);
+
+	if(!resolveRoutine)
+	{
+		RoutineTelemetry::ScopedCompile compile(RoutineKind::Resolve);
+		resolveRoutine = generateResolve(state);
+		resolveCache.add(state, resolveRoutine);
+	}
+
+	return resolveRoutine;
+}
+
 Blitter::CornerUpdateRoutineType Blitter::getCornerUpdateRoutine(const State &state)
 {
 	marl::lock lock(cornerUpdateMutex);
@@ -1810,6 +2121,7 @@ Blitter::CornerUpdateRoutineType Blitter::getCornerUpdateRoutine(const State &st
 
 	if(!cornerUpdateRoutine)
 	{
+		RoutineTelemetry::ScopedCompile compile(RoutineKind::CornerUpdate);
 		cornerUpdateRoutine = generateCornerUpdate(state);
 		cornerUpdateCache.add(state, cornerUpdateRoutine);
 	}
@@ -1878,6 +2190,8 @@ void Blitter::blit(const vk::Image *src, vk::Image *dst, VkImageBlit2KHR region,
 	                    (doFilter && ((x0 < 0.5f) || (y0 < 0.5f)));
 	state.filter3D = (region.srcOffsets[1].z - region.srcOffsets[0].z) !=
 	                 (region.dstOffsets[1].z - region.dstOffsets[0].z);
+	state.srcTiled = src->hasTiledLayout();
+	state.destTiled = dst->hasTiledLayout();
 
 	auto blitRoutine = getBlitRoutine(state);
 	if(!blitRoutine)
@@ -2045,7 +2359,7 @@ void Blitter::resolve(const vk::Image *src, vk::Image *dst, VkImageResolve2KHR r
 	// - VkSubpassDescription: "each resolve attachment that is not VK_ATTACHMENT_UNUSED must have the same VkFormat as its corresponding color attachment."
 	ASSERT(src->getFormat() == dst->getFormat());
 
-	if(fastResolve(src, dst, region))
+	if(fastResolve(src, dst, region) || routineResolve(src, dst, region))
 	{
 		return;
 	}
@@ -2071,6 +2385,79 @@ void Blitter::resolve(const vk::Image *src, vk::Image *dst, VkImageResolve2KHR r
 	blit(src, dst, blitRegion, VK_FILTER_NEAREST);
 }
 
+bool Blitter::routineResolve(const vk::Image *src, vk::Image *dst, const VkImageResolve2KHR &region)
+{
+	if((region.extent.depth != 1) || (region.srcOffset.z != 0) || (region.dstOffset.z != 0))
+	{
+		return false;
+	}
+
+	vk::Format format = src->getFormat(VK_IMAGE_ASPECT_COLOR_BIT);
+	State state(format, format, src->getSampleCount(), dst->getSampleCount(), Options{ false, true });
+	state.destTiled = dst->hasTiledLayout();
+
+	auto resolveRoutine = getResolveRoutine(state);
+	if(!resolveRoutine)
+	{
+		return false;
+	}
+
+	ResolveData data = {
+		nullptr,                                                                                                 // source
+		nullptr,                                                                                                 // dest
+		assert_cast<uint32_t>(src->rowPitchBytes(VK_IMAGE_ASPECT_COLOR_BIT, region.srcSubresource.mipLevel)),    // sPitchB
+		assert_cast<uint32_t>(src->slicePitchBytes(VK_IMAGE_ASPECT_COLOR_BIT, region.srcSubresource.mipLevel)),  // sSliceB
+		assert_cast<uint32_t>(dst->rowPitchBytes(VK_IMAGE_ASPECT_COLOR_BIT, region.dstSubresource.mipLevel)),    // dPitchB
+
+		region.srcOffset.x,                      // x0
+		region.srcOffset.y,                      // y0
+		region.dstOffset.x,                      // x0d
+		region.dstOffset.y,                      // y0d
+		static_cast<int>(region.extent.width),   // width
+		static_cast<int>(region.extent.height),  // height
+
+		nullptr,                             // sampleEquality
+		src->getSampleEqualityPitchBytes(),  // sampleEqualityPitchB
+		0,                                   // useSampleEquality
+	};
+
+	VkImageSubresource srcSubres = {
+		region.srcSubresource.aspectMask,
+		region.srcSubresource.mipLevel,
+		region.srcSubresource.baseArrayLayer
+	};
+
+	VkImageSubresource dstSubres = {
+		region.dstSubresource.aspectMask,
+		region.dstSubresource.mipLevel,
+		region.dstSubresource.baseArrayLayer
+	};
+
+	VkImageSubresourceRange dstSubresRange = {
+		region.dstSubresource.aspectMask,
+		region.dstSubresource.mipLevel,
+		1,  // levelCount
+		region.dstSubresource.baseArrayLayer,
+		region.dstSubresource.layerCount
+	};
+
+	uint32_t lastLayer = dst->getLastLayerIndex(dstSubresRange);
+
+	for(; dstSubres.arrayLayer <= lastLayer; srcSubres.arrayLayer++, dstSubres.arrayLayer++)
+	{
+		data.source = src->getTexelPointer({ 0, 0, 0 }, srcSubres);
+		data.dest = dst->getTexelPointer({ 0, 0, 0 }, dstSubres);
+		data.sampleEquality = (srcSubres.mipLevel == 0) ? src->getSampleEqualityTiles(srcSubres.arrayLayer) : nullptr;
+		data.useSampleEquality = (data.sampleEquality != nullptr);
+
+		resolveRoutine(&data);
+	}
+
+	dst->contentsChanged(dstSubresRange);
+
+	return true;
+}
+
 static inline uint32_t averageByte4(uint32_t x, uint32_t y)
 {
 	return (x & y) + (((x ^ y) >> 1) & 0x7F7F7F7F) + ((x ^ y) & 0x01010101);
@@ -2078,6 +2465,11 @@ static inline uint32_t averageByte4(uint32_t x, uint32_t y)
 
 bool Blitter::fastResolve(const vk::Image *src, vk::Image *dst, VkImageResolve2KHR region)
 {
+	if(dst->hasTiledLayout())
+	{
+		return false;
+	}
+
 	if(region.dstOffset != VkOffset3D{ 0, 0, 0 })
 	{
 		return false;
@@ -2137,6 +2529,21 @@ bool Blitter::fastResolve(const vk::Image *src, vk::Image *dst, VkImageResolve2K
 	uint8_t *source2 = source1 + slice;
 	uint8_t *source3 = source2 + slice;
 
+	// Pixels whose samples are known to be equal only need their first sample to be read.
+	const uint32_t *sampleEquality = (region.srcSubresource.mipLevel == 0) ? src->getSampleEqualityTiles(region.srcSubresource.baseArrayLayer) : nullptr;
+	int sampleEqualityPitch = src->getSampleEqualityPitchBytes() / sizeof(uint32_t);
+
+	auto uniformPixels = [&](int x, int y, int count) -> bool {
+		if(!sampleEquality)
+		{
+			return false;
+		}
+
+		uint32_t bits = sampleEquality[(y / HIZ_TILE_HEIGHT) * sampleEqualityPitch + x / HIZ_TILE_WIDTH];
+		uint32_t mask = ((1u << count) - 1) << ((y % HIZ_TILE_HEIGHT) * HIZ_TILE_WIDTH + x % HIZ_TILE_WIDTH);
+		return (bits & mask) == mask;
+	};
+
 	[[maybe_unused]] const bool SSE2 = CPUID::supportsSSE2();
 
 	if(format == VK_FORMAT_R8G8B8A8_UNORM || format == VK_FORMAT_B8G8R8A8_UNORM || format == VK_FORMAT_A8B8G8R8_UNORM_PACK32)
@@ -2152,6 +2559,12 @@ bool Blitter::fastResolve(const vk::Image *src, vk::Image *dst, VkImageResolve2K
 				{
 					for(; (x + 3) < width; x += 4)
 					{
+						if(uniformPixels(x, y, 4))
+						{
+							_mm_storeu_si128((__m128i *)(dest + 4 * x), _mm_loadu_si128((__m128i *)(source0 + 4 * x)));
+							continue;
+						}
+
 						__m128i c0 = _mm_loadu_si128((__m128i *)(source0 + 4 * x));
 						__m128i c1 = _mm_loadu_si128((__m128i *)(source1 + 4 * x));
 						__m128i c2 = _mm_loadu_si128((__m128i *)(source2 + 4 * x));
@@ -2168,6 +2581,12 @@ bool Blitter::fastResolve(const vk::Image *src, vk::Image *dst, VkImageResolve2K
 
 				for(; x < width; x++)
 				{
+					if(uniformPixels(x, y, 1))
+					{
+						*(uint32_t *)(dest + 4 * x) = *(uint32_t *)(source0 + 4 * x);
+						continue;
+					}
+
 					uint32_t c0 = *(uint32_t *)(source0 + 4 * x);
 					uint32_t c1 = *(uint32_t *)(source1 + 4 * x);
 					uint32_t c2 = *(uint32_t *)(source2 + 4 * x);
@@ -2210,6 +2629,7 @@ void Blitter::copy(const vk::Image *src, uint8_t *dst, unsigned int dstPitch)
 	size_t rowBytes = src->getFormat(VK_IMAGE_ASPECT_COLOR_BIT).bytes() * extent.width;
 	unsigned int srcPitch = src->rowPitchBytes(VK_IMAGE_ASPECT_COLOR_BIT, 0);
 	ASSERT(dstPitch >= rowBytes && srcPitch >= rowBytes && src->getMipLevelExtent(VK_IMAGE_ASPECT_COLOR_BIT, 0).height >= extent.height);
+	ASSERT(!src->hasTiledLayout());  // Presentable images are linear
 
 	const uint8_t *s = (uint8_t *)src->getTexelPointer({ 0, 0, 0 }, { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0 });
 	uint8_t *d = dst;
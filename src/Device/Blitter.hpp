@@ -96,6 +96,8 @@ class Blitter
 		int srcSamples = 0;
 		int destSamples = 0;
 		bool filter3D = false;
+		bool srcTiled = false;   // Source image has a tiled layout
+		bool destTiled = false;  // Destination image has a tiled layout
 	};
 	friend std::hash<Blitter::State>;
 
@@ -129,6 +131,27 @@ class Blitter
 		bool filter3D;
 	};
 
+	struct ResolveData
+	{
+		const void *source;
+		void *dest;
+		uint32_t sPitchB;
+		uint32_t sSliceB;
+		uint32_t dPitchB;
+
+		int x0;
+		int y0;
+		int x0d;
+		int y0d;
+		int width;
+		int height;
+
+		// Optional sample equality bits of the source. See vk::Image::getSampleEqualityTiles().
+		const uint32_t *sampleEquality;
+		uint32_t sampleEqualityPitchB;
+		int useSampleEquality;
+	};
+
 	struct CubeBorderData
 	{
 		void *layers;
@@ -143,6 +166,10 @@ public:
 
 	void clear(const void *clearValue, vk::Format clearFormat, vk::Image *dest, const vk::Format &viewFormat, const VkImageSubresourceRange &subresourceRange, const VkRect2D *renderArea = nullptr);
 
+	// Computes the texel value which clear() would write to the aspect of an image of the given
+	// view format, for formats with a single texel value of 32 bits or less. Returns false otherwise.
+	static bool GetClearPattern(const void *clearValue, vk::Format clearFormat, const vk::Format &viewFormat, VkImageAspectFlagBits aspect, uint32_t &packed);
+
 	void blit(const vk::Image *src, vk::Image *dst, VkImageBlit2KHR region, VkFilter filter);
 	void resolve(const vk::Image *src, vk::Image *dst, VkImageResolve2KHR region);
 	void resolveDepthStencil(const vk::ImageView *src, vk::ImageView *dst, VkResolveModeFlagBits depthResolveMode, VkResolveModeFlagBits stencilResolveMode);
@@ -161,6 +188,7 @@ private:
 
 	bool fastClear(const void *clearValue, vk::Format clearFormat, vk::Image *dest, const vk::Format &viewFormat, const VkImageSubresourceRange &subresourceRange, const VkRect2D *renderArea);
 	bool fastResolve(const vk::Image *src, vk::Image *dst, VkImageResolve2KHR region);
+	bool routineResolve(const vk::Image *src, vk::Image *dst, const VkImageResolve2KHR &region);
 
 	Float4 readFloat4(Pointer<Byte> element, const State &state);
 	void write(Float4 &color, Pointer<Byte> element, const State &state);
@@ -168,7 +196,8 @@ private:
 	void write(Int4 &color, Pointer<Byte> element, const State &state);
 	static void ApplyScaleAndClamp(Float4 &value, const State &state, bool preScaled = false);
 	static Int ComputeOffset(Int &x, Int &y, Int &pitchB, int bytes);
-	static Int ComputeOffset(Int &x, Int &y, Int &z, Int &sliceB, Int &pitchB, int bytes);
+	static Int ComputeOffset(Int &x, Int &y, Int &pitchB, int bytes, bool tiled);
+	static Int ComputeOffset(Int &x, Int &y, Int &z, Int &sliceB, Int &pitchB, int bytes, bool tiled);
 
 	using BlitFunction = FunctionT<void(const BlitData *)>;
 	using BlitRoutineType = BlitFunction::RoutineType;
@@ -177,6 +206,13 @@ private:
 	Float4 sample(Pointer<Byte> &source, Float &x, Float &y, Float &z,
 	              Int &sWidth, Int &sHeight, Int &sDepth,
 	              Int &sSliceB, Int &sPitchB, const State &state);
+	Float4 readAveraged(Pointer<Byte> element, Int &sSliceB, const State &state, bool &preScaled);
+	static void CopyTexel(Pointer<Byte> source, Pointer<Byte> dest, int bytes);
+
+	using ResolveFunction = FunctionT<void(const ResolveData *)>;
+	using ResolveRoutineType = ResolveFunction::RoutineType;
+	ResolveRoutineType getResolveRoutine(const State &state);
+	ResolveRoutineType generateResolve(const State &state);
 
 	using CornerUpdateFunction = FunctionT<void(const CubeBorderData *)>;
 	using CornerUpdateRoutineType = CornerUpdateFunction::RoutineType;
@@ -191,6 +227,9 @@ private:
 	marl::mutex blitMutex;
 	RoutineCache<State, BlitFunction::CFunctionType> blitCache GUARDED_BY(blitMutex);
 
+	marl::mutex resolveMutex;
+	RoutineCache<State, ResolveFunction::CFunctionType> resolveCache GUARDED_BY(resolveMutex);
+
 	marl::mutex cornerUpdateMutex;
 	RoutineCache<State, CornerUpdateFunction::CFunctionType> cornerUpdateCache GUARDED_BY(cornerUpdateMutex);
 };
@@ -209,6 +248,8 @@ struct hash<sw::Blitter::State>
 		hash = hash * 31 + state.srcSamples;
 		hash = hash * 31 + state.destSamples;
 		hash = hash * 31 + state.filter3D;
+		hash = hash * 31 + state.srcTiled;
+		hash = hash * 31 + state.destTiled;
 		return hash;
 	}
 };
@@ -17,7 +17,6 @@
 
 namespace sw {
 
-constexpr int OUTLINE_RESOLUTION = 8192;  // Maximum vertical resolution of the render target
 constexpr int MIPMAP_LEVELS = 15;
 constexpr int MAX_CLIP_DISTANCES = 8;
 constexpr int MAX_CULL_DISTANCES = 8;
@@ -26,8 +25,12 @@ constexpr int MAX_TEXEL_OFFSET = 7;
 constexpr int MAX_TEXTURE_LOD = MIPMAP_LEVELS - 2;  // Trilinear accesses lod+1
 constexpr int MAX_COLOR_BUFFERS = 8;
 constexpr int MAX_INTERFACE_COMPONENTS = 32 * 4;  // Must be multiple of 4 for 16-byte alignment.
-constexpr int MAX_FRAMEBUFFER_DIM = OUTLINE_RESOLUTION;
+constexpr int MAX_POLYGON_EDGES = 16;  // Clipped polygons have at most this many vertices
+constexpr int MAX_FRAMEBUFFER_DIM = 16384;
 constexpr int MAX_VIEWPORT_DIM = MAX_FRAMEBUFFER_DIM;
+constexpr int HIZ_TILE_WIDTH = 16;  // Must be a power of two
+constexpr int HIZ_TILE_HEIGHT = 2;
+constexpr int TEXEL_TILE_SIZE = 4;  // Width and height of the tiles of images with a tiled layout. Must be a power of two
 
 }  // namespace sw
 
@@ -0,0 +1,50 @@
+// Copyright 2026 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef sw_HiZ_hpp
+#define sw_HiZ_hpp
+
+#include "Device/Config.hpp"
+
+#include <cstdint>
+#include <limits>
+
+namespace sw {
+
+// Hierarchical depth information for one HIZ_TILE_WIDTH x HIZ_TILE_HEIGHT block of a
+// depth attachment, covering all of its samples. maxZ is an upper bound of the depth
+// values in the tile, expressed in the units the depth test compares in (i.e. 0 to
+// 0xFFFF for D16_UNORM). When 'dirty' is set, depth writes have occurred since maxZ was
+// last computed, and it must be recomputed from the depth buffer before it can be
+// relied upon to be tight. Writes which can increase depth also reset maxZ to infinity.
+//
+// Tiles span a single pair of rows, which is the granularity at which the rasterizer
+// distributes work across clusters. Each tile is therefore only ever accessed by the
+// cluster which also owns the corresponding depth buffer rows.
+struct HiZTile
+{
+	float maxZ;
+	uint32_t dirty;
+
+	static constexpr HiZTile Invalid()
+	{
+		return { std::numeric_limits<float>::infinity(), 1 };
+	}
+};
+
+static_assert(HIZ_TILE_HEIGHT == 2, "Hi-Z tiles must match the rasterizer's row pair granularity");
+
+}  // namespace sw
+
+#endif  // sw_HiZ_hpp
@@ -18,6 +18,7 @@
 #include "Pipeline/Constants.hpp"
 #include "Pipeline/PixelProgram.hpp"
 #include "System/Debug.hpp"
+#include "System/RoutineTelemetry.hpp"
 #include "Vulkan/VkImageView.hpp"
 #include "Vulkan/VkPipelineLayout.hpp"
 
@@ -68,7 +69,71 @@ void PixelProcessor::setBlendConstant(const float4 &blendConstant)
 
 void PixelProcessor::setRoutineCacheSize(int cacheSize)
 {
-	routineCache = std::make_unique<RoutineCacheType>(clamp(cacheSize, 1, 65536));
+	routineCache = std::make_unique<RoutineCacheType>(clamp(cacheSize, 1, 65536), RoutineKind::Pixel);
+}
+
+// Blending of 8-bit normalized color attachments can be performed on 8-bit fixed-point
+// values. The products of the 8-bit colors and blend factors are combined exactly, and
+// divided by 255 with rounding to nearest, which gives results identical to the
+// floating-point path whenever the source color is a multiple of 1/255. Other source
+// colors are rounded to 8-bit before blending instead of after it. Blend constants
+// are not supported since they're not limited to 8-bit precision.
+static bool SupportsFixedPointBlend(vk::Format format, const vk::BlendState &blendState)
+{
+	switch(format)
+	{
+	case VK_FORMAT_R8G8B8A8_UNORM:
+	case VK_FORMAT_B8G8R8A8_UNORM:
+	case VK_FORMAT_A8B8G8R8_UNORM_PACK32:
+		break;
+	default:
+		return false;
+	}
+
+	auto supportedFactor = [](VkBlendFactor factor) {
+		switch(factor)
+		{
+		case VK_BLEND_FACTOR_ZERO:
+		case VK_BLEND_FACTOR_ONE:
+		case VK_BLEND_FACTOR_SRC_COLOR:
+		case VK_BLEND_FACTOR_ONE_MINUS_SRC_COLOR:
+		case VK_BLEND_FACTOR_DST_COLOR:
+		case VK_BLEND_FACTOR_ONE_MINUS_DST_COLOR:
+		case VK_BLEND_FACTOR_SRC_ALPHA:
+		case VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA:
+		case VK_BLEND_FACTOR_DST_ALPHA:
+		case VK_BLEND_FACTOR_ONE_MINUS_DST_ALPHA:
+		case VK_BLEND_FACTOR_SRC_ALPHA_SATURATE:
+			return true;
+		default:
+			return false;
+		}
+	};
+
+	auto supportedOperation = [](VkBlendOp operation) {
+		switch(operation)
+		{
+		case VK_BLEND_OP_ADD:
+		case VK_BLEND_OP_SUBTRACT:
+		case VK_BLEND_OP_REVERSE_SUBTRACT:
+		case VK_BLEND_OP_MIN:
+		case VK_BLEND_OP_MAX:
+		case VK_BLEND_OP_SRC_EXT:
+		case VK_BLEND_OP_DST_EXT:
+		case VK_BLEND_OP_ZERO_EXT:
+			return true;
+		default:
+			return false;
+		}
+	};
+
+	return blendState.alphaBlendEnable &&
+	       supportedOperation(blendState.blendOperation) &&
+	       supportedOperation(blendState.blendOperationAlpha) &&
+	       supportedFactor(blendState.sourceBlendFactor) &&
+	       supportedFactor(blendState.destBlendFactor) &&
+	       supportedFactor(blendState.sourceBlendFactorAlpha) &&
+	       supportedFactor(blendState.destBlendFactorAlpha);
 }
 
 const PixelProcessor::State PixelProcessor::update(const vk::GraphicsState &pipelineState, const sw::SpirvShader *fragmentShader, const sw::SpirvShader *vertexShader, const vk::Attachments &attachments, bool occlusionEnabled) const
@@ -138,6 +203,30 @@ const PixelProcessor::State PixelProcessor::update(const vk::GraphicsState &pipe
 
 	state.occlusionEnabled = occlusionEnabled;
 
+	if(state.depthTestActive && attachments.depthBuffer->hasHiZ())
+	{
+		// Rejecting fragments ahead of the shader is only observable when the shader would
+		// otherwise have produced side effects, or determined a depth value of its own.
+		bool shaderAllowsCulling = !fragmentShader ||
+		                           fragmentShader->getExecutionModes().EarlyFragmentTests ||
+		                           (!fragmentShader->getAnalysis().ContainsSideEffects &&
+		                            !fragmentShader->hasBuiltinOutput(spv::BuiltInFragDepth));
+
+		// Failing the depth test must leave the stencil buffer untouched.
+		auto stencilKeeps = [](const States::StencilOpState &op) {
+			return !op.writeEnabled || ((op.failOp == VK_STENCIL_OP_KEEP) && (op.depthFailOp == VK_STENCIL_OP_KEEP));
+		};
+		bool stencilAllowsCulling = !state.stencilActive || (stencilKeeps(state.frontStencil) && stencilKeeps(state.backStencil));
+
+		// Only tests which fail for depth values greater than the stored ones can use the tiles' maximum depth.
+		bool compareAllowsCulling = (state.depthCompareMode == VK_COMPARE_OP_LESS) ||
+		                            (state.depthCompareMode == VK_COMPARE_OP_LESS_OR_EQUAL) ||
+		                            (state.depthCompareMode == VK_COMPARE_OP_EQUAL);
+
+		state.hiZCull = shaderAllowsCulling && stencilAllowsCulling && compareAllowsCulling;
+		state.hiZ = state.hiZCull || state.depthWriteEnable;
+	}
+
 	bool fragmentContainsDiscard = (fragmentShader && fragmentShader->getAnalysis().ContainsDiscard);
 	for(uint32_t location = 0; location < MAX_COLOR_BUFFERS; location++)
 	{
@@ -145,6 +234,29 @@ const PixelProcessor::State PixelProcessor::update(const vk::GraphicsState &pipe
 
 		state.colorWriteMask |= fragmentOutputInterfaceState.colorWriteActive(location, attachments) << (4 * location);
 		state.blendState[location] = fragmentOutputInterfaceState.getBlendState(location, attachments, fragmentContainsDiscard);
+
+		if(state.colorWriteActive(location) && SupportsFixedPointBlend(state.colorFormat[location], state.blendState[location]))
+		{
+			state.fixedPointBlendMask |= 1 << location;
+		}
+	}
+
+	for(uint32_t location = 0; location < MAX_COLOR_BUFFERS; location++)
+	{
+		if(state.colorWriteActive(location) && attachments.colorBuffer[location]->hasDeferredClears())
+		{
+			state.deferredClearMask |= 1 << location;
+		}
+
+		if(state.colorWriteActive(location) && attachments.colorBuffer[location]->hasSampleEquality())
+		{
+			state.sampleEqualityMask |= 1 << location;
+		}
+	}
+
+	if((state.depthTestActive || state.depthBoundsTestActive) && attachments.depthBuffer->hasDeferredClears())
+	{
+		state.deferredClearMask |= 1 << MAX_COLOR_BUFFERS;
 	}
 
 	const bool isBresenhamLine = vertexInputInterfaceState.isDrawLine(true, preRasterizationState.getPolygonMode()) &&
@@ -196,6 +308,8 @@ PixelProcessor::RoutineType PixelProcessor::routine(const State &state,
 
 	if(!routine)
 	{
+		RoutineTelemetry::ScopedCompile compile(RoutineKind::Pixel);
+
 		QuadRasterizer *generator = new PixelProgram(state, pipelineLayout, pixelShader, attachments, descriptorSets);
 		generator->generate();
 		routine = (*generator)("PixelRoutine_%0.8X", state.shaderID);
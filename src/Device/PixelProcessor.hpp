@@ -105,6 +105,13 @@ public:
 
 		float minDepthClamp;
 		float maxDepthClamp;
+
+		bool hiZ;      // Maintain the depth attachment's hierarchical depth tiles
+		bool hiZCull;  // Spans can be rejected based on the hierarchical depth tiles
+
+		unsigned int deferredClearMask;    // Attachments with pending per-tile clears. Bit MAX_COLOR_BUFFERS is depth.
+		unsigned int sampleEqualityMask;   // Color attachments whose per-pixel sample equality bits must be maintained
+		unsigned int fixedPointBlendMask;  // Color attachments blended in 8-bit fixed-point
 	};
 
 	struct State : States
@@ -38,6 +38,8 @@ struct Primitive
 {
 	int yMin;
 	int yMax;
+	int xMin;
+	int xMax;
 
 	float x0;
 	float y0;
@@ -56,17 +58,28 @@ struct Primitive
 	int64_t clockwiseMask;
 	int64_t invClockwiseMask;
 
-	struct Span
+	// Half-space form of a polygon edge, with the fixed-point vertex coordinates reduced to
+	// whole pixels. The rasterizer evaluates it exactly with 64-bit arithmetic, while the
+	// floating-point form only serves to bound the rows conservatively.
+	struct Edge  // Pixel (x, y) is covered when A * x + B * y + C >= 0
 	{
-		unsigned short left;
-		unsigned short right;
+		int A;
+		int B;
+		int64_t C;
+
+		float x0;  // x = x0 + dxdy * (y - y0), for edges with A != 0
+		float y0;
+		float dxdy;
+		int padding;
 	};
 
-	// The rasterizer adds a zero length span to the top and bottom of the polygon to allow
-	// for 2x2 pixel processing. We need an even number of spans to keep accesses aligned.
-	Span outlineUnderflow[2];
-	Span outline[OUTLINE_RESOLUTION];
-	Span outlineOverflow[2];
+	// The polygon's edges for this sample, followed by the left and right scissor edges.
+	int edgeCount;
+	Edge edge[MAX_POLYGON_EDGES + 2];
+
+	// Coverage of the 2x8 pixel block at (xMin & -8, yMin & -2) by this sample, for primitives
+	// which fit within it, as computed during setup. -1 for larger primitives.
+	int blockMask;
 };
 
 }  // namespace sw
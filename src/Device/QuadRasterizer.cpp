@@ -14,13 +14,17 @@
 
 #include "QuadRasterizer.hpp"
 
+#include "HiZ.hpp"
 #include "Primitive.hpp"
 #include "Renderer.hpp"
 #include "Pipeline/Constants.hpp"
+#include "Pipeline/RasterizerCore.hpp"
 #include "System/Debug.hpp"
 #include "System/Math.hpp"
 #include "Vulkan/VkDevice.hpp"
 
+#include <limits>
+
 namespace sw {
 
 QuadRasterizer::QuadRasterizer(const PixelProcessor::State &state, const SpirvShader *spirvShader)
@@ -94,34 +98,83 @@ void QuadRasterizer::rasterize(Int &yMin, Int &yMax)
 		sBuffer = *Pointer<Pointer<Byte>>(data + OFFSET(DrawData, stencilBuffer)) + yMin * *Pointer<Int>(data + OFFSET(DrawData, stencilPitchB));
 	}
 
-	Int y = yMin;
+	if(state.hiZ)
+	{
+		hiZBuffer = *Pointer<Pointer<Byte>>(data + OFFSET(DrawData, hiZBuffer)) + (yMin >> 1) * *Pointer<Int>(data + OFFSET(DrawData, hiZPitchB));
+	}
 
-	Do
+	for(int index = 0; index <= MAX_COLOR_BUFFERS; index++)
 	{
-		Int x0a = Int(*Pointer<Short>(primitive + OFFSET(Primitive, outline->left) + (y + 0) * sizeof(Primitive::Span)));
-		Int x0b = Int(*Pointer<Short>(primitive + OFFSET(Primitive, outline->left) + (y + 1) * sizeof(Primitive::Span)));
-		Int x0 = Min(x0a, x0b);
+		if(state.deferredClearMask & (1 << index))
+		{
+			deferredClearTiles[index] = *Pointer<Pointer<Byte>>(data + OFFSET(DrawData, deferredClearTiles[index])) + (yMin >> 1) * *Pointer<Int>(data + OFFSET(DrawData, deferredClearTilesPitchB[index]));
+		}
+	}
 
-		for(unsigned int q = 1; q < state.multiSampleCount; q++)
+	for(int index = 0; index < MAX_COLOR_BUFFERS; index++)
+	{
+		if(state.sampleEqualityMask & (1 << index))
 		{
-			x0a = Int(*Pointer<Short>(primitive + q * sizeof(Primitive) + OFFSET(Primitive, outline->left) + (y + 0) * sizeof(Primitive::Span)));
-			x0b = Int(*Pointer<Short>(primitive + q * sizeof(Primitive) + OFFSET(Primitive, outline->left) + (y + 1) * sizeof(Primitive::Span)));
-			x0 = Min(x0, Min(x0a, x0b));
+			sampleEqualityTiles[index] = *Pointer<Pointer<Byte>>(data + OFFSET(DrawData, sampleEqualityTiles[index])) + (yMin >> 1) * *Pointer<Int>(data + OFFSET(DrawData, sampleEqualityPitchB[index]));
 		}
+	}
 
-		x0 &= 0xFFFFFFFE;
+	// Horizontal bounding box of the primitive's samples
+	Int xMin = *Pointer<Int>(primitive + OFFSET(Primitive, xMin));
+	Int xMax = *Pointer<Int>(primitive + OFFSET(Primitive, xMax));
+	Bool narrow = (xMax - xMin <= 8);
 
-		Int x1a = Int(*Pointer<Short>(primitive + OFFSET(Primitive, outline->right) + (y + 0) * sizeof(Primitive::Span)));
-		Int x1b = Int(*Pointer<Short>(primitive + OFFSET(Primitive, outline->right) + (y + 1) * sizeof(Primitive::Span)));
-		Int x1 = Max(x1a, x1b);
+	// The coverage of primitives within a single 2x8 pixel block was computed during setup.
+	Bool precomputed = *Pointer<Int>(primitive + OFFSET(Primitive, blockMask)) != -1;
 
-		for(unsigned int q = 1; q < state.multiSampleCount; q++)
+	Int y = yMin;
+
+	Do
+	{
+		// Conservative horizontal bounds of the row pair. Narrow primitives just use their bounding
+		// box. Otherwise it's narrowed with the first sample's edges. These are evaluated one row
+		// beyond each side, and widened, to also contain the other sample locations.
+		Int x0 = xMin;
+		Int x1 = xMax;
+
+		If(!narrow)
 		{
-			x1a = Int(*Pointer<Short>(primitive + q * sizeof(Primitive) + OFFSET(Primitive, outline->right) + (y + 0) * sizeof(Primitive::Span)));
-			x1b = Int(*Pointer<Short>(primitive + q * sizeof(Primitive) + OFFSET(Primitive, outline->right) + (y + 1) * sizeof(Primitive::Span)));
-			x1 = Max(x1, Max(x1a, x1b));
+			Float yTop = Float(y - 1);
+			Float yBottom = Float(y + 2);
+			Float xLeft = Float(xMin);
+			Float xRight = Float(xMax);
+
+			Int edgeCount = *Pointer<Int>(primitive + OFFSET(Primitive, edgeCount));
+
+			For(Int e = 0, e < edgeCount, e++)
+			{
+				Pointer<Byte> edge = primitive + OFFSET(Primitive, edge) + e * sizeof(Primitive::Edge);
+				Int A = *Pointer<Int>(edge + OFFSET(Primitive::Edge, A));
+				Float edgeX0 = *Pointer<Float>(edge + OFFSET(Primitive::Edge, x0));
+				Float edgeY0 = *Pointer<Float>(edge + OFFSET(Primitive::Edge, y0));
+				Float dxdy = *Pointer<Float>(edge + OFFSET(Primitive::Edge, dxdy));
+
+				Float xTop = edgeX0 + dxdy * (yTop - edgeY0);
+				Float xBottom = edgeX0 + dxdy * (yBottom - edgeY0);
+
+				If(A > 0)  // Left edge
+				{
+					xLeft = Max(xLeft, Min(xTop, xBottom));
+				}
+
+				If(A < 0)  // Right edge
+				{
+					xRight = Min(xRight, Max(xTop, xBottom));
+				}
+			}
+
+			x0 = Max(Int(Min(xLeft, Float(xMax))) - 2, xMin);
+			x1 = Min(Int(Max(xRight, Float(xMin))) + 2, xMax);
 		}
 
+		// Blocks are aligned to 8 pixels, so they don't straddle attachment tiles.
+		x0 &= -8;
+
 		// Compute the y coordinate of each fragment in the SIMD group.
 		const auto yMorton = SIMD::Float([](int i) { return float(compactEvenBits(i >> 1)); });  // 0, 0, 1, 1, 0, 0, 1, 1, 2, 2, 3, 3, 2, 2, 3, 3, ...
 		yFragment = SIMD::Float(Float(y)) + yMorton - SIMD::Float(*Pointer<Float>(primitive + OFFSET(Primitive, y0)));
@@ -178,34 +231,127 @@ void QuadRasterizer::rasterize(Int &yMin, Int &yMax)
 				}
 			}
 
-			Short4 xLeft[4];
-			Short4 xRight[4];
+			// Rasterize blocks of 2x8 pixels. Quads with no covered samples are skipped.
+			auto rasterizeSpan = [&](const Int &xBegin, const Int &xEnd) {
+				For(Int x = xBegin, x < xEnd, x += 8)
+				{
+					Int blockMask[4];
+					Int covered = 0;
 
-			for(unsigned int q = 0; q < state.multiSampleCount; q++)
-			{
-				xLeft[q] = *Pointer<Short4>(primitive + q * sizeof(Primitive) + OFFSET(Primitive, outline) + y * sizeof(Primitive::Span));
-				xRight[q] = xLeft[q];
+					auto sampleCoverage = [&](unsigned int q) {
+						Pointer<Byte> sample = primitive + q * sizeof(Primitive);
+						Int mask;
 
-				xLeft[q] = Swizzle(xLeft[q], 0x0022) - Short4(1, 2, 1, 2);
-				xRight[q] = Swizzle(xRight[q], 0x1133) - Short4(0, 1, 0, 1);
-			}
+						If(precomputed)
+						{
+							mask = *Pointer<Int>(sample + OFFSET(Primitive, blockMask));
+						}
+						Else
+						{
+							mask = blockCoverage(sample, x, y);
+						}
+
+						return mask;
+					};
+
+					if(!state.enableMultiSampling)
+					{
+						covered = sampleCoverage(0);
+					}
 
-			For(Int x = x0, x < x1, x += 2)
+					for(unsigned int q = 0; q < state.multiSampleCount; q++)
+					{
+						if(state.multiSampleMask & (1 << q))
+						{
+							if(state.enableMultiSampling)
+							{
+								blockMask[q] = sampleCoverage(q);
+								covered |= blockMask[q];
+							}
+							else
+							{
+								blockMask[q] = covered;
+							}
+						}
+					}
+
+					If(covered != 0)
+					{
+						For(Int i = 0, i < 4, i++)
+						{
+							Int shift = i * 4;
+							Int cMask[4];
+
+							for(unsigned int q = 0; q < state.multiSampleCount; q++)
+							{
+								if(state.multiSampleMask & (1 << q))
+								{
+									cMask[q] = (blockMask[q] >> shift) & 0x0000000F;
+								}
+							}
+
+							If(((covered >> shift) & 0x0000000F) != 0)
+							{
+								Int xQuad = x + i * 2;
+								quad(cBuffer, zBuffer, sBuffer, cMask, xQuad, y);
+							}
+						}
+					}
+				}
+			};
+
+			if(!state.hiZ && !state.deferredClearMask)
 			{
-				Short4 xxxx = Short4(x);
-				Int cMask[4];
+				rasterizeSpan(x0, x1);
+			}
+			else
+			{
+				// Process the span in segments which each lie within a single attachment tile.
+				Int xBegin = x0;
 
-				for(unsigned int q = 0; q < state.multiSampleCount; q++)
+				Do
 				{
-					if(state.multiSampleMask & (1 << q))
+					Int xEnd = Min((xBegin & -HIZ_TILE_WIDTH) + HIZ_TILE_WIDTH, x1);
+
+					for(int index = 0; index < MAX_COLOR_BUFFERS; index++)
+					{
+						if(state.deferredClearMask & (1 << index))
+						{
+							performDeferredClear(index, cBuffer[index], xBegin);
+						}
+					}
+
+					if(state.deferredClearMask & (1 << MAX_COLOR_BUFFERS))
 					{
-						unsigned int i = state.enableMultiSampling ? q : 0;
-						Short4 mask = CmpGT(xxxx, xLeft[i]) & CmpGT(xRight[i], xxxx);
-						cMask[q] = SignMask(PackSigned(mask, mask)) & 0x0000000F;
+						performDeferredClear(MAX_COLOR_BUFFERS, zBuffer, xBegin);
 					}
-				}
 
-				quad(cBuffer, zBuffer, sBuffer, cMask, x, y);
+					Pointer<Byte> tile;
+					Bool visible = true;
+
+					if(state.hiZ)
+					{
+						tile = hiZBuffer + (xBegin / HIZ_TILE_WIDTH) * sizeof(HiZTile);
+					}
+
+					if(state.hiZCull)
+					{
+						visible = hiZTest(tile, zBuffer, xBegin, xEnd, y);
+					}
+
+					If(visible)
+					{
+						rasterizeSpan(xBegin, xEnd);
+
+						if(state.hiZ && state.depthWriteEnable)
+						{
+							hiZUpdate(tile);
+						}
+					}
+
+					xBegin = xEnd;
+				}
+				Until(xBegin >= x1);
 			}
 		}
 
@@ -227,11 +373,159 @@ void QuadRasterizer::rasterize(Int &yMin, Int &yMax)
 			sBuffer += *Pointer<Int>(data + OFFSET(DrawData, stencilPitchB)) << (1 + clusterCountLog2);  // FIXME: Precompute
 		}
 
+		if(state.hiZ)
+		{
+			hiZBuffer += *Pointer<Int>(data + OFFSET(DrawData, hiZPitchB)) << clusterCountLog2;
+		}
+
+		for(int index = 0; index <= MAX_COLOR_BUFFERS; index++)
+		{
+			if(state.deferredClearMask & (1 << index))
+			{
+				deferredClearTiles[index] += *Pointer<Int>(data + OFFSET(DrawData, deferredClearTilesPitchB[index])) << clusterCountLog2;
+			}
+		}
+
+		for(int index = 0; index < MAX_COLOR_BUFFERS; index++)
+		{
+			if(state.sampleEqualityMask & (1 << index))
+			{
+				sampleEqualityTiles[index] += *Pointer<Int>(data + OFFSET(DrawData, sampleEqualityPitchB[index])) << clusterCountLog2;
+			}
+		}
+
 		y += 2 * clusterCount;
 	}
 	Until(y >= yMax);
 }
 
+Bool QuadRasterizer::hiZTest(const Pointer<Byte> &tile, const Pointer<Byte> &zBuffer, const Int &xBegin, const Int &xEnd, const Int &y)
+{
+	Float A = *Pointer<Float>(primitive + OFFSET(Primitive, z.A));
+	Float B = *Pointer<Float>(primitive + OFFSET(Primitive, z.B));
+	Float C = *Pointer<Float>(primitive + OFFSET(Primitive, z.C));
+
+	// Bounds of the fragment and sample locations of the segment, relative to the polygon's origin.
+	Float xLo = Float(xBegin - 1) - *Pointer<Float>(primitive + OFFSET(Primitive, x0));
+	Float xHi = Float(xEnd) - *Pointer<Float>(primitive + OFFSET(Primitive, x0));
+	Float yLo = Float(y - 1) - *Pointer<Float>(primitive + OFFSET(Primitive, y0));
+	Float yHi = Float(y + 2) - *Pointer<Float>(primitive + OFFSET(Primitive, y0));
+
+	Float Ax = Min(A * xLo, A * xHi);
+	Float By = Min(B * yLo, B * yHi);
+	Float zMin = C + Ax + By;
+
+	// Allow for rounding differences with the per-fragment interpolation.
+	Float error = Abs(C) + Max(Abs(A * xLo), Abs(A * xHi)) + Max(Abs(B * yLo), Abs(B * yHi));
+
+	if(state.depthBias)
+	{
+		Float zBias = *Pointer<Float>(primitive + OFFSET(Primitive, zBias));
+		zMin += zBias;
+		error += Abs(zBias);
+	}
+
+	zMin -= error * (1.0f / (1 << 20));
+
+	if(state.depthClamp)
+	{
+		zMin = Min(Max(zMin, state.minDepthClamp), state.maxDepthClamp);
+	}
+
+	if(state.depthFormat == VK_FORMAT_D16_UNORM)
+	{
+		zMin = zMin * 0xFFFF - 0.5f;  // Lower bound of the rounded depth value
+	}
+
+	// Fragments which are all further away than the tile's maximum depth fail the depth test.
+	// Note that NaN depth values are considered visible.
+	Bool visible = !(zMin > *Pointer<Float>(tile + OFFSET(HiZTile, maxZ)));
+
+	If(visible && (*Pointer<UInt>(tile + OFFSET(HiZTile, dirty)) != 0))
+	{
+		Float maxZ = hiZTileMaxZ(zBuffer, xBegin);
+
+		*Pointer<Float>(tile + OFFSET(HiZTile, maxZ)) = maxZ;
+		*Pointer<UInt>(tile + OFFSET(HiZTile, dirty)) = 0;
+
+		visible = !(zMin > maxZ);
+	}
+
+	return visible;
+}
+
+Float QuadRasterizer::hiZTileMaxZ(const Pointer<Byte> &zBuffer, const Int &x)
+{
+	const bool d16 = (state.depthFormat == VK_FORMAT_D16_UNORM);
+	const int bytes = d16 ? 2 : 4;
+
+	Int pitch = *Pointer<Int>(data + OFFSET(DrawData, depthPitchB));
+	Int xBegin = x & -HIZ_TILE_WIDTH;
+	Int xEnd = Min(xBegin + HIZ_TILE_WIDTH, pitch / bytes);
+
+	Float4 maxZ = Float4(-std::numeric_limits<float>::infinity());
+	Int4 unordered = Int4(0);
+
+	for(unsigned int q = 0; q < state.multiSampleCount; q++)
+	{
+		Pointer<Byte> buffer = zBuffer;
+
+		if(q > 0)
+		{
+			buffer += q * *Pointer<Int>(data + OFFSET(DrawData, depthSliceB));
+		}
+
+		For(Int i = xBegin, i < xEnd, i += 2)
+		{
+			Float4 z;
+
+			if(d16)
+			{
+				UShort4 z16;
+				z16 = As<UShort4>(Insert(As<Int2>(z16), *Pointer<Int>(buffer + 2 * i), 0));
+				z16 = As<UShort4>(Insert(As<Int2>(z16), *Pointer<Int>(buffer + 2 * i + pitch), 1));
+				z = Float4(z16);
+			}
+			else
+			{
+				z = Float4(*Pointer<Float2>(buffer + 4 * i), *Pointer<Float2>(buffer + 4 * i + pitch));
+				unordered |= CmpUNEQ(z, z);
+			}
+
+			maxZ = Max(maxZ, z);
+		}
+	}
+
+	Float tileMaxZ = Max(Max(Extract(maxZ, 0), Extract(maxZ, 1)), Max(Extract(maxZ, 2), Extract(maxZ, 3)));
+
+	// Stored NaN values pass depth tests which compare against them.
+	If(SignMask(unordered) != 0)
+	{
+		tileMaxZ = std::numeric_limits<float>::infinity();
+	}
+
+	return tileMaxZ;
+}
+
+void QuadRasterizer::hiZUpdate(const Pointer<Byte> &tile)
+{
+	switch(state.depthCompareMode)
+	{
+	case VK_COMPARE_OP_NEVER:
+		break;
+	case VK_COMPARE_OP_LESS:
+	case VK_COMPARE_OP_LESS_OR_EQUAL:
+	case VK_COMPARE_OP_EQUAL:
+		// Depth writes can only lower the stored values, so the maximum remains an upper bound.
+		*Pointer<UInt>(tile + OFFSET(HiZTile, dirty)) = 1;
+		break;
+	default:
+		*Pointer<Float>(tile + OFFSET(HiZTile, maxZ)) = std::numeric_limits<float>::infinity();
+		*Pointer<UInt>(tile + OFFSET(HiZTile, dirty)) = 1;
+		break;
+	}
+}
+
 SIMD::Float QuadRasterizer::interpolate(SIMD::Float &x, SIMD::Float &D, SIMD::Float &rhw, Pointer<Byte> planeEquation, bool flat, bool perspective)
 {
 	if(flat)
@@ -261,4 +555,51 @@ bool QuadRasterizer::interpolateW() const
 	return spirvShader != nullptr;
 }
 
+void QuadRasterizer::performDeferredClear(int index, const Pointer<Byte> &buffer, const Int &x)
+{
+	Pointer<Byte> flag = deferredClearTiles[index] + x / HIZ_TILE_WIDTH;
+
+	// The first access to a tile with a pending clear writes the clear value to all of its
+	// texels, so that the pixel routine can treat the attachment as fully materialized.
+	If(*Pointer<Byte>(flag) != Byte(0))
+	{
+		const bool depth = (index == MAX_COLOR_BUFFERS);
+		const int bytes = depth ? state.depthFormat.bytes() : state.colorFormat[index].bytes();
+
+		Int pitch = depth ? *Pointer<Int>(data + OFFSET(DrawData, depthPitchB)) : *Pointer<Int>(data + OFFSET(DrawData, colorPitchB[index]));
+		Int slice = depth ? *Pointer<Int>(data + OFFSET(DrawData, depthSliceB)) : *Pointer<Int>(data + OFFSET(DrawData, colorSliceB[index]));
+		Int value = *Pointer<Int>(data + OFFSET(DrawData, deferredClearValue[index]));
+
+		Int xBegin = x & -HIZ_TILE_WIDTH;
+		Int xEnd = Min(xBegin + HIZ_TILE_WIDTH, pitch / bytes);
+
+		for(unsigned int q = 0; q < state.multiSampleCount; q++)
+		{
+			Pointer<Byte> sample = buffer;
+
+			if(q > 0)
+			{
+				sample += q * slice;
+			}
+
+			For(Int i = xBegin, i < xEnd, i += 2)
+			{
+				if(bytes == 4)
+				{
+					*Pointer<Int2>(sample + 4 * i) = Int2(value, value);
+					*Pointer<Int2>(sample + 4 * i + pitch) = Int2(value, value);
+				}
+				else
+				{
+					ASSERT(bytes == 2);  // Two texels at a time, as the value is replicated
+					*Pointer<Int>(sample + 2 * i) = value;
+					*Pointer<Int>(sample + 2 * i + pitch) = value;
+				}
+			}
+		}
+
+		*Pointer<Byte>(flag) = Byte(0);
+	}
+}
+
 }  // namespace sw
@@ -48,6 +48,9 @@ protected:
 
 	UInt occlusion;
 
+	// Sample equality tiles of the current row pair, for the color attachments in state.sampleEqualityMask
+	Pointer<Byte> sampleEqualityTiles[MAX_COLOR_BUFFERS];
+
 	virtual void quad(Pointer<Byte> cBuffer[4], Pointer<Byte> &zBuffer, Pointer<Byte> &sBuffer, Int cMask[4], Int &x, Int &y) = 0;
 
 	bool interpolateZ() const;
@@ -59,6 +62,15 @@ protected:
 
 private:
 	void rasterize(Int &yMin, Int &yMax);
+
+	// Hierarchical depth tests and updates, for the Hi-Z tile containing the span segment.
+	Bool hiZTest(const Pointer<Byte> &tile, const Pointer<Byte> &zBuffer, const Int &xBegin, const Int &xEnd, const Int &y);
+	Float hiZTileMaxZ(const Pointer<Byte> &zBuffer, const Int &x);
+	void hiZUpdate(const Pointer<Byte> &tile);
+	void performDeferredClear(int index, const Pointer<Byte> &buffer, const Int &x);
+
+	Pointer<Byte> hiZBuffer;
+	Pointer<Byte> deferredClearTiles[MAX_COLOR_BUFFERS + 1];
 };
 
 }  // namespace sw
@@ -25,6 +25,9 @@
 #include "System/Half.hpp"
 #include "System/Math.hpp"
 #include "System/Memory.hpp"
+#include "System/RoutineTelemetry.hpp"
+#include "System/SwiftConfig.hpp"
+#include "System/Timeline.hpp"
 #include "System/Timer.hpp"
 #include "Vulkan/VkConfig.hpp"
 #include "Vulkan/VkDescriptorSet.hpp"
@@ -36,6 +39,7 @@
 
 #include "marl/containers.h"
 #include "marl/defer.h"
+#include "marl/scheduler.h"
 #include "marl/trace.h"
 
 #undef max
@@ -155,8 +159,44 @@ DrawCall::~DrawCall()
 	sw::freeMemory(data);
 }
 
+namespace {
+
+int workerThreadCount()
+{
+	marl::Scheduler *scheduler = marl::Scheduler::get();
+	return scheduler ? scheduler->config().workerThread.count : 0;
+}
+
+// Returns the configured limit, or the default sized to the scheduler's worker thread
+// count when the configuration leaves it at 0, clamped to [1, max].
+int runtimeLimit(uint32_t configured, int threadCount, int max)
+{
+	int limit = (configured != 0) ? static_cast<int>(std::min<uint32_t>(configured, max))
+	                              : std::max(16, threadCount);
+	return std::max(1, std::min(limit, max));
+}
+
+int clusterCountFor(const Configuration &config, int threadCount)
+{
+	// The rasterizer distributes row pairs over the clusters using masking, so the
+	// count has to be a power of two. Explicit counts round down, derived ones round
+	// up so every worker thread can be kept busy.
+	int count = runtimeLimit(config.clusterCount, threadCount, MaxClusterCount);
+	int pow2 = 1;
+	while(pow2 * 2 <= count) { pow2 *= 2; }
+	if(config.clusterCount == 0 && pow2 < count && pow2 * 2 <= MaxClusterCount) { pow2 *= 2; }
+	return pow2;
+}
+
+}  // anonymous namespace
+
 Renderer::Renderer(vk::Device *device)
-    : device(device)
+    : clusterCount(clusterCountFor(getConfiguration(), workerThreadCount()))
+    , batchCount(runtimeLimit(getConfiguration().batchCount, workerThreadCount(), MaxBatchCount))
+    , drawCount(runtimeLimit(getConfiguration().drawCount, workerThreadCount(), MaxDrawCount))
+    , drawCallPool(drawCount)
+    , batchDataPool(batchCount)
+    , device(device)
 {
 	vertexProcessor.setRoutineCacheSize(1024);
 	pixelProcessor.setRoutineCacheSize(1024);
@@ -195,6 +235,7 @@ void Renderer::draw(const vk::GraphicsPipeline *pipeline, const vk::DynamicState
 		draw = drawCallPool.borrow();
 	}
 	draw->id = id;
+	draw->timelineBegin = Timeline::isEnabled() ? Timeline::now() : -1;
 
 	const vk::GraphicsState &pipelineState = pipeline->getCombinedState(dynamicState);
 
@@ -231,7 +272,7 @@ void Renderer::draw(const vk::GraphicsPipeline *pipeline, const vk::DynamicState
 
 		const vk::Attachments attachments = pipeline->getAttachments();
 
-		vertexState = vertexProcessor.update(pipelineState, vertexShader, inputs);
+		vertexState = vertexProcessor.update(pipelineState, vertexShader, inputs, indexBuffer != nullptr);
 		vertexRoutine = vertexProcessor.routine(vertexState, preRasterizationState.getPipelineLayout(), vertexShader, inputs.getDescriptorSets());
 
 		if(!hasRasterizerDiscard)
@@ -263,6 +304,7 @@ void Renderer::draw(const vk::GraphicsPipeline *pipeline, const vk::DynamicState
 	DrawData *data = draw->data;
 	draw->occlusionQuery = occlusionQuery;
 	draw->batchDataPool = &batchDataPool;
+	draw->clusterCount = clusterCount;
 	draw->numPrimitives = count;
 	draw->numPrimitivesPerBatch = numPrimitivesPerBatch;
 	draw->numBatches = (count + draw->numPrimitivesPerBatch - 1) / draw->numPrimitivesPerBatch;
@@ -294,6 +336,7 @@ void Renderer::draw(const vk::GraphicsPipeline *pipeline, const vk::DynamicState
 	draw->indexType = indexBuffer ? pipeline->getIndexBuffer().getIndexType() : VK_INDEX_TYPE_UINT16;
 
 	draw->vertexRoutine = vertexRoutine;
+	draw->deduplicateVertices = vertexState.deduplicateVertices;
 
 	vk::DescriptorSet::PrepareForSampling(draw->descriptorSetObjects, draw->preRasterizationPipelineLayout, device);
 
@@ -412,7 +455,7 @@ void Renderer::draw(const vk::GraphicsPipeline *pipeline, const vk::DynamicState
 
 		if(pixelState.occlusionEnabled)
 		{
-			for(int cluster = 0; cluster < MaxClusterCount; cluster++)
+			for(int cluster = 0; cluster < clusterCount; cluster++)
 			{
 				data->occlusion[cluster] = 0;
 			}
@@ -465,6 +508,33 @@ void Renderer::draw(const vk::GraphicsPipeline *pipeline, const vk::DynamicState
 				data->depthSliceB = attachments.depthBuffer->slicePitchBytes(VK_IMAGE_ASPECT_DEPTH_BIT, 0);
 			}
 
+			if(pixelState.hiZ)
+			{
+				data->hiZBuffer = attachments.depthBuffer->getHiZTiles(data->layer);
+				data->hiZPitchB = attachments.depthBuffer->getHiZPitchBytes();
+			}
+
+			for(int index = 0; index <= MAX_COLOR_BUFFERS; index++)
+			{
+				if(pixelState.deferredClearMask & (1 << index))
+				{
+					vk::ImageView *view = (index < MAX_COLOR_BUFFERS) ? attachments.colorBuffer[index] : attachments.depthBuffer;
+
+					data->deferredClearTiles[index] = view->getDeferredClearTiles(data->layer);
+					data->deferredClearTilesPitchB[index] = view->getDeferredClearTilesPitchBytes();
+					data->deferredClearValue[index] = view->getDeferredClearValue(data->layer);
+				}
+			}
+
+			for(int index = 0; index < MAX_COLOR_BUFFERS; index++)
+			{
+				if(pixelState.sampleEqualityMask & (1 << index))
+				{
+					data->sampleEqualityTiles[index] = attachments.colorBuffer[index]->getSampleEqualityTiles(data->layer);
+					data->sampleEqualityPitchB[index] = attachments.colorBuffer[index]->getSampleEqualityPitchBytes();
+				}
+			}
+
 			if(draw->stencilBuffer)
 			{
 				data->stencilBuffer = (unsigned char *)attachments.stencilBuffer->getOffsetPointer({ 0, 0, 0 }, VK_IMAGE_ASPECT_STENCIL_BIT, 0, data->layer);
@@ -523,7 +593,7 @@ void DrawCall::teardown(vk::Device *device)
 	{
 		if(occlusionQuery != nullptr)
 		{
-			for(int cluster = 0; cluster < MaxClusterCount; cluster++)
+			for(int cluster = 0; cluster < clusterCount; cluster++)
 			{
 				occlusionQuery->add(data->occlusion[cluster]);
 			}
@@ -534,7 +604,7 @@ void DrawCall::teardown(vk::Device *device)
 		{
 			if(target)
 			{
-				target->contentsChanged(vk::Image::DIRECT_MEMORY_ACCESS);
+				target->contentsChanged(vk::Image::RENDERED);
 			}
 		}
 
@@ -555,11 +625,18 @@ void DrawCall::run(vk::Device *device, const marl::Loan<DrawCall> &draw, marl::T
 	const auto numPrimitives = draw->numPrimitives;
 	const auto numPrimitivesPerBatch = draw->numPrimitivesPerBatch;
 	const auto numBatches = draw->numBatches;
+	const int clusterCount = draw->clusterCount;
 
 	auto ticket = tickets->take();
 	auto finally = marl::make_shared_finally([device, draw, ticket] {
 		MARL_SCOPED_EVENT("FINISH draw %d", draw->id);
 		draw->teardown(device);
+
+		if(draw->timelineBegin >= 0)
+		{
+			Timeline::record(Timeline::Category::Draw, "Draw", draw->timelineBegin, draw->id);
+		}
+
 		ticket.done();
 	});
 
@@ -570,7 +647,7 @@ void DrawCall::run(vk::Device *device, const marl::Loan<DrawCall> &draw, marl::T
 		batch->firstPrimitive = batch->id * numPrimitivesPerBatch;
 		batch->numPrimitives = std::min(batch->firstPrimitive + numPrimitivesPerBatch, numPrimitives) - batch->firstPrimitive;
 
-		for(int cluster = 0; cluster < MaxClusterCount; cluster++)
+		for(int cluster = 0; cluster < clusterCount; cluster++)
 		{
 			batch->clusterTickets[cluster] = std::move(clusterQueues[cluster].take());
 		}
@@ -589,7 +666,7 @@ void DrawCall::run(vk::Device *device, const marl::Loan<DrawCall> &draw, marl::T
 				}
 			}
 
-			for(int cluster = 0; cluster < MaxClusterCount; cluster++)
+			for(int cluster = 0; cluster < draw->clusterCount; cluster++)
 			{
 				batch->clusterTickets[cluster].done();
 			}
@@ -600,6 +677,7 @@ void DrawCall::run(vk::Device *device, const marl::Loan<DrawCall> &draw, marl::T
 void DrawCall::processVertices(vk::Device *device, DrawCall *draw, BatchData *batch)
 {
 	MARL_SCOPED_EVENT("VERTEX draw %d, batch %d", draw->id, batch->id);
+	Timeline::Scope timeline(Timeline::Category::Batch, "Vertices", draw->id, batch->id);
 
 	unsigned int triangleIndices[MaxBatchSize + 1][3];  // One extra for SIMD width overrun. TODO: Adjust to dynamic batch size.
 	{
@@ -618,6 +696,21 @@ void DrawCall::processVertices(vk::Device *device, DrawCall *draw, BatchData *ba
 	vertexTask.primitiveStart = batch->firstPrimitive;
 	// We're only using batch compaction for points, not lines
 	vertexTask.vertexCount = batch->numPrimitives * ((draw->topology == VK_PRIMITIVE_TOPOLOGY_POINT_LIST) ? 1 : 3);
+
+	if(draw->deduplicateVertices)
+	{
+		unsigned int uniqueIndices[VertexDeduplication::MAX_VERTICES + 4];  // Padded for SIMD width overrun.
+		{
+			MARL_SCOPED_EVENT("deduplicateBatchVertices");
+			deduplicateBatchVertices(&triangleIndices[0][0], vertexTask.vertexCount, uniqueIndices, vertexTask.deduplication);
+		}
+
+		RoutineTelemetry::recordVertexDeduplication(vertexTask.vertexCount, vertexTask.deduplication.uniqueCount);
+
+		draw->vertexRoutine(device, &batch->triangles.front().v0, uniqueIndices, &vertexTask, draw->data);
+		return;
+	}
+
 	if(vertexTask.vertexCache.drawCall != draw->id)
 	{
 		vertexTask.vertexCache.clear();
@@ -630,9 +723,10 @@ void DrawCall::processVertices(vk::Device *device, DrawCall *draw, BatchData *ba
 void DrawCall::processPrimitives(vk::Device *device, DrawCall *draw, BatchData *batch)
 {
 	MARL_SCOPED_EVENT("PRIMITIVES draw %d batch %d", draw->id, batch->id);
-	auto triangles = &batch->triangles[0];
+	Timeline::Scope timeline(Timeline::Category::Batch, "Primitives", draw->id, batch->id);
+	auto vertices = &batch->triangles.front().v0;
 	auto primitives = &batch->primitives[0];
-	batch->numVisible = draw->setupPrimitives(device, triangles, primitives, draw, batch->numPrimitives);
+	batch->numVisible = draw->setupPrimitives(device, vertices, primitives, draw, batch->numPrimitives);
 }
 
 void DrawCall::processPixels(vk::Device *device, const marl::Loan<DrawCall> &draw, const marl::Loan<BatchData> &batch, const std::shared_ptr<marl::Finally> &finally)
@@ -649,13 +743,14 @@ void DrawCall::processPixels(vk::Device *device, const marl::Loan<DrawCall> &dra
 		std::shared_ptr<marl::Finally> finally;
 	};
 	auto data = std::make_shared<Data>(draw, batch, finally);
-	for(int cluster = 0; cluster < MaxClusterCount; cluster++)
+	for(int cluster = 0; cluster < draw->clusterCount; cluster++)
 	{
 		batch->clusterTickets[cluster].onCall([device, data, cluster] {
 			auto &draw = data->draw;
 			auto &batch = data->batch;
 			MARL_SCOPED_EVENT("PIXEL draw %d, batch %d, cluster %d", draw->id, batch->id, cluster);
-			draw->pixelRoutine(device, &batch->primitives.front(), batch->numVisible, cluster, MaxClusterCount, draw->data);
+			Timeline::Scope timeline(Timeline::Category::Batch, "Pixels", draw->id, batch->id);
+			draw->pixelRoutine(device, &batch->primitives.front(), batch->numVisible, cluster, draw->clusterCount, draw->data);
 			batch->clusterTickets[cluster].done();
 		});
 	}
@@ -730,7 +825,62 @@ void DrawCall::processPrimitiveVertices(
 	}
 }
 
-int DrawCall::setupSolidTriangles(vk::Device *device, Triangle *triangles, Primitive *primitives, const DrawCall *drawCall, int count)
+void DrawCall::deduplicateBatchVertices(
+    const unsigned int *indices,
+    unsigned int vertexCount,
+    unsigned int *uniqueIndicesOut,
+    VertexDeduplication &deduplication)
+{
+	ASSERT(vertexCount > 0 && vertexCount <= VertexDeduplication::MAX_VERTICES);
+
+	// Open addressing hash table of unique vertex entries, offset by one so that zero denotes an empty bucket.
+	constexpr unsigned int hashBits = 10;
+	constexpr unsigned int hashSize = 1 << hashBits;
+	static_assert(hashSize >= 2 * VertexDeduplication::MAX_VERTICES, "Hash table load factor must not exceed 50%");
+
+	uint16_t table[hashSize] = {};
+	unsigned int uniqueCount = 0;
+
+	for(unsigned int i = 0; i < vertexCount; i++)
+	{
+		unsigned int index = indices[i];
+		unsigned int bucket = (index * 0x9E3779B1u) >> (32 - hashBits);  // Fibonacci hashing
+
+		while(true)
+		{
+			unsigned int entry = table[bucket];
+
+			if(entry == 0)
+			{
+				table[bucket] = static_cast<uint16_t>(uniqueCount + 1);
+				uniqueIndicesOut[uniqueCount] = index;
+				deduplication.slot[uniqueCount] = i;
+				deduplication.source[i] = i;
+				uniqueCount++;
+				break;
+			}
+
+			if(uniqueIndicesOut[entry - 1] == index)
+			{
+				deduplication.source[i] = deduplication.slot[entry - 1];
+				break;
+			}
+
+			bucket = (bucket + 1) & (hashSize - 1);
+		}
+	}
+
+	// Repeat the last unique vertex to allow for SIMD width overrun.
+	for(unsigned int i = uniqueCount; i < uniqueCount + 4; i++)
+	{
+		uniqueIndicesOut[i] = uniqueIndicesOut[uniqueCount - 1];
+		deduplication.slot[i] = deduplication.slot[uniqueCount - 1];
+	}
+
+	deduplication.uniqueCount = uniqueCount;
+}
+
+int DrawCall::setupSolidTriangles(vk::Device *device, const Vertex *vertices, Primitive *primitives, const DrawCall *drawCall, int count)
 {
 	auto &state = drawCall->setupState;
 
@@ -738,11 +888,12 @@ int DrawCall::setupSolidTriangles(vk::Device *device, Triangle *triangles, Primi
 	const DrawData *data = drawCall->data;
 	int visible = 0;
 
-	for(int i = 0; i < count; i++, triangles++)
+	for(int i = 0; i < count; i++)
 	{
-		Vertex &v0 = triangles->v0;
-		Vertex &v1 = triangles->v1;
-		Vertex &v2 = triangles->v2;
+		const Vertex *triangle = &drawCall->vertex(vertices, 3 * i);
+		const Vertex &v0 = drawCall->vertex(triangle, 0);
+		const Vertex &v1 = drawCall->vertex(triangle, 1);
+		const Vertex &v2 = drawCall->vertex(triangle, 2);
 
 		Polygon polygon(&v0.position, &v1.position, &v2.position);
 
@@ -765,7 +916,7 @@ int DrawCall::setupSolidTriangles(vk::Device *device, Triangle *triangles, Primi
 			}
 		}
 
-		if(drawCall->setupRoutine(device, primitives, triangles, &polygon, data))
+		if(drawCall->setupRoutine(device, primitives, triangle, &polygon, data))
 		{
 			primitives += ms;
 			visible++;
@@ -775,18 +926,20 @@ int DrawCall::setupSolidTriangles(vk::Device *device, Triangle *triangles, Primi
 	return visible;
 }
 
-int DrawCall::setupWireframeTriangles(vk::Device *device, Triangle *triangles, Primitive *primitives, const DrawCall *drawCall, int count)
+int DrawCall::setupWireframeTriangles(vk::Device *device, const Vertex *vertices, Primitive *primitives, const DrawCall *drawCall, int count)
 {
 	auto &state = drawCall->setupState;
 
 	int ms = state.multiSampleCount;
+	int stride = state.vertexStride;
 	int visible = 0;
 
 	for(int i = 0; i < count; i++)
 	{
-		const Vertex &v0 = triangles[i].v0;
-		const Vertex &v1 = triangles[i].v1;
-		const Vertex &v2 = triangles[i].v2;
+		const Vertex *triangle = &drawCall->vertex(vertices, 3 * i);
+		const Vertex &v0 = drawCall->vertex(triangle, 0);
+		const Vertex &v1 = drawCall->vertex(triangle, 1);
+		const Vertex &v2 = drawCall->vertex(triangle, 2);
 
 		float A = ((float)v0.projected.y - (float)v2.projected.y) * (float)v1.projected.x +
 		          ((float)v2.projected.y - (float)v1.projected.y) * (float)v0.projected.x +
@@ -809,17 +962,20 @@ int DrawCall::setupWireframeTriangles(vk::Device *device, Triangle *triangles, P
 			if(!frontFacing) continue;
 		}
 
+		// Each edge needs its two vertex records to be consecutive.
 		Triangle lines[3];
-		lines[0].v0 = v0;
-		lines[0].v1 = v1;
-		lines[1].v0 = v1;
-		lines[1].v1 = v2;
-		lines[2].v0 = v2;
-		lines[2].v1 = v0;
+		const Vertex *edges[3][2] = { { &v0, &v1 }, { &v1, &v2 }, { &v2, &v0 } };
+
+		for(int i = 0; i < 3; i++)
+		{
+			uint8_t *line = reinterpret_cast<uint8_t *>(&lines[i]);
+			memcpy(line, edges[i][0], stride);
+			memcpy(line + stride, edges[i][1], stride);
+		}
 
 		for(int i = 0; i < 3; i++)
 		{
-			if(setupLine(device, *primitives, lines[i], *drawCall))
+			if(setupLine(device, *primitives, &lines[i].v0, *drawCall))
 			{
 				primitives += ms;
 				visible++;
@@ -830,7 +986,7 @@ int DrawCall::setupWireframeTriangles(vk::Device *device, Triangle *triangles, P
 	return visible;
 }
 
-int DrawCall::setupPointTriangles(vk::Device *device, Triangle *triangles, Primitive *primitives, const DrawCall *drawCall, int count)
+int DrawCall::setupPointTriangles(vk::Device *device, const Vertex *vertices, Primitive *primitives, const DrawCall *drawCall, int count)
 {
 	auto &state = drawCall->setupState;
 
@@ -839,9 +995,10 @@ int DrawCall::setupPointTriangles(vk::Device *device, Triangle *triangles, Primi
 
 	for(int i = 0; i < count; i++)
 	{
-		const Vertex &v0 = triangles[i].v0;
-		const Vertex &v1 = triangles[i].v1;
-		const Vertex &v2 = triangles[i].v2;
+		const Vertex *triangle = &drawCall->vertex(vertices, 3 * i);
+		const Vertex &v0 = drawCall->vertex(triangle, 0);
+		const Vertex &v1 = drawCall->vertex(triangle, 1);
+		const Vertex &v2 = drawCall->vertex(triangle, 2);
 
 		float d = (v0.y * v1.x - v0.x * v1.y) * v2.w +
 		          (v0.x * v2.y - v0.y * v2.x) * v1.w +
@@ -857,10 +1014,8 @@ int DrawCall::setupPointTriangles(vk::Device *device, Triangle *triangles, Primi
 			if(!frontFacing) continue;
 		}
 
-		Triangle points[3];
-		points[0].v0 = v0;
-		points[1].v0 = v1;
-		points[2].v0 = v2;
+		// Points only use their leading vertex record, so they don't need to be copied.
+		const Vertex *points[3] = { &v0, &v1, &v2 };
 
 		for(int i = 0; i < 3; i++)
 		{
@@ -875,7 +1030,7 @@ int DrawCall::setupPointTriangles(vk::Device *device, Triangle *triangles, Primi
 	return visible;
 }
 
-int DrawCall::setupLines(vk::Device *device, Triangle *triangles, Primitive *primitives, const DrawCall *drawCall, int count)
+int DrawCall::setupLines(vk::Device *device, const Vertex *vertices, Primitive *primitives, const DrawCall *drawCall, int count)
 {
 	auto &state = drawCall->setupState;
 
@@ -884,19 +1039,17 @@ int DrawCall::setupLines(vk::Device *device, Triangle *triangles, Primitive *pri
 
 	for(int i = 0; i < count; i++)
 	{
-		if(setupLine(device, *primitives, *triangles, *drawCall))
+		if(setupLine(device, *primitives, &drawCall->vertex(vertices, 3 * i), *drawCall))
 		{
 			primitives += ms;
 			visible++;
 		}
-
-		triangles++;
 	}
 
 	return visible;
 }
 
-int DrawCall::setupPoints(vk::Device *device, Triangle *triangles, Primitive *primitives, const DrawCall *drawCall, int count)
+int DrawCall::setupPoints(vk::Device *device, const Vertex *vertices, Primitive *primitives, const DrawCall *drawCall, int count)
 {
 	auto &state = drawCall->setupState;
 
@@ -905,22 +1058,20 @@ int DrawCall::setupPoints(vk::Device *device, Triangle *triangles, Primitive *pr
 
 	for(int i = 0; i < count; i++)
 	{
-		if(setupPoint(device, *primitives, *triangles, *drawCall))
+		if(setupPoint(device, *primitives, &drawCall->vertex(vertices, 3 * i), *drawCall))
 		{
 			primitives += ms;
 			visible++;
 		}
-
-		triangles++;
 	}
 
 	return visible;
 }
 
-bool DrawCall::setupLine(vk::Device *device, Primitive &primitive, Triangle &triangle, const DrawCall &draw)
+bool DrawCall::setupLine(vk::Device *device, Primitive &primitive, const Vertex *vertices, const DrawCall &draw)
 {
-	const Vertex &v0 = triangle.v0;
-	const Vertex &v1 = triangle.v1;
+	const Vertex &v0 = draw.vertex(vertices, 0);
+	const Vertex &v1 = draw.vertex(vertices, 1);
 
 	if((v0.cullMask | v1.cullMask) == 0)
 	{
@@ -992,7 +1143,7 @@ bool DrawCall::setupLine(vk::Device *device, Primitive &primitive, Triangle &tri
 			return false;
 		}
 
-		return draw.setupRoutine(device, &primitive, &triangle, &polygon, &data);
+		return draw.setupRoutine(device, &primitive, vertices, &polygon, &data);
 	}
 	else if(false)  // TODO(b/80135519): Deprecate
 	{
@@ -1079,7 +1230,7 @@ bool DrawCall::setupLine(vk::Device *device, Primitive &primitive, Triangle &tri
 			return false;
 		}
 
-		return draw.setupRoutine(device, &primitive, &triangle, &polygon, &data);
+		return draw.setupRoutine(device, &primitive, vertices, &polygon, &data);
 	}
 	else
 	{
@@ -1157,15 +1308,15 @@ bool DrawCall::setupLine(vk::Device *device, Primitive &primitive, Triangle &tri
 			return false;
 		}
 
-		return draw.setupRoutine(device, &primitive, &triangle, &polygon, &data);
+		return draw.setupRoutine(device, &primitive, vertices, &polygon, &data);
 	}
 
 	return false;
 }
 
-bool DrawCall::setupPoint(vk::Device *device, Primitive &primitive, Triangle &triangle, const DrawCall &draw)
+bool DrawCall::setupPoint(vk::Device *device, Primitive &primitive, const Vertex *vertices, const DrawCall &draw)
 {
-	const Vertex &v = triangle.v0;
+	const Vertex &v = vertices[0];
 
 	if(v.cullMask == 0)
 	{
@@ -1206,7 +1357,7 @@ bool DrawCall::setupPoint(vk::Device *device, Primitive &primitive, Triangle &tr
 
 	primitive.pointSizeInv = 1.0f / pSize;
 
-	return draw.setupRoutine(device, &primitive, &triangle, &polygon, &data);
+	return draw.setupRoutine(device, &primitive, vertices, &polygon, &data);
 }
 
 void Renderer::addQuery(vk::Query *query)
@@ -19,6 +19,7 @@
 #include "Primitive.hpp"
 #include "SetupProcessor.hpp"
 #include "VertexProcessor.hpp"
+#include "System/Synchronization.hpp"
 #include "Vulkan/VkDescriptorSet.hpp"
 #include "Vulkan/VkPipeline.hpp"
 
@@ -41,6 +42,7 @@ namespace sw {
 
 class CountedEvent;
 struct DrawCall;
+struct HiZTile;
 class PixelShader;
 class VertexShader;
 struct Task;
@@ -48,9 +50,11 @@ class Resource;
 struct Constants;
 
 static constexpr int MaxBatchSize = 128;
-static constexpr int MaxBatchCount = 16;
-static constexpr int MaxClusterCount = 16;
-static constexpr int MaxDrawCount = 16;
+static constexpr int MaxBatchCount = 256;    // Upper bound for the number of batches in flight
+static constexpr int MaxClusterCount = 128;  // Upper bound for the number of pixel processing clusters
+static constexpr int MaxDrawCount = 256;     // Upper bound for the number of draw calls in flight
+
+static_assert(VertexDeduplication::MAX_VERTICES == MaxBatchSize * 3, "Vertex deduplication must cover entire batches");
 
 using TriangleBatch = std::array<Triangle, MaxBatchSize>;
 using PrimitiveBatch = std::array<Primitive, MaxBatchSize>;
@@ -93,6 +97,13 @@ struct DrawData
 	float *depthBuffer;
 	int depthPitchB;
 	int depthSliceB;
+	HiZTile *hiZBuffer;
+	int hiZPitchB;
+	uint8_t *deferredClearTiles[MAX_COLOR_BUFFERS + 1];  // Last entry is the depth attachment
+	int deferredClearTilesPitchB[MAX_COLOR_BUFFERS + 1];
+	unsigned int deferredClearValue[MAX_COLOR_BUFFERS + 1];
+	uint32_t *sampleEqualityTiles[MAX_COLOR_BUFFERS];
+	int sampleEqualityPitchB[MAX_COLOR_BUFFERS];
 	unsigned char *stencilBuffer;
 	int stencilPitchB;
 	int stencilSliceB;
@@ -116,7 +127,7 @@ struct DrawCall
 {
 	struct BatchData
 	{
-		using Pool = marl::BoundedPool<BatchData, MaxBatchCount, marl::PoolPolicy::Preserve>;
+		using Pool = sw::CappedPool<BatchData>;
 
 		TriangleBatch triangles;
 		PrimitiveBatch primitives;
@@ -128,8 +139,8 @@ struct DrawCall
 		marl::Ticket clusterTickets[MaxClusterCount];
 	};
 
-	using Pool = marl::BoundedPool<DrawCall, MaxDrawCount, marl::PoolPolicy::Preserve>;
-	using SetupFunction = int (*)(vk::Device *device, Triangle *triangles, Primitive *primitives, const DrawCall *drawCall, int count);
+	using Pool = sw::CappedPool<DrawCall>;
+	using SetupFunction = int (*)(vk::Device *device, const Vertex *vertices, Primitive *primitives, const DrawCall *drawCall, int count);
 
 	DrawCall();
 	~DrawCall();
@@ -142,11 +153,13 @@ struct DrawCall
 	void teardown(vk::Device *device);
 
 	int id;
+	int64_t timelineBegin;  // Start of the draw on the timeline, or -1 when it is disabled.
 
 	BatchData::Pool *batchDataPool;
 	unsigned int numPrimitives;
 	unsigned int numPrimitivesPerBatch;
 	unsigned int numBatches;
+	int clusterCount;
 
 	VkPrimitiveTopology topology;
 	VkProvokingVertexModeEXT provokingVertexMode;
@@ -155,6 +168,7 @@ struct DrawCall
 
 	bool depthClipEnable;
 	bool depthClipNegativeOneToOne;
+	bool deduplicateVertices;
 
 	VertexProcessor::RoutineType vertexRoutine;
 	SetupProcessor::RoutineType setupRoutine;
@@ -186,14 +200,27 @@ struct DrawCall
 	    VkPrimitiveTopology topology,
 	    VkProvokingVertexModeEXT provokingVertexMode);
 
-	static int setupSolidTriangles(vk::Device *device, Triangle *triangles, Primitive *primitives, const DrawCall *drawCall, int count);
-	static int setupWireframeTriangles(vk::Device *device, Triangle *triangles, Primitive *primitives, const DrawCall *drawCall, int count);
-	static int setupPointTriangles(vk::Device *device, Triangle *triangles, Primitive *primitives, const DrawCall *drawCall, int count);
-	static int setupLines(vk::Device *device, Triangle *triangles, Primitive *primitives, const DrawCall *drawCall, int count);
-	static int setupPoints(vk::Device *device, Triangle *triangles, Primitive *primitives, const DrawCall *drawCall, int count);
+	static void deduplicateBatchVertices(
+	    const unsigned int *indices,
+	    unsigned int vertexCount,
+	    unsigned int *uniqueIndicesOut,
+	    VertexDeduplication &deduplication);
+
+	static int setupSolidTriangles(vk::Device *device, const Vertex *vertices, Primitive *primitives, const DrawCall *drawCall, int count);
+	static int setupWireframeTriangles(vk::Device *device, const Vertex *vertices, Primitive *primitives, const DrawCall *drawCall, int count);
+	static int setupPointTriangles(vk::Device *device, const Vertex *vertices, Primitive *primitives, const DrawCall *drawCall, int count);
+	static int setupLines(vk::Device *device, const Vertex *vertices, Primitive *primitives, const DrawCall *drawCall, int count);
+	static int setupPoints(vk::Device *device, const Vertex *vertices, Primitive *primitives, const DrawCall *drawCall, int count);
+
+	static bool setupLine(vk::Device *device, Primitive &primitive, const Vertex *vertices, const DrawCall &draw);
+	static bool setupPoint(vk::Device *device, Primitive &primitive, const Vertex *vertices, const DrawCall &draw);
 
-	static bool setupLine(vk::Device *device, Primitive &primitive, Triangle &triangle, const DrawCall &draw);
-	static bool setupPoint(vk::Device *device, Primitive &primitive, Triangle &triangle, const DrawCall &draw);
+	// Returns the vertex record at the given index. Records are sized to the vertex shader's
+	// output interface, and three consecutive ones form a triangle.
+	const Vertex &vertex(const Vertex *vertices, int index) const
+	{
+		return *reinterpret_cast<const Vertex *>(reinterpret_cast<const uint8_t *>(vertices) + index * setupState.vertexStride);
+	}
 };
 
 class alignas(16) Renderer
@@ -218,6 +245,13 @@ public:
 	void synchronize();
 
 private:
+	// Runtime limits, derived from the [Processor] configuration and the scheduler's
+	// worker thread count. Must be declared before the pools they size. The cluster
+	// count is always a power of two, as expected by the rasterizer.
+	const int clusterCount;
+	const int batchCount;
+	const int drawCount;
+
 	DrawCall::Pool drawCallPool;
 	DrawCall::BatchData::Pool batchDataPool;
 
@@ -16,6 +16,7 @@
 #define sw_RoutineCache_hpp
 
 #include "System/LRUCache.hpp"
+#include "System/RoutineTelemetry.hpp"
 
 #include "Reactor/Reactor.hpp"
 
@@ -23,8 +24,28 @@ namespace sw {
 
 using namespace rr;
 
+// RoutineCache is an LRUCache of routines which records each of its lookups
+// in the RoutineTelemetry of the kind of routines it holds.
 template<class State, class FunctionType>
-using RoutineCache = LRUCache<State, RoutineT<FunctionType>>;
+class RoutineCache : public LRUCache<State, RoutineT<FunctionType>>
+{
+public:
+	RoutineCache(size_t capacity, RoutineKind kind)
+	    : LRUCache<State, RoutineT<FunctionType>>(capacity)
+	    , kind(kind)
+	{}
+
+	RoutineT<FunctionType> lookup(const State &key)
+	{
+		auto routine = LRUCache<State, RoutineT<FunctionType>>::lookup(key);
+		RoutineTelemetry::recordCacheLookup(kind, routine);
+
+		return routine;
+	}
+
+private:
+	const RoutineKind kind;
+};
 
 }  // namespace sw
 
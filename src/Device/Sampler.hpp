@@ -88,6 +88,7 @@ struct Sampler
 {
 	VkImageViewType textureType;
 	vk::Format textureFormat;
+	bool tiledLayout;  // Texels are stored in TEXEL_TILE_SIZE x TEXEL_TILE_SIZE tiles
 	FilterType textureFilter;
 	AddressingMode addressingModeU;
 	AddressingMode addressingModeV;
@@ -21,6 +21,7 @@
 #include "Pipeline/SetupRoutine.hpp"
 #include "Pipeline/SpirvShader.hpp"
 #include "System/Debug.hpp"
+#include "System/RoutineTelemetry.hpp"
 #include "Vulkan/VkImageView.hpp"
 
 #include <cstring>
@@ -88,6 +89,7 @@ SetupProcessor::State SetupProcessor::update(const vk::GraphicsState &pipelineSt
 
 	state.numClipDistances = vertexShader->getNumOutputClipDistances();
 	state.numCullDistances = vertexShader->getNumOutputCullDistances();
+	state.vertexStride = VertexStride(vertexShader->getOutputInterfaceSize());
 
 	if(fragmentShader)
 	{
@@ -108,6 +110,8 @@ SetupProcessor::RoutineType SetupProcessor::routine(const State &state)
 
 	if(!routine)
 	{
+		RoutineTelemetry::ScopedCompile compile(RoutineKind::Setup);
+
 		SetupRoutine *generator = new SetupRoutine(state);
 		generator->generate();
 		routine = generator->getRoutine();
@@ -121,7 +125,7 @@ SetupProcessor::RoutineType SetupProcessor::routine(const State &state)
 
 void SetupProcessor::setRoutineCacheSize(int cacheSize)
 {
-	routineCache = std::make_unique<RoutineCacheType>(clamp(cacheSize, 1, 65536));
+	routineCache = std::make_unique<RoutineCacheType>(clamp(cacheSize, 1, 65536), RoutineKind::Setup);
 }
 
 }  // namespace sw
@@ -26,11 +26,11 @@
 namespace sw {
 
 struct Primitive;
-struct Triangle;
+struct Vertex;
 struct Polygon;
 struct DrawData;
 
-using SetupFunction = FunctionT<int(const vk::Device *device, Primitive *primitive, const Triangle *triangle, const Polygon *polygon, const DrawData *draw)>;
+using SetupFunction = FunctionT<int(const vk::Device *device, Primitive *primitive, const Vertex *vertices, const Polygon *polygon, const DrawData *draw)>;
 
 class SetupProcessor
 {
@@ -58,6 +58,7 @@ public:
 		bool enableMultiSampling : 1;
 		unsigned int numClipDistances : 4;  // [0 - 8]
 		unsigned int numCullDistances : 4;  // [0 - 8]
+		unsigned int vertexStride;          // Size of the vertex records, in bytes
 
 		SpirvShader::InterfaceComponent gradient[MAX_INTERFACE_COMPONENTS];
 	};
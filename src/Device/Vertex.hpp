@@ -18,6 +18,8 @@
 #include "Device/Config.hpp"
 #include "System/Types.hpp"
 
+#include <cstddef>
+
 namespace sw {
 
 struct alignas(16) Vertex
@@ -55,6 +57,17 @@ struct alignas(16) Vertex
 
 static_assert((sizeof(Vertex) & 0x0000000F) == 0, "Vertex size not a multiple of 16 bytes (alignment requirement)");
 
+// Vertices are stored as records which only hold the first 'interfaceComponents' elements of
+// v[], rounded up to whole vectors. This keeps the records, and the memory traffic between the
+// vertex and setup stages, proportional to the vertex shader's actual output interface.
+constexpr int VertexStride(int interfaceComponents)
+{
+	return static_cast<int>(offsetof(Vertex, v)) + ((interfaceComponents + 3) & ~3) * static_cast<int>(sizeof(float));
+}
+
+static_assert(VertexStride(MAX_INTERFACE_COMPONENTS) == sizeof(Vertex), "Vertex records must not exceed the Vertex structure");
+static_assert((VertexStride(0) & 0x0000000F) == 0, "Vertex records must preserve 16 byte alignment");
+
 }  // namespace sw
 
 #endif  // Vertex_hpp
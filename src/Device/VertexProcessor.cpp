@@ -18,6 +18,7 @@
 #include "Pipeline/VertexProgram.hpp"
 #include "System/Debug.hpp"
 #include "System/Math.hpp"
+#include "System/RoutineTelemetry.hpp"
 #include "Vulkan/VkPipelineLayout.hpp"
 
 #include <cstring>
@@ -62,10 +63,10 @@ VertexProcessor::VertexProcessor()
 
 void VertexProcessor::setRoutineCacheSize(int cacheSize)
 {
-	routineCache = std::make_unique<RoutineCacheType>(clamp(cacheSize, 1, 65536));
+	routineCache = std::make_unique<RoutineCacheType>(clamp(cacheSize, 1, 65536), RoutineKind::Vertex);
 }
 
-const VertexProcessor::State VertexProcessor::update(const vk::GraphicsState &pipelineState, const sw::SpirvShader *vertexShader, const vk::Inputs &inputs)
+const VertexProcessor::State VertexProcessor::update(const vk::GraphicsState &pipelineState, const sw::SpirvShader *vertexShader, const vk::Inputs &inputs, bool indexed)
 {
 	const vk::VertexInputInterfaceState &vertexInputInterfaceState = pipelineState.getVertexInputInterfaceState();
 	const vk::PreRasterizationState &preRasterizationState = pipelineState.getPreRasterizationState();
@@ -79,9 +80,16 @@ const VertexProcessor::State VertexProcessor::update(const vk::GraphicsState &pi
 	state.depthClipEnable = preRasterizationState.getDepthClipEnable();
 	state.depthClipNegativeOneToOne = preRasterizationState.getDepthClipNegativeOneToOne();
 
+	// Index buffers can reference vertices in any order, which the direct mapped vertex
+	// cache handles poorly. Points are compacted into batches of distinct vertices instead.
+	state.deduplicateVertices = indexed && !state.isPoint;
+
 	for(size_t i = 0; i < MAX_INTERFACE_COMPONENTS / 4; i++)
 	{
-		state.input[i].format = inputs.getStream(i).format;
+		const sw::Stream &stream = inputs.getStream(i);
+		state.input[i].format = stream.format;
+		state.input[i].binding = stream.binding;
+		state.input[i].offset = stream.offset;
 		// TODO: get rid of attribType -- just keep the VK format all the way through, this fully determines
 		// how to handle the attribute.
 		state.input[i].attribType = vertexShader->inputs[i * 4].Type;
@@ -101,6 +109,8 @@ VertexProcessor::RoutineType VertexProcessor::routine(const State &state,
 
 	if(!routine)  // Create one
 	{
+		RoutineTelemetry::ScopedCompile compile(RoutineKind::Vertex);
+
 		VertexRoutine *generator = new VertexProgram(state, pipelineLayout, vertexShader, descriptorSets);
 		generator->generate();
 		routine = (*generator)("VertexRoutine_%0.8X", state.shaderID);
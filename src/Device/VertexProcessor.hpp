@@ -44,11 +44,27 @@ struct VertexCache
 	int drawCall = -1;
 };
 
+// Distinct vertex indices of a batch, for shading each of them exactly once.
+struct VertexDeduplication
+{
+	static constexpr uint32_t MAX_VERTICES = 128 * 3;  // Three vertices for each primitive of a full batch.
+
+	uint32_t uniqueCount;
+
+	// Output vertex which receives the shaded results of each unique vertex. This
+	// is its first occurrence in the batch. Padded for SIMD width overrun.
+	uint32_t slot[MAX_VERTICES + 4];
+
+	// Output vertex from which each output vertex gets copied, if not itself.
+	uint32_t source[MAX_VERTICES];
+};
+
 struct VertexTask
 {
 	unsigned int vertexCount;
 	unsigned int primitiveStart;
 	VertexCache vertexCache;
+	VertexDeduplication deduplication;
 };
 
 using VertexRoutineFunction = FunctionT<void(const vk::Device *device, Vertex *output, unsigned int *batch, VertexTask *vertextask, DrawData *draw)>;
@@ -76,6 +92,8 @@ public:
 
 			VkFormat format;  // TODO(b/148016460): Could be restricted to VK_FORMAT_END_RANGE
 			unsigned int attribType : BITS(SpirvShader::ATTRIBTYPE_LAST);
+			unsigned int binding : BITS(vk::MAX_VERTEX_INPUT_BINDINGS - 1);
+			unsigned int offset : BITS(vk::MAX_VERTEX_INPUT_ATTRIBUTE_OFFSET);  // Within the binding's vertex record
 		};
 
 		Input input[MAX_INTERFACE_COMPONENTS / 4];
@@ -83,6 +101,7 @@ public:
 		bool isPoint : 1;
 		bool depthClipEnable : 1;
 		bool depthClipNegativeOneToOne : 1;
+		bool deduplicateVertices : 1;
 	};
 
 	struct State : States
@@ -96,7 +115,7 @@ public:
 
 	VertexProcessor();
 
-	const State update(const vk::GraphicsState &pipelineState, const sw::SpirvShader *vertexShader, const vk::Inputs &inputs);
+	const State update(const vk::GraphicsState &pipelineState, const sw::SpirvShader *vertexShader, const vk::Inputs &inputs, bool indexed);
 	RoutineType routine(const State &state, const vk::PipelineLayout *pipelineLayout,
 	                    const SpirvShader *vertexShader, const vk::DescriptorSet::Bindings &descriptorSets);
 
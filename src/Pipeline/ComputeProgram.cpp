@@ -16,22 +16,145 @@
 
 #include "Constants.hpp"
 #include "System/Debug.hpp"
+#include "System/Timeline.hpp"
 #include "Vulkan/VkDevice.hpp"
 #include "Vulkan/VkPipelineLayout.hpp"
 
 #include "marl/defer.h"
+#include "marl/scheduler.h"
 #include "marl/trace.h"
 #include "marl/waitgroup.h"
 
+#include <algorithm>
+#include <atomic>
 #include <queue>
 
 namespace sw {
 
+namespace {
+
+// Width and height, in workgroups, of the tiles in which 2D and 3D dispatches
+// are traversed, so that consecutive workgroups touch neighbouring data.
+constexpr uint32_t WorkgroupTileSize = 4;
+
+// Average number of chunks of workgroups initially assigned to each task. More
+// chunks improve load balancing when workgroups have uneven cost.
+constexpr uint32_t ChunksPerTask = 8;
+
+// Maps linear workgroup indices to workgroup offsets. Each XY slice of the
+// dispatch is traversed in bands of WorkgroupTileSize rows, and each band in
+// tiles of WorkgroupTileSize columns. Partial tiles only occur at the end of
+// a band, and partial bands at the end of a slice, which keeps the mapping a
+// simple bijection.
+class WorkgroupOrder
+{
+public:
+	WorkgroupOrder(uint32_t groupCountX, uint32_t groupCountY)
+	    : groupCountX(groupCountX)
+	    , groupCountY(groupCountY)
+	{}
+
+	void offsets(uint32_t index, uint32_t &x, uint32_t &y, uint32_t &z) const
+	{
+		uint32_t sliceSize = groupCountX * groupCountY;
+		z = index / sliceSize;
+		index -= z * sliceSize;
+
+		uint32_t band = index / (groupCountX * WorkgroupTileSize);
+		index -= band * (groupCountX * WorkgroupTileSize);
+		uint32_t bandHeight = std::min(WorkgroupTileSize, groupCountY - band * WorkgroupTileSize);
+
+		uint32_t tile = index / (WorkgroupTileSize * bandHeight);
+		index -= tile * (WorkgroupTileSize * bandHeight);
+		uint32_t tileWidth = std::min(WorkgroupTileSize, groupCountX - tile * WorkgroupTileSize);
+
+		x = tile * WorkgroupTileSize + index % tileWidth;
+		y = band * WorkgroupTileSize + index / tileWidth;
+	}
+
+private:
+	const uint32_t groupCountX;
+	const uint32_t groupCountY;
+};
+
+// Work-stealing queues of chunk indices. Each task owns a contiguous range of
+// chunks, which it takes from the front. Once its own range is exhausted, it
+// steals chunks from the back of the other tasks' ranges.
+class WorkgroupQueues
+{
+public:
+	WorkgroupQueues(uint32_t chunkCount, uint32_t queueCount)
+	    : queues(queueCount)
+	{
+		for(uint32_t i = 0; i < queueCount; i++)
+		{
+			uint64_t begin = uint64_t(chunkCount) * i / queueCount;
+			uint64_t end = uint64_t(chunkCount) * (i + 1) / queueCount;
+			queues[i].range = begin | (end << 32);
+		}
+	}
+
+	// Returns false once all chunks have been taken.
+	bool take(uint32_t queue, uint32_t &chunk)
+	{
+		if(pop(queue, false, chunk))
+		{
+			return true;
+		}
+
+		for(size_t i = 1; i < queues.size(); i++)
+		{
+			if(pop((queue + i) % queues.size(), true, chunk))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+private:
+	bool pop(size_t queue, bool back, uint32_t &chunk)
+	{
+		auto &range = queues[queue].range;
+		uint64_t current = range.load(std::memory_order_relaxed);
+
+		for(;;)
+		{
+			uint32_t begin = static_cast<uint32_t>(current);
+			uint32_t end = static_cast<uint32_t>(current >> 32);
+
+			if(begin >= end)
+			{
+				return false;
+			}
+
+			uint64_t next = back ? (begin | (uint64_t(end - 1) << 32)) : ((begin + 1) | (uint64_t(end) << 32));
+
+			if(range.compare_exchange_weak(current, next, std::memory_order_relaxed))
+			{
+				chunk = back ? (end - 1) : begin;
+				return true;
+			}
+		}
+	}
+
+	struct alignas(64) Queue  // Avoid false sharing between queues.
+	{
+		std::atomic<uint64_t> range;  // Begin index in the low 32 bits, end index in the high 32 bits.
+	};
+
+	std::vector<Queue> queues;
+};
+
+}  // anonymous namespace
+
 ComputeProgram::ComputeProgram(vk::Device *device, std::shared_ptr<SpirvShader> shader, const vk::PipelineLayout *pipelineLayout, const vk::DescriptorSet::Bindings &descriptorSets)
     : device(device)
     , shader(shader)
     , pipelineLayout(pipelineLayout)
     , descriptorSets(descriptorSets)
+    , splitIntoPhases(device->splitsComputePhases() && shader->canSplitIntoPhases())
 {
 }
 
@@ -43,10 +166,49 @@ void ComputeProgram::generate()
 {
 	MARL_SCOPED_EVENT("ComputeProgram::generate");
 
-	SpirvRoutine routine(pipelineLayout);
-	shader->emitProlog(&routine);
-	emit(&routine);
-	shader->emitEpilog(&routine);
+	if(splitIntoPhases)
+	{
+		phaseFunction = std::make_unique<PhaseFunction>();
+
+		SpirvRoutine routine(pipelineLayout);
+		shader->emitProlog(&routine);
+		emitPhases(&routine);
+		shader->emitEpilog(&routine);
+
+		phaseStateSize = sw::align(routine.phaseStateSize, 16);  // Keep each subgroup's state aligned.
+	}
+	else
+	{
+		coroutine = std::make_unique<SubgroupCoroutine>();
+
+		SpirvRoutine routine(pipelineLayout);
+		shader->emitProlog(&routine);
+		emitSubgroups(&routine);
+		shader->emitEpilog(&routine);
+	}
+}
+
+void ComputeProgram::finalize(const char *name)
+{
+	if(phaseFunction)
+	{
+		phaseRoutine = (*phaseFunction)(name);
+		phaseFunction.reset();
+	}
+	else
+	{
+		coroutine->finalize(name);
+	}
+}
+
+void ComputeProgram::setRoutinePointers(Pointer<Byte> device, Pointer<Byte> data, Pointer<Byte> workgroupMemory, SpirvRoutine *routine)
+{
+	routine->device = device;
+	routine->descriptorSets = data + OFFSET(Data, descriptorSets);
+	routine->descriptorDynamicOffsets = data + OFFSET(Data, descriptorDynamicOffsets);
+	routine->pushConstants = data + OFFSET(Data, pushConstants);
+	routine->constants = device + OFFSET(vk::Device, constants);
+	routine->workgroupMemory = workgroupMemory;
 }
 
 void ComputeProgram::setWorkgroupBuiltins(Pointer<Byte> data, SpirvRoutine *routine, Int workgroupID[3])
@@ -148,23 +310,18 @@ void ComputeProgram::setSubgroupBuiltins(Pointer<Byte> data, SpirvRoutine *routi
 	});
 }
 
-void ComputeProgram::emit(SpirvRoutine *routine)
+void ComputeProgram::emitSubgroups(SpirvRoutine *routine)
 {
-	Pointer<Byte> device = Arg<0>();
-	Pointer<Byte> data = Arg<1>();
-	Int workgroupX = Arg<2>();
-	Int workgroupY = Arg<3>();
-	Int workgroupZ = Arg<4>();
-	Pointer<Byte> workgroupMemory = Arg<5>();
-	Int firstSubgroup = Arg<6>();
-	Int subgroupCount = Arg<7>();
+	Pointer<Byte> device = coroutine->Arg<0>();
+	Pointer<Byte> data = coroutine->Arg<1>();
+	Int workgroupX = coroutine->Arg<2>();
+	Int workgroupY = coroutine->Arg<3>();
+	Int workgroupZ = coroutine->Arg<4>();
+	Pointer<Byte> workgroupMemory = coroutine->Arg<5>();
+	Int firstSubgroup = coroutine->Arg<6>();
+	Int subgroupCount = coroutine->Arg<7>();
 
-	routine->device = device;
-	routine->descriptorSets = data + OFFSET(Data, descriptorSets);
-	routine->descriptorDynamicOffsets = data + OFFSET(Data, descriptorDynamicOffsets);
-	routine->pushConstants = data + OFFSET(Data, pushConstants);
-	routine->constants = device + OFFSET(vk::Device, constants);
-	routine->workgroupMemory = workgroupMemory;
+	setRoutinePointers(device, data, workgroupMemory, routine);
 
 	Int invocationsPerWorkgroup = *Pointer<Int>(data + OFFSET(Data, invocationsPerWorkgroup));
 
@@ -187,6 +344,73 @@ void ComputeProgram::emit(SpirvRoutine *routine)
 	}
 }
 
+void ComputeProgram::emitPhases(SpirvRoutine *routine)
+{
+	Pointer<Byte> device = phaseFunction->Arg<0>();
+	Pointer<Byte> data = phaseFunction->Arg<1>();
+	Int workgroupX = phaseFunction->Arg<2>();
+	Int workgroupY = phaseFunction->Arg<3>();
+	Int workgroupZ = phaseFunction->Arg<4>();
+	Pointer<Byte> workgroupMemory = phaseFunction->Arg<5>();
+	Pointer<Byte> phaseState = phaseFunction->Arg<6>();
+
+	setRoutinePointers(device, data, workgroupMemory, routine);
+
+	Int invocationsPerWorkgroup = *Pointer<Int>(data + OFFSET(Data, invocationsPerWorkgroup));
+	Int subgroupsPerWorkgroup = *Pointer<Int>(data + OFFSET(Data, subgroupsPerWorkgroup));
+	Int subgroupStateSize = *Pointer<Int>(data + OFFSET(Data, phaseStateSize));
+
+	Int workgroupID[3] = { workgroupX, workgroupY, workgroupZ };
+	setWorkgroupBuiltins(data, routine, workgroupID);
+
+	// Each phase is a loop over the subgroups. Phases end in the middle of
+	// the shader's code, so the loops are built from basic blocks rather
+	// than with For().
+	Int subgroupIndex = 0;
+	BasicBlock *loopHeader = nullptr;
+	BasicBlock *loopEnd = nullptr;
+
+	auto beginPhase = [&]() {
+		subgroupIndex = 0;
+
+		loopHeader = Nucleus::createBasicBlock();
+		BasicBlock *loopBody = Nucleus::createBasicBlock();
+		loopEnd = Nucleus::createBasicBlock();
+
+		Nucleus::createBr(loopHeader);
+		Nucleus::setInsertBlock(loopHeader);
+		Nucleus::createCondBr((subgroupIndex < subgroupsPerWorkgroup).value(), loopBody, loopEnd);
+		Nucleus::setInsertBlock(loopBody);
+
+		// TODO: Replace SIMD::Int(0, 1, 2, 3) with SIMD-width equivalent
+		SIMD::Int localInvocationIndex = SIMD::Int(subgroupIndex * SIMD::Width) + SIMD::Int(0, 1, 2, 3);
+
+		setSubgroupBuiltins(data, routine, workgroupID, localInvocationIndex, subgroupIndex);
+		routine->phaseState = phaseState + subgroupIndex * subgroupStateSize;
+
+		// Disable lanes where (invocationIDs >= invocationsPerWorkgroup)
+		return CmpLT(localInvocationIndex, SIMD::Int(invocationsPerWorkgroup));
+	};
+
+	auto endPhase = [&]() {
+		subgroupIndex += 1;
+
+		Nucleus::createBr(loopHeader);
+		Nucleus::setInsertBlock(loopEnd);
+	};
+
+	routine->endPhase = [&]() {
+		endPhase();
+		beginPhase();  // The emitter restores the active lane mask.
+	};
+
+	SIMD::Int activeLaneMask = beginPhase();
+	shader->emit(routine, activeLaneMask, activeLaneMask, descriptorSets);
+	endPhase();
+
+	routine->endPhase = nullptr;
+}
+
 void ComputeProgram::run(
     const vk::DescriptorSet::Array &descriptorSetObjects,
     const vk::DescriptorSet::Bindings &descriptorSets,
@@ -215,69 +439,92 @@ void ComputeProgram::run(
 	data.invocationsPerSubgroup = invocationsPerSubgroup;
 	data.invocationsPerWorkgroup = invocationsPerWorkgroup;
 	data.subgroupsPerWorkgroup = subgroupsPerWorkgroup;
+	data.phaseStateSize = phaseStateSize;
 	data.pushConstants = pushConstants;
 
-	marl::WaitGroup wg;
-	constexpr uint32_t batchCount = 16;
-
 	auto groupCount = groupCountX * groupCountY * groupCountZ;
+	if(groupCount == 0)
+	{
+		return;
+	}
+
+	Timeline::Scope timeline(Timeline::Category::Dispatch, "Dispatch", groupCount);
+
+	// Size the number of tasks to the scheduler's worker threads, and divide
+	// the dispatch into chunks which tasks take dynamically.
+	uint32_t threadCount = std::max(marl::Scheduler::get()->config().workerThread.count, 1);
+	uint32_t taskCount = std::min(threadCount, groupCount);
+	uint32_t chunkSize = std::max(groupCount / (taskCount * ChunksPerTask), 1u);
+	uint32_t chunkCount = (groupCount + chunkSize - 1) / chunkSize;
+
+	WorkgroupOrder order(groupCountX, groupCountY);
+	WorkgroupQueues queues(chunkCount, taskCount);
 
-	for(uint32_t batchID = 0; batchID < batchCount && batchID < groupCount; batchID++)
+	marl::WaitGroup wg;
+
+	for(uint32_t taskID = 0; taskID < taskCount; taskID++)
 	{
 		wg.add(1);
-		marl::schedule([this, batchID, groupCount, groupCountX, groupCountY,
+		marl::schedule([this, taskID, groupCount, chunkSize, &order, &queues,
 		                baseGroupZ, baseGroupY, baseGroupX, wg, subgroupsPerWorkgroup,
 		                &data] {
-			// Workaround for the fact that some compilers don't allow batchCount to be captured.
-			constexpr uint32_t batchCount = 16;
 			defer(wg.done());
 			std::vector<uint8_t> workgroupMemory(shader->workgroupMemory.size());
+			std::vector<uint8_t> phaseState(phaseRoutine ? phaseStateSize * subgroupsPerWorkgroup : 0);
 
-			for(uint32_t groupIndex = batchID; groupIndex < groupCount; groupIndex += batchCount)
+			uint32_t chunk = 0;
+			while(queues.take(taskID, chunk))
 			{
-				auto modulo = groupIndex;
-				auto groupOffsetZ = modulo / (groupCountX * groupCountY);
-				modulo -= groupOffsetZ * (groupCountX * groupCountY);
-				auto groupOffsetY = modulo / groupCountX;
-				modulo -= groupOffsetY * groupCountX;
-				auto groupOffsetX = modulo;
-
-				auto groupZ = baseGroupZ + groupOffsetZ;
-				auto groupY = baseGroupY + groupOffsetY;
-				auto groupX = baseGroupX + groupOffsetX;
-				MARL_SCOPED_EVENT("groupX: %d, groupY: %d, groupZ: %d", groupX, groupY, groupZ);
-
-				using Coroutine = std::unique_ptr<rr::Stream<SpirvEmitter::YieldResult>>;
-				std::queue<Coroutine> coroutines;
-
-				if(shader->getAnalysis().ContainsControlBarriers)
+				uint32_t chunkEnd = std::min(groupCount, (chunk + 1) * chunkSize);
+
+				for(uint32_t groupIndex = chunk * chunkSize; groupIndex < chunkEnd; groupIndex++)
 				{
-					// Make a function call per subgroup so each subgroup
-					// can yield, bringing all subgroups to the barrier
-					// together.
-					for(uint32_t subgroupIndex = 0; subgroupIndex < subgroupsPerWorkgroup; subgroupIndex++)
+					uint32_t groupOffsetX, groupOffsetY, groupOffsetZ;
+					order.offsets(groupIndex, groupOffsetX, groupOffsetY, groupOffsetZ);
+
+					auto groupZ = baseGroupZ + groupOffsetZ;
+					auto groupY = baseGroupY + groupOffsetY;
+					auto groupX = baseGroupX + groupOffsetX;
+					MARL_SCOPED_EVENT("groupX: %d, groupY: %d, groupZ: %d", groupX, groupY, groupZ);
+
+					if(phaseRoutine)
 					{
-						auto coroutine = (*this)(device, &data, groupX, groupY, groupZ, workgroupMemory.data(), subgroupIndex, 1);
-						coroutines.push(std::move(coroutine));
+						phaseRoutine(device, &data, groupX, groupY, groupZ, workgroupMemory.data(), phaseState.data());
+						continue;
 					}
-				}
-				else
-				{
-					auto coroutine = (*this)(device, &data, groupX, groupY, groupZ, workgroupMemory.data(), 0, subgroupsPerWorkgroup);
-					coroutines.push(std::move(coroutine));
-				}
 
-				while(coroutines.size() > 0)
-				{
-					auto coroutine = std::move(coroutines.front());
-					coroutines.pop();
+					using Coroutine = std::unique_ptr<rr::Stream<SpirvEmitter::YieldResult>>;
+					std::queue<Coroutine> coroutines;
 
-					SpirvEmitter::YieldResult result;
-					if(coroutine->await(result))
+					if(shader->getAnalysis().ContainsControlBarriers)
+					{
+						// Make a function call per subgroup so each subgroup
+						// can yield, bringing all subgroups to the barrier
+						// together.
+						for(uint32_t subgroupIndex = 0; subgroupIndex < subgroupsPerWorkgroup; subgroupIndex++)
+						{
+							auto coroutine = (*this->coroutine)(device, &data, groupX, groupY, groupZ, workgroupMemory.data(), subgroupIndex, 1);
+							coroutines.push(std::move(coroutine));
+						}
+					}
+					else
 					{
-						// TODO: Consider result (when the enum is more than 1 entry).
+						auto coroutine = (*this->coroutine)(device, &data, groupX, groupY, groupZ, workgroupMemory.data(), 0, subgroupsPerWorkgroup);
 						coroutines.push(std::move(coroutine));
 					}
+
+					while(coroutines.size() > 0)
+					{
+						auto coroutine = std::move(coroutines.front());
+						coroutines.pop();
+
+						SpirvEmitter::YieldResult result;
+						if(coroutine->await(result))
+						{
+							// TODO: Consider result (when the enum is more than 1 entry).
+							coroutines.push(std::move(coroutine));
+						}
+					}
 				}
 			}
 		});
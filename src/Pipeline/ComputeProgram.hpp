@@ -22,6 +22,7 @@
 #include "Vulkan/VkPipeline.hpp"
 
 #include <functional>
+#include <memory>
 
 namespace vk {
 class Device;
@@ -36,15 +37,7 @@ class DescriptorSetsLayout;
 struct Constants;
 
 // ComputeProgram builds a SPIR-V compute shader.
-class ComputeProgram : public Coroutine<SpirvEmitter::YieldResult(
-                           const vk::Device *device,
-                           void *data,
-                           int32_t workgroupX,
-                           int32_t workgroupY,
-                           int32_t workgroupZ,
-                           void *workgroupMemory,
-                           int32_t firstSubgroup,
-                           int32_t subgroupCount)>
+class ComputeProgram
 {
 public:
 	ComputeProgram(vk::Device *device, std::shared_ptr<SpirvShader> spirvShader, const vk::PipelineLayout *pipelineLayout, const vk::DescriptorSet::Bindings &descriptorSets);
@@ -54,6 +47,10 @@ public:
 	// generate builds the shader program.
 	void generate();
 
+	// finalize generates the executable code of the shader program. It must
+	// be called on the thread which called generate().
+	void finalize(const char *name);
+
 	// run executes the compute shader routine for all workgroups.
 	void run(
 	    const vk::DescriptorSet::Array &descriptorSetObjects,
@@ -64,7 +61,34 @@ public:
 	    uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ);
 
 protected:
-	void emit(SpirvRoutine *routine);
+	// Runs a range of subgroups of a workgroup, and yields at each control
+	// barrier so that all subgroups can be brought to it together.
+	using SubgroupCoroutine = Coroutine<SpirvEmitter::YieldResult(
+	    const vk::Device *device,
+	    void *data,
+	    int32_t workgroupX,
+	    int32_t workgroupY,
+	    int32_t workgroupZ,
+	    void *workgroupMemory,
+	    int32_t firstSubgroup,
+	    int32_t subgroupCount)>;
+
+	// Runs all subgroups of a workgroup, when the shader is split into phases
+	// at its control barriers. Each phase runs for all subgroups before the
+	// next one starts, and values live across barriers are kept in
+	// phaseState, which holds phaseStateSize bytes per subgroup.
+	using PhaseFunction = FunctionT<void(
+	    const vk::Device *device,
+	    void *data,
+	    int32_t workgroupX,
+	    int32_t workgroupY,
+	    int32_t workgroupZ,
+	    void *workgroupMemory,
+	    void *phaseState)>;
+
+	void emitSubgroups(SpirvRoutine *routine);
+	void emitPhases(SpirvRoutine *routine);
+	void setRoutinePointers(Pointer<Byte> device, Pointer<Byte> data, Pointer<Byte> workgroupMemory, SpirvRoutine *routine);
 	void setWorkgroupBuiltins(Pointer<Byte> data, SpirvRoutine *routine, Int workgroupID[3]);
 	void setSubgroupBuiltins(Pointer<Byte> data, SpirvRoutine *routine, Int workgroupID[3], SIMD::Int localInvocationIndex, Int subgroupIndex);
 
@@ -77,6 +101,7 @@ protected:
 		uint32_t invocationsPerSubgroup;   // SPIR-V: "SubgroupSize"
 		uint32_t subgroupsPerWorkgroup;    // SPIR-V: "NumSubgroups"
 		uint32_t invocationsPerWorkgroup;  // Total number of invocations per workgroup.
+		uint32_t phaseStateSize;           // Bytes of phase state per subgroup.
 		vk::Pipeline::PushConstantStorage pushConstants;
 	};
 
@@ -84,6 +109,12 @@ protected:
 	const std::shared_ptr<SpirvShader> shader;
 	const vk::PipelineLayout *const pipelineLayout;  // Reference held by vk::Pipeline
 	const vk::DescriptorSet::Bindings &descriptorSets;
+	const bool splitIntoPhases;
+
+	std::unique_ptr<SubgroupCoroutine> coroutine;  // Used when not split into phases.
+	std::unique_ptr<PhaseFunction> phaseFunction;  // Only set while generating.
+	PhaseFunction::RoutineType phaseRoutine;
+	uint32_t phaseStateSize = 0;
 };
 
 }  // namespace sw
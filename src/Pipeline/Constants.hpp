@@ -46,6 +46,11 @@ static constexpr float SampleLocationsY[4] = {
 	VkSampleLocations4[3][1] - 0.5f,
 };
 
+// Compute the xMin and xMax multisample offsets so that they are just
+// large enough (+/- max range - epsilon) to include sample points
+static constexpr int xMinMultiSampleOffset = sw::toFixedPoint(1, vk::SUBPIXEL_PRECISION_BITS) - sw::toFixedPoint(sw::max(SampleLocationsX[0], SampleLocationsX[1], SampleLocationsX[2], SampleLocationsX[3]), vk::SUBPIXEL_PRECISION_BITS) - 1;
+static constexpr int xMaxMultiSampleOffset = sw::toFixedPoint(1, vk::SUBPIXEL_PRECISION_BITS) + sw::toFixedPoint(sw::max(SampleLocationsX[0], SampleLocationsX[1], SampleLocationsX[2], SampleLocationsX[3]), vk::SUBPIXEL_PRECISION_BITS) - 1;
+
 // Compute the yMin and yMax multisample offsets so that they are just
 // large enough (+/- max range - epsilon) to include sample points
 static constexpr int yMinMultiSampleOffset = sw::toFixedPoint(1, vk::SUBPIXEL_PRECISION_BITS) - sw::toFixedPoint(sw::max(SampleLocationsY[0], SampleLocationsY[1], SampleLocationsY[2], SampleLocationsY[3]), vk::SUBPIXEL_PRECISION_BITS) - 1;
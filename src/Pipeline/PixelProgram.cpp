@@ -267,18 +267,50 @@ void PixelProgram::blendColor(Pointer<Byte> cBuffer[4], Int &x, Int sMask[4], In
 			continue;
 		}
 
-		for(unsigned int q : samples)
+		if(state.fixedPointBlendMask & (1 << index))
 		{
-			Pointer<Byte> buffer = cBuffer[index] + q * *Pointer<Int>(data + OFFSET(DrawData, colorSliceB[index]));
-
-			SIMD::Float4 C = alphaBlend(index, buffer, c[index], x);
+			// The color has been clamped to [0, 1] by clampColor(). It is rounded to 8-bit
+			// like the floating-point path does when writing the blended color.
 			ASSERT(SIMD::Width == 4);
-			Vector4f color;
-			color.x = Extract128(C.x, 0);
-			color.y = Extract128(C.y, 0);
-			color.z = Extract128(C.z, 0);
-			color.w = Extract128(C.w, 0);
-			writeColor(index, buffer, x, color, sMask[q], zMask[q], cMask[q]);
+			auto toFixedPoint = [](const SIMD::Float &color) {
+				return Short4(RoundInt(Extract128(color, 0) * Float4(0xFF)));
+			};
+
+			Vector4s source;
+			source.x = toFixedPoint(c[index].x);
+			source.y = toFixedPoint(c[index].y);
+			source.z = toFixedPoint(c[index].z);
+			source.w = toFixedPoint(c[index].w);
+
+			for(unsigned int q : samples)
+			{
+				Pointer<Byte> buffer = cBuffer[index] + q * *Pointer<Int>(data + OFFSET(DrawData, colorSliceB[index]));
+
+				Vector4s color = source;
+				alphaBlend(index, buffer, color, x);
+				writeColor(index, buffer, x, color, sMask[q], zMask[q], cMask[q]);
+			}
+		}
+		else
+		{
+			for(unsigned int q : samples)
+			{
+				Pointer<Byte> buffer = cBuffer[index] + q * *Pointer<Int>(data + OFFSET(DrawData, colorSliceB[index]));
+
+				SIMD::Float4 C = alphaBlend(index, buffer, c[index], x);
+				ASSERT(SIMD::Width == 4);
+				Vector4f color;
+				color.x = Extract128(C.x, 0);
+				color.y = Extract128(C.y, 0);
+				color.z = Extract128(C.z, 0);
+				color.w = Extract128(C.w, 0);
+				writeColor(index, buffer, x, color, sMask[q], zMask[q], cMask[q]);
+			}
+		}
+
+		if(state.sampleEqualityMask & (1 << index))
+		{
+			updateSampleEquality(index, x, sMask, zMask, cMask, samples);
 		}
 	}
 }
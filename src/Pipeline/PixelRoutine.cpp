@@ -1110,6 +1110,8 @@ void PixelRoutine::readPixel(int index, const Pointer<Byte> &cBuffer, const Int
 		break;
 	case VK_FORMAT_R8G8B8A8_UNORM:
 	case VK_FORMAT_R8G8B8A8_SRGB:
+	case VK_FORMAT_A8B8G8R8_UNORM_PACK32:
+	case VK_FORMAT_A8B8G8R8_SRGB_PACK32:
 		buffer += 4 * x;
 		c01 = *Pointer<Short4>(buffer);
 		buffer += pitchB;
@@ -1960,6 +1962,188 @@ SIMD::Float4 PixelRoutine::alphaBlend(int index, const Pointer<Byte> &cBuffer, c
 	return blendedColor;
 }
 
+Short4 PixelRoutine::blendFactor(VkBlendFactor factor, Vector4s &source, Vector4s &dest, int component)
+{
+	switch(factor)
+	{
+	case VK_BLEND_FACTOR_ZERO:
+		return Short4(0x0000);
+	case VK_BLEND_FACTOR_ONE:
+		return Short4(0x00FF);
+	case VK_BLEND_FACTOR_SRC_COLOR:
+		return source[component];
+	case VK_BLEND_FACTOR_ONE_MINUS_SRC_COLOR:
+		return Short4(0x00FF) - source[component];
+	case VK_BLEND_FACTOR_DST_COLOR:
+		return dest[component];
+	case VK_BLEND_FACTOR_ONE_MINUS_DST_COLOR:
+		return Short4(0x00FF) - dest[component];
+	case VK_BLEND_FACTOR_SRC_ALPHA:
+		return source.w;
+	case VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA:
+		return Short4(0x00FF) - source.w;
+	case VK_BLEND_FACTOR_DST_ALPHA:
+		return dest.w;
+	case VK_BLEND_FACTOR_ONE_MINUS_DST_ALPHA:
+		return Short4(0x00FF) - dest.w;
+	case VK_BLEND_FACTOR_SRC_ALPHA_SATURATE:
+		if(component == 3)
+		{
+			return Short4(0x00FF);
+		}
+		return Min(source.w, Short4(0x00FF) - dest.w);
+	default:
+		UNSUPPORTED("VkBlendFactor: %d", int(factor));
+		return Short4(0x0000);
+	}
+}
+
+Short4 PixelRoutine::blendCombine(VkBlendOp operation, const Short4 &source, const Short4 &sourceFactor, const Short4 &dest, const Short4 &destFactor)
+{
+	switch(operation)
+	{
+	case VK_BLEND_OP_ADD:
+	case VK_BLEND_OP_SUBTRACT:
+	case VK_BLEND_OP_REVERSE_SUBTRACT:
+		break;
+	case VK_BLEND_OP_MIN:
+		return Min(source, dest);
+	case VK_BLEND_OP_MAX:
+		return Max(source, dest);
+	case VK_BLEND_OP_SRC_EXT:
+		return source;
+	case VK_BLEND_OP_DST_EXT:
+		return dest;
+	case VK_BLEND_OP_ZERO_EXT:
+		return Short4(0x0000);
+	default:
+		UNSUPPORTED("VkBlendOp: %d", int(operation));
+		return source;
+	}
+
+	// The terms are products of two 8-bit values, so they're at most 255 * 255 and
+	// the blended value is scaled by 255 * 255.
+	UShort4 sourceTerm = As<UShort4>(source) * As<UShort4>(sourceFactor);
+	UShort4 destTerm = As<UShort4>(dest) * As<UShort4>(destFactor);
+
+	UShort4 blended;
+	switch(operation)
+	{
+	case VK_BLEND_OP_ADD:
+		blended = Min(AddSat(sourceTerm, destTerm), UShort4(255 * 255));
+		break;
+	case VK_BLEND_OP_SUBTRACT:
+		blended = SubSat(sourceTerm, destTerm);
+		break;
+	default:
+		blended = SubSat(destTerm, sourceTerm);
+		break;
+	}
+
+	// Divide by 255 with rounding to nearest. This is exact for the full [0, 255 * 255]
+	// range, and matches the floating-point path's rounding because a blend of 8-bit
+	// values never falls halfway between two 8-bit results.
+	blended = blended + UShort4(0x0080);
+	return As<Short4>((blended + (blended >> 8)) >> 8);
+}
+
+void PixelRoutine::alphaBlend(int index, const Pointer<Byte> &cBuffer, Vector4s &current, const Int &x)
+{
+	ASSERT(state.fixedPointBlendMask & (1 << index));
+
+	// Expand the destination from the 16-bit replicated values returned by readPixel()
+	// to 8-bit values, like the source.
+	Vector4s pixel;
+	readPixel(index, cBuffer, x, pixel);
+	for(int i = 0; i < 4; i++)
+	{
+		pixel[i] = As<Short4>(As<UShort4>(pixel[i]) >> 8);
+	}
+
+	const vk::BlendState &blendState = state.blendState[index];
+
+	Vector4s blended;
+	for(int i = 0; i < 3; i++)
+	{
+		Short4 sourceFactor = blendFactor(blendState.sourceBlendFactor, current, pixel, i);
+		Short4 destFactor = blendFactor(blendState.destBlendFactor, current, pixel, i);
+		blended[i] = blendCombine(blendState.blendOperation, current[i], sourceFactor, pixel[i], destFactor);
+	}
+
+	Short4 sourceFactor = blendFactor(blendState.sourceBlendFactorAlpha, current, pixel, 3);
+	Short4 destFactor = blendFactor(blendState.destBlendFactorAlpha, current, pixel, 3);
+	blended.w = blendCombine(blendState.blendOperationAlpha, current.w, sourceFactor, pixel.w, destFactor);
+
+	current = blended;
+}
+
+void PixelRoutine::writeColor(int index, const Pointer<Byte> &cBuffer, const Int &x, Vector4s &current, const Int &sMask, const Int &zMask, const Int &cMask)
+{
+	ASSERT(state.fixedPointBlendMask & (1 << index));
+
+	vk::Format format = state.colorFormat[index];
+	int writeMask = state.colorWriteActive(index);
+
+	if(format.isBGRformat())
+	{
+		Short4 r = current.x;
+		current.x = current.z;
+		current.z = r;
+		writeMask = (writeMask & 0x0000000A) | (writeMask & 0x00000001) << 2 | (writeMask & 0x00000004) >> 2;
+	}
+
+	// Interleave the components into the texels of the two rows.
+	Short4 xz = As<Short4>(PackUnsigned(current.x, current.z));
+	Short4 yw = As<Short4>(PackUnsigned(current.y, current.w));
+	Short4 xy = UnpackLow(As<Byte8>(xz), As<Byte8>(yw));
+	Short4 zw = UnpackHigh(As<Byte8>(xz), As<Byte8>(yw));
+	UInt2 packed01 = As<UInt2>(UnpackLow(xy, zw));
+	UInt2 packed23 = As<UInt2>(UnpackHigh(xy, zw));
+
+	Int xMask = writtenMask(sMask, zMask, cMask);
+	Int pitchB = *Pointer<Int>(data + OFFSET(DrawData, colorPitchB[index]));
+	Pointer<Byte> buffer = cBuffer + 4 * x;
+
+	UInt2 value = *Pointer<UInt2>(buffer, 16);
+	UInt2 mergedMask = *Pointer<UInt2>(constants + OFFSET(Constants, maskD01Q) + xMask * 8);
+	if(writeMask != 0xF)
+	{
+		mergedMask &= *Pointer<UInt2>(constants + OFFSET(Constants, maskB4Q[writeMask]));
+	}
+	*Pointer<UInt2>(buffer) = (packed01 & mergedMask) | (value & ~mergedMask);
+
+	buffer += pitchB;
+
+	value = *Pointer<UInt2>(buffer, 16);
+	mergedMask = *Pointer<UInt2>(constants + OFFSET(Constants, maskD23Q) + xMask * 8);
+	if(writeMask != 0xF)
+	{
+		mergedMask &= *Pointer<UInt2>(constants + OFFSET(Constants, maskB4Q[writeMask]));
+	}
+	*Pointer<UInt2>(buffer) = (packed23 & mergedMask) | (value & ~mergedMask);
+}
+
+Int PixelRoutine::writtenMask(const Int &sMask, const Int &zMask, const Int &cMask)
+{
+	Int xMask;  // Combination of all masks
+
+	if(state.depthTestActive)
+	{
+		xMask = zMask;
+	}
+	else
+	{
+		xMask = cMask;
+	}
+
+	if(state.stencilActive)
+	{
+		xMask &= sMask;
+	}
+
+	return xMask;
+}
+
 void PixelRoutine::writeColor(int index, const Pointer<Byte> &cBuffer, const Int &x, Vector4f &color, const Int &sMask, const Int &zMask, const Int &cMask)
 {
 	if(isSRGB(index))
@@ -2142,21 +2326,7 @@ void PixelRoutine::writeColor(int index, const Pointer<Byte> &cBuffer, const Int
 		writeMask = (writeMask & 0x0000000A) | (writeMask & 0x00000001) << 2 | (writeMask & 0x00000004) >> 2;
 	}
 
-	Int xMask;  // Combination of all masks
-
-	if(state.depthTestActive)
-	{
-		xMask = zMask;
-	}
-	else
-	{
-		xMask = cMask;
-	}
-
-	if(state.stencilActive)
-	{
-		xMask &= sMask;
-	}
+	Int xMask = writtenMask(sMask, zMask, cMask);
 
 	Pointer<Byte> buffer = cBuffer;
 	Int pitchB = *Pointer<Int>(data + OFFSET(DrawData, colorPitchB[index]));
@@ -2935,4 +3105,45 @@ void PixelRoutine::writeColor(int index, const Pointer<Byte> &cBuffer, const Int
 	}
 }
 
+void PixelRoutine::updateSampleEquality(int index, const Int &x, const Int sMask[4], const Int zMask[4], const Int cMask[4], const SampleSet &samples)
+{
+	// When the shader runs once per pixel, every sample written by this invocation receives
+	// the same color. Pixels for which all samples got written therefore become uniform,
+	// except when the result depends on the previous sample values, in which case they
+	// remain uniform only if they were before. Partially written pixels may now differ.
+	Int anyWritten = 0;
+	Int allWritten = (samples.size() == state.multiSampleCount) ? 0xF : 0x0;
+
+	for(unsigned int q : samples)
+	{
+		Int mask = writtenMask(sMask[q], zMask[q], cMask[q]);
+		anyWritten |= mask;
+		allWritten &= mask;
+	}
+
+	int componentMask = (1 << state.colorFormat[index].componentCount()) - 1;
+	bool dependsOnDestination = state.blendState[index].alphaBlendEnable ||
+	                            ((state.colorWriteActive(index) & componentMask) != componentMask);
+
+	// The quad's pixels (x, y), (x + 1, y), (x, y + 1), (x + 1, y + 1) map to bits
+	// x % HIZ_TILE_WIDTH + {0, 1, HIZ_TILE_WIDTH, HIZ_TILE_WIDTH + 1} of the tile.
+	Int shift = x & (HIZ_TILE_WIDTH - 1);
+	Int written = ((anyWritten & 0x3) | ((anyWritten & 0xC) << (HIZ_TILE_WIDTH - 2))) << shift;
+	Int equal = ((allWritten & 0x3) | ((allWritten & 0xC) << (HIZ_TILE_WIDTH - 2))) << shift;
+
+	Pointer<Int> tile = sampleEqualityTiles[index] + (x / HIZ_TILE_WIDTH) * sizeof(uint32_t);
+	Int bits = *tile;
+
+	if(dependsOnDestination)
+	{
+		bits &= ~written | equal;
+	}
+	else
+	{
+		bits = (bits & ~written) | equal;
+	}
+
+	*tile = bits;
+}
+
 }  // namespace sw
@@ -57,8 +57,14 @@ protected:
 	void alphaToCoverage(Int cMask[4], const SIMD::Float &alpha, const SampleSet &samples);
 
 	void writeColor(int index, const Pointer<Byte> &cBuffer, const Int &x, Vector4f &color, const Int &sMask, const Int &zMask, const Int &cMask);
+	void updateSampleEquality(int index, const Int &x, const Int sMask[4], const Int zMask[4], const Int cMask[4], const SampleSet &samples);
 	SIMD::Float4 alphaBlend(int index, const Pointer<Byte> &cBuffer, const SIMD::Float4 &sourceColor, const Int &x);
 
+	// Fixed-point blending of 8-bit normalized formats, with the components held as 8-bit values
+	// in 16-bit lanes. See PixelProcessor::States::fixedPointBlendMask.
+	void alphaBlend(int index, const Pointer<Byte> &cBuffer, Vector4s &current, const Int &x);
+	void writeColor(int index, const Pointer<Byte> &cBuffer, const Int &x, Vector4s &current, const Int &sMask, const Int &zMask, const Int &cMask);
+
 	bool isSRGB(int index) const;
 
 private:
@@ -72,6 +78,9 @@ private:
 	Bool depthTest(const Pointer<Byte> &zBuffer, int q, const Int &x, const SIMD::Float &z, const Int &sMask, Int &zMask, const Int &cMask);
 	void depthBoundsTest(const Pointer<Byte> &zBuffer, int q, const Int &x, Int &zMask, Int &cMask);
 
+	Int writtenMask(const Int &sMask, const Int &zMask, const Int &cMask);
+	Short4 blendFactor(VkBlendFactor factor, Vector4s &source, Vector4s &dest, int component);
+	Short4 blendCombine(VkBlendOp operation, const Short4 &source, const Short4 &sourceFactor, const Short4 &dest, const Short4 &destFactor);
 	void readPixel(int index, const Pointer<Byte> &cBuffer, const Int &x, Vector4s &pixel);
 	enum BlendFactorModifier
 	{
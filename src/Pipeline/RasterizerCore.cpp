@@ -0,0 +1,73 @@
+// Copyright 2026 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "RasterizerCore.hpp"
+
+#include "Device/Primitive.hpp"
+
+namespace sw {
+
+Int blockCoverage(const Pointer<Byte> &primitive, const Int &x, const Int &y)
+{
+	Pointer<Byte> edge = primitive + OFFSET(Primitive, edge);
+	Int edgeCount = *Pointer<Int>(primitive + OFFSET(Primitive, edgeCount));
+
+	Int mask = 0xFFFF;
+	Int e = 0;
+
+	// The edge functions are evaluated exactly at the block's origin, using 64-bit arithmetic.
+	// Blocks entirely inside or outside of an edge are accepted or rejected using the extreme
+	// values at their corners. Only blocks which straddle the edge are tested per pixel, with
+	// 32-bit offsets from the origin, which can't overflow close to the edge.
+	While(e < edgeCount && mask != 0)
+	{
+		Int A = *Pointer<Int>(edge + OFFSET(Primitive::Edge, A));
+		Int B = *Pointer<Int>(edge + OFFSET(Primitive::Edge, B));
+		Long C;
+		C = *Pointer<Long>(edge + OFFSET(Primitive::Edge, C));
+
+		Long V = Long(A) * Long(x) + Long(B) * Long(y) + C;
+		Long minimum = V + Long(Min(A * 7, Int(0)) + Min(B, Int(0)));
+		Long maximum = V + Long(Max(A * 7, Int(0)) + Max(B, Int(0)));
+
+		If(Int(maximum >> Long(Int(32))) < 0)  // Outside
+		{
+			mask = 0;
+		}
+		Else
+		{
+			If(Int(minimum >> Long(Int(32))) < 0)  // Straddling
+			{
+				Int4 v = Int4(Int(V)) + Int4(0, 1, 0, 1) * Int4(A) + Int4(0, 0, 1, 1) * Int4(B);
+				Int4 step = Int4(A + A);
+				Int inside = 0;
+
+				for(int i = 0; i < 4; i++)
+				{
+					inside |= (~SignMask(v) & 0x0000000F) << (4 * i);
+					v += step;
+				}
+
+				mask &= inside;
+			}
+		}
+
+		edge += sizeof(Primitive::Edge);
+		e++;
+	}
+
+	return mask;
+}
+
+}  // namespace sw
@@ -0,0 +1,31 @@
+// Copyright 2026 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef sw_RasterizerCore_hpp
+#define sw_RasterizerCore_hpp
+
+#include "Reactor/Reactor.hpp"
+
+namespace sw {
+
+using namespace rr;
+
+// Coverage of the 2x8 pixel block at (x, y) by the edges of a sample's primitive, as 4-bit
+// masks of its quads from left to right. Used both by primitive setup, to test primitives
+// which fit within one block, and by the rasterizer.
+Int blockCoverage(const Pointer<Byte> &primitive, const Int &x, const Int &y);
+
+}  // namespace sw
+
+#endif  // sw_RasterizerCore_hpp
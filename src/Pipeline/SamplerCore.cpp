@@ -1171,7 +1171,8 @@ Vector4f SamplerCore::sampleFloat2D(Pointer<Byte> &texture, Float4 &u, Float4 &v
 	address(v, y0, y1, fv, mipmap, filter, OFFSET(Mipmap, height), state.addressingModeV);
 
 	Int4 pitchP = As<Int4>(*Pointer<UInt4>(mipmap + OFFSET(Mipmap, pitchP), 16));
-	y0 *= pitchP;
+	x0 = columnOffset(x0);
+	y0 = rowOffset(y0, pitchP);
 
 	Int4 z;
 	if(state.isCube() || state.isArrayed())
@@ -1201,7 +1202,8 @@ Vector4f SamplerCore::sampleFloat2D(Pointer<Byte> &texture, Float4 &u, Float4 &v
 	}
 	else
 	{
-		y1 *= pitchP;
+		x1 = columnOffset(x1);
+		y1 = rowOffset(y1, pitchP);
 
 		Vector4f c00 = sampleTexel(x0, y0, z, dRef, sample, mipmap, buffer);
 		Vector4f c10 = sampleTexel(x1, y0, z, dRef, sample, mipmap, buffer);
@@ -1600,12 +1602,20 @@ void SamplerCore::computeIndices(UInt index[4], Short4 uuuu, Short4 vvvv, Short4
 	{
 		vvvv = MulHigh(As<UShort4>(vvvv), UShort4(*Pointer<UInt4>(mipmap + OFFSET(Mipmap, height))));
 
-		Short4 uv0uv1 = As<Short4>(UnpackLow(uuuu, vvvv));
-		Short4 uv2uv3 = As<Short4>(UnpackHigh(uuuu, vvvv));
-		Int2 i01 = MulAdd(uv0uv1, *Pointer<Short4>(mipmap + OFFSET(Mipmap, onePitchP)));
-		Int2 i23 = MulAdd(uv2uv3, *Pointer<Short4>(mipmap + OFFSET(Mipmap, onePitchP)));
+		if(state.tiledLayout)
+		{
+			Int4 pitchP = As<Int4>(*Pointer<UInt4>(mipmap + OFFSET(Mipmap, pitchP), 16));
+			indices = As<UInt4>(columnOffset(Int4(As<UShort4>(uuuu))) + rowOffset(Int4(As<UShort4>(vvvv)), pitchP));
+		}
+		else
+		{
+			Short4 uv0uv1 = As<Short4>(UnpackLow(uuuu, vvvv));
+			Short4 uv2uv3 = As<Short4>(UnpackHigh(uuuu, vvvv));
+			Int2 i01 = MulAdd(uv0uv1, *Pointer<Short4>(mipmap + OFFSET(Mipmap, onePitchP)));
+			Int2 i23 = MulAdd(uv2uv3, *Pointer<Short4>(mipmap + OFFSET(Mipmap, onePitchP)));
 
-		indices = UInt4(As<UInt2>(i01), As<UInt2>(i23));
+			indices = UInt4(As<UInt2>(i01), As<UInt2>(i23));
+		}
 	}
 
 	if(state.is3D())
@@ -1675,6 +1685,31 @@ void SamplerCore::computeIndices(UInt index[4], Int4 uuuu, Int4 vvvv, Int4 wwww,
 	}
 }
 
+// Returns the texel offset of the given columns within a row. Adding this to the offset of a
+// row returned by rowOffset() produces the texel index within a slice.
+Int4 SamplerCore::columnOffset(const Int4 &x)
+{
+	if(!state.tiledLayout)
+	{
+		return x;
+	}
+
+	// See vk::Image::hasTiledLayout(). Negative coordinates used for border texels remain negative.
+	constexpr int mask = TEXEL_TILE_SIZE - 1;
+	return ((x & Int4(~mask)) * Int4(TEXEL_TILE_SIZE)) + (x & Int4(mask));
+}
+
+Int4 SamplerCore::rowOffset(const Int4 &y, const Int4 &pitchP)
+{
+	if(!state.tiledLayout)
+	{
+		return y * pitchP;
+	}
+
+	constexpr int mask = TEXEL_TILE_SIZE - 1;
+	return ((y & Int4(~mask)) * pitchP) + ((y & Int4(mask)) * Int4(TEXEL_TILE_SIZE));
+}
+
 Vector4s SamplerCore::sampleTexel(UInt index[4], Pointer<Byte> buffer)
 {
 	Vector4s c;
@@ -15,6 +15,7 @@
 #include "SetupRoutine.hpp"
 
 #include "Constants.hpp"
+#include "RasterizerCore.hpp"
 #include "Device/Polygon.hpp"
 #include "Device/Primitive.hpp"
 #include "Device/Renderer.hpp"
@@ -39,7 +40,7 @@ void SetupRoutine::generate()
 	{
 		Pointer<Byte> device(function.Arg<0>());
 		Pointer<Byte> primitive(function.Arg<1>());
-		Pointer<Byte> tri(function.Arg<2>());
+		Pointer<Byte> vertices(function.Arg<2>());
 		Pointer<Byte> polygon(function.Arg<3>());
 		Pointer<Byte> data(function.Arg<4>());
 
@@ -49,13 +50,14 @@ void SetupRoutine::generate()
 		const bool line = state.isDrawLine;
 		const bool triangle = state.isDrawTriangle;
 
-		const int V0 = OFFSET(Triangle, v0);
-		const int V1 = (triangle || line) ? OFFSET(Triangle, v1) : OFFSET(Triangle, v0);
-		const int V2 = triangle ? OFFSET(Triangle, v2) : (line ? OFFSET(Triangle, v1) : OFFSET(Triangle, v0));
+		const int stride = state.vertexStride;
+		const int V0 = 0;
+		const int V1 = (triangle || line) ? stride : 0;
+		const int V2 = triangle ? 2 * stride : (line ? stride : 0);
 
-		Pointer<Byte> v0 = tri + V0;
-		Pointer<Byte> v1 = tri + V1;
-		Pointer<Byte> v2 = tri + V2;
+		Pointer<Byte> v0 = vertices + V0;
+		Pointer<Byte> v1 = vertices + V1;
+		Pointer<Byte> v2 = vertices + V2;
 
 		Array<Int> X(16);
 		Array<Int> Y(16);
@@ -144,7 +146,9 @@ void SetupRoutine::generate()
 			Until(i >= n);
 		}
 
-		// Vertical range
+		// Bounding box
+		Int xMin = X[0];
+		Int xMax = X[0];
 		Int yMin = Y[0];
 		Int yMax = Y[0];
 
@@ -152,6 +156,8 @@ void SetupRoutine::generate()
 
 		Do
 		{
+			xMin = Min(X[i], xMin);
+			xMax = Max(X[i], xMax);
 			yMin = Min(Y[i], yMin);
 			yMax = Max(Y[i], yMax);
 
@@ -165,26 +171,43 @@ void SetupRoutine::generate()
 
 		if(state.enableMultiSampling)
 		{
+			xMin = (xMin + xMinMultiSampleOffset) >> subPixB;
+			xMax = (xMax + xMaxMultiSampleOffset) >> subPixB;
 			yMin = (yMin + yMinMultiSampleOffset) >> subPixB;
 			yMax = (yMax + yMaxMultiSampleOffset) >> subPixB;
 		}
 		else
 		{
+			xMin = (xMin + subPixM) >> subPixB;
+			xMax = (xMax + subPixM) >> subPixB;
 			yMin = (yMin + subPixM) >> subPixB;
 			yMax = (yMax + subPixM) >> subPixB;
 		}
 
+		Int scissorX0 = *Pointer<Int>(data + OFFSET(DrawData, scissorX0));
+		Int scissorX1 = *Pointer<Int>(data + OFFSET(DrawData, scissorX1));
+
+		xMin = Max(xMin, scissorX0);
+		xMax = Min(xMax, scissorX1);
 		yMin = Max(yMin, *Pointer<Int>(data + OFFSET(DrawData, scissorY0)));
 		yMax = Min(yMax, *Pointer<Int>(data + OFFSET(DrawData, scissorY1)));
 
 		// If yMin and yMax are initially negative, the scissor clamping above will typically result
 		// in yMin == 0 and yMax unchanged. We bail as we don't need to rasterize this primitive, and
-		// code below assumes yMin < yMax.
-		If(yMin >= yMax)
+		// code below assumes yMin < yMax. Likewise for primitives between two pixel columns.
+		If(yMin >= yMax || xMin >= xMax)
 		{
 			Return(0);
 		}
 
+		// Dense meshes have many primitives which fit within a 2x8 pixel block, and often don't
+		// cover any samples. These are tested up front, so that they can be culled here. The block
+		// is aligned like the rasterizer's, which reuses its coverage.
+		Int xBlock = xMin & -8;
+		Int yBlock = yMin & -2;
+		Bool small = (xMax <= xBlock + 8) && (yMax <= yBlock + 2);
+		Int covered = 0;
+
 		For(Int q = 0, q < state.multiSampleCount, q++)
 		{
 			Array<Int> Xq(16);
@@ -208,62 +231,63 @@ void SetupRoutine::generate()
 			}
 			Until(i >= n);
 
-			Pointer<Byte> leftEdge = Pointer<Byte>(primitive + OFFSET(Primitive, outline->left)) + q * sizeof(Primitive);
-			Pointer<Byte> rightEdge = Pointer<Byte>(primitive + OFFSET(Primitive, outline->right)) + q * sizeof(Primitive);
-
-			if(state.enableMultiSampling)
-			{
-				Int xMin = *Pointer<Int>(data + OFFSET(DrawData, scissorX0));
-				Int xMax = *Pointer<Int>(data + OFFSET(DrawData, scissorX1));
-				Short x = Short(Clamp((X[0] + subPixM) >> subPixB, xMin, xMax));
-
-				For(Int y = yMin - 1, y < yMax + 1, y++)
-				{
-					*Pointer<Short>(leftEdge + y * sizeof(Primitive::Span)) = x;
-					*Pointer<Short>(rightEdge + y * sizeof(Primitive::Span)) = x;
-				}
-			}
-
 			Xq[n] = Xq[0];
 			Yq[n] = Yq[0];
 
-			// Rasterize
+			Pointer<Byte> edges = primitive + q * sizeof(Primitive) + OFFSET(Primitive, edge);
+			Int edgeCount = 0;
+
+			// Polygon edges
 			{
 				Int i = 0;
 
 				Do
 				{
-					edge(primitive, data, Xq[i + 1 - d], Yq[i + 1 - d], Xq[i + d], Yq[i + d], q);
+					edge(edges, edgeCount, Xq[i + 1 - d], Yq[i + 1 - d], Xq[i + d], Yq[i + d]);
 
 					i++;
 				}
 				Until(i >= n);
 			}
 
-			if(!state.enableMultiSampling)
-			{
-				For(, yMin < yMax && *Pointer<Short>(leftEdge + yMin * sizeof(Primitive::Span)) == *Pointer<Short>(rightEdge + yMin * sizeof(Primitive::Span)), yMin++)
-				{
-					// Increments yMin
-				}
+			// Scissor edges
+			Pointer<Byte> left = edges + edgeCount * sizeof(Primitive::Edge);
+			*Pointer<Int>(left + OFFSET(Primitive::Edge, A)) = 1;
+			*Pointer<Int>(left + OFFSET(Primitive::Edge, B)) = 0;
+			*Pointer<Long>(left + OFFSET(Primitive::Edge, C)) = Long(-scissorX0);
+			*Pointer<Float>(left + OFFSET(Primitive::Edge, x0)) = Float(scissorX0);
+			*Pointer<Float>(left + OFFSET(Primitive::Edge, y0)) = 0.0f;
+			*Pointer<Float>(left + OFFSET(Primitive::Edge, dxdy)) = 0.0f;
 
-				For(, yMax > yMin && *Pointer<Short>(leftEdge + (yMax - 1) * sizeof(Primitive::Span)) == *Pointer<Short>(rightEdge + (yMax - 1) * sizeof(Primitive::Span)), yMax--)
-				{
-					// Decrements yMax
-				}
+			Pointer<Byte> right = left + sizeof(Primitive::Edge);
+			*Pointer<Int>(right + OFFSET(Primitive::Edge, A)) = -1;
+			*Pointer<Int>(right + OFFSET(Primitive::Edge, B)) = 0;
+			*Pointer<Long>(right + OFFSET(Primitive::Edge, C)) = Long(scissorX1 - 1);
+			*Pointer<Float>(right + OFFSET(Primitive::Edge, x0)) = Float(scissorX1);
+			*Pointer<Float>(right + OFFSET(Primitive::Edge, y0)) = 0.0f;
+			*Pointer<Float>(right + OFFSET(Primitive::Edge, dxdy)) = 0.0f;
 
-				If(yMin == yMax)
-				{
-					Return(0);
-				}
+			*Pointer<Int>(primitive + q * sizeof(Primitive) + OFFSET(Primitive, edgeCount)) = edgeCount + 2;
+
+			Int blockMask = -1;
 
-				*Pointer<Short>(leftEdge + (yMin - 1) * sizeof(Primitive::Span)) = *Pointer<Short>(leftEdge + yMin * sizeof(Primitive::Span));
-				*Pointer<Short>(rightEdge + (yMin - 1) * sizeof(Primitive::Span)) = *Pointer<Short>(leftEdge + yMin * sizeof(Primitive::Span));
-				*Pointer<Short>(leftEdge + yMax * sizeof(Primitive::Span)) = *Pointer<Short>(leftEdge + (yMax - 1) * sizeof(Primitive::Span));
-				*Pointer<Short>(rightEdge + yMax * sizeof(Primitive::Span)) = *Pointer<Short>(leftEdge + (yMax - 1) * sizeof(Primitive::Span));
+			If(small)
+			{
+				blockMask = blockCoverage(primitive + q * sizeof(Primitive), xBlock, yBlock);
+				covered |= blockMask;
 			}
+
+			*Pointer<Int>(primitive + q * sizeof(Primitive) + OFFSET(Primitive, blockMask)) = blockMask;
+		}
+
+		If(small && covered == 0)
+		{
+			Return(0);
 		}
 
+		*Pointer<Int>(primitive + OFFSET(Primitive, xMin)) = xMin;
+		*Pointer<Int>(primitive + OFFSET(Primitive, xMax)) = xMax;
+
 		*Pointer<Int>(primitive + OFFSET(Primitive, yMin)) = yMin;
 		*Pointer<Int>(primitive + OFFSET(Primitive, yMax)) = yMax;
 
@@ -480,7 +504,7 @@ void SetupRoutine::generate()
 		{
 			if(state.gradient[interfaceInterpolant].Type != SpirvShader::ATTRIBTYPE_UNUSED)
 			{
-				setupGradient(primitive, tri, w012, M, v0, v1, v2,
+				setupGradient(primitive, vertices, w012, M, v0, v1, v2,
 				              OFFSET(Vertex, v[interfaceInterpolant]),
 				              OFFSET(Primitive, V[packedInterpolant]),
 				              state.gradient[interfaceInterpolant].Flat,
@@ -491,7 +515,7 @@ void SetupRoutine::generate()
 
 		for(unsigned int i = 0; i < state.numClipDistances; i++)
 		{
-			setupGradient(primitive, tri, w012, M, v0, v1, v2,
+			setupGradient(primitive, vertices, w012, M, v0, v1, v2,
 			              OFFSET(Vertex, clipDistance[i]),
 			              OFFSET(Primitive, clipDistance[i]),
 			              false, true);
@@ -499,7 +523,7 @@ void SetupRoutine::generate()
 
 		for(unsigned int i = 0; i < state.numCullDistances; i++)
 		{
-			setupGradient(primitive, tri, w012, M, v0, v1, v2,
+			setupGradient(primitive, vertices, w012, M, v0, v1, v2,
 			              OFFSET(Vertex, cullDistance[i]),
 			              OFFSET(Primitive, cullDistance[i]),
 			              false, true);
@@ -511,7 +535,7 @@ void SetupRoutine::generate()
 	routine = function("SetupRoutine");
 }
 
-void SetupRoutine::setupGradient(Pointer<Byte> &primitive, Pointer<Byte> &triangle, Float4 &w012, Float4 (&m)[3], Pointer<Byte> &v0, Pointer<Byte> &v1, Pointer<Byte> &v2, int attribute, int planeEquation, bool flat, bool perspective)
+void SetupRoutine::setupGradient(Pointer<Byte> &primitive, Pointer<Byte> &vertices, Float4 &w012, Float4 (&m)[3], Pointer<Byte> &v0, Pointer<Byte> &v1, Pointer<Byte> &v2, int attribute, int planeEquation, bool flat, bool perspective)
 {
 	if(!flat)
 	{
@@ -538,8 +562,7 @@ void SetupRoutine::setupGradient(Pointer<Byte> &primitive, Pointer<Byte> &triang
 	}
 	else
 	{
-		int leadingVertex = OFFSET(Triangle, v0);
-		Float C = *Pointer<Float>(triangle + leadingVertex + attribute);
+		Float C = *Pointer<Float>(vertices + attribute);  // Leading vertex
 
 		*Pointer<Float>(primitive + planeEquation + 0) = 0;
 		*Pointer<Float>(primitive + planeEquation + 4) = 0;
@@ -547,76 +570,39 @@ void SetupRoutine::setupGradient(Pointer<Byte> &primitive, Pointer<Byte> &triang
 	}
 }
 
-void SetupRoutine::edge(Pointer<Byte> &primitive, Pointer<Byte> &data, const Int &Xa, const Int &Ya, const Int &Xb, const Int &Yb, Int &q)
+void SetupRoutine::edge(Pointer<Byte> &edges, Int &edgeCount, const Int &Xa, const Int &Ya, const Int &Xb, const Int &Yb)
 {
-	If(Ya != Yb)
-	{
-		Bool swap = Yb < Ya;
-
-		Int X1 = IfThenElse(swap, Xb, Xa);
-		Int X2 = IfThenElse(swap, Xa, Xb);
-		Int Y1 = IfThenElse(swap, Yb, Ya);
-		Int Y2 = IfThenElse(swap, Ya, Yb);
+	// Deltas
+	Int DX = Xb - Xa;
+	Int DY = Yb - Ya;
 
+	If(DX != 0 || DY != 0)
+	{
 		constexpr int subPixB = vk::SUBPIXEL_PRECISION_BITS;
-		constexpr int subPixM = vk::SUBPIXEL_PRECISION_MASK;
-
-		Int y1 = (Y1 + subPixM) >> subPixB;
-		Int y2 = (Y2 + subPixM) >> subPixB;
-		Int yMin = Max(y1, *Pointer<Int>(data + OFFSET(DrawData, scissorY0)));
-		Int yMax = Min(y2, *Pointer<Int>(data + OFFSET(DrawData, scissorY1)));
-
-		If(yMin < yMax)
-		{
-			Int xMin = *Pointer<Int>(data + OFFSET(DrawData, scissorX0));
-			Int xMax = *Pointer<Int>(data + OFFSET(DrawData, scissorX1));
-
-			Pointer<Byte> leftEdge = primitive + q * sizeof(Primitive) + OFFSET(Primitive, outline->left);
-			Pointer<Byte> rightEdge = primitive + q * sizeof(Primitive) + OFFSET(Primitive, outline->right);
-			Pointer<Byte> edge = IfThenElse(swap, rightEdge, leftEdge);
-
-			// Deltas
-			Int DX12 = X2 - X1;
-			Int DY12 = Y2 - Y1;
-
-			Int FDX12 = DX12 << subPixB;
-			Int FDY12 = DY12 << subPixB;
-
-			Int X = DX12 * ((y1 << subPixB) - Y1) + (X1 & subPixM) * DY12;
-			Int x = (X1 >> subPixB) + X / FDY12;  // Edge
-			Int d = X % FDY12;                    // Error-term
-			Int ceil = -d >> 31;                  // Ceiling division: remainder <= 0
-			x -= ceil;
-			d -= ceil & FDY12;
-
-			Int Q = FDX12 / FDY12;  // Edge-step
-			Int R = FDX12 % FDY12;  // Error-step
-			Int floor = R >> 31;    // Flooring division: remainder >= 0
-			Q += floor;
-			R += floor & FDY12;
-
-			Int D = FDY12;  // Error-overflow
-			Int y = y1;
-
-			Do
-			{
-				If(y >= yMin)
-				{
-					*Pointer<Short>(edge + y * sizeof(Primitive::Span)) = Short(Clamp(x, xMin, xMax));
-				}
+		constexpr float subPixF = vk::SUBPIXEL_PRECISION_FACTOR;
 
-				x += Q;
-				d += R;
+		// Edges run downward along the left side of the polygon. Pixels exactly on a left edge
+		// or on a horizontal top edge are covered, while those on the other edges are not.
+		Bool inclusive = (DY > 0) || (DY == 0 && DX < 0);
+		Int bias = IfThenElse(inclusive, Int(0), Int(-1));
 
-				Int overflow = -d >> 31;
+		// DY * (x * F - Xa) - DX * (y * F - Ya) + bias >= 0, divided by F with the constant
+		// term rounded down, so it can be evaluated exactly at whole pixel coordinates.
+		Long C = (Long(Ya) * Long(DX) - Long(Xa) * Long(DY) + Long(bias)) >> Long(Int(subPixB));
 
-				d -= D & overflow;
-				x -= overflow;
+		Pointer<Byte> edge = edges + edgeCount * sizeof(Primitive::Edge);
+		*Pointer<Int>(edge + OFFSET(Primitive::Edge, A)) = DY;
+		*Pointer<Int>(edge + OFFSET(Primitive::Edge, B)) = -DX;
+		*Pointer<Long>(edge + OFFSET(Primitive::Edge, C)) = C;
 
-				y++;
-			}
-			Until(y >= yMax);
+		If(DY != 0)
+		{
+			*Pointer<Float>(edge + OFFSET(Primitive::Edge, x0)) = Float(Xa) * (1.0f / subPixF);
+			*Pointer<Float>(edge + OFFSET(Primitive::Edge, y0)) = Float(Ya) * (1.0f / subPixF);
+			*Pointer<Float>(edge + OFFSET(Primitive::Edge, dxdy)) = Float(DX) / Float(DY);
 		}
+
+		edgeCount++;
 	}
 }
 
@@ -887,6 +887,69 @@ SIMD::UInt floatToHalfBits(SIMD::UInt floatBits, bool storeInUpperBits)
 	return storeInUpperBits ? (sign | (fp16u << 16)) : ((sign >> 16) | fp16u);
 }
 
+SIMD::Float roundToHalf(RValue<SIMD::Float> x)
+{
+	SIMD::UInt bits = As<SIMD::UInt>(x);
+	SIMD::UInt sign = bits & SIMD::UInt(0x80000000);
+	SIMD::UInt abs = bits & SIMD::UInt(0x7FFFFFFF);
+
+	// Round the mantissa to 10 bits, with ties to even.
+	SIMD::UInt normal = (abs + SIMD::UInt(0x00000FFF) + ((abs >> 13) & SIMD::UInt(1))) & SIMD::UInt(0xFFFFE000);
+
+	// Half-float denormals have a fixed exponent of -24.
+	SIMD::UInt denormal = As<SIMD::UInt>(Round(As<SIMD::Float>(abs) * SIMD::Float(16777216.0f)) * SIMD::Float(1.0f / 16777216.0f));
+
+	SIMD::UInt isDenormal = CmpLT(abs, SIMD::UInt(0x38800000));
+	SIMD::UInt isOverflow = CmpGE(abs, SIMD::UInt(0x477FF000));  // Halfway between 65504 and 65536.
+	SIMD::UInt isNaN = CmpGT(abs, SIMD::UInt(0x7F800000));
+
+	SIMD::UInt rounded = (isDenormal & denormal) | (~isDenormal & normal);
+	rounded = (isOverflow & SIMD::UInt(0x7F800000)) | (~isOverflow & rounded);
+	rounded = (isNaN & abs) | (~isNaN & rounded);
+
+	return As<SIMD::Float>(sign | rounded);
+}
+
+SIMD::UInt halfBitsOf(RValue<SIMD::Float> x)
+{
+	SIMD::UInt bits = As<SIMD::UInt>(x);
+	SIMD::UInt sign = (bits & SIMD::UInt(0x80000000)) >> 16;
+	SIMD::UInt abs = bits & SIMD::UInt(0x7FFFFFFF);
+
+	// float exponent bias is 127, half bias is 15, so adjust by -112
+	SIMD::UInt normal = (abs - SIMD::UInt(0x38000000)) >> 13;
+	SIMD::UInt denormal = SIMD::UInt(As<SIMD::Float>(abs) * SIMD::Float(16777216.0f));
+	SIMD::UInt infOrNaN = SIMD::UInt(0x7C00) | ((abs >> 13) & SIMD::UInt(0x03FF)) | (CmpGT(abs, SIMD::UInt(0x7F800000)) & SIMD::UInt(0x0200));
+
+	SIMD::UInt isDenormal = CmpLT(abs, SIMD::UInt(0x38800000));
+	SIMD::UInt isInfOrNaN = CmpGE(abs, SIMD::UInt(0x7F800000));
+
+	SIMD::UInt fp16u = (isDenormal & denormal) | (~isDenormal & normal);
+	fp16u = (isInfOrNaN & infOrNaN) | (~isInfOrNaN & fp16u);
+
+	return sign | fp16u;
+}
+
+SIMD::Int SignExtend(RValue<SIMD::Int> v, uint32_t width)
+{
+	if(width == 16)
+	{
+		return (v << 16) >> 16;
+	}
+
+	return v;
+}
+
+SIMD::UInt ZeroExtend(RValue<SIMD::UInt> v, uint32_t width)
+{
+	if(width == 16)
+	{
+		return v & SIMD::UInt(0xFFFF);
+	}
+
+	return v;
+}
+
 Float4 r11g11b10Unpack(UInt r11g11b10bits)
 {
 	// 10 (or 11) bit float formats are unsigned formats with a 5 bit exponent and a 5 (or 6) bit mantissa.
@@ -148,6 +148,17 @@ template<> inline RValue<SIMD::Float> Sqrt<Mediump>(RValue<SIMD::Float> x) { ret
 
 SIMD::UInt halfToFloatBits(SIMD::UInt halfBits);
 SIMD::UInt floatToHalfBits(SIMD::UInt floatBits, bool storeInUpperBits);
+// Rounds to the nearest value representable as a 16-bit float, keeping it in
+// 32-bit format. Values beyond the half-float range round to infinity.
+SIMD::Float roundToHalf(RValue<SIMD::Float> x);
+// Returns the 16-bit float encoding of values representable as a 16-bit float,
+// including infinities and denormals. Other values are rounded towards zero.
+SIMD::UInt halfBitsOf(RValue<SIMD::Float> x);
+// 16-bit integers are held sign- or zero-extended according to the signedness
+// of their type, which may differ from the interpretation an instruction
+// applies to its operands. These re-extend operands of the given bit width.
+SIMD::Int SignExtend(RValue<SIMD::Int> v, uint32_t width);
+SIMD::UInt ZeroExtend(RValue<SIMD::UInt> v, uint32_t width);
 SIMD::Float linearToSRGB(const SIMD::Float &c);
 SIMD::Float sRGBtoLinear(const SIMD::Float &c);
 
@@ -184,6 +195,7 @@ UInt4 halfToFloatBits(RValue<UInt4> halfBits);
 UInt4 floatToHalfBits(RValue<UInt4> floatBits, bool storeInUpperBits);
 Float4 r11g11b10Unpack(UInt r11g11b10bits);
 UInt r11g11b10Pack(const Float4 &value);
+
 Float4 linearToSRGB(const Float4 &c);
 Float4 sRGBtoLinear(const Float4 &c);
 
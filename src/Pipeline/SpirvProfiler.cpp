@@ -19,8 +19,17 @@
 #include "spirv-tools/libspirv.h"
 
 #include <string.h>
+#include <algorithm>
 #include <atomic>
+#include <bitset>
+#include <chrono>
 #include <fstream>
+#include <iomanip>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#	include <intrin.h>
+#endif
 
 namespace {
 std::string GetSpvOpName(const spv::Op &op)
@@ -34,21 +43,50 @@ std::string ConcatPath(const std::string &base, const std::string &file)
 	{
 		return file;
 	}
-	char lastChar = *base.rend();
+	char lastChar = *base.rbegin();
 	if(lastChar == '\\' || lastChar == '/')
 	{
 		return base + file;
 	}
 	return base + "/" + file;
 }
+
+// Returns the name of a block's frame in reports, e.g. "%12 (shader.frag:34)".
+std::string GetBlockName(const sw::SpirvProfileData::Block &block)
+{
+	std::string name = "%" + std::to_string(block.labelId);
+	if(!block.file.empty())
+	{
+		name += " (" + block.file + ":" + std::to_string(block.line) + ")";
+	}
+	return name;
+}
 }  // namespace
 
 namespace sw {
 
+SpirvProfileData::Block &SpirvProfileData::addBlock(uint32_t labelId)
+{
+	Block &block = blocks.emplace_back();
+	block.labelId = labelId;
+
+	bool added = blocksByLabel.emplace(labelId, &block).second;
+	ASSERT_MSG(added, "Duplicate block %d", int(labelId));
+
+	return block;
+}
+
+SpirvProfileData::Block *SpirvProfileData::getBlock(uint32_t labelId)
+{
+	auto it = blocksByLabel.find(labelId);
+	return (it != blocksByLabel.end()) ? it->second : nullptr;
+}
+
 SpirvProfiler::SpirvProfiler(const Configuration &config)
     : cfg(config)
 {
 	reportFilePath = ConcatPath(cfg.spvProfilingReportDir, "spirv_profile.txt");
+	foldedStacksFilePath = ConcatPath(cfg.spvProfilingReportDir, "spirv_profile.folded");
 
 	reportThreadStop = false;
 	reportThread = std::thread{ [this] {
@@ -64,6 +102,34 @@ SpirvProfiler::~SpirvProfiler()
 {
 	reportThreadStop.store(true, std::memory_order_release);
 	reportThread.join();
+
+	// Report the executions since the last periodic report.
+	ReportSnapshot();
+}
+
+uint64_t SpirvProfiler::ReadCycleCounter()
+{
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+	return __rdtsc();
+#elif defined(__i386__) || defined(__x86_64__)
+	return __builtin_ia32_rdtsc();
+#else
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void SpirvProfiler::RecordBlockExecution(SpirvProfileData::Block *block, uint64_t begin, int laneMask)
+{
+	uint64_t end = ReadCycleCounter();
+
+	block->executions.fetch_add(1, std::memory_order_relaxed);
+	block->laneExecutions.fetch_add(std::bitset<32>(laneMask).count(), std::memory_order_relaxed);
+	block->cycles.fetch_add(end - begin, std::memory_order_relaxed);
+}
+
+void SpirvProfiler::RecordBlockCycles(SpirvProfileData::Block *block, uint64_t begin)
+{
+	block->cycles.fetch_add(ReadCycleCounter() - begin, std::memory_order_relaxed);
 }
 
 void SpirvProfiler::ReportSnapshot()
@@ -79,6 +145,47 @@ void SpirvProfiler::ReportSnapshot()
 	auto profiles = GetRegisteredProfilesSnapshot();
 	for(const auto &[shaderId, profileData] : profiles)
 	{
+		// Snapshot the counters, which are updated concurrently, and rank the
+		// executed blocks by the cycles spent in them.
+		struct BlockSnapshot
+		{
+			const SpirvProfileData::Block *block;
+			uint64_t executions;
+			uint64_t laneExecutions;
+			uint64_t cycles;
+		};
+
+		std::vector<BlockSnapshot> hotBlocks;
+		uint64_t totalCycles = 0;
+		profileData->spvOpExecutionCount.clear();
+
+		for(const auto &block : profileData->blocks)
+		{
+			BlockSnapshot snapshot = {
+				&block,
+				block.executions.load(std::memory_order_relaxed),
+				block.laneExecutions.load(std::memory_order_relaxed),
+				block.cycles.load(std::memory_order_relaxed),
+			};
+
+			if(snapshot.executions == 0)
+			{
+				continue;
+			}
+
+			for(const auto &[spvOp, count] : block.instructionCount)
+			{
+				profileData->spvOpExecutionCount[spvOp] += static_cast<int64_t>(count * snapshot.executions);
+			}
+
+			totalCycles += snapshot.cycles;
+			hotBlocks.push_back(snapshot);
+		}
+
+		std::sort(hotBlocks.begin(), hotBlocks.end(), [](const BlockSnapshot &a, const BlockSnapshot &b) {
+			return a.cycles > b.cycles;
+		});
+
 		f << "[Shader " << shaderId << "]" << std::endl;
 
 		f << "[SPIR-V operand execution count]" << std::endl;
@@ -87,16 +194,65 @@ void SpirvProfiler::ReportSnapshot()
 			f << GetSpvOpName(spvOp) << ": " << execCount << std::endl;
 		}
 
+		f << "[Hot blocks]" << std::endl;
+		for(const auto &snapshot : hotBlocks)
+		{
+			double percentage = (totalCycles > 0) ? 100.0 * snapshot.cycles / totalCycles : 0.0;
+
+			f << GetBlockName(*snapshot.block) << ": "
+			  << std::fixed << std::setprecision(1) << percentage << "% of cycles, "
+			  << snapshot.cycles << " cycles, "
+			  << snapshot.executions << " executions, "
+			  << snapshot.laneExecutions << " active lanes" << std::endl;
+		}
+
 		f << std::endl;
 	}
 
 	f.close();
+
+	WriteFoldedStacks(profiles);
+}
+
+void SpirvProfiler::WriteFoldedStacks(const std::unordered_map<std::string, SpirvProfileData *> &profiles)
+{
+	// Folded stacks, as consumed by flamegraph.pl and speedscope: one line per
+	// block, with the frames separated by semicolons, followed by its cycles.
+	std::ofstream f{ foldedStacksFilePath };
+
+	if(!f)
+	{
+		warn("Error writing SPIR-V profile to file %s: %s\n", foldedStacksFilePath.c_str(), strerror(errno));
+		return;
+	}
+
+	for(const auto &[shaderId, profileData] : profiles)
+	{
+		for(const auto &block : profileData->blocks)
+		{
+			uint64_t cycles = block.cycles.load(std::memory_order_relaxed);
+			if(cycles > 0)
+			{
+				f << shaderId << ";" << profileData->function << ";" << GetBlockName(block) << " " << cycles << std::endl;
+			}
+		}
+	}
+
+	f.close();
 }
 
-void SpirvProfiler::RegisterShaderForProfiling(std::string shaderId, std::unique_ptr<SpirvProfileData> profData)
+SpirvProfileData *SpirvProfiler::RegisterShaderForProfiling(std::string shaderId, std::unique_ptr<SpirvProfileData> profData)
 {
 	marl::lock lock{ profileMux };
-	shaderProfiles[shaderId] = std::move(profData);
+
+	// Shaders with equal IDs have the same blocks, so they share their counters.
+	auto &registered = shaderProfiles[shaderId];
+	if(!registered)
+	{
+		registered = std::move(profData);
+	}
+
+	return registered.get();
 }
 
 std::unordered_map<std::string, SpirvProfileData *> SpirvProfiler::GetRegisteredProfilesSnapshot()
@@ -24,6 +24,8 @@
 
 #include <atomic>
 #include <cstdint>
+#include <deque>
+#include <string>
 #include <thread>
 #include <unordered_map>
 
@@ -40,8 +42,42 @@ public:
 	SpirvProfileData &operator=(const SpirvProfileData &) = delete;
 	SpirvProfileData &operator=(SpirvProfileData &&) = delete;
 
-	// SPIR-V instruction execution count, by opcode.
+	// Execution counters of a SPIR-V block, along with the source it was
+	// generated from. Blocks are executed by a SIMD group of invocations at a
+	// time, with some of the lanes possibly inactive.
+	struct Block
+	{
+		uint32_t labelId = 0;  // Result id of the block's OpLabel.
+		std::string file;      // Source location of the block's first OpLine, if any.
+		uint32_t line = 0;
+
+		// Number of instructions in the block, by opcode.
+		std::unordered_map<spv::Op, uint32_t> instructionCount;
+
+		std::atomic<uint64_t> executions = { 0 };      // Number of SIMD group executions.
+		std::atomic<uint64_t> laneExecutions = { 0 };  // Sum of the active lanes of all executions.
+		std::atomic<uint64_t> cycles = { 0 };          // Cycle counter ticks spent in the block.
+	};
+
+	// Adds a block, which must have a unique label.
+	Block &addBlock(uint32_t labelId);
+
+	// Returns the block with the given label, or nullptr.
+	Block *getBlock(uint32_t labelId);
+
+	// Name of the entry point the blocks belong to.
+	std::string function;
+
+	// Blocks in the order they were added. Instrumented routines hold
+	// pointers to them, so they must not move.
+	std::deque<Block> blocks;
+
+	// SPIR-V instruction execution count, by opcode. Derived from the block
+	// counters when a report is written.
 	std::unordered_map<spv::Op, int64_t> spvOpExecutionCount;
+
+private:
+	std::unordered_map<uint32_t, Block *> blocksByLabel;
 };
 
 class SpirvProfiler
@@ -50,14 +86,31 @@ public:
 	SpirvProfiler(const Configuration &config);
 	~SpirvProfiler();
 
-	void RegisterShaderForProfiling(std::string shaderId, std::unique_ptr<SpirvProfileData> profData);
+	// Registers the profile data of a shader, unless a shader with the same ID
+	// was already registered. Returns the registered profile data, which
+	// remains valid for the lifetime of the profiler.
+	SpirvProfileData *RegisterShaderForProfiling(std::string shaderId, std::unique_ptr<SpirvProfileData> profData);
+
+	// Called by instrumented routines. Returns the current value of the cycle
+	// counter, which is the time stamp counter on x86.
+	static uint64_t ReadCycleCounter();
+
+	// Called by instrumented routines at the end of a block, with the cycle
+	// counter value at its start and the sign mask of its active lanes.
+	static void RecordBlockExecution(SpirvProfileData::Block *block, uint64_t begin, int laneMask);
+
+	// Called by instrumented routines to record the cycles spent in a block
+	// so far, when its execution is split by a workgroup barrier.
+	static void RecordBlockCycles(SpirvProfileData::Block *block, uint64_t begin);
 
 private:
 	void ReportSnapshot();
+	void WriteFoldedStacks(const std::unordered_map<std::string, SpirvProfileData *> &profiles);
 	std::unordered_map<std::string, SpirvProfileData *> GetRegisteredProfilesSnapshot();
 
 	const Configuration &cfg;
 	std::string reportFilePath;
+	std::string foldedStacksFilePath;
 
 	std::thread reportThread;
 	std::atomic<bool> reportThreadStop;
@@ -19,6 +19,7 @@
 
 #include "Device/Context.hpp"
 #include "System/Debug.hpp"
+#include "System/Half.hpp"
 #include "Vulkan/VkPipelineLayout.hpp"
 #include "Vulkan/VkRenderPass.hpp"
 
@@ -26,6 +27,9 @@
 
 #include <spirv/unified1/spirv.hpp>
 
+#include <algorithm>
+#include <cstdio>
+
 namespace sw {
 
 Spirv::Spirv(
@@ -321,7 +325,10 @@ Spirv::Spirv(
 
 		case spv::OpConstant:
 		case spv::OpSpecConstant:
-			CreateConstant(insn).constantValue[0] = insn.word(3);
+			{
+				auto &object = CreateConstant(insn);
+				object.constantValue[0] = WidenLiteral(getType(object), insn.word(3));
+			}
 			break;
 		case spv::OpConstantFalse:
 		case spv::OpSpecConstantFalse:
@@ -437,6 +444,12 @@ Spirv::Spirv(
 				case spv::CapabilitySampledImageArrayNonUniformIndexing: capabilities.SampledImageArrayNonUniformIndexing = true; break;
 				case spv::CapabilityStorageImageArrayNonUniformIndexing: capabilities.StorageImageArrayNonUniformIndexing = true; break;
 				case spv::CapabilityPhysicalStorageBufferAddresses: capabilities.PhysicalStorageBufferAddresses = true; break;
+				case spv::CapabilityInt16: capabilities.Int16 = true; break;
+				case spv::CapabilityFloat16: capabilities.Float16 = true; break;
+				case spv::CapabilityStorageBuffer16BitAccess: capabilities.StorageBuffer16BitAccess = true; break;
+				case spv::CapabilityUniformAndStorageBuffer16BitAccess: capabilities.UniformAndStorageBuffer16BitAccess = true; break;
+				case spv::CapabilityStoragePushConstant16: capabilities.StoragePushConstant16 = true; break;
+				case spv::CapabilityStorageInputOutput16: capabilities.StorageInputOutput16 = true; break;
 				default:
 					UNSUPPORTED("Unsupported capability %u", insn.word(1));
 				}
@@ -530,18 +543,6 @@ Spirv::Spirv(
 			// TODO(b/141246700): Add full support for spv::OpFunctionCall
 			break;
 
-		case spv::OpFConvert:
-			UNSUPPORTED("SPIR-V Float16 or Float64 Capability (OpFConvert)");
-			break;
-
-		case spv::OpSConvert:
-			UNSUPPORTED("SPIR-V Int16 or Int64 Capability (OpSConvert)");
-			break;
-
-		case spv::OpUConvert:
-			UNSUPPORTED("SPIR-V Int16 or Int64 Capability (OpUConvert)");
-			break;
-
 		case spv::OpLoad:
 		case spv::OpAccessChain:
 		case spv::OpInBoundsAccessChain:
@@ -661,6 +662,9 @@ Spirv::Spirv(
 		case spv::OpConvertFToS:
 		case spv::OpConvertSToF:
 		case spv::OpConvertUToF:
+		case spv::OpFConvert:
+		case spv::OpSConvert:
+		case spv::OpUConvert:
 		case spv::OpBitcast:
 		case spv::OpSelect:
 		case spv::OpIsInf:
@@ -677,19 +681,6 @@ Spirv::Spirv(
 		case spv::OpDPdyFine:
 		case spv::OpFwidthFine:
 		case spv::OpAtomicLoad:
-		case spv::OpAtomicIAdd:
-		case spv::OpAtomicISub:
-		case spv::OpAtomicSMin:
-		case spv::OpAtomicSMax:
-		case spv::OpAtomicUMin:
-		case spv::OpAtomicUMax:
-		case spv::OpAtomicAnd:
-		case spv::OpAtomicOr:
-		case spv::OpAtomicXor:
-		case spv::OpAtomicIIncrement:
-		case spv::OpAtomicIDecrement:
-		case spv::OpAtomicExchange:
-		case spv::OpAtomicCompareExchange:
 		case spv::OpPhi:
 		case spv::OpImageSampleImplicitLod:
 		case spv::OpImageSampleExplicitLod:
@@ -766,15 +757,42 @@ Spirv::Spirv(
 			}
 			break;
 
+		case spv::OpAtomicIAdd:
+		case spv::OpAtomicISub:
+		case spv::OpAtomicSMin:
+		case spv::OpAtomicSMax:
+		case spv::OpAtomicUMin:
+		case spv::OpAtomicUMax:
+		case spv::OpAtomicAnd:
+		case spv::OpAtomicOr:
+		case spv::OpAtomicXor:
+		case spv::OpAtomicIIncrement:
+		case spv::OpAtomicIDecrement:
+		case spv::OpAtomicExchange:
+		case spv::OpAtomicCompareExchange:
+			if(isExternallyVisibleStore(insn.word(3)))
+			{
+				analysis.ContainsSideEffects = true;
+			}
+			DefineResult(insn);
+			break;
+
 		case spv::OpStore:
 		case spv::OpAtomicStore:
 		case spv::OpCopyMemory:
+			if(isExternallyVisibleStore(insn.word(1)))
+			{
+				analysis.ContainsSideEffects = true;
+			}
+			break;
+
 		case spv::OpMemoryBarrier:
 			// Don't need to do anything during analysis pass
 			break;
 
 		case spv::OpImageWrite:
 			analysis.ContainsImageWrite = true;
+			analysis.ContainsSideEffects = true;
 			break;
 
 		case spv::OpControlBarrier:
@@ -845,8 +863,43 @@ void Spirv::DeclareType(InsnIterator insn)
 	spv::Op opcode = insn.opcode();
 	switch(opcode)
 	{
+	case spv::OpTypeInt:
+		type.componentWidth = insn.word(2);
+		if(type.componentWidth == 16)
+		{
+			type.narrowing = insn.word(3) ? Intermediate::Narrowing::Int16 : Intermediate::Narrowing::UInt16;
+		}
+		break;
+	case spv::OpTypeFloat:
+		type.componentWidth = insn.word(2);
+		if(type.componentWidth == 16)
+		{
+			type.narrowing = Intermediate::Narrowing::Float16;
+		}
+		break;
+	case spv::OpTypeBool:
+		type.componentWidth = 32;
+		break;
 	case spv::OpTypeStruct:
 		{
+			// Structures of uniformly typed members, such as the results of
+			// the extended arithmetic instructions, share their narrowing.
+			for(uint32_t i = 2; i < insn.wordCount(); i++)
+			{
+				auto &memberType = getType(insn.word(i));
+				if(i == 2)
+				{
+					type.componentWidth = memberType.componentWidth;
+					type.narrowing = memberType.narrowing;
+				}
+				else if(memberType.componentWidth != type.componentWidth ||
+				        memberType.narrowing != type.narrowing)
+				{
+					type.componentWidth = 0;
+					type.narrowing = Intermediate::Narrowing::None;
+				}
+			}
+
 			auto d = memberDecorations.find(resultId);
 			if(d != memberDecorations.end())
 			{
@@ -877,6 +930,8 @@ void Spirv::DeclareType(InsnIterator insn)
 		{
 			Type::ID elementTypeId = insn.word(2);
 			type.element = elementTypeId;
+			type.componentWidth = getType(elementTypeId).componentWidth;
+			type.narrowing = getType(elementTypeId).narrowing;
 		}
 		break;
 	default:
@@ -884,6 +939,38 @@ void Spirv::DeclareType(InsnIterator insn)
 	}
 }
 
+uint32_t Spirv::WidenLiteral(const Type &type, uint32_t literal)
+{
+	// 16-bit literals occupy the low-order bits of the word.
+	switch(type.narrowing)
+	{
+	case Intermediate::Narrowing::Float16:
+		return bit_cast<uint32_t>(static_cast<float>(shortAsHalf(static_cast<short>(literal))));
+	case Intermediate::Narrowing::Int16:
+		return static_cast<uint32_t>(static_cast<int32_t>(static_cast<int16_t>(literal)));
+	case Intermediate::Narrowing::UInt16:
+		return literal & 0xFFFF;
+	default:
+		return literal;
+	}
+}
+
+rr::Value *Intermediate::narrow(rr::Value *value) const
+{
+	switch(narrowing)
+	{
+	case Narrowing::Float16:
+		return RValue<SIMD::Float>(roundToHalf(As<SIMD::Float>(value))).value();
+	case Narrowing::Int16:
+		return ((As<SIMD::Int>(value) << 16) >> 16).value();
+	case Narrowing::UInt16:
+		return (As<SIMD::UInt>(value) & SIMD::UInt(0xFFFF)).value();
+	default:
+		UNREACHABLE("Narrowing %d", int(narrowing));
+		return value;
+	}
+}
+
 Spirv::Object &Spirv::CreateConstant(InsnIterator insn)
 {
 	Type::ID typeId = insn.word(1);
@@ -1318,7 +1405,7 @@ SIMD::Pointer SpirvEmitter::WalkExplicitLayoutAccessChain(Object::ID baseId, Obj
 				// TODO: b/127950082: Check bounds.
 				ASSERT(d.HasMatrixStride);
 				d.InsideMatrix = true;
-				auto columnStride = (d.HasRowMajor && d.RowMajor) ? static_cast<int32_t>(sizeof(float)) : d.MatrixStride;
+				auto columnStride = (d.HasRowMajor && d.RowMajor) ? type.componentSize() : d.MatrixStride;
 				auto &obj = shader.getObject(indexIds[i]);
 				if(obj.kind == Object::Kind::Constant)
 				{
@@ -1333,7 +1420,7 @@ SIMD::Pointer SpirvEmitter::WalkExplicitLayoutAccessChain(Object::ID baseId, Obj
 			break;
 		case spv::OpTypeVector:
 			{
-				auto elemStride = (d.InsideMatrix && d.HasRowMajor && d.RowMajor) ? d.MatrixStride : static_cast<int32_t>(sizeof(float));
+				auto elemStride = (d.InsideMatrix && d.HasRowMajor && d.RowMajor) ? d.MatrixStride : type.componentSize();
 				auto &obj = shader.getObject(indexIds[i]);
 				if(obj.kind == Object::Kind::Constant)
 				{
@@ -1699,6 +1786,19 @@ void Spirv::DefineResult(const InsnIterator &insn)
 	object.definition = insn;
 }
 
+bool Spirv::isExternallyVisibleStore(Object::ID pointerId) const
+{
+	// Pointers which aren't defined yet (e.g. by an OpPhi in a loop) are conservatively
+	// assumed to point to externally visible memory.
+	auto it = defs.find(pointerId);
+	if(it == defs.end())
+	{
+		return true;
+	}
+
+	return StoresInHelperInvocationsHaveNoEffect(getType(it->second).storageClass);
+}
+
 OutOfBoundsBehavior SpirvShader::getOutOfBoundsBehavior(Object::ID pointerId, const vk::PipelineLayout *pipelineLayout) const
 {
 	auto it = descriptorDecorations.find(pointerId);
@@ -1782,6 +1882,53 @@ vk::Format SpirvShader::getInputAttachmentFormat(const vk::Attachments &attachme
 	return inputAttachmentFormats[index];
 }
 
+void SpirvShader::enableProfiling(SpirvProfiler &profiler)
+{
+	auto data = std::make_unique<SpirvProfileData>();
+
+	for(auto insn : *this)
+	{
+		if(insn.opcode() == spv::OpEntryPoint && Function::ID(insn.word(2)) == entryPoint)
+		{
+			data->function = insn.string(3);
+		}
+	}
+
+	// Add the blocks in the order of the label IDs, which usually follows the source.
+	const auto &function = getFunction(entryPoint);
+	std::vector<Block::ID> labels;
+	for(const auto &it : function.blocks)
+	{
+		labels.push_back(it.first);
+	}
+	std::sort(labels.begin(), labels.end(), [](Block::ID a, Block::ID b) { return a.value() < b.value(); });
+
+	for(Block::ID label : labels)
+	{
+		auto &block = data->addBlock(label.value());
+
+		for(auto insn : function.getBlock(label))
+		{
+			block.instructionCount[insn.opcode()]++;
+
+			if(insn.opcode() == spv::OpLine && block.file.empty())
+			{
+				auto file = strings.find(StringID(insn.word(1)));
+				if(file != strings.end())
+				{
+					block.file = file->second;
+					block.line = insn.word(2);
+				}
+			}
+		}
+	}
+
+	char shaderId[64];
+	snprintf(shaderId, sizeof(shaderId), "%s_%016llx", data->function.c_str(), static_cast<unsigned long long>(getIdentifier()));
+
+	profileData = profiler.RegisterShaderForProfiling(shaderId, std::move(data));
+}
+
 // emit-time
 
 void SpirvShader::emitProlog(SpirvRoutine *routine) const
@@ -2155,6 +2302,9 @@ void SpirvEmitter::EmitInstruction(InsnIterator insn)
 		case spv::OpConvertFToS:
 		case spv::OpConvertSToF:
 		case spv::OpConvertUToF:
+		case spv::OpFConvert:
+		case spv::OpSConvert:
+		case spv::OpUConvert:
 		case spv::OpBitcast:
 		case spv::OpIsInf:
 		case spv::OpIsNan:
@@ -2271,7 +2421,7 @@ void SpirvEmitter::EmitInstruction(InsnIterator insn)
 		case spv::OpImageDrefGather:
 		case spv::OpImageFetch:
 		case spv::OpImageQueryLod:
-			return EmitImageSample(ImageInstruction(insn, shader, *this));
+			return EmitImageSample(ImageInstruction(insn, shader, this));
 
 		case spv::OpImageQuerySizeLod:
 			return EmitImageQuerySizeLod(insn);
@@ -2286,13 +2436,13 @@ void SpirvEmitter::EmitInstruction(InsnIterator insn)
 			return EmitImageQuerySamples(insn);
 
 		case spv::OpImageRead:
-			return EmitImageRead(ImageInstruction(insn, shader, *this));
+			return EmitImageRead(ImageInstruction(insn, shader, this));
 
 		case spv::OpImageWrite:
-			return EmitImageWrite(ImageInstruction(insn, shader, *this));
+			return EmitImageWrite(ImageInstruction(insn, shader, this));
 
 		case spv::OpImageTexelPointer:
-			return EmitImageTexelPointer(ImageInstruction(insn, shader, *this));
+			return EmitImageTexelPointer(ImageInstruction(insn, shader, this));
 
 		case spv::OpSampledImage:
 			return EmitSampledImage(insn);
@@ -61,6 +61,8 @@ struct SamplerState;
 namespace sw {
 
 // Forward declarations.
+class SpirvProfileData;
+class SpirvProfiler;
 class SpirvRoutine;
 
 // Incrementally constructed complex bundle of rvalues
@@ -71,8 +73,21 @@ class SpirvRoutine;
 class Intermediate
 {
 public:
-	Intermediate(uint32_t componentCount)
+	// 16-bit values are held in 32-bit lanes: half-floats as the equal 32-bit
+	// float value, and 16-bit integers sign- or zero-extended according to the
+	// signedness of their type. Narrowing specifies the conversion applied to
+	// each component on assignment to maintain this representation.
+	enum class Narrowing
+	{
+		None,
+		Float16,
+		Int16,
+		UInt16,
+	};
+
+	Intermediate(uint32_t componentCount, Narrowing narrowing = Narrowing::None)
 	    : componentCount(componentCount)
+	    , narrowing(narrowing)
 	    , scalar(new rr::Value *[componentCount])
 	{
 		for(auto i = 0u; i < componentCount; i++) { scalar[i] = nullptr; }
@@ -132,16 +147,19 @@ public:
 	Intermediate &operator=(Intermediate &&) = delete;
 
 	const uint32_t componentCount;
+	const Narrowing narrowing;
 
 private:
 	void emplace(uint32_t i, rr::Value *value, TypeHint type)
 	{
 		ASSERT(i < componentCount);
 		ASSERT(scalar[i] == nullptr);
-		scalar[i] = value;
+		scalar[i] = (narrowing == Narrowing::None) ? value : narrow(value);
 		RR_PRINT_ONLY(typeHint = type;)
 	}
 
+	rr::Value *narrow(rr::Value *value) const;
+
 	rr::Value **const scalar;
 
 #ifdef ENABLE_RR_PRINT
@@ -340,6 +358,15 @@ public:
 		uint32_t componentCount = 0;
 		bool isBuiltInBlock = false;
 
+		// Bit width of the scalar components, for numerical types and
+		// aggregates of uniform width. Zero if not applicable.
+		uint32_t componentWidth = 0;
+		// Conversion maintaining the 32-bit lane representation of 16-bit components.
+		Intermediate::Narrowing narrowing = Intermediate::Narrowing::None;
+
+		// Size in bytes of the scalar components in explicitly laid out memory.
+		int32_t componentSize() const { return (componentWidth == 16) ? 2 : static_cast<int32_t>(sizeof(float)); }
+
 		// Inner element type for pointers, arrays, vectors and matrices.
 		ID element;
 	};
@@ -565,6 +592,7 @@ public:
 		bool NeedsCentroid : 1;
 		bool ContainsSampleQualifier : 1;
 		bool ContainsImageWrite : 1;
+		bool ContainsSideEffects : 1;  // Stores, atomics, or image writes visible outside the invocation
 	};
 
 	const Analysis &getAnalysis() const { return analysis; }
@@ -626,6 +654,12 @@ public:
 		bool SampledImageArrayNonUniformIndexing : 1;
 		bool StorageImageArrayNonUniformIndexing : 1;
 		bool PhysicalStorageBufferAddresses : 1;
+		bool Int16 : 1;
+		bool Float16 : 1;
+		bool StorageBuffer16BitAccess : 1;
+		bool UniformAndStorageBuffer16BitAccess : 1;
+		bool StoragePushConstant16 : 1;
+		bool StorageInputOutput16 : 1;
 	};
 
 	const Capabilities &getUsedCapabilities() const
@@ -663,6 +697,20 @@ public:
 		return 0;
 	}
 
+	// getOutputInterfaceSize() returns the number of user-defined output
+	// components, up to and including the last one written by this shader.
+	unsigned int getOutputInterfaceSize() const
+	{
+		for(size_t i = outputs.size(); i > 0; i--)
+		{
+			if(outputs[i - 1].Type != ATTRIBTYPE_UNUSED)
+			{
+				return static_cast<unsigned int>(i);
+			}
+		}
+		return 0;
+	}
+
 	enum AttribType : unsigned char
 	{
 		ATTRIBTYPE_FLOAT,
@@ -820,6 +868,11 @@ public:
 	uint32_t getWorkgroupSizeY() const;
 	uint32_t getWorkgroupSizeZ() const;
 
+	// Returns true if all workgroup-scope control barriers are in the entry
+	// point function and outside of loops. Such compute shaders can be split
+	// into phases at their barriers, and run without coroutines.
+	bool canSplitIntoPhases() const;
+
 	using BuiltInHash = std::hash<std::underlying_type<spv::BuiltIn>::type>;
 	std::unordered_map<spv::BuiltIn, BuiltinMapping, BuiltInHash> inputBuiltins;
 	std::unordered_map<spv::BuiltIn, BuiltinMapping, BuiltInHash> outputBuiltins;
@@ -859,6 +912,9 @@ public:
 	// Creates an Object for the instruction's result in 'defs'.
 	void DefineResult(const InsnIterator &insn);
 
+	// Returns whether stores through the pointer can be observed outside of the invocation.
+	bool isExternallyVisibleStore(Object::ID pointerId) const;
+
 	using InterfaceVisitor = std::function<void(Decorations const, AttribType)>;
 
 	void VisitInterface(Object::ID id, const InterfaceVisitor &v) const;
@@ -941,6 +997,11 @@ public:
 	void EvalSpecConstantUnaryOp(InsnIterator insn);
 	void EvalSpecConstantBinaryOp(InsnIterator insn);
 
+	// Returns the 32-bit lane representation of a scalar constant's literal.
+	static uint32_t WidenLiteral(const Type &type, uint32_t literal);
+	// Returns the 32-bit lane representation of a value computed in 32 bits.
+	static uint32_t NarrowConstant(const Type &type, uint32_t value);
+
 	// Fragment input interpolation functions
 	uint32_t GetNumInputComponents(int32_t location) const;
 	uint32_t GetPackedInterpolant(int32_t location) const;
@@ -995,9 +1056,17 @@ public:
 
 	vk::Format getInputAttachmentFormat(const vk::Attachments &attachments, int32_t index) const;
 
+	// Registers the blocks of the entry point with the profiler, and makes the
+	// routines emitted from now on record their execution.
+	void enableProfiling(SpirvProfiler &profiler);
+	SpirvProfileData *getProfileData() const { return profileData; }
+
 private:
 	const bool robustBufferAccess;
 
+	// Owned by the profiler. Null when the shader isn't profiled.
+	SpirvProfileData *profileData = nullptr;
+
 	// When reading from an input attachment, its format is needed.  When the fragment shader
 	// pipeline library is created, the formats are available with render pass objects, but not
 	// with dynamic rendering.  Instead, with dynamic rendering the formats are provided to the
@@ -1050,6 +1119,25 @@ public:
 	                 const vk::DescriptorSet::Bindings &descriptorSets,
 	                 unsigned int multiSampleCount);
 
+	// Image instruction which obtains its routine from the device's sampling routine cache,
+	// along with the descriptor bindings of the image and of the sampler it uses. The sampler
+	// set and binding are -1 for samplerless instructions.
+	struct SamplingRoutineUse
+	{
+		uint32_t signature;
+		int32_t imageSet;
+		int32_t imageBinding;
+		int32_t samplerSet;
+		int32_t samplerBinding;
+	};
+
+	// Returns the sampling routine uses which can be determined without emitting the shader.
+	static std::vector<SamplingRoutineUse> GetSamplingRoutineUses(const SpirvShader &shader);
+
+	// Compiles the sampling routine for the given instruction signature, sampler and image
+	// view ahead of its first use, unless the image view is incompatible with the instruction.
+	static void PrecompileImageSampler(const vk::Device *device, uint32_t signature, uint32_t samplerId, uint32_t imageViewId);
+
 	// Helper for calling rr::Yield with result cast to an rr::Int.
 	enum class YieldResult
 	{
@@ -1188,7 +1276,8 @@ private:
 
 	struct ImageInstruction : public ImageInstructionSignature
 	{
-		ImageInstruction(InsnIterator insn, const Spirv &shader, const SpirvEmitter &state);
+		// When 'state' is null, sampled images are only resolved through OpSampledImage.
+		ImageInstruction(InsnIterator insn, const Spirv &shader, const SpirvEmitter *state);
 
 		const uint32_t position;
 
@@ -1311,11 +1400,11 @@ private:
 
 	RR_PRINT_ONLY(friend struct rr::PrintValue::Ty<Operand>;)
 
-	Intermediate &createIntermediate(Object::ID id, uint32_t componentCount)
+	Intermediate &createIntermediate(Object::ID id, uint32_t componentCount, Intermediate::Narrowing narrowing = Intermediate::Narrowing::None)
 	{
 		auto it = intermediates.emplace(std::piecewise_construct,
 		                                std::forward_as_tuple(id),
-		                                std::forward_as_tuple(componentCount));
+		                                std::forward_as_tuple(componentCount, narrowing));
 		ASSERT_MSG(it.second, "Intermediate %d created twice", id.value());
 		return it.first->second;
 	}
@@ -1493,7 +1582,12 @@ private:
 	Pointer<Byte> getSamplerDescriptor(Pointer<Byte> imageDescriptor, const ImageInstruction &instruction) const;
 	Pointer<Byte> getSamplerDescriptor(Pointer<Byte> imageDescriptor, const ImageInstruction &instruction, int laneIdx) const;
 	Pointer<Byte> lookupSamplerFunction(Pointer<Byte> imageDescriptor, Pointer<Byte> samplerDescriptor, const ImageInstruction &instruction) const;
+	uint32_t getImmutableSamplerId(const ImageInstruction &instruction) const;
+	const vk::SamplerState *getImmutableSamplerState(const ImageInstruction &instruction) const;
+	uint32_t getInlineSamplingImageViewId(const ImageInstruction &instruction, uint32_t immutableSamplerId) const;
+	void getSamplerParameters(Array<SIMD::Float> &in, const ImageInstruction &instruction) const;
 	void callSamplerFunction(Pointer<Byte> samplerFunction, Array<SIMD::Float> &out, Pointer<Byte> imageDescriptor, const ImageInstruction &instruction) const;
+	void emitInlineSampler(const vk::SamplerState *vkSamplerState, uint32_t imageViewId, Array<SIMD::Float> &out, Pointer<Byte> imageDescriptor, const ImageInstruction &instruction) const;
 
 	void GetImageDimensions(const Type &resultTy, Object::ID imageId, Object::ID lodId, Intermediate &dst) const;
 	struct TexelAddressData
@@ -1528,6 +1622,15 @@ private:
 	void EmitInstructions(InsnIterator begin, InsnIterator end);
 	void EmitInstruction(InsnIterator insn);
 
+	// Instrument the instructions of the current block to record its execution
+	// for SPIR-V profiling. Nothing is emitted when the shader isn't profiled.
+	void BeginBlockProfiling();
+	void EndBlockProfiling();
+	// Records the cycles spent in the current block so far, when its execution
+	// is split by a workgroup barrier. Returns whether the block is profiled, in
+	// which case BeginBlockProfiling() restarts counting after the barrier.
+	bool PauseBlockProfiling();
+
 	// Helper for implementing OpStore, which doesn't take an InsnIterator so it
 	// can also store independent operands.
 	void Store(Object::ID pointerId, const Operand &value, bool atomic, std::memory_order memoryOrder) const;
@@ -1546,6 +1649,16 @@ private:
 
 	void Yield(YieldResult res) const;
 
+	// Waits for all subgroups of the workgroup to reach the barrier. This
+	// yields from the coroutine, or when the routine is split into phases,
+	// saves the values used after 'insn' to the phase state, ends the phase,
+	// and restores them at the start of the next one.
+	void EmitWorkgroupBarrier(InsnIterator insn);
+
+	// Returns the IDs which may be referenced by the instructions still to
+	// be emitted after 'insn'. Literals are included, so this is conservative.
+	std::unordered_set<uint32_t> GetIdsUsedAfter(InsnIterator insn) const;
+
 	// Helper as we often need to take dot products as part of doing other things.
 	static SIMD::Float FDot(unsigned numComponents, const Operand &x, const Operand &y);
 	static SIMD::Int SDot(unsigned numComponents, const Operand &x, const Operand &y, const Operand *accum);
@@ -1556,7 +1669,9 @@ private:
 
 	using ImageSampler = void(void *texture, void *uvsIn, void *texelOut, void *constants);
 	static ImageSampler *getImageSampler(const vk::Device *device, uint32_t signature, uint32_t samplerId, uint32_t imageViewId);
+	static Sampler getSamplerState(ImageInstructionSignature instruction, const vk::SamplerState *vkSamplerState, uint32_t imageViewId);
 	static std::shared_ptr<rr::Routine> emitSamplerRoutine(ImageInstructionSignature instruction, const Sampler &samplerState);
+	static void emitSamplerFunction(ImageInstructionSignature instruction, const Sampler &samplerState, Pointer<Byte> texture, Pointer<SIMD::Float> in, Pointer<SIMD::Float> out, Pointer<Byte> constants);
 	static std::shared_ptr<rr::Routine> emitWriteRoutine(ImageInstructionSignature instruction, const Sampler &samplerState);
 
 	// TODO(b/129523279): Eliminate conversion and use vk::Sampler members directly.
@@ -1573,6 +1688,8 @@ private:
 	Spirv::Block::Set visited;                       // Blocks already built.
 	std::unordered_map<Block::Edge, RValue<SIMD::Int>, Block::Edge::Hash> edgeActiveLaneMasks;
 	std::deque<Block::ID> *pending;
+	rr::Value *profileCyclesBegin = nullptr;         // Cycle counter at the start of the profiled block.
+	rr::Value *profileLaneMask = nullptr;            // Active lanes at the start of the profiled block.
 
 	const vk::Attachments *attachments;
 	const vk::DescriptorSet::Bindings &descriptorSets;
@@ -1638,6 +1755,15 @@ public:
 	Pointer<Byte> constants;
 	Int discardMask = 0;
 
+	// Compute shaders split into phases at their barriers run each phase for
+	// all subgroups of the workgroup in a loop. endPhase() ends the current
+	// loop and starts the next, and phaseState points to the current
+	// subgroup's storage for values live across the barrier, of which
+	// phaseStateSize bytes are used. endPhase is empty otherwise.
+	std::function<void()> endPhase;
+	Pointer<Byte> phaseState;
+	uint32_t phaseStateSize = 0;
+
 	// Shader invocation state.
 	// Not all of these variables are used for every type of shader, and some
 	// are only used when debugging. See b/146486064 for more information.
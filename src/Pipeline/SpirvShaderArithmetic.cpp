@@ -26,7 +26,7 @@ namespace sw {
 void SpirvEmitter::EmitVectorTimesScalar(Spirv::InsnIterator insn)
 {
 	auto &type = shader.getType(insn.resultTypeId());
-	auto &dst = createIntermediate(insn.resultId(), type.componentCount);
+	auto &dst = createIntermediate(insn.resultId(), type.componentCount, type.narrowing);
 	auto lhs = Operand(shader, *this, insn.word(3));
 	auto rhs = Operand(shader, *this, insn.word(4));
 
@@ -39,7 +39,7 @@ void SpirvEmitter::EmitVectorTimesScalar(Spirv::InsnIterator insn)
 void SpirvEmitter::EmitMatrixTimesVector(Spirv::InsnIterator insn)
 {
 	auto &type = shader.getType(insn.resultTypeId());
-	auto &dst = createIntermediate(insn.resultId(), type.componentCount);
+	auto &dst = createIntermediate(insn.resultId(), type.componentCount, type.narrowing);
 	auto lhs = Operand(shader, *this, insn.word(3));
 	auto rhs = Operand(shader, *this, insn.word(4));
 
@@ -57,7 +57,7 @@ void SpirvEmitter::EmitMatrixTimesVector(Spirv::InsnIterator insn)
 void SpirvEmitter::EmitVectorTimesMatrix(Spirv::InsnIterator insn)
 {
 	auto &type = shader.getType(insn.resultTypeId());
-	auto &dst = createIntermediate(insn.resultId(), type.componentCount);
+	auto &dst = createIntermediate(insn.resultId(), type.componentCount, type.narrowing);
 	auto lhs = Operand(shader, *this, insn.word(3));
 	auto rhs = Operand(shader, *this, insn.word(4));
 
@@ -75,7 +75,7 @@ void SpirvEmitter::EmitVectorTimesMatrix(Spirv::InsnIterator insn)
 void SpirvEmitter::EmitMatrixTimesMatrix(Spirv::InsnIterator insn)
 {
 	auto &type = shader.getType(insn.resultTypeId());
-	auto &dst = createIntermediate(insn.resultId(), type.componentCount);
+	auto &dst = createIntermediate(insn.resultId(), type.componentCount, type.narrowing);
 	auto lhs = Operand(shader, *this, insn.word(3));
 	auto rhs = Operand(shader, *this, insn.word(4));
 
@@ -100,7 +100,7 @@ void SpirvEmitter::EmitMatrixTimesMatrix(Spirv::InsnIterator insn)
 void SpirvEmitter::EmitOuterProduct(Spirv::InsnIterator insn)
 {
 	auto &type = shader.getType(insn.resultTypeId());
-	auto &dst = createIntermediate(insn.resultId(), type.componentCount);
+	auto &dst = createIntermediate(insn.resultId(), type.componentCount, type.narrowing);
 	auto lhs = Operand(shader, *this, insn.word(3));
 	auto rhs = Operand(shader, *this, insn.word(4));
 
@@ -189,7 +189,55 @@ void SpirvEmitter::EmitUnaryOp(Spirv::InsnIterator insn)
 		return EmitBitcastPointer(insn.resultId(), src);
 	}
 
-	auto &dst = createIntermediate(insn.resultId(), type.componentCount);
+	auto &srcType = shader.getObjectType(insn.word(3));
+	auto width = srcType.componentWidth;
+
+	if(insn.opcode() == spv::OpBitcast && (type.componentWidth == 16 || width == 16))
+	{
+		// Bitcasts involving 16-bit types operate on the 16-bit encoding of the
+		// components, pairs of which make up the bits of 32-bit components.
+		std::vector<SIMD::UInt> bits;
+		for(auto i = 0u; i < srcType.componentCount; i++)
+		{
+			if(width != 16)
+			{
+				bits.push_back(src.UInt(i) & SIMD::UInt(0xFFFF));
+				bits.push_back(src.UInt(i) >> 16);
+			}
+			else if(srcType.narrowing == Intermediate::Narrowing::Float16)
+			{
+				bits.push_back(halfBitsOf(src.Float(i)));
+			}
+			else
+			{
+				bits.push_back(src.UInt(i) & SIMD::UInt(0xFFFF));
+			}
+		}
+
+		auto &dst = createIntermediate(insn.resultId(), type.componentCount);
+		for(auto i = 0u; i < type.componentCount; i++)
+		{
+			switch(type.narrowing)
+			{
+			case Intermediate::Narrowing::Float16:
+				dst.move(i, halfToFloatBits(bits[i]));
+				break;
+			case Intermediate::Narrowing::Int16:
+				dst.move(i, SignExtend(As<SIMD::Int>(bits[i]), 16));
+				break;
+			case Intermediate::Narrowing::UInt16:
+				dst.move(i, bits[i]);
+				break;
+			default:
+				dst.move(i, bits[2 * i] | (bits[2 * i + 1] << 16));
+				break;
+			}
+		}
+
+		return;
+	}
+
+	auto &dst = createIntermediate(insn.resultId(), type.componentCount, type.narrowing);
 
 	for(auto i = 0u; i < type.componentCount; i++)
 	{
@@ -239,11 +287,15 @@ void SpirvEmitter::EmitUnaryOp(Spirv::InsnIterator insn)
 				v = ((v >> 4) & SIMD::UInt(0x0F0F0F0F)) | ((v & SIMD::UInt(0x0F0F0F0F)) << 4);
 				v = ((v >> 8) & SIMD::UInt(0x00FF00FF)) | ((v & SIMD::UInt(0x00FF00FF)) << 8);
 				v = (v >> 16) | (v << 16);
+				if(width == 16)
+				{
+					v = v >> 16;  // Reversed 16-bit value is in the upper half.
+				}
 				dst.move(i, v);
 			}
 			break;
 		case spv::OpBitCount:
-			dst.move(i, CountBits(src.UInt(i)));
+			dst.move(i, CountBits(ZeroExtend(src.UInt(i), width)));
 			break;
 		case spv::OpSNegate:
 			dst.move(i, -src.Int(i));
@@ -258,10 +310,19 @@ void SpirvEmitter::EmitUnaryOp(Spirv::InsnIterator insn)
 			dst.move(i, SIMD::Int(src.Float(i)));
 			break;
 		case spv::OpConvertSToF:
-			dst.move(i, SIMD::Float(src.Int(i)));
+			dst.move(i, SIMD::Float(SignExtend(src.Int(i), width)));
 			break;
 		case spv::OpConvertUToF:
-			dst.move(i, SIMD::Float(src.UInt(i)));
+			dst.move(i, SIMD::Float(ZeroExtend(src.UInt(i), width)));
+			break;
+		case spv::OpFConvert:
+			dst.move(i, src.Float(i));
+			break;
+		case spv::OpSConvert:
+			dst.move(i, SignExtend(src.Int(i), width));
+			break;
+		case spv::OpUConvert:
+			dst.move(i, ZeroExtend(src.UInt(i), width));
 			break;
 		case spv::OpBitcast:
 			dst.move(i, src.Float(i));
@@ -348,10 +409,11 @@ void SpirvEmitter::EmitUnaryOp(Spirv::InsnIterator insn)
 void SpirvEmitter::EmitBinaryOp(Spirv::InsnIterator insn)
 {
 	auto &type = shader.getType(insn.resultTypeId());
-	auto &dst = createIntermediate(insn.resultId(), type.componentCount);
+	auto &dst = createIntermediate(insn.resultId(), type.componentCount, type.narrowing);
 	auto &lhsType = shader.getObjectType(insn.word(3));
 	auto lhs = Operand(shader, *this, insn.word(3));
 	auto rhs = Operand(shader, *this, insn.word(4));
+	auto width = lhsType.componentWidth;
 
 	for(auto i = 0u; i < lhsType.componentCount; i++)
 	{
@@ -368,8 +430,8 @@ void SpirvEmitter::EmitBinaryOp(Spirv::InsnIterator insn)
 			break;
 		case spv::OpSDiv:
 			{
-				SIMD::Int a = lhs.Int(i);
-				SIMD::Int b = rhs.Int(i);
+				SIMD::Int a = SignExtend(lhs.Int(i), width);
+				SIMD::Int b = SignExtend(rhs.Int(i), width);
 				b = b | CmpEQ(b, SIMD::Int(0));                                       // prevent divide-by-zero
 				a = a | (CmpEQ(a, SIMD::Int(0x80000000)) & CmpEQ(b, SIMD::Int(-1)));  // prevent integer overflow
 				dst.move(i, a / b);
@@ -377,14 +439,14 @@ void SpirvEmitter::EmitBinaryOp(Spirv::InsnIterator insn)
 			break;
 		case spv::OpUDiv:
 			{
-				auto zeroMask = As<SIMD::UInt>(CmpEQ(rhs.Int(i), SIMD::Int(0)));
-				dst.move(i, lhs.UInt(i) / (rhs.UInt(i) | zeroMask));
+				auto zeroMask = As<SIMD::UInt>(CmpEQ(ZeroExtend(rhs.UInt(i), width), SIMD::UInt(0)));
+				dst.move(i, ZeroExtend(lhs.UInt(i), width) / (ZeroExtend(rhs.UInt(i), width) | zeroMask));
 			}
 			break;
 		case spv::OpSRem:
 			{
-				SIMD::Int a = lhs.Int(i);
-				SIMD::Int b = rhs.Int(i);
+				SIMD::Int a = SignExtend(lhs.Int(i), width);
+				SIMD::Int b = SignExtend(rhs.Int(i), width);
 				b = b | CmpEQ(b, SIMD::Int(0));                                       // prevent divide-by-zero
 				a = a | (CmpEQ(a, SIMD::Int(0x80000000)) & CmpEQ(b, SIMD::Int(-1)));  // prevent integer overflow
 				dst.move(i, a % b);
@@ -392,8 +454,8 @@ void SpirvEmitter::EmitBinaryOp(Spirv::InsnIterator insn)
 			break;
 		case spv::OpSMod:
 			{
-				SIMD::Int a = lhs.Int(i);
-				SIMD::Int b = rhs.Int(i);
+				SIMD::Int a = SignExtend(lhs.Int(i), width);
+				SIMD::Int b = SignExtend(rhs.Int(i), width);
 				b = b | CmpEQ(b, SIMD::Int(0));                                       // prevent divide-by-zero
 				a = a | (CmpEQ(a, SIMD::Int(0x80000000)) & CmpEQ(b, SIMD::Int(-1)));  // prevent integer overflow
 				auto mod = a % b;
@@ -410,41 +472,41 @@ void SpirvEmitter::EmitBinaryOp(Spirv::InsnIterator insn)
 			break;
 		case spv::OpUMod:
 			{
-				auto zeroMask = As<SIMD::UInt>(CmpEQ(rhs.Int(i), SIMD::Int(0)));
-				dst.move(i, lhs.UInt(i) % (rhs.UInt(i) | zeroMask));
+				auto zeroMask = As<SIMD::UInt>(CmpEQ(ZeroExtend(rhs.UInt(i), width), SIMD::UInt(0)));
+				dst.move(i, ZeroExtend(lhs.UInt(i), width) % (ZeroExtend(rhs.UInt(i), width) | zeroMask));
 			}
 			break;
 		case spv::OpIEqual:
 		case spv::OpLogicalEqual:
-			dst.move(i, CmpEQ(lhs.Int(i), rhs.Int(i)));
+			dst.move(i, CmpEQ(ZeroExtend(lhs.UInt(i), width), ZeroExtend(rhs.UInt(i), width)));
 			break;
 		case spv::OpINotEqual:
 		case spv::OpLogicalNotEqual:
-			dst.move(i, CmpNEQ(lhs.Int(i), rhs.Int(i)));
+			dst.move(i, CmpNEQ(ZeroExtend(lhs.UInt(i), width), ZeroExtend(rhs.UInt(i), width)));
 			break;
 		case spv::OpUGreaterThan:
-			dst.move(i, CmpGT(lhs.UInt(i), rhs.UInt(i)));
+			dst.move(i, CmpGT(ZeroExtend(lhs.UInt(i), width), ZeroExtend(rhs.UInt(i), width)));
 			break;
 		case spv::OpSGreaterThan:
-			dst.move(i, CmpGT(lhs.Int(i), rhs.Int(i)));
+			dst.move(i, CmpGT(SignExtend(lhs.Int(i), width), SignExtend(rhs.Int(i), width)));
 			break;
 		case spv::OpUGreaterThanEqual:
-			dst.move(i, CmpGE(lhs.UInt(i), rhs.UInt(i)));
+			dst.move(i, CmpGE(ZeroExtend(lhs.UInt(i), width), ZeroExtend(rhs.UInt(i), width)));
 			break;
 		case spv::OpSGreaterThanEqual:
-			dst.move(i, CmpGE(lhs.Int(i), rhs.Int(i)));
+			dst.move(i, CmpGE(SignExtend(lhs.Int(i), width), SignExtend(rhs.Int(i), width)));
 			break;
 		case spv::OpULessThan:
-			dst.move(i, CmpLT(lhs.UInt(i), rhs.UInt(i)));
+			dst.move(i, CmpLT(ZeroExtend(lhs.UInt(i), width), ZeroExtend(rhs.UInt(i), width)));
 			break;
 		case spv::OpSLessThan:
-			dst.move(i, CmpLT(lhs.Int(i), rhs.Int(i)));
+			dst.move(i, CmpLT(SignExtend(lhs.Int(i), width), SignExtend(rhs.Int(i), width)));
 			break;
 		case spv::OpULessThanEqual:
-			dst.move(i, CmpLE(lhs.UInt(i), rhs.UInt(i)));
+			dst.move(i, CmpLE(ZeroExtend(lhs.UInt(i), width), ZeroExtend(rhs.UInt(i), width)));
 			break;
 		case spv::OpSLessThanEqual:
-			dst.move(i, CmpLE(lhs.Int(i), rhs.Int(i)));
+			dst.move(i, CmpLE(SignExtend(lhs.Int(i), width), SignExtend(rhs.Int(i), width)));
 			break;
 		case spv::OpFAdd:
 			dst.move(i, lhs.Float(i) + rhs.Float(i));
@@ -508,10 +570,10 @@ void SpirvEmitter::EmitBinaryOp(Spirv::InsnIterator insn)
 			dst.move(i, CmpUGE(lhs.Float(i), rhs.Float(i)));
 			break;
 		case spv::OpShiftRightLogical:
-			dst.move(i, lhs.UInt(i) >> rhs.UInt(i));
+			dst.move(i, ZeroExtend(lhs.UInt(i), width) >> rhs.UInt(i));
 			break;
 		case spv::OpShiftRightArithmetic:
-			dst.move(i, lhs.Int(i) >> rhs.Int(i));
+			dst.move(i, SignExtend(lhs.Int(i), width) >> rhs.Int(i));
 			break;
 		case spv::OpShiftLeftLogical:
 			dst.move(i, lhs.UInt(i) << rhs.UInt(i));
@@ -531,20 +593,39 @@ void SpirvEmitter::EmitBinaryOp(Spirv::InsnIterator insn)
 			// Extended ops: result is a structure containing two members of the same type as lhs & rhs.
 			// In our flat view then, component i is the i'th component of the first member;
 			// component i + N is the i'th component of the second member.
-			dst.move(i, lhs.Int(i) * rhs.Int(i));
-			dst.move(i + lhsType.componentCount, MulHigh(lhs.Int(i), rhs.Int(i)));
+			if(width == 16)
+			{
+				// The full product of 16-bit integers fits in 32 bits.
+				SIMD::Int product = SignExtend(lhs.Int(i), width) * SignExtend(rhs.Int(i), width);
+				dst.move(i, product);
+				dst.move(i + lhsType.componentCount, product >> 16);
+			}
+			else
+			{
+				dst.move(i, lhs.Int(i) * rhs.Int(i));
+				dst.move(i + lhsType.componentCount, MulHigh(lhs.Int(i), rhs.Int(i)));
+			}
 			break;
 		case spv::OpUMulExtended:
-			dst.move(i, lhs.UInt(i) * rhs.UInt(i));
-			dst.move(i + lhsType.componentCount, MulHigh(lhs.UInt(i), rhs.UInt(i)));
+			if(width == 16)
+			{
+				SIMD::UInt product = ZeroExtend(lhs.UInt(i), width) * ZeroExtend(rhs.UInt(i), width);
+				dst.move(i, product);
+				dst.move(i + lhsType.componentCount, product >> 16);
+			}
+			else
+			{
+				dst.move(i, lhs.UInt(i) * rhs.UInt(i));
+				dst.move(i + lhsType.componentCount, MulHigh(lhs.UInt(i), rhs.UInt(i)));
+			}
 			break;
 		case spv::OpIAddCarry:
 			dst.move(i, lhs.UInt(i) + rhs.UInt(i));
-			dst.move(i + lhsType.componentCount, CmpLT(dst.UInt(i), lhs.UInt(i)) >> 31);
+			dst.move(i + lhsType.componentCount, CmpLT(dst.UInt(i), ZeroExtend(lhs.UInt(i), width)) >> 31);
 			break;
 		case spv::OpISubBorrow:
 			dst.move(i, lhs.UInt(i) - rhs.UInt(i));
-			dst.move(i + lhsType.componentCount, CmpLT(lhs.UInt(i), rhs.UInt(i)) >> 31);
+			dst.move(i + lhsType.componentCount, CmpLT(ZeroExtend(lhs.UInt(i), width), ZeroExtend(rhs.UInt(i), width)) >> 31);
 			break;
 		default:
 			UNREACHABLE("%s", shader.OpcodeName(insn.opcode()));
@@ -560,7 +641,7 @@ void SpirvEmitter::EmitDot(Spirv::InsnIterator insn)
 {
 	auto &type = shader.getType(insn.resultTypeId());
 	ASSERT(type.componentCount == 1);
-	auto &dst = createIntermediate(insn.resultId(), type.componentCount);
+	auto &dst = createIntermediate(insn.resultId(), type.componentCount, type.narrowing);
 	auto &lhsType = shader.getObjectType(insn.word(3));
 	auto lhs = Operand(shader, *this, insn.word(3));
 	auto rhs = Operand(shader, *this, insn.word(4));
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "SpirvShader.hpp"
+#include "SpirvProfiler.hpp"
 #include "SpirvShaderDebug.hpp"
 
 #include "Reactor/Coroutine.hpp"  // rr::Yield
@@ -21,6 +22,7 @@
 
 #include <spirv/unified1/spirv.hpp>
 
+#include <algorithm>
 #include <queue>
 
 #include <fstream>
@@ -195,6 +197,43 @@ bool Spirv::Function::ExistsPath(Block::ID from, Block::ID to, Block::ID notPass
 	return false;
 }
 
+bool Spirv::canSplitIntoPhases() const
+{
+	for(auto &functionIt : functions)
+	{
+		const auto &function = functionIt.second;
+
+		for(auto &blockIt : function.blocks)
+		{
+			for(auto insn : blockIt.second)
+			{
+				if(insn.opcode() != spv::OpControlBarrier ||
+				   spv::Scope(GetConstScalarInt(insn.word(1))) != spv::ScopeWorkgroup)
+				{
+					continue;
+				}
+
+				if(functionIt.first != entryPoint)
+				{
+					return false;
+				}
+
+				for(auto &loopIt : function.blocks)
+				{
+					const auto &loop = loopIt.second;
+					if(loop.kind == Block::Loop &&
+					   (loopIt.first == blockIt.first || function.ExistsPath(loopIt.first, blockIt.first, loop.mergeBlock)))
+					{
+						return false;
+					}
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
 void SpirvEmitter::addOutputActiveLaneMaskEdge(Block::ID to, RValue<SIMD::Int> mask)
 {
 	addActiveLaneMaskEdge(block, to, mask & activeLaneMask());
@@ -309,7 +348,9 @@ void SpirvEmitter::EmitNonLoop()
 		SetActiveLaneMask(activeLaneMask);
 	}
 
+	BeginBlockProfiling();
 	EmitInstructions(block.begin(), block.end());
+	EndBlockProfiling();
 
 	for(auto out : block.outs)
 	{
@@ -392,6 +433,7 @@ void SpirvEmitter::EmitLoop()
 	SetActiveLaneMask(loopActiveLaneMask);
 
 	// Emit the non-phi loop header block's instructions.
+	BeginBlockProfiling();
 	for(auto insn = block.begin(); insn != block.end(); insn++)
 	{
 		if(insn.opcode() == spv::OpPhi)
@@ -403,6 +445,7 @@ void SpirvEmitter::EmitLoop()
 			EmitInstruction(insn);
 		}
 	}
+	EndBlockProfiling();
 
 	// Emit all blocks between the loop header and the merge block, but
 	// don't emit the merge block yet.
@@ -634,7 +677,7 @@ void SpirvEmitter::EmitControlBarrier(InsnIterator insn)
 	switch(executionScope)
 	{
 	case spv::ScopeWorkgroup:
-		Yield(YieldResult::ControlBarrier);
+		EmitWorkgroupBarrier(insn);
 		break;
 	case spv::ScopeSubgroup:
 		break;
@@ -722,6 +765,285 @@ void SpirvEmitter::Yield(YieldResult res) const
 	rr::Yield(RValue<Int>(int(res)));
 }
 
+void SpirvEmitter::EmitWorkgroupBarrier(InsnIterator insn)
+{
+	if(!routine->endPhase)
+	{
+		// The other invocations of the workgroup run until they reach the
+		// barrier too, which mustn't be counted as time spent in this block.
+		bool profiling = PauseBlockProfiling();
+
+		Yield(YieldResult::ControlBarrier);
+
+		if(profiling)
+		{
+			BeginBlockProfiling();
+		}
+
+		return;
+	}
+
+	// Values computed in one phase are only valid within its loop over the
+	// subgroups, so the ones still used must be saved in the subgroup's phase
+	// state, and restored from it in the next phase. Pointers, which vary in
+	// size, are stored last to keep the vectors aligned.
+	auto used = GetIdsUsedAfter(insn);
+
+	std::vector<Block::Edge> liveEdges;
+	for(auto &it : edgeActiveLaneMasks)
+	{
+		if(visited.count(it.first.to) == 0)
+		{
+			liveEdges.push_back(it.first);
+		}
+	}
+
+	std::vector<Object::ID> liveIntermediates;
+	for(auto &it : intermediates)
+	{
+		if(used.count(it.first.value()) != 0)
+		{
+			liveIntermediates.push_back(it.first);
+		}
+	}
+
+	std::vector<Object::ID> livePhis;
+	for(auto &it : phis)
+	{
+		if(used.count(it.first.value()) != 0)
+		{
+			livePhis.push_back(it.first);
+		}
+	}
+
+	std::vector<Object::ID> livePointers;
+	for(auto &it : pointers)
+	{
+		if(used.count(it.first.value()) != 0)
+		{
+			livePointers.push_back(it.first);
+		}
+	}
+
+	std::vector<Object::ID> liveSampledImages;
+	for(auto &it : sampledImages)
+	{
+		if(used.count(it.first.value()) != 0)
+		{
+			liveSampledImages.push_back(it.first);
+		}
+	}
+
+	Pointer<Byte> state = routine->phaseState;
+	uint32_t offset = 0;
+
+	auto save = [&](RValue<SIMD::Float> value) {
+		*Pointer<SIMD::Float>(state + offset) = value;
+		offset += sizeof(float) * SIMD::Width;
+	};
+
+	save(As<SIMD::Float>(activeLaneMask()));
+	save(As<SIMD::Float>(storesAndAtomicsMask()));
+
+	for(auto &edge : liveEdges)
+	{
+		save(As<SIMD::Float>(edgeActiveLaneMasks.at(edge)));
+	}
+
+	for(auto id : liveIntermediates)
+	{
+		auto &intermediate = intermediates.at(id);
+		for(uint32_t i = 0; i < intermediate.componentCount; i++)
+		{
+			save(intermediate.Float(i));
+		}
+	}
+
+	for(auto id : livePhis)
+	{
+		for(auto &component : phis.at(id))
+		{
+			save(component);
+		}
+	}
+
+	// Function, private and input variables are not tracked by ID, as they
+	// can be accessed through pointers derived from them.
+	for(auto &it : routine->variables)
+	{
+		for(int i = 0; i < it.second.getArraySize(); i++)
+		{
+			save(it.second[i]);
+		}
+	}
+
+	for(auto id : livePointers)
+	{
+		pointers.at(id).spill(state + offset);
+		offset += pointers.at(id).spillSize();
+	}
+
+	for(auto id : liveSampledImages)
+	{
+		sampledImages.at(id).spill(state + offset);
+		offset += sampledImages.at(id).spillSize();
+	}
+
+	routine->phaseStateSize = std::max(routine->phaseStateSize, offset);
+
+	// The profiled block's start values don't outlive the phase either, so
+	// record the cycles spent in it so far, and restart in the next phase.
+	bool profiling = PauseBlockProfiling();
+
+	routine->endPhase();
+
+	state = routine->phaseState;
+	offset = 0;
+
+	auto restore = [&]() {
+		RValue<SIMD::Float> value = *Pointer<SIMD::Float>(state + offset);
+		offset += sizeof(float) * SIMD::Width;
+		return value;
+	};
+
+	SetActiveLaneMask(As<SIMD::Int>(restore()));
+	SetStoresAndAtomicsMask(As<SIMD::Int>(restore()));
+
+	for(auto &edge : liveEdges)
+	{
+		edgeActiveLaneMasks.erase(edge);
+		edgeActiveLaneMasks.emplace(edge, As<SIMD::Int>(restore()));
+	}
+
+	for(auto id : liveIntermediates)
+	{
+		// The saved values are already narrowed.
+		uint32_t componentCount = intermediates.at(id).componentCount;
+		intermediates.erase(id);
+		auto &intermediate = createIntermediate(id, componentCount);
+		for(uint32_t i = 0; i < componentCount; i++)
+		{
+			intermediate.move(i, restore());
+		}
+	}
+
+	for(auto id : livePhis)
+	{
+		for(auto &component : phis.at(id))
+		{
+			component = restore();
+		}
+	}
+
+	for(auto &it : routine->variables)
+	{
+		for(int i = 0; i < it.second.getArraySize(); i++)
+		{
+			it.second[i] = restore();
+		}
+	}
+
+	for(auto id : livePointers)
+	{
+		pointers.at(id).reload(state + offset);
+		offset += pointers.at(id).spillSize();
+	}
+
+	for(auto id : liveSampledImages)
+	{
+		sampledImages.at(id).reload(state + offset);
+		offset += sampledImages.at(id).spillSize();
+	}
+
+	if(profiling)
+	{
+		BeginBlockProfiling();
+	}
+}
+
+void SpirvEmitter::BeginBlockProfiling()
+{
+	if(shader.getProfileData())
+	{
+		profileLaneMask = SignMask(activeLaneMask()).value();
+		profileCyclesBegin = rr::Call(ConstantPointer(reinterpret_cast<void *>(SpirvProfiler::ReadCycleCounter)), Long::type(), {}, {});
+	}
+}
+
+void SpirvEmitter::EndBlockProfiling()
+{
+	if(profileCyclesBegin)
+	{
+		auto *profileBlock = shader.getProfileData()->getBlock(block.value());
+		rr::Call(ConstantPointer(reinterpret_cast<void *>(SpirvProfiler::RecordBlockExecution)), Void::type(),
+		         { ConstantPointer(profileBlock).value(), profileCyclesBegin, profileLaneMask },
+		         { Pointer<Byte>::type(), Long::type(), Int::type() });
+
+		profileCyclesBegin = nullptr;
+		profileLaneMask = nullptr;
+	}
+}
+
+bool SpirvEmitter::PauseBlockProfiling()
+{
+	if(!profileCyclesBegin)
+	{
+		return false;
+	}
+
+	auto *profileBlock = shader.getProfileData()->getBlock(block.value());
+	rr::Call(ConstantPointer(reinterpret_cast<void *>(SpirvProfiler::RecordBlockCycles)), Void::type(),
+	         { ConstantPointer(profileBlock).value(), profileCyclesBegin },
+	         { Pointer<Byte>::type(), Long::type() });
+
+	profileCyclesBegin = nullptr;
+	profileLaneMask = nullptr;
+
+	return true;
+}
+
+std::unordered_set<uint32_t> SpirvEmitter::GetIdsUsedAfter(InsnIterator insn) const
+{
+	std::unordered_set<uint32_t> ids;
+
+	auto addIds = [&](InsnIterator begin, InsnIterator end) {
+		for(auto it = begin; it != end; it++)
+		{
+			for(uint32_t i = 1; i < it.wordCount(); i++)
+			{
+				ids.emplace(it.word(i));
+			}
+		}
+	};
+
+	auto next = insn;
+	next++;
+
+	if(block == Block::ID())
+	{
+		// Still emitting the declarations preceding the first function.
+		addIds(next, shader.end());
+		return ids;
+	}
+
+	addIds(next, shader.getFunction(function).getBlock(block).end());
+
+	// Called functions can be emitted again, while blocks of this function
+	// are only emitted once.
+	for(auto &functionIt : shader.functions)
+	{
+		for(auto &blockIt : functionIt.second.blocks)
+		{
+			if(functionIt.first != function || visited.count(blockIt.first) == 0)
+			{
+				addIds(blockIt.second.begin(), blockIt.second.end());
+			}
+		}
+	}
+
+	return ids;
+}
+
 void SpirvEmitter::SetActiveLaneMask(RValue<SIMD::Int> mask)
 {
 	activeLaneMaskValue = mask.value();
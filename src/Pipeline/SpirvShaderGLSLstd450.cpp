@@ -28,7 +28,7 @@ static constexpr float PI = 3.141592653589793f;
 void SpirvEmitter::EmitExtGLSLstd450(Spirv::InsnIterator insn)
 {
 	auto &type = shader.getType(insn.resultTypeId());
-	auto &dst = createIntermediate(insn.resultId(), type.componentCount);
+	auto &dst = createIntermediate(insn.resultId(), type.componentCount, type.narrowing);
 	auto extInstIndex = static_cast<GLSLstd450>(insn.word(4));
 
 	switch(extInstIndex)
@@ -45,9 +45,10 @@ void SpirvEmitter::EmitExtGLSLstd450(Spirv::InsnIterator insn)
 	case GLSLstd450SAbs:
 		{
 			auto src = Operand(shader, *this, insn.word(5));
+			auto width = shader.getObjectType(insn.word(5)).componentWidth;
 			for(auto i = 0u; i < type.componentCount; i++)
 			{
-				dst.move(i, Abs(src.Int(i)));
+				dst.move(i, Abs(SignExtend(src.Int(i), width)));
 			}
 		}
 		break;
@@ -141,9 +142,10 @@ void SpirvEmitter::EmitExtGLSLstd450(Spirv::InsnIterator insn)
 		{
 			auto lhs = Operand(shader, *this, insn.word(5));
 			auto rhs = Operand(shader, *this, insn.word(6));
+			auto width = shader.getObjectType(insn.word(5)).componentWidth;
 			for(auto i = 0u; i < type.componentCount; i++)
 			{
-				dst.move(i, Min(lhs.Int(i), rhs.Int(i)));
+				dst.move(i, Min(SignExtend(lhs.Int(i), width), SignExtend(rhs.Int(i), width)));
 			}
 		}
 		break;
@@ -151,9 +153,10 @@ void SpirvEmitter::EmitExtGLSLstd450(Spirv::InsnIterator insn)
 		{
 			auto lhs = Operand(shader, *this, insn.word(5));
 			auto rhs = Operand(shader, *this, insn.word(6));
+			auto width = shader.getObjectType(insn.word(5)).componentWidth;
 			for(auto i = 0u; i < type.componentCount; i++)
 			{
-				dst.move(i, Max(lhs.Int(i), rhs.Int(i)));
+				dst.move(i, Max(SignExtend(lhs.Int(i), width), SignExtend(rhs.Int(i), width)));
 			}
 		}
 		break;
@@ -226,9 +229,10 @@ void SpirvEmitter::EmitExtGLSLstd450(Spirv::InsnIterator insn)
 			auto x = Operand(shader, *this, insn.word(5));
 			auto minVal = Operand(shader, *this, insn.word(6));
 			auto maxVal = Operand(shader, *this, insn.word(7));
+			auto width = shader.getObjectType(insn.word(5)).componentWidth;
 			for(auto i = 0u; i < type.componentCount; i++)
 			{
-				dst.move(i, Min(Max(x.Int(i), minVal.Int(i)), maxVal.Int(i)));
+				dst.move(i, Min(Max(SignExtend(x.Int(i), width), SignExtend(minVal.Int(i), width)), SignExtend(maxVal.Int(i), width)));
 			}
 		}
 		break;
@@ -257,10 +261,12 @@ void SpirvEmitter::EmitExtGLSLstd450(Spirv::InsnIterator insn)
 	case GLSLstd450SSign:
 		{
 			auto src = Operand(shader, *this, insn.word(5));
+			auto width = shader.getObjectType(insn.word(5)).componentWidth;
 			for(auto i = 0u; i < type.componentCount; i++)
 			{
-				auto neg = CmpLT(src.Int(i), SIMD::Int(0)) & SIMD::Int(-1);
-				auto pos = CmpNLE(src.Int(i), SIMD::Int(0)) & SIMD::Int(1);
+				auto v = SignExtend(src.Int(i), width);
+				auto neg = CmpLT(v, SIMD::Int(0)) & SIMD::Int(-1);
+				auto pos = CmpNLE(v, SIMD::Int(0)) & SIMD::Int(1);
 				dst.move(i, neg | pos);
 			}
 		}
@@ -873,9 +879,11 @@ void SpirvEmitter::EmitExtGLSLstd450(Spirv::InsnIterator insn)
 	case GLSLstd450FindSMsb:
 		{
 			auto val = Operand(shader, *this, insn.word(5));
+			auto width = shader.getObjectType(insn.word(5)).componentWidth;
 			for(auto i = 0u; i < type.componentCount; i++)
 			{
-				auto v = val.UInt(i) ^ As<SIMD::UInt>(CmpLT(val.Int(i), SIMD::Int(0)));
+				auto s = SignExtend(val.Int(i), width);
+				auto v = As<SIMD::UInt>(s) ^ As<SIMD::UInt>(CmpLT(s, SIMD::Int(0)));
 				dst.move(i, SIMD::UInt(31) - Ctlz(v, false));
 			}
 		}
@@ -883,9 +891,10 @@ void SpirvEmitter::EmitExtGLSLstd450(Spirv::InsnIterator insn)
 	case GLSLstd450FindUMsb:
 		{
 			auto val = Operand(shader, *this, insn.word(5));
+			auto width = shader.getObjectType(insn.word(5)).componentWidth;
 			for(auto i = 0u; i < type.componentCount; i++)
 			{
-				dst.move(i, SIMD::UInt(31) - Ctlz(val.UInt(i), false));
+				dst.move(i, SIMD::UInt(31) - Ctlz(ZeroExtend(val.UInt(i), width), false));
 			}
 		}
 		break;
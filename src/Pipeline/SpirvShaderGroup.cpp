@@ -73,7 +73,7 @@ void SpirvEmitter::EmitGroupNonUniform(InsnIterator insn)
 	auto scope = spv::Scope(shader.GetConstScalarInt(insn.word(3)));
 	ASSERT_MSG(scope == spv::ScopeSubgroup, "Scope for Non Uniform Group Operations must be Subgroup for Vulkan 1.1");
 
-	auto &dst = createIntermediate(resultId, type.componentCount);
+	auto &dst = createIntermediate(resultId, type.componentCount, type.narrowing);
 
 	switch(insn.opcode())
 	{
@@ -74,7 +74,7 @@ static vk::Format SpirvFormatToVulkanFormat(spv::ImageFormat format)
 	}
 }
 
-SpirvEmitter::ImageInstruction::ImageInstruction(InsnIterator insn, const Spirv &shader, const SpirvEmitter &state)
+SpirvEmitter::ImageInstruction::ImageInstruction(InsnIterator insn, const Spirv &shader, const SpirvEmitter *state)
     : ImageInstructionSignature(parseVariantAndMethod(insn))
     , position(insn.distanceFrom(shader.begin()))
 {
@@ -99,12 +99,17 @@ SpirvEmitter::ImageInstruction::ImageInstruction(InsnIterator insn, const Spirv
 			// an externally combined sampler and image.
 			Object::ID sampledImageId = insn.word(3);
 
-			if(state.isSampledImage(sampledImageId))  // Result of an OpSampledImage instruction
+			if(state && state->isSampledImage(sampledImageId))  // Result of an OpSampledImage instruction
 			{
-				const SampledImagePointer &sampledImage = state.getSampledImage(sampledImageId);
+				const SampledImagePointer &sampledImage = state->getSampledImage(sampledImageId);
 				imageId = shader.getObject(sampledImageId).definition.word(3);
 				samplerId = sampledImage.samplerId;
 			}
+			else if(!state && (shader.getObject(sampledImageId).opcode() == spv::OpSampledImage))
+			{
+				imageId = shader.getObject(sampledImageId).definition.word(3);
+				samplerId = shader.getObject(sampledImageId).definition.word(4);
+			}
 			else  // Combined image/sampler
 			{
 				imageId = sampledImageId;
@@ -346,31 +351,63 @@ void SpirvEmitter::EmitImageSample(const ImageInstruction &instruction)
 	for(auto i = 0u; i < resultType.componentCount; i++) { result.move(i, out[i]); }
 }
 
+// Returns a mask of the lanes whose pointer is equal to the pointer of the given lane.
+static SIMD::Int LanesMatching(const SIMD::Pointer &pointer, int lane)
+{
+	if(pointer.isBasePlusOffset)
+	{
+		SIMD::Int offsets = pointer.offsets();
+		return CmpEQ(offsets, SIMD::Int(Extract(offsets, lane)));
+	}
+
+	Pointer<Byte> lanePointer = pointer.getPointerForLane(lane);
+	SIMD::Int matching = 0;
+	for(int i = 0; i < SIMD::Width; i++)
+	{
+		matching = Insert(matching, IfThenElse(pointer.getPointerForLane(i) == lanePointer, Int(-1), Int(0)), i);
+	}
+
+	return matching;
+}
+
 void SpirvEmitter::EmitImageSampleUnconditional(Array<SIMD::Float> &out, const ImageInstruction &instruction) const
 {
 	auto decorations = shader.GetDecorationsForId(instruction.imageId);
 
 	if(decorations.NonUniform)
 	{
-		SIMD::Int activeLaneMask = this->activeLaneMask();
+		// Waterfall loop: sample all lanes which use the same descriptors as the first remaining
+		// active lane with a single SIMD call, and repeat until all active lanes are processed.
+		// In practice most lanes tend to use the same descriptors, requiring only one iteration.
+		SIMD::Int remainingLanes = activeLaneMask();
 		SIMD::Pointer imagePointer = getImage(instruction.imageId);
-		// PerLane output
+		bool separateSampler = (instruction.samplerId != instruction.imageId) && (instruction.samplerId != 0);
+
 		for(int laneIdx = 0; laneIdx < SIMD::Width; laneIdx++)
 		{
-			Array<SIMD::Float> laneOut(out.getArraySize());
-			If(Extract(activeLaneMask, laneIdx) != 0)
+			If(Extract(remainingLanes, laneIdx) != 0)
 			{
 				Pointer<Byte> imageDescriptor = imagePointer.getPointerForLane(laneIdx);  // vk::SampledImageDescriptor*
 				Pointer<Byte> samplerDescriptor = getSamplerDescriptor(imageDescriptor, instruction, laneIdx);
 
+				SIMD::Int matchingLanes = remainingLanes & LanesMatching(imagePointer, laneIdx);
+				if(separateSampler)
+				{
+					matchingLanes &= LanesMatching(getImage(instruction.samplerId), laneIdx);
+				}
+
 				Pointer<Byte> samplerFunction = lookupSamplerFunction(imageDescriptor, samplerDescriptor, instruction);
 
-				callSamplerFunction(samplerFunction, laneOut, imageDescriptor, instruction);
-			}
+				Array<SIMD::Float> groupOut(out.getArraySize());
+				callSamplerFunction(samplerFunction, groupOut, imageDescriptor, instruction);
 
-			for(int outIdx = 0; outIdx < out.getArraySize(); outIdx++)
-			{
-				out[outIdx] = Insert(out[outIdx], Extract(laneOut[outIdx], laneIdx), laneIdx);
+				for(int outIdx = 0; outIdx < out.getArraySize(); outIdx++)
+				{
+					out[outIdx] = As<SIMD::Float>((matchingLanes & As<SIMD::Int>(groupOut[outIdx])) |
+					                              (~matchingLanes & As<SIMD::Int>(out[outIdx])));
+				}
+
+				remainingLanes &= ~matchingLanes;
 			}
 		}
 	}
@@ -379,9 +416,30 @@ void SpirvEmitter::EmitImageSampleUnconditional(Array<SIMD::Float> &out, const I
 		Pointer<Byte> imageDescriptor = getImage(instruction.imageId).getUniformPointer();  // vk::SampledImageDescriptor*
 		Pointer<Byte> samplerDescriptor = getSamplerDescriptor(imageDescriptor, instruction);
 
-		Pointer<Byte> samplerFunction = lookupSamplerFunction(imageDescriptor, samplerDescriptor, instruction);
+		uint32_t immutableSamplerId = getImmutableSamplerId(instruction);
+		uint32_t inlineImageViewId = getInlineSamplingImageViewId(instruction, immutableSamplerId);
+
+		if(inlineImageViewId != 0)
+		{
+			// With an immutable sampler, only the image view's state can differ from the one
+			// bound while generating this routine, so sample inline when it's the same.
+			Int imageViewId = *Pointer<Int>(imageDescriptor + OFFSET(vk::ImageDescriptor, imageViewId));
 
-		callSamplerFunction(samplerFunction, out, imageDescriptor, instruction);
+			If(imageViewId == Int(inlineImageViewId))
+			{
+				emitInlineSampler(getImmutableSamplerState(instruction), inlineImageViewId, out, imageDescriptor, instruction);
+			}
+			Else
+			{
+				Pointer<Byte> samplerFunction = lookupSamplerFunction(imageDescriptor, samplerDescriptor, instruction);
+				callSamplerFunction(samplerFunction, out, imageDescriptor, instruction);
+			}
+		}
+		else
+		{
+			Pointer<Byte> samplerFunction = lookupSamplerFunction(imageDescriptor, samplerDescriptor, instruction);
+			callSamplerFunction(samplerFunction, out, imageDescriptor, instruction);
+		}
 	}
 }
 
@@ -397,10 +455,19 @@ Pointer<Byte> SpirvEmitter::getSamplerDescriptor(Pointer<Byte> imageDescriptor,
 
 Pointer<Byte> SpirvEmitter::lookupSamplerFunction(Pointer<Byte> imageDescriptor, Pointer<Byte> samplerDescriptor, const ImageInstruction &instruction) const
 {
-	Int samplerId = (instruction.samplerId != 0) ? *Pointer<rr::Int>(samplerDescriptor + OFFSET(vk::SampledImageDescriptor, samplerId)) : Int(0);
+	// Immutable samplers are known when compiling the pipeline, so the sampler ID can be
+	// embedded in the routine and only the image view determines the sampling function.
+	uint32_t immutableSamplerId = getImmutableSamplerId(instruction);
+	bool dynamicSampler = (instruction.samplerId != 0) && (immutableSamplerId == 0);
+
+	Int samplerId = dynamicSampler ? *Pointer<rr::Int>(samplerDescriptor + OFFSET(vk::SampledImageDescriptor, samplerId)) : Int(immutableSamplerId);
 
 	auto &cache = routine->samplerCache.at(instruction.position);
-	Bool cacheHit = (cache.imageDescriptor == imageDescriptor) && (cache.samplerId == samplerId);  // TODO(b/205566405): Skip sampler ID check for samplerless instructions.
+	Bool cacheHit = (cache.imageDescriptor == imageDescriptor);
+	if(dynamicSampler)
+	{
+		cacheHit = cacheHit && (cache.samplerId == samplerId);
+	}
 
 	If(!cacheHit)
 	{
@@ -413,10 +480,32 @@ Pointer<Byte> SpirvEmitter::lookupSamplerFunction(Pointer<Byte> imageDescriptor,
 	return cache.function;
 }
 
-void SpirvEmitter::callSamplerFunction(Pointer<Byte> samplerFunction, Array<SIMD::Float> &out, Pointer<Byte> imageDescriptor, const ImageInstruction &instruction) const
+uint32_t SpirvEmitter::getImmutableSamplerId(const ImageInstruction &instruction) const
 {
-	Array<SIMD::Float> in(16);  // Maximum 16 input parameter components.
+	if(instruction.samplerId == 0)
+	{
+		return 0;  // Samplerless instruction
+	}
+
+	auto it = shader.descriptorDecorations.find(instruction.samplerId);
+	if((it == shader.descriptorDecorations.end()) || (it->second.DescriptorSet < 0) || (it->second.Binding < 0))
+	{
+		return 0;
+	}
+
+	return routine->pipelineLayout->getImmutableSamplerId(it->second.DescriptorSet, it->second.Binding);
+}
+
+const vk::SamplerState *SpirvEmitter::getImmutableSamplerState(const ImageInstruction &instruction) const
+{
+	auto it = shader.descriptorDecorations.find(instruction.samplerId);
+	ASSERT(it != shader.descriptorDecorations.end());  // Only called when getImmutableSamplerId() is non-zero
 
+	return routine->pipelineLayout->getImmutableSamplerState(it->second.DescriptorSet, it->second.Binding);
+}
+
+void SpirvEmitter::getSamplerParameters(Array<SIMD::Float> &in, const ImageInstruction &instruction) const
+{
 	auto coordinate = Operand(shader, *this, instruction.coordinateId);
 
 	uint32_t i = 0;
@@ -494,12 +583,30 @@ void SpirvEmitter::callSamplerFunction(Pointer<Byte> samplerFunction, Array<SIMD
 		auto sampleValue = Operand(shader, *this, instruction.sampleId);
 		in[i] = As<SIMD::Float>(sampleValue.Int(0));
 	}
+}
+
+void SpirvEmitter::callSamplerFunction(Pointer<Byte> samplerFunction, Array<SIMD::Float> &out, Pointer<Byte> imageDescriptor, const ImageInstruction &instruction) const
+{
+	Array<SIMD::Float> in(16);  // Maximum 16 input parameter components.
+	getSamplerParameters(in, instruction);
 
 	Pointer<Byte> texture = imageDescriptor + OFFSET(vk::SampledImageDescriptor, texture);  // sw::Texture*
 
 	Call<ImageSampler>(samplerFunction, texture, &in, &out, routine->constants);
 }
 
+void SpirvEmitter::emitInlineSampler(const vk::SamplerState *vkSamplerState, uint32_t imageViewId, Array<SIMD::Float> &out, Pointer<Byte> imageDescriptor, const ImageInstruction &instruction) const
+{
+	Array<SIMD::Float> in(16);  // Maximum 16 input parameter components.
+	getSamplerParameters(in, instruction);
+
+	Pointer<Byte> texture = imageDescriptor + OFFSET(vk::SampledImageDescriptor, texture);  // sw::Texture*
+
+	// The same sampler state as the routine obtained through getImageSampler() uses.
+	Sampler samplerState = getSamplerState(instruction, vkSamplerState, imageViewId);
+	emitSamplerFunction(instruction, samplerState, texture, &in, &out, routine->constants);
+}
+
 void SpirvEmitter::EmitImageQuerySizeLod(InsnIterator insn)
 {
 	auto &resultTy = shader.getType(insn.resultTypeId());
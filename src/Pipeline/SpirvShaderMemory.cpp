@@ -23,6 +23,35 @@
 
 namespace sw {
 
+// Returns true if the element is a 16-bit scalar in explicitly laid out memory.
+// Elsewhere 16-bit values occupy 32-bit slots, like other scalars.
+static bool Is16BitElement(const Spirv::MemoryElement &el, spv::StorageClass storageClass)
+{
+	return Spirv::IsExplicitLayout(storageClass) &&
+	       (el.type.opcode() == spv::OpTypeInt || el.type.opcode() == spv::OpTypeFloat) &&
+	       (el.type.componentWidth == 16);
+}
+
+// Converts 16-bit memory contents to the 32-bit lane representation of the type.
+static SIMD::UInt Widen16(const Spirv::Type &type, SIMD::UInt bits)
+{
+	switch(type.narrowing)
+	{
+	case Intermediate::Narrowing::Float16:
+		return halfToFloatBits(bits);
+	case Intermediate::Narrowing::Int16:
+		return As<SIMD::UInt>((As<SIMD::Int>(bits) << 16) >> 16);
+	default:
+		return bits;
+	}
+}
+
+// Converts the 32-bit lane representation of a 16-bit type to its memory contents.
+static SIMD::UInt Narrow16(const Spirv::Type &type, SIMD::UInt value)
+{
+	return (type.narrowing == Intermediate::Narrowing::Float16) ? halfBitsOf(As<SIMD::Float>(value)) : value;
+}
+
 void SpirvEmitter::EmitLoad(InsnIterator insn)
 {
 	bool atomic = (insn.opcode() == spv::OpAtomicLoad);
@@ -70,7 +99,14 @@ void SpirvEmitter::EmitLoad(InsnIterator insn)
 		auto &dst = createIntermediate(resultId, resultTy.componentCount);
 		shader.VisitMemoryObject(pointerId, false, [&](const Spirv::MemoryElement &el) {
 			auto p = GetElementPointer(ptr, el.offset, pointerTy.storageClass);
-			dst.move(el.index, p.Load<SIMD::Float>(robustness, activeLaneMask(), atomic, memoryOrder));
+			if(Is16BitElement(el, pointerTy.storageClass))
+			{
+				dst.move(el.index, Widen16(el.type, p.Load16(robustness, activeLaneMask())));
+			}
+			else
+			{
+				dst.move(el.index, p.Load<SIMD::Float>(robustness, activeLaneMask(), atomic, memoryOrder));
+			}
 		});
 
 		SPIRV_SHADER_DBG("Load(atomic: {0}, order: {1}, ptr: {2}, val: {3}, mask: {4})", atomic, int(memoryOrder), ptr, dst, activeLaneMask());
@@ -127,7 +163,14 @@ void SpirvEmitter::Store(Object::ID pointerId, const Operand &value, bool atomic
 	{
 		shader.VisitMemoryObject(pointerId, false, [&](const Spirv::MemoryElement &el) {
 			auto p = GetElementPointer(ptr, el.offset, pointerTy.storageClass);
-			p.Store(value.Float(el.index), robustness, mask, atomic, memoryOrder);
+			if(Is16BitElement(el, pointerTy.storageClass))
+			{
+				p.Store16(Narrow16(el.type, value.UInt(el.index)), robustness, mask);
+			}
+			else
+			{
+				p.Store(value.Float(el.index), robustness, mask, atomic, memoryOrder);
+			}
 		});
 	}
 }
@@ -249,7 +292,7 @@ void SpirvEmitter::EmitVariable(InsnIterator insn)
 				{
 					// Initialization of workgroup memory is done by each subgroup and requires waiting on a barrier.
 					// TODO(b/221242292): Initialize just once per workgroup and eliminate the barrier.
-					Yield(YieldResult::ControlBarrier);
+					EmitWorkgroupBarrier(insn);
 				}
 			}
 			break;
@@ -271,8 +314,12 @@ void SpirvEmitter::EmitCopyMemory(InsnIterator insn)
 	auto srcPtr = GetPointerToData(srcPtrId, 0, false);
 
 	std::unordered_map<uint32_t, uint32_t> srcOffsets;
+	std::unordered_map<uint32_t, const Spirv::Type *> src16BitTypes;  // Types of 16-bit elements in explicitly laid out memory
 
-	shader.VisitMemoryObject(srcPtrId, false, [&](const Spirv::MemoryElement &el) { srcOffsets[el.index] = el.offset; });
+	shader.VisitMemoryObject(srcPtrId, false, [&](const Spirv::MemoryElement &el) {
+		srcOffsets[el.index] = el.offset;
+		src16BitTypes[el.index] = Is16BitElement(el, srcPtrTy.storageClass) ? &el.type : nullptr;
+	});
 
 	shader.VisitMemoryObject(dstPtrId, false, [&](const Spirv::MemoryElement &el) {
 		auto it = srcOffsets.find(el.index);
@@ -286,8 +333,34 @@ void SpirvEmitter::EmitCopyMemory(InsnIterator insn)
 		// TODO(b/131224163): Optimize based on src/dst storage classes.
 		auto robustness = OutOfBoundsBehavior::RobustBufferAccess;
 
-		auto value = src.Load<SIMD::Float>(robustness, activeLaneMask());
-		dst.Store(value, robustness, activeLaneMask());
+		auto src16BitType = src16BitTypes[el.index];
+		bool srcIs16 = (src16BitType != nullptr);
+		bool dstIs16 = Is16BitElement(el, dstPtrTy.storageClass);
+
+		if(srcIs16 && dstIs16)
+		{
+			dst.Store16(src.Load16(robustness, activeLaneMask()), robustness, activeLaneMask());
+		}
+		else if(srcIs16 || dstIs16)
+		{
+			// 16-bit values held in 32-bit slots on one side only.
+			SIMD::UInt value = srcIs16 ? Widen16(*src16BitType, src.Load16(robustness, activeLaneMask()))
+			                           : SIMD::UInt(As<SIMD::UInt>(src.Load<SIMD::Float>(robustness, activeLaneMask())));
+
+			if(dstIs16)
+			{
+				dst.Store16(Narrow16(el.type, value), robustness, activeLaneMask());
+			}
+			else
+			{
+				dst.Store(As<SIMD::Float>(value), robustness, activeLaneMask());
+			}
+		}
+		else
+		{
+			auto value = src.Load<SIMD::Float>(robustness, activeLaneMask());
+			dst.Store(value, robustness, activeLaneMask());
+		}
 	});
 }
 
@@ -330,7 +403,7 @@ void Spirv::VisitMemoryObjectInner(Type::ID id, Decorations d, uint32_t &index,
 		break;
 	case spv::OpTypeVector:
 		{
-			auto elemStride = (d.InsideMatrix && d.HasRowMajor && d.RowMajor) ? d.MatrixStride : static_cast<int32_t>(sizeof(float));
+			auto elemStride = (d.InsideMatrix && d.HasRowMajor && d.RowMajor) ? d.MatrixStride : type.componentSize();
 			for(auto i = 0u; i < type.definition.word(3); i++)
 			{
 				VisitMemoryObjectInner(type.definition.word(2), d, index, offset + elemStride * i, resultIsPointer, f);
@@ -339,7 +412,7 @@ void Spirv::VisitMemoryObjectInner(Type::ID id, Decorations d, uint32_t &index,
 		break;
 	case spv::OpTypeMatrix:
 		{
-			auto columnStride = (d.HasRowMajor && d.RowMajor) ? static_cast<int32_t>(sizeof(float)) : d.MatrixStride;
+			auto columnStride = (d.HasRowMajor && d.RowMajor) ? type.componentSize() : d.MatrixStride;
 			d.InsideMatrix = true;
 			for(auto i = 0u; i < type.definition.word(3); i++)
 			{
@@ -21,6 +21,7 @@
 #include "Vulkan/VkDescriptorSetLayout.hpp"
 #include "Vulkan/VkDevice.hpp"
 #include "Vulkan/VkImageView.hpp"
+#include "Vulkan/VkPipelineLayout.hpp"
 #include "Vulkan/VkSampler.hpp"
 
 #include <spirv/unified1/spirv.hpp>
@@ -40,98 +41,257 @@ SpirvEmitter::ImageSampler *SpirvEmitter::getImageSampler(const vk::Device *devi
 
 	auto createSamplingRoutine = [device](const vk::Device::SamplingRoutineCache::Key &key) {
 		ImageInstructionSignature instruction(key.instruction);
-		const vk::Identifier::State imageViewState = vk::Identifier(key.imageView).getState();
 		const vk::SamplerState *vkSamplerState = (key.sampler != 0) ? device->findSampler(key.sampler) : nullptr;
+		Sampler samplerState = getSamplerState(instruction, vkSamplerState, key.imageView);
 
-		auto type = imageViewState.imageViewType;
-		auto samplerMethod = static_cast<SamplerMethod>(instruction.samplerMethod);
+		if(instruction.samplerMethod == Write)
+		{
+			return emitWriteRoutine(instruction, samplerState);
+		}
+
+		return emitSamplerRoutine(instruction, samplerState);
+	};
+
+	vk::Device::SamplingRoutineCache *cache = device->getSamplingRoutineCache();
+	auto routine = cache->getOrCreate(key, createSamplingRoutine);
 
-		Sampler samplerState = {};
-		samplerState.textureType = type;
-		ASSERT(instruction.coordinates >= samplerState.dimensionality());  // "It may be a vector larger than needed, but all unused components appear after all used components."
-		samplerState.textureFormat = imageViewState.format;
+	return (ImageSampler *)(routine->getEntry());
+}
+
+Sampler SpirvEmitter::getSamplerState(ImageInstructionSignature instruction, const vk::SamplerState *vkSamplerState, uint32_t imageViewId)
+{
+	const vk::Identifier::State imageViewState = vk::Identifier(imageViewId).getState();
+
+	auto type = imageViewState.imageViewType;
+	auto samplerMethod = static_cast<SamplerMethod>(instruction.samplerMethod);
 
-		samplerState.addressingModeU = convertAddressingMode(0, vkSamplerState, type);
-		samplerState.addressingModeV = convertAddressingMode(1, vkSamplerState, type);
-		samplerState.addressingModeW = convertAddressingMode(2, vkSamplerState, type);
+	Sampler samplerState = {};
+	samplerState.textureType = type;
+	ASSERT(instruction.coordinates >= samplerState.dimensionality());  // "It may be a vector larger than needed, but all unused components appear after all used components."
+	samplerState.textureFormat = imageViewState.format;
+	samplerState.tiledLayout = imageViewState.tiledLayout;
+
+	samplerState.addressingModeU = convertAddressingMode(0, vkSamplerState, type);
+	samplerState.addressingModeV = convertAddressingMode(1, vkSamplerState, type);
+	samplerState.addressingModeW = convertAddressingMode(2, vkSamplerState, type);
+
+	samplerState.mipmapFilter = convertMipmapMode(vkSamplerState);
+	samplerState.swizzle = imageViewState.mapping;
+	samplerState.gatherComponent = instruction.gatherComponent;
+
+	if(vkSamplerState)
+	{
+		samplerState.textureFilter = convertFilterMode(vkSamplerState, type, samplerMethod);
+		samplerState.border = vkSamplerState->borderColor;
+		samplerState.customBorder = vkSamplerState->customBorderColor;
 
 		samplerState.mipmapFilter = convertMipmapMode(vkSamplerState);
-		samplerState.swizzle = imageViewState.mapping;
-		samplerState.gatherComponent = instruction.gatherComponent;
+		samplerState.highPrecisionFiltering = vkSamplerState->highPrecisionFiltering;
+
+		samplerState.compareEnable = (vkSamplerState->compareEnable != VK_FALSE);
+		samplerState.compareOp = vkSamplerState->compareOp;
+		samplerState.unnormalizedCoordinates = (vkSamplerState->unnormalizedCoordinates != VK_FALSE);
+
+		samplerState.ycbcrModel = vkSamplerState->ycbcrModel;
+		samplerState.studioSwing = vkSamplerState->studioSwing;
+		samplerState.swappedChroma = vkSamplerState->swappedChroma;
+		samplerState.chromaFilter = vkSamplerState->chromaFilter == VK_FILTER_LINEAR ?  FILTER_LINEAR : FILTER_POINT;
+		samplerState.chromaXOffset = vkSamplerState->chromaXOffset;
+		samplerState.chromaYOffset = vkSamplerState->chromaYOffset;
+
+		samplerState.mipLodBias = vkSamplerState->mipLodBias;
+		samplerState.maxAnisotropy = vkSamplerState->maxAnisotropy;
+		samplerState.minLod = vkSamplerState->minLod;
+		samplerState.maxLod = vkSamplerState->maxLod;
+
+		// If there's a single mip level and filtering doesn't depend on the LOD level,
+		// the sampler will need to compute the LOD to produce the proper result.
+		// Otherwise, it can be ignored.
+		// We can skip the LOD computation for all modes, except LOD query,
+		// where we have to return the proper value even if nothing else requires it.
+		if(imageViewState.singleMipLevel &&
+		   (samplerState.textureFilter != FILTER_MIN_POINT_MAG_LINEAR) &&
+		   (samplerState.textureFilter != FILTER_MIN_LINEAR_MAG_POINT) &&
+		   (samplerMethod != Query))
+		{
+			samplerState.minLod = 0.0f;
+			samplerState.maxLod = 0.0f;
+		}
+	}
+	else if(samplerMethod == Fetch)
+	{
+		// OpImageFetch does not take a sampler descriptor, but for VK_EXT_image_robustness
+		// requires replacing invalid texels with zero.
+		// TODO(b/162327166): Only perform bounds checks when VK_EXT_image_robustness is enabled.
+		samplerState.border = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
 
-		if(vkSamplerState)
+		// If there's a single mip level we can skip LOD computation.
+		if(imageViewState.singleMipLevel)
 		{
-			samplerState.textureFilter = convertFilterMode(vkSamplerState, type, samplerMethod);
-			samplerState.border = vkSamplerState->borderColor;
-			samplerState.customBorder = vkSamplerState->customBorderColor;
-
-			samplerState.mipmapFilter = convertMipmapMode(vkSamplerState);
-			samplerState.highPrecisionFiltering = vkSamplerState->highPrecisionFiltering;
-
-			samplerState.compareEnable = (vkSamplerState->compareEnable != VK_FALSE);
-			samplerState.compareOp = vkSamplerState->compareOp;
-			samplerState.unnormalizedCoordinates = (vkSamplerState->unnormalizedCoordinates != VK_FALSE);
-
-			samplerState.ycbcrModel = vkSamplerState->ycbcrModel;
-			samplerState.studioSwing = vkSamplerState->studioSwing;
-			samplerState.swappedChroma = vkSamplerState->swappedChroma;
-			samplerState.chromaFilter = vkSamplerState->chromaFilter == VK_FILTER_LINEAR ?  FILTER_LINEAR : FILTER_POINT;
-			samplerState.chromaXOffset = vkSamplerState->chromaXOffset;
-			samplerState.chromaYOffset = vkSamplerState->chromaYOffset;
-
-			samplerState.mipLodBias = vkSamplerState->mipLodBias;
-			samplerState.maxAnisotropy = vkSamplerState->maxAnisotropy;
-			samplerState.minLod = vkSamplerState->minLod;
-			samplerState.maxLod = vkSamplerState->maxLod;
-
-			// If there's a single mip level and filtering doesn't depend on the LOD level,
-			// the sampler will need to compute the LOD to produce the proper result.
-			// Otherwise, it can be ignored.
-			// We can skip the LOD computation for all modes, except LOD query,
-			// where we have to return the proper value even if nothing else requires it.
-			if(imageViewState.singleMipLevel &&
-			   (samplerState.textureFilter != FILTER_MIN_POINT_MAG_LINEAR) &&
-			   (samplerState.textureFilter != FILTER_MIN_LINEAR_MAG_POINT) &&
-			   (samplerMethod != Query))
-			{
-				samplerState.minLod = 0.0f;
-				samplerState.maxLod = 0.0f;
-			}
+			samplerState.minLod = 0.0f;
+			samplerState.maxLod = 0.0f;
 		}
-		else if(samplerMethod == Fetch)
+		// Otherwise make sure LOD is clamped for robustness
+		else
 		{
-			// OpImageFetch does not take a sampler descriptor, but for VK_EXT_image_robustness
-			// requires replacing invalid texels with zero.
-			// TODO(b/162327166): Only perform bounds checks when VK_EXT_image_robustness is enabled.
-			samplerState.border = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+			samplerState.minLod = imageViewState.minLod;
+			samplerState.maxLod = imageViewState.maxLod;
+		}
+	}
+	else
+		ASSERT(samplerMethod == Write);
 
-			// If there's a single mip level we can skip LOD computation.
-			if(imageViewState.singleMipLevel)
-			{
-				samplerState.minLod = 0.0f;
-				samplerState.maxLod = 0.0f;
-			}
-			// Otherwise make sure LOD is clamped for robustness
-			else
-			{
-				samplerState.minLod = imageViewState.minLod;
-				samplerState.maxLod = imageViewState.maxLod;
-			}
+	return samplerState;
+}
+
+// Returns whether image views of the given type can be accessed by image instructions with the given dimensionality.
+static bool IsCompatibleImageViewType(spv::Dim dim, bool arrayed, VkImageViewType imageViewType)
+{
+	switch(dim)
+	{
+	case spv::Dim1D:
+		return imageViewType == (arrayed ? VK_IMAGE_VIEW_TYPE_1D_ARRAY : VK_IMAGE_VIEW_TYPE_1D);
+	case spv::Dim2D:
+	case spv::DimSubpassData:
+		return imageViewType == (arrayed ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D);
+	case spv::Dim3D:
+		return !arrayed && (imageViewType == VK_IMAGE_VIEW_TYPE_3D);
+	case spv::DimCube:
+		return imageViewType == (arrayed ? VK_IMAGE_VIEW_TYPE_CUBE_ARRAY : VK_IMAGE_VIEW_TYPE_CUBE);
+	default:
+		return false;
+	}
+}
+
+std::vector<SpirvEmitter::SamplingRoutineUse> SpirvEmitter::GetSamplingRoutineUses(const SpirvShader &shader)
+{
+	std::vector<SamplingRoutineUse> uses;
+
+	for(auto insn : shader)
+	{
+		switch(insn.opcode())
+		{
+		case spv::OpImageSampleImplicitLod:
+		case spv::OpImageSampleExplicitLod:
+		case spv::OpImageSampleDrefImplicitLod:
+		case spv::OpImageSampleDrefExplicitLod:
+		case spv::OpImageSampleProjImplicitLod:
+		case spv::OpImageSampleProjExplicitLod:
+		case spv::OpImageSampleProjDrefImplicitLod:
+		case spv::OpImageSampleProjDrefExplicitLod:
+		case spv::OpImageGather:
+		case spv::OpImageDrefGather:
+		case spv::OpImageFetch:
+		case spv::OpImageQueryLod:
+		case spv::OpImageWrite:
+			break;
+		default:
+			continue;
 		}
-		else if(samplerMethod == Write)
+
+		ImageInstruction instruction(insn, shader, nullptr);
+
+		// Image writes only use a sampling routine when the format isn't declared by the shader.
+		if((instruction.samplerMethod == Write) && (instruction.imageFormat != spv::ImageFormatUnknown))
 		{
-			return emitWriteRoutine(instruction, samplerState);
+			continue;
 		}
-		else
-			ASSERT(false);
 
-		return emitSamplerRoutine(instruction, samplerState);
-	};
+		auto image = shader.descriptorDecorations.find(instruction.imageId);
+		if(image == shader.descriptorDecorations.end() || (image->second.DescriptorSet < 0) || (image->second.Binding < 0))
+		{
+			continue;
+		}
 
-	vk::Device::SamplingRoutineCache *cache = device->getSamplingRoutineCache();
-	auto routine = cache->getOrCreate(key, createSamplingRoutine);
+		SamplingRoutineUse use = { instruction.signature, image->second.DescriptorSet, image->second.Binding, -1, -1 };
 
-	return (ImageSampler *)(routine->getEntry());
+		if(instruction.samplerId != 0)
+		{
+			auto sampler = shader.descriptorDecorations.find(instruction.samplerId);
+			if(sampler == shader.descriptorDecorations.end())
+			{
+				continue;  // The sampler's descriptor can't be determined statically
+			}
+
+			use.samplerSet = sampler->second.DescriptorSet;
+			use.samplerBinding = sampler->second.Binding;
+		}
+
+		uses.push_back(use);
+	}
+
+	return uses;
+}
+
+void SpirvEmitter::PrecompileImageSampler(const vk::Device *device, uint32_t signature, uint32_t samplerId, uint32_t imageViewId)
+{
+	ImageInstructionSignature instruction(signature);
+	const vk::Identifier::State imageViewState = vk::Identifier(imageViewId).getState();
+
+	// The written descriptor may not actually be used with the shaders the signature
+	// was obtained from, so only compile routines for matching image view types.
+	if(!IsCompatibleImageViewType(static_cast<spv::Dim>(instruction.dim), instruction.arrayed != 0, imageViewState.imageViewType))
+	{
+		return;
+	}
+
+	if((samplerId == 0) && (instruction.samplerMethod != Fetch) && (instruction.samplerMethod != Write))
+	{
+		return;
+	}
+
+	if((samplerId != 0) && !device->findSampler(samplerId))
+	{
+		return;  // The sampler has already been destroyed
+	}
+
+	getImageSampler(device, signature, samplerId, imageViewId);
+}
+
+uint32_t SpirvEmitter::getInlineSamplingImageViewId(const ImageInstruction &instruction, uint32_t immutableSamplerId) const
+{
+	if(immutableSamplerId == 0)
+	{
+		return 0;
+	}
+
+	auto it = shader.descriptorDecorations.find(instruction.imageId);
+	if((it == shader.descriptorDecorations.end()) || (it->second.DescriptorSet < 0) || (it->second.Binding < 0))
+	{
+		return 0;
+	}
+
+	uint32_t set = it->second.DescriptorSet;
+	uint32_t binding = it->second.Binding;
+
+	// Descriptor arrays can be indexed dynamically, so only single descriptors are predictable.
+	if((set >= vk::MAX_BOUND_DESCRIPTOR_SETS) || !descriptorSets[set] ||
+	   (routine->pipelineLayout->getDescriptorCount(set, binding) != 1))
+	{
+		return 0;
+	}
+
+	switch(routine->pipelineLayout->getDescriptorType(set, binding))
+	{
+	case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+	case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+		break;
+	default:
+		return 0;
+	}
+
+	// The descriptor bound while the routine is being generated is the one most likely to be
+	// used by it. Its image view ID is zero when it hasn't been written.
+	const uint8_t *descriptor = descriptorSets[set] + routine->pipelineLayout->getBindingOffset(set, binding);
+	uint32_t imageViewId = reinterpret_cast<const vk::ImageDescriptor *>(descriptor)->imageViewId;
+
+	if((imageViewId == 0) ||
+	   !IsCompatibleImageViewType(static_cast<spv::Dim>(instruction.dim), instruction.arrayed != 0, vk::Identifier(imageViewId).getState().imageViewType))
+	{
+		return 0;
+	}
+
+	return imageViewId;
 }
 
 std::shared_ptr<rr::Routine> SpirvEmitter::emitWriteRoutine(ImageInstructionSignature instruction, const Sampler &samplerState)
@@ -160,116 +320,121 @@ std::shared_ptr<rr::Routine> SpirvEmitter::emitSamplerRoutine(ImageInstructionSi
 		Pointer<SIMD::Float> out = function.Arg<2>();
 		Pointer<Byte> constants = function.Arg<3>();
 
-		SIMD::Float uvwa[4];
-		SIMD::Float dRef;
-		SIMD::Float lodOrBias;  // Explicit level-of-detail, or bias added to the implicit level-of-detail (depending on samplerMethod).
-		SIMD::Float dsx[4];
-		SIMD::Float dsy[4];
-		SIMD::Int offset[4];
-		SIMD::Int sampleId;
-		SamplerFunction samplerFunction = instruction.getSamplerFunction();
-
-		uint32_t i = 0;
-		for(; i < instruction.coordinates; i++)
-		{
-			uvwa[i] = in[i];
-		}
+		emitSamplerFunction(instruction, samplerState, texture, in, out, constants);
+	}
 
-		if(instruction.isDref())
-		{
-			dRef = in[i];
-			i++;
-		}
+	return function("sampler");
+}
 
-		if(instruction.samplerMethod == Lod || instruction.samplerMethod == Bias || instruction.samplerMethod == Fetch)
-		{
-			lodOrBias = in[i];
-			i++;
-		}
-		else if(instruction.samplerMethod == Grad)
-		{
-			for(uint32_t j = 0; j < instruction.grad; j++, i++)
-			{
-				dsx[j] = in[i];
-			}
+void SpirvEmitter::emitSamplerFunction(ImageInstructionSignature instruction, const Sampler &samplerState, Pointer<Byte> texture, Pointer<SIMD::Float> in, Pointer<SIMD::Float> out, Pointer<Byte> constants)
+{
+	SIMD::Float uvwa[4];
+	SIMD::Float dRef;
+	SIMD::Float lodOrBias;  // Explicit level-of-detail, or bias added to the implicit level-of-detail (depending on samplerMethod).
+	SIMD::Float dsx[4];
+	SIMD::Float dsy[4];
+	SIMD::Int offset[4];
+	SIMD::Int sampleId;
+	SamplerFunction samplerFunction = instruction.getSamplerFunction();
+
+	uint32_t i = 0;
+	for(; i < instruction.coordinates; i++)
+	{
+		uvwa[i] = in[i];
+	}
 
-			for(uint32_t j = 0; j < instruction.grad; j++, i++)
-			{
-				dsy[j] = in[i];
-			}
-		}
+	if(instruction.isDref())
+	{
+		dRef = in[i];
+		i++;
+	}
 
-		for(uint32_t j = 0; j < instruction.offset; j++, i++)
+	if(instruction.samplerMethod == Lod || instruction.samplerMethod == Bias || instruction.samplerMethod == Fetch)
+	{
+		lodOrBias = in[i];
+		i++;
+	}
+	else if(instruction.samplerMethod == Grad)
+	{
+		for(uint32_t j = 0; j < instruction.grad; j++, i++)
 		{
-			offset[j] = As<SIMD::Int>(in[i]);
+			dsx[j] = in[i];
 		}
 
-		if(instruction.sample)
+		for(uint32_t j = 0; j < instruction.grad; j++, i++)
 		{
-			sampleId = As<SIMD::Int>(in[i]);
+			dsy[j] = in[i];
 		}
+	}
 
-		SamplerCore s(constants, samplerState, samplerFunction);
+	for(uint32_t j = 0; j < instruction.offset; j++, i++)
+	{
+		offset[j] = As<SIMD::Int>(in[i]);
+	}
 
-		// For explicit-lod instructions the LOD can be different per SIMD lane. SamplerCore currently assumes
-		// a single LOD per four elements, so we sample the image again for each LOD separately.
-		// TODO(b/133868964) Pass down 4 component lodOrBias, dsx, and dsy to sampleTexture
-		if(samplerFunction.method == Lod || samplerFunction.method == Grad ||
-		   samplerFunction.method == Bias || samplerFunction.method == Fetch)
+	if(instruction.sample)
+	{
+		sampleId = As<SIMD::Int>(in[i]);
+	}
+
+	SamplerCore s(constants, samplerState, samplerFunction);
+
+	// For explicit-lod instructions the LOD can be different per SIMD lane. SamplerCore currently assumes
+	// a single LOD per four elements, so we sample the image again for each LOD separately.
+	// TODO(b/133868964) Pass down 4 component lodOrBias, dsx, and dsy to sampleTexture
+	if(samplerFunction.method == Lod || samplerFunction.method == Grad ||
+	   samplerFunction.method == Bias || samplerFunction.method == Fetch)
+	{
+		// Only perform per-lane sampling if LOD diverges or we're doing Grad sampling.
+		Bool perLaneSampling = (samplerFunction.method == Grad) || Divergent(As<SIMD::Int>(lodOrBias));
+		auto lod = Pointer<Float>(&lodOrBias);
+		Int i = 0;
+		Do
 		{
-			// Only perform per-lane sampling if LOD diverges or we're doing Grad sampling.
-			Bool perLaneSampling = (samplerFunction.method == Grad) || Divergent(As<SIMD::Int>(lodOrBias));
-			auto lod = Pointer<Float>(&lodOrBias);
-			Int i = 0;
-			Do
+			SIMD::Float dPdx;
+			SIMD::Float dPdy;
+			dPdx.x = Pointer<Float>(&dsx[0])[i];
+			dPdx.y = Pointer<Float>(&dsx[1])[i];
+			dPdx.z = Pointer<Float>(&dsx[2])[i];
+
+			dPdy.x = Pointer<Float>(&dsy[0])[i];
+			dPdy.y = Pointer<Float>(&dsy[1])[i];
+			dPdy.z = Pointer<Float>(&dsy[2])[i];
+
+			SIMD::Float4 sample = s.sampleTexture(texture, uvwa, dRef, lod[i], dPdx, dPdy, offset, sampleId);
+
+			If(perLaneSampling)
 			{
-				SIMD::Float dPdx;
-				SIMD::Float dPdy;
-				dPdx.x = Pointer<Float>(&dsx[0])[i];
-				dPdx.y = Pointer<Float>(&dsx[1])[i];
-				dPdx.z = Pointer<Float>(&dsx[2])[i];
-
-				dPdy.x = Pointer<Float>(&dsy[0])[i];
-				dPdy.y = Pointer<Float>(&dsy[1])[i];
-				dPdy.z = Pointer<Float>(&dsy[2])[i];
-
-				SIMD::Float4 sample = s.sampleTexture(texture, uvwa, dRef, lod[i], dPdx, dPdy, offset, sampleId);
-
-				If(perLaneSampling)
-				{
-					Pointer<Float> rgba = out;
-					rgba[0 * SIMD::Width + i] = Pointer<Float>(&sample.x)[i];
-					rgba[1 * SIMD::Width + i] = Pointer<Float>(&sample.y)[i];
-					rgba[2 * SIMD::Width + i] = Pointer<Float>(&sample.z)[i];
-					rgba[3 * SIMD::Width + i] = Pointer<Float>(&sample.w)[i];
-					i++;
-				}
-				Else
-				{
-					Pointer<SIMD::Float> rgba = out;
-					rgba[0] = sample.x;
-					rgba[1] = sample.y;
-					rgba[2] = sample.z;
-					rgba[3] = sample.w;
-					i = SIMD::Width;
-				}
+				Pointer<Float> rgba = out;
+				rgba[0 * SIMD::Width + i] = Pointer<Float>(&sample.x)[i];
+				rgba[1 * SIMD::Width + i] = Pointer<Float>(&sample.y)[i];
+				rgba[2 * SIMD::Width + i] = Pointer<Float>(&sample.z)[i];
+				rgba[3 * SIMD::Width + i] = Pointer<Float>(&sample.w)[i];
+				i++;
+			}
+			Else
+			{
+				Pointer<SIMD::Float> rgba = out;
+				rgba[0] = sample.x;
+				rgba[1] = sample.y;
+				rgba[2] = sample.z;
+				rgba[3] = sample.w;
+				i = SIMD::Width;
 			}
-			Until(i == SIMD::Width);
-		}
-		else
-		{
-			Float lod = Float(lodOrBias.x);
-			SIMD::Float4 sample = s.sampleTexture(texture, uvwa, dRef, lod, (dsx[0]), (dsy[0]), offset, sampleId);
-
-			Pointer<SIMD::Float> rgba = out;
-			rgba[0] = sample.x;
-			rgba[1] = sample.y;
-			rgba[2] = sample.z;
-			rgba[3] = sample.w;
 		}
+		Until(i == SIMD::Width);
+	}
+	else
+	{
+		Float lod = Float(lodOrBias.x);
+		SIMD::Float4 sample = s.sampleTexture(texture, uvwa, dRef, lod, (dsx[0]), (dsy[0]), offset, sampleId);
+
+		Pointer<SIMD::Float> rgba = out;
+		rgba[0] = sample.x;
+		rgba[1] = sample.y;
+		rgba[2] = sample.z;
+		rgba[3] = sample.w;
 	}
-
-	return function("sampler");
 }
 
 sw::FilterType SpirvEmitter::convertFilterMode(const vk::SamplerState *samplerState, VkImageViewType imageViewType, SamplerMethod samplerMethod)
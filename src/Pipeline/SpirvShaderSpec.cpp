@@ -14,10 +14,39 @@
 
 #include "SpirvShader.hpp"
 
+#include "System/Half.hpp"
+
 #include <spirv/unified1/spirv.hpp>
 
 namespace sw {
 
+uint32_t Spirv::NarrowConstant(const Type &type, uint32_t value)
+{
+	switch(type.narrowing)
+	{
+	case Intermediate::Narrowing::Float16:
+		return bit_cast<uint32_t>(static_cast<float>(half(bit_cast<float>(value))));
+	case Intermediate::Narrowing::Int16:
+		return static_cast<uint32_t>(static_cast<int32_t>(static_cast<int16_t>(value)));
+	case Intermediate::Narrowing::UInt16:
+		return value & 0xFFFF;
+	default:
+		return value;
+	}
+}
+
+// Reinterprets a 16-bit integer constant, held extended according to the
+// signedness of its type, as either signed or unsigned.
+static uint32_t Extend16(const Spirv::Type &type, uint32_t value, bool isSigned)
+{
+	if(type.componentWidth != 16)
+	{
+		return value;
+	}
+
+	return isSigned ? static_cast<uint32_t>(static_cast<int32_t>(static_cast<int16_t>(value))) : (value & 0xFFFF);
+}
+
 void Spirv::EvalSpecConstantOp(InsnIterator insn)
 {
 	auto opcode = static_cast<spv::Op>(insn.word(3));
@@ -159,7 +188,8 @@ void Spirv::EvalSpecConstantUnaryOp(InsnIterator insn)
 
 	auto opcode = static_cast<spv::Op>(insn.word(3));
 	const auto &lhs = getObject(insn.word(4));
-	auto size = getType(lhs).componentCount;
+	auto &lhsType = getType(lhs);
+	auto size = lhsType.componentCount;
 
 	for(auto i = 0u; i < size; i++)
 	{
@@ -169,9 +199,13 @@ void Spirv::EvalSpecConstantUnaryOp(InsnIterator insn)
 		switch(opcode)
 		{
 		case spv::OpSConvert:
-		case spv::OpFConvert:
+			v = Extend16(lhsType, l, true);
+			break;
 		case spv::OpUConvert:
-			UNREACHABLE("Not possible until we have multiple bit widths");
+			v = Extend16(lhsType, l, false);
+			break;
+		case spv::OpFConvert:
+			v = l;
 			break;
 
 		case spv::OpSNegate:
@@ -200,6 +234,8 @@ void Spirv::EvalSpecConstantUnaryOp(InsnIterator insn)
 		default:
 			UNREACHABLE("EvalSpecConstantUnaryOp op: %s", OpcodeName(opcode));
 		}
+
+		v = NarrowConstant(getType(result), v);
 	}
 }
 
@@ -210,13 +246,31 @@ void Spirv::EvalSpecConstantBinaryOp(InsnIterator insn)
 	auto opcode = static_cast<spv::Op>(insn.word(3));
 	const auto &lhs = getObject(insn.word(4));
 	const auto &rhs = getObject(insn.word(5));
-	auto size = getType(lhs).componentCount;
+	auto &lhsType = getType(lhs);
+	auto size = lhsType.componentCount;
+
+	bool isSigned = false;
+	switch(opcode)
+	{
+	case spv::OpSDiv:
+	case spv::OpSRem:
+	case spv::OpSMod:
+	case spv::OpShiftRightArithmetic:
+	case spv::OpSLessThan:
+	case spv::OpSGreaterThan:
+	case spv::OpSLessThanEqual:
+	case spv::OpSGreaterThanEqual:
+		isSigned = true;
+		break;
+	default:
+		break;
+	}
 
 	for(auto i = 0u; i < size; i++)
 	{
 		auto &v = result.constantValue[i];
-		auto l = lhs.constantValue[i];
-		auto r = rhs.constantValue[i];
+		auto l = Extend16(lhsType, lhs.constantValue[i], isSigned);
+		auto r = Extend16(getType(rhs), rhs.constantValue[i], isSigned);
 
 		switch(opcode)
 		{
@@ -308,6 +362,8 @@ void Spirv::EvalSpecConstantBinaryOp(InsnIterator insn)
 		default:
 			UNREACHABLE("EvalSpecConstantBinaryOp op: %s", OpcodeName(opcode));
 		}
+
+		v = NarrowConstant(getType(result), v);
 	}
 }
 
@@ -23,6 +23,29 @@
 #include "System/Half.hpp"
 #include "Vulkan/VkDevice.hpp"
 
+namespace {
+
+// Vertex records are read as a whole, for all the attributes they contain, up to this size.
+constexpr int MAX_RECORD_DWORDS = 16;
+
+void setMissingComponents(sw::Vector4f &v, int componentCount, bool bgra, bool isNativeFloatAttrib)
+{
+	if(bgra)
+	{
+		// Swap red and blue
+		rr::Float4 t = v.x;
+		v.x = v.z;
+		v.z = t;
+	}
+
+	if(componentCount < 1) v.x = rr::Float4(0.0f);
+	if(componentCount < 2) v.y = rr::Float4(0.0f);
+	if(componentCount < 3) v.z = rr::Float4(0.0f);
+	if(componentCount < 4) v.w = isNativeFloatAttrib ? rr::As<rr::Float4>(rr::Float4(1.0f)) : rr::As<rr::Float4>(rr::Int4(1));
+}
+
+}  // anonymous namespace
+
 namespace sw {
 
 VertexRoutine::VertexRoutine(
@@ -32,6 +55,7 @@ VertexRoutine::VertexRoutine(
     : routine(pipelineLayout)
     , state(state)
     , spirvShader(spirvShader)
+    , vertexStride(VertexStride(spirvShader->getOutputInterfaceSize()))
 {
 	spirvShader->emitProlog(&routine);
 }
@@ -42,14 +66,28 @@ VertexRoutine::~VertexRoutine()
 
 void VertexRoutine::generate()
 {
-	Pointer<Byte> cache = task + OFFSET(VertexTask, vertexCache);
-	Pointer<Byte> vertexCache = cache + OFFSET(VertexCache, vertex);
-	Pointer<UInt> tagCache = Pointer<UInt>(cache + OFFSET(VertexCache, tag));
-
 	UInt vertexCount = *Pointer<UInt>(task + OFFSET(VertexTask, vertexCount));
 
 	constants = device + OFFSET(vk::Device, constants);
 
+	if(state.deduplicateVertices)
+	{
+		generateDeduplicated(vertexCount);
+	}
+	else
+	{
+		generateCached(vertexCount);
+	}
+
+	Return();
+}
+
+void VertexRoutine::generateCached(UInt &vertexCount)
+{
+	Pointer<Byte> cache = task + OFFSET(VertexTask, vertexCache);
+	Pointer<Byte> vertexCache = cache + OFFSET(VertexCache, vertex);
+	Pointer<UInt> tagCache = Pointer<UInt>(cache + OFFSET(VertexCache, tag));
+
 	// Check the cache one vertex index at a time. If a hit occurs, copy from the cache to the 'vertex' output buffer.
 	// On a cache miss, process a SIMD width of consecutive indices from the input batch. They're written to the cache
 	// in reverse order to guarantee that the first one doesn't get evicted and can be written out.
@@ -69,46 +107,254 @@ void VertexRoutine::generate()
 			writeCache(vertexCache, tagCache, batch);
 		}
 
-		Pointer<Byte> cacheEntry = vertexCache + cacheIndex * UInt((int)sizeof(Vertex));
+		Pointer<Byte> cacheEntry = vertexCache + cacheIndex * UInt(vertexStride);
 
 		// For points, vertexCount is 1 per primitive, so duplicate vertex for all 3 vertices of the primitive
 		for(int i = 0; i < (state.isPoint ? 3 : 1); i++)
 		{
 			writeVertex(vertex, cacheEntry);
-			vertex += sizeof(Vertex);
+			vertex += vertexStride;
 		}
 
 		batch = Pointer<UInt>(Pointer<Byte>(batch) + sizeof(uint32_t));
 		vertexCount--;
 	}
 	Until(vertexCount == 0);
+}
 
-	Return();
+void VertexRoutine::generateDeduplicated(UInt &vertexCount)
+{
+	// The batch holds the distinct vertex indices, which get shaded in dense SIMD groups. Each
+	// result is written to the output vertex of its first occurrence, and then copied to the
+	// output vertices of all other occurrences. The lanes past the last distinct vertex of the
+	// final group repeat it, so they store the same results to its output vertex again.
+	Pointer<Byte> deduplication = task + OFFSET(VertexTask, deduplication);
+	Pointer<UInt> slot = Pointer<UInt>(deduplication + OFFSET(VertexDeduplication, slot));
+	Pointer<UInt> source = Pointer<UInt>(deduplication + OFFSET(VertexDeduplication, source));
+
+	UInt uniqueCount = *Pointer<UInt>(deduplication + OFFSET(VertexDeduplication, uniqueCount));
+
+	Do
+	{
+		readInput(batch);
+		program(batch, uniqueCount);
+		computeClipFlags();
+		computeCullMask();
+
+		Pointer<Byte> entries[4] = {
+			vertex + vertexStride * slot[0],
+			vertex + vertexStride * slot[1],
+			vertex + vertexStride * slot[2],
+			vertex + vertexStride * slot[3],
+		};
+
+		writeOutputs(entries);
+
+		batch = Pointer<UInt>(Pointer<Byte>(batch) + 4 * sizeof(uint32_t));
+		slot = Pointer<UInt>(Pointer<Byte>(slot) + 4 * sizeof(uint32_t));
+		uniqueCount -= Min(uniqueCount, UInt(4));
+	}
+	Until(uniqueCount == 0);
+
+	Pointer<Byte> output = vertex;
+
+	For(UInt i = 0, i < vertexCount, i++)
+	{
+		UInt sourceIndex = source[i];
+
+		If(sourceIndex != i)
+		{
+			Pointer<Byte> sourceVertex = vertex + vertexStride * sourceIndex;
+			writeVertex(output, sourceVertex);
+		}
+
+		output += vertexStride;
+	}
 }
 
 void VertexRoutine::readInput(Pointer<UInt> &batch)
 {
-	for(int i = 0; i < MAX_INTERFACE_COMPONENTS; i += 4)
+	constexpr int attributeCount = MAX_INTERFACE_COMPONENTS / 4;
+
+	bool used[attributeCount];
+	bool read[attributeCount] = {};
+
+	for(int i = 0; i < attributeCount; i++)
+	{
+		used[i] = spirvShader->inputs[4 * i + 0].Type != Spirv::ATTRIBTYPE_UNUSED ||
+		          spirvShader->inputs[4 * i + 1].Type != Spirv::ATTRIBTYPE_UNUSED ||
+		          spirvShader->inputs[4 * i + 2].Type != Spirv::ATTRIBTYPE_UNUSED ||
+		          spirvShader->inputs[4 * i + 3].Type != Spirv::ATTRIBTYPE_UNUSED;
+	}
+
+	for(int i = 0; i < attributeCount; i++)
 	{
-		if(spirvShader->inputs[i + 0].Type != Spirv::ATTRIBTYPE_UNUSED ||
-		   spirvShader->inputs[i + 1].Type != Spirv::ATTRIBTYPE_UNUSED ||
-		   spirvShader->inputs[i + 2].Type != Spirv::ATTRIBTYPE_UNUSED ||
-		   spirvShader->inputs[i + 3].Type != Spirv::ATTRIBTYPE_UNUSED)
+		if(!used[i] || read[i])
 		{
-			Pointer<Byte> input = *Pointer<Pointer<Byte>>(data + OFFSET(DrawData, input) + sizeof(void *) * (i / 4));
-			UInt stride = *Pointer<UInt>(data + OFFSET(DrawData, stride) + sizeof(uint32_t) * (i / 4));
+			continue;
+		}
+
+		// Attributes sourced from the same binding are fetched together, by reading their
+		// vertex records once. This is skipped when each attribute needs its own bounds check.
+		if(!state.robustBufferAccess && state.input[i])
+		{
+			auto sameBinding = [&](int j) {
+				return used[j] && !read[j] && state.input[j] && (state.input[j].binding == state.input[i].binding);
+			};
+
+			int lead = i;  // Attribute at the lowest offset, where the records get read from.
+			for(int j = i + 1; j < attributeCount; j++)
+			{
+				if(sameBinding(j) && (state.input[j].offset < state.input[lead].offset))
+				{
+					lead = j;
+				}
+			}
+
+			bool attributes[attributeCount] = {};
+			int dwordCount = 0;
+			for(int j = i; j < attributeCount; j++)
+			{
+				int offset = state.input[j].offset - state.input[lead].offset;
+				int end = offset + vk::Format(state.input[j].format).bytes();
+
+				if(sameBinding(j) && (offset % 4 == 0) && (end <= MAX_RECORD_DWORDS * 4))
+				{
+					attributes[j] = true;
+					dwordCount = std::max(dwordCount, (end + 3) / 4);
+				}
+			}
+
+			readRecords(attributes, lead, dwordCount, batch);
+
+			for(int j = i; j < attributeCount; j++)
+			{
+				read[j] = read[j] || attributes[j];
+			}
+		}
+
+		if(!read[i])
+		{
+			Pointer<Byte> input = *Pointer<Pointer<Byte>>(data + OFFSET(DrawData, input) + sizeof(void *) * i);
+			UInt stride = *Pointer<UInt>(data + OFFSET(DrawData, stride) + sizeof(uint32_t) * i);
 			Int baseVertex = *Pointer<Int>(data + OFFSET(DrawData, baseVertex));
 			UInt robustnessSize(0);
 			if(state.robustBufferAccess)
 			{
-				robustnessSize = *Pointer<UInt>(data + OFFSET(DrawData, robustnessSize) + sizeof(uint32_t) * (i / 4));
+				robustnessSize = *Pointer<UInt>(data + OFFSET(DrawData, robustnessSize) + sizeof(uint32_t) * i);
 			}
 
-			auto value = readStream(input, stride, state.input[i / 4], batch, state.robustBufferAccess, robustnessSize, baseVertex);
-			routine.inputs[i + 0] = value.x;
-			routine.inputs[i + 1] = value.y;
-			routine.inputs[i + 2] = value.z;
-			routine.inputs[i + 3] = value.w;
+			auto value = readStream(input, stride, state.input[i], batch, state.robustBufferAccess, robustnessSize, baseVertex);
+			routine.inputs[4 * i + 0] = value.x;
+			routine.inputs[4 * i + 1] = value.y;
+			routine.inputs[4 * i + 2] = value.z;
+			routine.inputs[4 * i + 3] = value.w;
+
+			read[i] = true;
+		}
+	}
+}
+
+void VertexRoutine::readRecords(const bool attributes[], int lead, int dwordCount, Pointer<UInt> &batch)
+{
+	Pointer<Byte> buffer = *Pointer<Pointer<Byte>>(data + OFFSET(DrawData, input) + sizeof(void *) * lead);
+	UInt stride = *Pointer<UInt>(data + OFFSET(DrawData, stride) + sizeof(uint32_t) * lead);
+	Int baseVertex = *Pointer<Int>(data + OFFSET(DrawData, baseVertex));
+
+	UInt4 offsets = (*Pointer<UInt4>(As<Pointer<UInt4>>(batch)) + As<UInt4>(Int4(baseVertex))) * UInt4(stride);
+
+	// Gaps between the attributes don't get read.
+	bool usedDwords[MAX_RECORD_DWORDS] = {};
+	for(int i = 0; i < MAX_INTERFACE_COMPONENTS / 4; i++)
+	{
+		if(attributes[i])
+		{
+			int offset = state.input[i].offset - state.input[lead].offset;
+			int end = offset + vk::Format(state.input[i].format).bytes();
+
+			for(int d = offset / 4; d < (end + 3) / 4; d++)
+			{
+				usedDwords[d] = true;
+			}
+		}
+	}
+
+	// Dword d of the records of all four vertices.
+	Int4 columns[MAX_RECORD_DWORDS];
+
+	if(Caps::gatherIsFast())
+	{
+		SIMD::Int gatherOffsets = Insert128(SIMD::Int(0), As<Int4>(offsets), 0);
+
+		for(int d = 0; d < dwordCount; d++)
+		{
+			if(usedDwords[d])
+			{
+				columns[d] = Extract128(rr::Gather(Pointer<Int>(buffer + 4 * d), gatherOffsets, SIMD::Int(-1), 1), 0);
+			}
+		}
+	}
+	else
+	{
+		Pointer<Byte> source[4] = {
+			buffer + offsets.x,
+			buffer + offsets.y,
+			buffer + offsets.z,
+			buffer + offsets.w,
+		};
+
+		// Load up to four dwords of each record at a time, and transpose them into columns.
+		for(int d = 0; d < dwordCount; d += 4)
+		{
+			int n = std::min(dwordCount - d, 4);
+
+			if(!usedDwords[d] && !(n > 1 && usedDwords[d + 1]) && !(n > 2 && usedDwords[d + 2]) && !(n > 3 && usedDwords[d + 3]))
+			{
+				continue;
+			}
+
+			Float4 row[4];
+			for(int k = 0; k < 4; k++)
+			{
+				Pointer<Byte> record = source[k] + 4 * d;
+
+				switch(n)
+				{
+				case 1:
+					row[k] = As<Float4>(Insert(Int4(0), *Pointer<Int>(record), 0));
+					break;
+				case 2:
+					row[k] = As<Float4>(Int4(*Pointer<Int2>(record), Int2(0, 0)));
+					break;
+				case 3:
+					row[k] = As<Float4>(Insert(Int4(*Pointer<Int2>(record), Int2(0, 0)), *Pointer<Int>(record + 8), 2));
+					break;
+				default:
+					row[k] = *Pointer<Float4>(record);
+					break;
+				}
+			}
+
+			transpose4xN(row[0], row[1], row[2], row[3], n);
+
+			for(int k = 0; k < n; k++)
+			{
+				columns[d + k] = As<Int4>(row[k]);
+			}
+		}
+	}
+
+	for(int i = 0; i < MAX_INTERFACE_COMPONENTS / 4; i++)
+	{
+		if(attributes[i])
+		{
+			int offset = state.input[i].offset - state.input[lead].offset;
+
+			auto value = readColumns(columns + offset / 4, state.input[i]);
+			routine.inputs[4 * i + 0] = value.x;
+			routine.inputs[4 * i + 1] = value.y;
+			routine.inputs[4 * i + 2] = value.z;
+			routine.inputs[4 * i + 3] = value.w;
 		}
 	}
 }
@@ -551,18 +797,201 @@ Vector4f VertexRoutine::readStream(Pointer<Byte> &buffer, UInt &stride, const St
 		UNSUPPORTED("stream.format %d", int(stream.format));
 	}
 
-	if(bgra)
+	setMissingComponents(v, componentCount, bgra, isNativeFloatAttrib);
+
+	return v;
+}
+
+Vector4f VertexRoutine::readColumns(const Int4 *dwords, const Stream &stream)
+{
+	Vector4f v;
+
+	vk::Format format(stream.format);
+
+	int componentCount = format.componentCount();
+	bool normalized = !format.isUnnormalizedInteger();
+	bool isNativeFloatAttrib = (stream.attribType == Spirv::ATTRIBTYPE_FLOAT) || normalized;
+	bool bgra = false;
+
+	// Zero or sign extended components of 8 and 16 bit formats.
+	auto ubyte = [&](int i) { return As<Int4>((As<UInt4>(dwords[0]) >> (8 * i)) & UInt4(0xFF)); };
+	auto sbyte = [&](int i) { return (dwords[0] << (24 - 8 * i)) >> 24; };
+	auto ushort = [&](int i) { return As<Int4>((As<UInt4>(dwords[i / 2]) >> (16 * (i % 2))) & UInt4(0xFFFF)); };
+	auto sshort = [&](int i) { return (dwords[i / 2] << (16 - 16 * (i % 2))) >> 16; };
+
+	switch(stream.format)
 	{
-		// Swap red and blue
-		Float4 t = v.x;
-		v.x = v.z;
-		v.z = t;
+	case VK_FORMAT_R32_SFLOAT:
+	case VK_FORMAT_R32G32_SFLOAT:
+	case VK_FORMAT_R32G32B32_SFLOAT:
+	case VK_FORMAT_R32G32B32A32_SFLOAT:
+	case VK_FORMAT_R32_SINT:
+	case VK_FORMAT_R32G32_SINT:
+	case VK_FORMAT_R32G32B32_SINT:
+	case VK_FORMAT_R32G32B32A32_SINT:
+	case VK_FORMAT_R32_UINT:
+	case VK_FORMAT_R32G32_UINT:
+	case VK_FORMAT_R32G32B32_UINT:
+	case VK_FORMAT_R32G32B32A32_UINT:
+		for(int i = 0; i < componentCount; i++)
+		{
+			v[i] = As<Float4>(dwords[i]);
+		}
+		break;
+	case VK_FORMAT_B8G8R8A8_UNORM:
+		bgra = true;
+		// [[fallthrough]]
+	case VK_FORMAT_R8_UNORM:
+	case VK_FORMAT_R8G8_UNORM:
+	case VK_FORMAT_R8G8B8A8_UNORM:
+	case VK_FORMAT_A8B8G8R8_UNORM_PACK32:
+		for(int i = 0; i < componentCount; i++)
+		{
+			v[i] = Float4(ubyte(i)) * Float4(1.0f / 0xFF);
+		}
+		break;
+	case VK_FORMAT_R8_UINT:
+	case VK_FORMAT_R8G8_UINT:
+	case VK_FORMAT_R8G8B8A8_UINT:
+	case VK_FORMAT_A8B8G8R8_UINT_PACK32:
+		for(int i = 0; i < componentCount; i++)
+		{
+			v[i] = As<Float4>(ubyte(i));
+		}
+		break;
+	case VK_FORMAT_R8_SNORM:
+	case VK_FORMAT_R8G8_SNORM:
+	case VK_FORMAT_R8G8B8A8_SNORM:
+	case VK_FORMAT_A8B8G8R8_SNORM_PACK32:
+		for(int i = 0; i < componentCount; i++)
+		{
+			v[i] = Max(Float4(sbyte(i)) * Float4(1.0f / 0x7F), Float4(-1.0f));
+		}
+		break;
+	case VK_FORMAT_R8_USCALED:
+	case VK_FORMAT_R8G8_USCALED:
+	case VK_FORMAT_R8G8B8A8_USCALED:
+	case VK_FORMAT_A8B8G8R8_USCALED_PACK32:
+		for(int i = 0; i < componentCount; i++)
+		{
+			v[i] = Float4(ubyte(i));
+		}
+		break;
+	case VK_FORMAT_R8_SSCALED:
+	case VK_FORMAT_R8G8_SSCALED:
+	case VK_FORMAT_R8G8B8A8_SSCALED:
+	case VK_FORMAT_A8B8G8R8_SSCALED_PACK32:
+		for(int i = 0; i < componentCount; i++)
+		{
+			v[i] = Float4(sbyte(i));
+		}
+		break;
+	case VK_FORMAT_R8_SINT:
+	case VK_FORMAT_R8G8_SINT:
+	case VK_FORMAT_R8G8B8A8_SINT:
+	case VK_FORMAT_A8B8G8R8_SINT_PACK32:
+		for(int i = 0; i < componentCount; i++)
+		{
+			v[i] = As<Float4>(sbyte(i));
+		}
+		break;
+	case VK_FORMAT_R16_UNORM:
+	case VK_FORMAT_R16G16_UNORM:
+	case VK_FORMAT_R16G16B16A16_UNORM:
+		for(int i = 0; i < componentCount; i++)
+		{
+			v[i] = Float4(ushort(i)) * Float4(1.0f / 0xFFFF);
+		}
+		break;
+	case VK_FORMAT_R16_SNORM:
+	case VK_FORMAT_R16G16_SNORM:
+	case VK_FORMAT_R16G16B16A16_SNORM:
+		for(int i = 0; i < componentCount; i++)
+		{
+			v[i] = Max(Float4(sshort(i)) * Float4(1.0f / 0x7FFF), Float4(-1.0f));
+		}
+		break;
+	case VK_FORMAT_R16_USCALED:
+	case VK_FORMAT_R16G16_USCALED:
+	case VK_FORMAT_R16G16B16A16_USCALED:
+		for(int i = 0; i < componentCount; i++)
+		{
+			v[i] = Float4(ushort(i));
+		}
+		break;
+	case VK_FORMAT_R16_SSCALED:
+	case VK_FORMAT_R16G16_SSCALED:
+	case VK_FORMAT_R16G16B16A16_SSCALED:
+		for(int i = 0; i < componentCount; i++)
+		{
+			v[i] = Float4(sshort(i));
+		}
+		break;
+	case VK_FORMAT_R16_SINT:
+	case VK_FORMAT_R16G16_SINT:
+	case VK_FORMAT_R16G16B16A16_SINT:
+		for(int i = 0; i < componentCount; i++)
+		{
+			v[i] = As<Float4>(sshort(i));
+		}
+		break;
+	case VK_FORMAT_R16_UINT:
+	case VK_FORMAT_R16G16_UINT:
+	case VK_FORMAT_R16G16B16A16_UINT:
+		for(int i = 0; i < componentCount; i++)
+		{
+			v[i] = As<Float4>(ushort(i));
+		}
+		break;
+	case VK_FORMAT_R16_SFLOAT:
+	case VK_FORMAT_R16G16_SFLOAT:
+	case VK_FORMAT_R16G16B16A16_SFLOAT:
+		for(int i = 0; i < componentCount; i++)
+		{
+			v[i] = As<Float4>(halfToFloatBits(As<UInt4>(ushort(i))));
+		}
+		break;
+	case VK_FORMAT_A2R10G10B10_SNORM_PACK32:
+		bgra = true;
+		// [[fallthrough]]
+	case VK_FORMAT_A2B10G10R10_SNORM_PACK32:
+		v.x = Max(Float4((dwords[0] << 22) >> 22) * Float4(1.0f / 0x1FF), Float4(-1.0f));
+		v.y = Max(Float4((dwords[0] << 12) >> 22) * Float4(1.0f / 0x1FF), Float4(-1.0f));
+		v.z = Max(Float4((dwords[0] << 02) >> 22) * Float4(1.0f / 0x1FF), Float4(-1.0f));
+		v.w = Max(Float4(dwords[0] >> 30), Float4(-1.0f));
+		break;
+	case VK_FORMAT_A2R10G10B10_SINT_PACK32:
+		bgra = true;
+		// [[fallthrough]]
+	case VK_FORMAT_A2B10G10R10_SINT_PACK32:
+		v.x = As<Float4>((dwords[0] << 22) >> 22);
+		v.y = As<Float4>((dwords[0] << 12) >> 22);
+		v.z = As<Float4>((dwords[0] << 02) >> 22);
+		v.w = As<Float4>(dwords[0] >> 30);
+		break;
+	case VK_FORMAT_A2R10G10B10_UNORM_PACK32:
+		bgra = true;
+		// [[fallthrough]]
+	case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+		v.x = Float4(dwords[0] & Int4(0x3FF)) * Float4(1.0f / 0x3FF);
+		v.y = Float4((dwords[0] >> 10) & Int4(0x3FF)) * Float4(1.0f / 0x3FF);
+		v.z = Float4((dwords[0] >> 20) & Int4(0x3FF)) * Float4(1.0f / 0x3FF);
+		v.w = Float4((dwords[0] >> 30) & Int4(0x3)) * Float4(1.0f / 0x3);
+		break;
+	case VK_FORMAT_A2R10G10B10_UINT_PACK32:
+		bgra = true;
+		// [[fallthrough]]
+	case VK_FORMAT_A2B10G10R10_UINT_PACK32:
+		v.x = As<Float4>(dwords[0] & Int4(0x3FF));
+		v.y = As<Float4>((dwords[0] >> 10) & Int4(0x3FF));
+		v.z = As<Float4>((dwords[0] >> 20) & Int4(0x3FF));
+		v.w = As<Float4>((dwords[0] >> 30) & Int4(0x3));
+		break;
+	default:
+		UNSUPPORTED("stream.format %d", int(stream.format));
 	}
 
-	if(componentCount < 1) v.x = Float4(0.0f);
-	if(componentCount < 2) v.y = Float4(0.0f);
-	if(componentCount < 3) v.z = Float4(0.0f);
-	if(componentCount < 4) v.w = isNativeFloatAttrib ? As<Float4>(Float4(1.0f)) : As<Float4>(Int4(1));
+	setMissingComponents(v, componentCount, bgra, isNativeFloatAttrib);
 
 	return v;
 }
@@ -588,6 +1017,22 @@ void VertexRoutine::writeCache(Pointer<Byte> &vertexCache, Pointer<UInt> &tagCac
 	tagCache[cacheIndex1] = index1;
 	tagCache[cacheIndex0] = index0;
 
+	Pointer<Byte> entries[4] = {
+		vertexCache + vertexStride * cacheIndex0,
+		vertexCache + vertexStride * cacheIndex1,
+		vertexCache + vertexStride * cacheIndex2,
+		vertexCache + vertexStride * cacheIndex3,
+	};
+
+	writeOutputs(entries);
+}
+
+void VertexRoutine::writeOutputs(Pointer<Byte> entries[4])
+{
+	ASSERT(SIMD::Width == 4);
+
+	// Entries may alias when the same vertex occupies multiple lanes, which is harmless since
+	// their outputs are identical. The first lane's entry is written last.
 	auto it = spirvShader->outputBuiltins.find(spv::BuiltInPosition);
 	if(it != spirvShader->outputBuiltins.end())
 	{
@@ -616,15 +1061,15 @@ void VertexRoutine::writeCache(Pointer<Byte> &vertexCache, Pointer<UInt> &tagCac
 		Float4 pos_w = Extract128(pos.w, 0);
 		transpose4x4(pos_x, pos_y, pos_z, pos_w);
 
-		*Pointer<Float4>(vertexCache + sizeof(Vertex) * cacheIndex3 + OFFSET(Vertex, position), 16) = pos_w;
-		*Pointer<Float4>(vertexCache + sizeof(Vertex) * cacheIndex2 + OFFSET(Vertex, position), 16) = pos_z;
-		*Pointer<Float4>(vertexCache + sizeof(Vertex) * cacheIndex1 + OFFSET(Vertex, position), 16) = pos_y;
-		*Pointer<Float4>(vertexCache + sizeof(Vertex) * cacheIndex0 + OFFSET(Vertex, position), 16) = pos_x;
+		*Pointer<Float4>(entries[3] + OFFSET(Vertex, position), 16) = pos_w;
+		*Pointer<Float4>(entries[2] + OFFSET(Vertex, position), 16) = pos_z;
+		*Pointer<Float4>(entries[1] + OFFSET(Vertex, position), 16) = pos_y;
+		*Pointer<Float4>(entries[0] + OFFSET(Vertex, position), 16) = pos_x;
 
-		*Pointer<Int>(vertexCache + sizeof(Vertex) * cacheIndex3 + OFFSET(Vertex, clipFlags)) = Extract(clipFlags, 3);
-		*Pointer<Int>(vertexCache + sizeof(Vertex) * cacheIndex2 + OFFSET(Vertex, clipFlags)) = Extract(clipFlags, 2);
-		*Pointer<Int>(vertexCache + sizeof(Vertex) * cacheIndex1 + OFFSET(Vertex, clipFlags)) = Extract(clipFlags, 1);
-		*Pointer<Int>(vertexCache + sizeof(Vertex) * cacheIndex0 + OFFSET(Vertex, clipFlags)) = Extract(clipFlags, 0);
+		*Pointer<Int>(entries[3] + OFFSET(Vertex, clipFlags)) = Extract(clipFlags, 3);
+		*Pointer<Int>(entries[2] + OFFSET(Vertex, clipFlags)) = Extract(clipFlags, 2);
+		*Pointer<Int>(entries[1] + OFFSET(Vertex, clipFlags)) = Extract(clipFlags, 1);
+		*Pointer<Int>(entries[0] + OFFSET(Vertex, clipFlags)) = Extract(clipFlags, 0);
 
 		Float4 proj_x = Extract128(proj.x, 0);
 		Float4 proj_y = Extract128(proj.y, 0);
@@ -632,10 +1077,10 @@ void VertexRoutine::writeCache(Pointer<Byte> &vertexCache, Pointer<UInt> &tagCac
 		Float4 proj_w = Extract128(proj.w, 0);
 		transpose4x4(proj_x, proj_y, proj_z, proj_w);
 
-		*Pointer<Float4>(vertexCache + sizeof(Vertex) * cacheIndex3 + OFFSET(Vertex, projected), 16) = proj_w;
-		*Pointer<Float4>(vertexCache + sizeof(Vertex) * cacheIndex2 + OFFSET(Vertex, projected), 16) = proj_z;
-		*Pointer<Float4>(vertexCache + sizeof(Vertex) * cacheIndex1 + OFFSET(Vertex, projected), 16) = proj_y;
-		*Pointer<Float4>(vertexCache + sizeof(Vertex) * cacheIndex0 + OFFSET(Vertex, projected), 16) = proj_x;
+		*Pointer<Float4>(entries[3] + OFFSET(Vertex, projected), 16) = proj_w;
+		*Pointer<Float4>(entries[2] + OFFSET(Vertex, projected), 16) = proj_z;
+		*Pointer<Float4>(entries[1] + OFFSET(Vertex, projected), 16) = proj_y;
+		*Pointer<Float4>(entries[0] + OFFSET(Vertex, projected), 16) = proj_x;
 	}
 
 	it = spirvShader->outputBuiltins.find(spv::BuiltInPointSize);
@@ -644,10 +1089,10 @@ void VertexRoutine::writeCache(Pointer<Byte> &vertexCache, Pointer<UInt> &tagCac
 		ASSERT(it->second.SizeInComponents == 1);
 		auto psize = routine.getVariable(it->second.Id)[it->second.FirstComponent];
 
-		*Pointer<Float>(vertexCache + sizeof(Vertex) * cacheIndex3 + OFFSET(Vertex, pointSize)) = Extract(psize, 3);
-		*Pointer<Float>(vertexCache + sizeof(Vertex) * cacheIndex2 + OFFSET(Vertex, pointSize)) = Extract(psize, 2);
-		*Pointer<Float>(vertexCache + sizeof(Vertex) * cacheIndex1 + OFFSET(Vertex, pointSize)) = Extract(psize, 1);
-		*Pointer<Float>(vertexCache + sizeof(Vertex) * cacheIndex0 + OFFSET(Vertex, pointSize)) = Extract(psize, 0);
+		*Pointer<Float>(entries[3] + OFFSET(Vertex, pointSize)) = Extract(psize, 3);
+		*Pointer<Float>(entries[2] + OFFSET(Vertex, pointSize)) = Extract(psize, 2);
+		*Pointer<Float>(entries[1] + OFFSET(Vertex, pointSize)) = Extract(psize, 1);
+		*Pointer<Float>(entries[0] + OFFSET(Vertex, pointSize)) = Extract(psize, 0);
 	}
 
 	it = spirvShader->outputBuiltins.find(spv::BuiltInClipDistance);
@@ -657,10 +1102,10 @@ void VertexRoutine::writeCache(Pointer<Byte> &vertexCache, Pointer<UInt> &tagCac
 		for(unsigned int i = 0; i < count; i++)
 		{
 			auto dist = routine.getVariable(it->second.Id)[it->second.FirstComponent + i];
-			*Pointer<Float>(vertexCache + sizeof(Vertex) * cacheIndex3 + OFFSET(Vertex, clipDistance[i])) = Extract(dist, 3);
-			*Pointer<Float>(vertexCache + sizeof(Vertex) * cacheIndex2 + OFFSET(Vertex, clipDistance[i])) = Extract(dist, 2);
-			*Pointer<Float>(vertexCache + sizeof(Vertex) * cacheIndex1 + OFFSET(Vertex, clipDistance[i])) = Extract(dist, 1);
-			*Pointer<Float>(vertexCache + sizeof(Vertex) * cacheIndex0 + OFFSET(Vertex, clipDistance[i])) = Extract(dist, 0);
+			*Pointer<Float>(entries[3] + OFFSET(Vertex, clipDistance[i])) = Extract(dist, 3);
+			*Pointer<Float>(entries[2] + OFFSET(Vertex, clipDistance[i])) = Extract(dist, 2);
+			*Pointer<Float>(entries[1] + OFFSET(Vertex, clipDistance[i])) = Extract(dist, 1);
+			*Pointer<Float>(entries[0] + OFFSET(Vertex, clipDistance[i])) = Extract(dist, 0);
 		}
 	}
 
@@ -671,17 +1116,17 @@ void VertexRoutine::writeCache(Pointer<Byte> &vertexCache, Pointer<UInt> &tagCac
 		for(unsigned int i = 0; i < count; i++)
 		{
 			auto dist = routine.getVariable(it->second.Id)[it->second.FirstComponent + i];
-			*Pointer<Float>(vertexCache + sizeof(Vertex) * cacheIndex3 + OFFSET(Vertex, cullDistance[i])) = Extract(dist, 3);
-			*Pointer<Float>(vertexCache + sizeof(Vertex) * cacheIndex2 + OFFSET(Vertex, cullDistance[i])) = Extract(dist, 2);
-			*Pointer<Float>(vertexCache + sizeof(Vertex) * cacheIndex1 + OFFSET(Vertex, cullDistance[i])) = Extract(dist, 1);
-			*Pointer<Float>(vertexCache + sizeof(Vertex) * cacheIndex0 + OFFSET(Vertex, cullDistance[i])) = Extract(dist, 0);
+			*Pointer<Float>(entries[3] + OFFSET(Vertex, cullDistance[i])) = Extract(dist, 3);
+			*Pointer<Float>(entries[2] + OFFSET(Vertex, cullDistance[i])) = Extract(dist, 2);
+			*Pointer<Float>(entries[1] + OFFSET(Vertex, cullDistance[i])) = Extract(dist, 1);
+			*Pointer<Float>(entries[0] + OFFSET(Vertex, cullDistance[i])) = Extract(dist, 0);
 		}
 	}
 
-	*Pointer<Int>(vertexCache + sizeof(Vertex) * cacheIndex3 + OFFSET(Vertex, cullMask)) = -((cullMask >> 3) & 1);
-	*Pointer<Int>(vertexCache + sizeof(Vertex) * cacheIndex2 + OFFSET(Vertex, cullMask)) = -((cullMask >> 2) & 1);
-	*Pointer<Int>(vertexCache + sizeof(Vertex) * cacheIndex1 + OFFSET(Vertex, cullMask)) = -((cullMask >> 1) & 1);
-	*Pointer<Int>(vertexCache + sizeof(Vertex) * cacheIndex0 + OFFSET(Vertex, cullMask)) = -((cullMask >> 0) & 1);
+	*Pointer<Int>(entries[3] + OFFSET(Vertex, cullMask)) = -((cullMask >> 3) & 1);
+	*Pointer<Int>(entries[2] + OFFSET(Vertex, cullMask)) = -((cullMask >> 2) & 1);
+	*Pointer<Int>(entries[1] + OFFSET(Vertex, cullMask)) = -((cullMask >> 1) & 1);
+	*Pointer<Int>(entries[0] + OFFSET(Vertex, cullMask)) = -((cullMask >> 0) & 1);
 
 	for(int i = 0; i < MAX_INTERFACE_COMPONENTS; i += 4)
 	{
@@ -698,10 +1143,10 @@ void VertexRoutine::writeCache(Pointer<Byte> &vertexCache, Pointer<UInt> &tagCac
 
 			transpose4x4(v.x, v.y, v.z, v.w);
 
-			*Pointer<Float4>(vertexCache + sizeof(Vertex) * cacheIndex3 + OFFSET(Vertex, v[i]), 16) = v.w;
-			*Pointer<Float4>(vertexCache + sizeof(Vertex) * cacheIndex2 + OFFSET(Vertex, v[i]), 16) = v.z;
-			*Pointer<Float4>(vertexCache + sizeof(Vertex) * cacheIndex1 + OFFSET(Vertex, v[i]), 16) = v.y;
-			*Pointer<Float4>(vertexCache + sizeof(Vertex) * cacheIndex0 + OFFSET(Vertex, v[i]), 16) = v.x;
+			*Pointer<Float4>(entries[3] + OFFSET(Vertex, v[i]), 16) = v.w;
+			*Pointer<Float4>(entries[2] + OFFSET(Vertex, v[i]), 16) = v.z;
+			*Pointer<Float4>(entries[1] + OFFSET(Vertex, v[i]), 16) = v.y;
+			*Pointer<Float4>(entries[0] + OFFSET(Vertex, v[i]), 16) = v.x;
 		}
 	}
 }
@@ -66,18 +66,25 @@ protected:
 
 	const VertexProcessor::State &state;
 	const SpirvShader *const spirvShader;
+	const int vertexStride;  // Size of the vertex records, in bytes
 
 private:
 	virtual void program(Pointer<UInt> &batch, UInt &vertexCount) = 0;
 
+	void generateCached(UInt &vertexCount);
+	void generateDeduplicated(UInt &vertexCount);
+
 	typedef VertexProcessor::State::Input Stream;
 
 	Vector4f readStream(Pointer<Byte> &buffer, UInt &stride, const Stream &stream, Pointer<UInt> &batch,
 	                    bool robustBufferAccess, UInt &robustnessSize, Int baseVertex);
+	void readRecords(const bool attributes[], int lead, int dwordCount, Pointer<UInt> &batch);
+	Vector4f readColumns(const Int4 *columns, const Stream &stream);
 	void readInput(Pointer<UInt> &batch);
 	void computeClipFlags();
 	void computeCullMask();
 	void writeCache(Pointer<Byte> &vertexCache, Pointer<UInt> &tagCache, Pointer<UInt> &batch);
+	void writeOutputs(Pointer<Byte> entries[4]);
 	void writeVertex(const Pointer<Byte> &vertex, Pointer<Byte> &cacheEntry);
 };
 
@@ -987,14 +987,14 @@ JITBuilder::JITBuilder()
 	msanInstrumentation = getPragmaState(MemorySanitizerInstrumentation);
 }
 
-void JITBuilder::runPasses()
+uint32_t JITBuilder::passes() const
 {
-#if defined(ENABLE_RR_LLVM_IR_VERIFICATION) || !defined(NDEBUG)
-	if(llvm::verifyModule(*module, &llvm::errs()))
+	uint32_t passes = 0;
+
+	if(coroutine.id)
 	{
-		llvm::report_fatal_error("Invalid LLVM module");
+		passes |= CoroutinePasses;
 	}
-#endif
 
 	int optimizationLevel = getPragmaState(OptimizationLevel);
 
@@ -1005,6 +1005,35 @@ void JITBuilder::runPasses()
 	}
 #endif  // ENABLE_RR_DEBUG_INFO
 
+	if(optimizationLevel > 0)
+	{
+		passes |= SROAPass | InstCombinePass;
+	}
+
+	if(__has_feature(memory_sanitizer) && msanInstrumentation)
+	{
+		passes |= MemorySanitizerPass;
+	}
+
+	if(__has_feature(address_sanitizer) && ADDRESS_SANITIZER_INSTRUMENTATION_SUPPORTED)
+	{
+		passes |= AddressSanitizerPass;
+	}
+
+	return passes;
+}
+
+void JITBuilder::runPasses()
+{
+#if defined(ENABLE_RR_LLVM_IR_VERIFICATION) || !defined(NDEBUG)
+	if(llvm::verifyModule(*module, &llvm::errs()))
+	{
+		llvm::report_fatal_error("Invalid LLVM module");
+	}
+#endif
+
+	const uint32_t enabled = passes();
+
 #if LLVM_VERSION_MAJOR >= 13  // New pass manager
 	llvm::LoopAnalysisManager lam;
 	llvm::FunctionAnalysisManager fam;
@@ -1021,15 +1050,19 @@ void JITBuilder::runPasses()
 	llvm::ModulePassManager pm;
 	llvm::FunctionPassManager fpm;
 
-	if(coroutine.id)
+	if(enabled & CoroutinePasses)
 	{
 		// Adds mandatory coroutine transforms.
 		pm = pb.buildO0DefaultPipeline(llvm::OptimizationLevel::O0);
 	}
 
-	if(optimizationLevel > 0)
+	if(enabled & SROAPass)
 	{
 		fpm.addPass(llvm::SROAPass(llvm::SROAOptions::PreserveCFG));
+	}
+
+	if(enabled & InstCombinePass)
+	{
 		fpm.addPass(llvm::InstCombinePass());
 	}
 
@@ -1038,13 +1071,13 @@ void JITBuilder::runPasses()
 		pm.addPass(llvm::createModuleToFunctionPassAdaptor(std::move(fpm)));
 	}
 
-	if(__has_feature(memory_sanitizer) && msanInstrumentation)
+	if(enabled & MemorySanitizerPass)
 	{
 		llvm::MemorySanitizerOptions msanOpts(0 /* TrackOrigins */, false /* Recover */, false /* Kernel */, true /* EagerChecks */);
 		pm.addPass(llvm::MemorySanitizerPass(msanOpts));
 	}
 
-	if(__has_feature(address_sanitizer) && ADDRESS_SANITIZER_INSTRUMENTATION_SUPPORTED)
+	if(enabled & AddressSanitizerPass)
 	{
 		pm.addPass(llvm::AddressSanitizerPass(llvm::AddressSanitizerOptions{}));
 	}
@@ -1053,7 +1086,7 @@ void JITBuilder::runPasses()
 #else  // Legacy pass manager
 	llvm::legacy::PassManager passManager;
 
-	if(coroutine.id)
+	if(enabled & CoroutinePasses)
 	{
 		// Run mandatory coroutine transforms.
 		passManager.add(llvm::createCoroEarlyLegacyPass());
@@ -1063,19 +1096,23 @@ void JITBuilder::runPasses()
 		passManager.add(llvm::createCoroCleanupLegacyPass());
 	}
 
-	if(optimizationLevel > 0)
+	if(enabled & SROAPass)
 	{
 		passManager.add(llvm::createSROAPass());
+	}
+
+	if(enabled & InstCombinePass)
+	{
 		passManager.add(llvm::createInstructionCombiningPass());
 	}
 
-	if(__has_feature(memory_sanitizer) && msanInstrumentation)
+	if(enabled & MemorySanitizerPass)
 	{
 		llvm::MemorySanitizerOptions msanOpts(0 /* TrackOrigins */, false /* Recover */, false /* Kernel */);
 		passManager.add(llvm::createMemorySanitizerLegacyPassPass(msanOpts));
 	}
 
-	if(__has_feature(address_sanitizer) && ADDRESS_SANITIZER_INSTRUMENTATION_SUPPORTED)
+	if(enabled & AddressSanitizerPass)
 	{
 		passManager.add(llvm::createAddressSanitizerFunctionPass());
 	}
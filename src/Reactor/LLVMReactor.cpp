@@ -20,6 +20,7 @@
 #include "PragmaInternals.hpp"
 #include "Print.hpp"
 #include "Reactor.hpp"
+#include "RoutineDeduplicator.hpp"
 #include "SIMD.hpp"
 #include "x86.hpp"
 
@@ -399,6 +400,14 @@ bool Caps::fmaIsFast()
 	return AVX2;
 }
 
+bool Caps::gatherIsFast()
+{
+	static bool AVX2 = CPUID::supportsAVX2();
+
+	// LLVM lowers masked gathers to vpgatherdd / vgatherdps when AVX2 is available, and scalarizes them otherwise.
+	return AVX2;
+}
+
 // The abstract Type* types are implemented as LLVM types, except that
 // 64-bit vectors are emulated using 128-bit ones to avoid use of MMX in x86
 // and VFP in ARM, and eliminate the overhead of converting them to explicit
@@ -540,6 +549,431 @@ Nucleus::~Nucleus()
 	jit = nullptr;
 }
 
+namespace {
+
+// Returns the alignment of a memory access in bytes. Depending on the LLVM version
+// and the instruction, alignments are either Align or MaybeAlign.
+uint64_t AlignmentValue(llvm::Align align)
+{
+	return align.value();
+}
+
+uint64_t AlignmentValue(llvm::MaybeAlign align)
+{
+	return align ? align->value() : 0;
+}
+
+// ModuleHasher adds the structure of an LLVM module to an IRHasher, without printing
+// it to text. Local values are numbered in the order they're defined, and types and
+// constants are hashed by content, since each routine is built in its own context.
+// Anything the hasher doesn't know about makes it return false, in which case the
+// routine is not deduplicated.
+class ModuleHasher
+{
+public:
+	ModuleHasher(IRHasher &hasher)
+	    : hasher(hasher)
+	{}
+
+	bool addModule(const llvm::Module &module)
+	{
+		if(!module.global_empty() || !module.alias_empty() || !module.ifunc_empty())
+		{
+			return false;
+		}
+
+		hasher.add(module.size());
+		for(const llvm::Function &function : module)
+		{
+			if(!addFunction(function))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+private:
+	enum OperandTag : uint64_t
+	{
+		LocalOperand = 1,
+		FunctionOperand,
+		ConstantOperand,
+	};
+
+	void addString(llvm::StringRef string)
+	{
+		hasher.add(string.size());
+		hasher.add(string.data(), string.size());
+	}
+
+	void addAttributes(const llvm::AttributeList &attributes, unsigned argCount)
+	{
+		addString(attributes.getAsString(llvm::AttributeList::FunctionIndex));
+		addString(attributes.getAsString(llvm::AttributeList::ReturnIndex));
+
+		for(unsigned i = 0; i < argCount; i++)
+		{
+			addString(attributes.getAsString(llvm::AttributeList::FirstArgIndex + i));
+		}
+	}
+
+	// Pointee types of typed pointers aren't hashed. They don't affect code generation
+	// on their own, and every instruction which accesses memory hashes the type it uses.
+	void addType(const llvm::Type *type)
+	{
+		hasher.add(type->getTypeID());
+
+		if(auto *integerType = llvm::dyn_cast<llvm::IntegerType>(type))
+		{
+			hasher.add(integerType->getBitWidth());
+		}
+		else if(auto *vectorType = llvm::dyn_cast<llvm::FixedVectorType>(type))
+		{
+			hasher.add(vectorType->getNumElements());
+			addType(vectorType->getElementType());
+		}
+		else if(auto *arrayType = llvm::dyn_cast<llvm::ArrayType>(type))
+		{
+			hasher.add(arrayType->getNumElements());
+			addType(arrayType->getElementType());
+		}
+		else if(auto *structType = llvm::dyn_cast<llvm::StructType>(type))
+		{
+			hasher.add(structType->isPacked());
+			hasher.add(structType->getNumElements());
+			for(const llvm::Type *elementType : structType->elements())
+			{
+				addType(elementType);
+			}
+		}
+		else if(auto *pointerType = llvm::dyn_cast<llvm::PointerType>(type))
+		{
+			hasher.add(pointerType->getAddressSpace());
+		}
+		else if(auto *functionType = llvm::dyn_cast<llvm::FunctionType>(type))
+		{
+			hasher.add(functionType->isVarArg());
+			addType(functionType->getReturnType());
+			hasher.add(functionType->getNumParams());
+			for(const llvm::Type *paramType : functionType->params())
+			{
+				addType(paramType);
+			}
+		}
+	}
+
+	bool addFunction(const llvm::Function &function)
+	{
+		addString(function.getName());
+		addType(function.getFunctionType());
+		hasher.add(function.getCallingConv());
+		hasher.add(function.getLinkage());
+		addAttributes(function.getAttributes(), function.arg_size());
+
+		if(function.hasPersonalityFn() || function.hasGC() || function.hasSection())
+		{
+			return false;
+		}
+
+		hasher.add(function.isDeclaration());
+		if(function.isDeclaration())
+		{
+			return true;
+		}
+
+		// Number all local values up front, since they can be used before their
+		// definition, by phis and by branches to later blocks.
+		locals.clear();
+		uint64_t index = 0;
+		for(const llvm::Argument &arg : function.args())
+		{
+			locals[&arg] = index++;
+		}
+		for(const llvm::BasicBlock &block : function)
+		{
+			locals[&block] = index++;
+			for(const llvm::Instruction &inst : block)
+			{
+				locals[&inst] = index++;
+			}
+		}
+
+		hasher.add(function.size());
+		for(const llvm::BasicBlock &block : function)
+		{
+			hasher.add(block.size());
+			for(const llvm::Instruction &inst : block)
+			{
+				if(!addInstruction(inst))
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	bool addInstruction(const llvm::Instruction &inst)
+	{
+		if(inst.hasMetadataOtherThanDebugLoc())
+		{
+			return false;
+		}
+
+		hasher.add(inst.getOpcode());
+		addType(inst.getType());
+		hasher.add(inst.getRawSubclassOptionalData());  // Wrap, exact and fast-math flags.
+
+		hasher.add(inst.getNumOperands());
+		for(const llvm::Use &operand : inst.operands())
+		{
+			if(!addOperand(operand.get()))
+			{
+				return false;
+			}
+		}
+
+		if(auto *cmp = llvm::dyn_cast<llvm::CmpInst>(&inst))
+		{
+			hasher.add(cmp->getPredicate());
+		}
+		else if(auto *alloca = llvm::dyn_cast<llvm::AllocaInst>(&inst))
+		{
+			addType(alloca->getAllocatedType());
+#if LLVM_VERSION_MAJOR >= 11
+			hasher.add(AlignmentValue(alloca->getAlign()));
+#else
+			hasher.add(alloca->getAlignment());
+#endif
+		}
+		else if(auto *load = llvm::dyn_cast<llvm::LoadInst>(&inst))
+		{
+			hasher.add(AlignmentValue(load->getAlign()));
+			hasher.add(load->isVolatile());
+			hasher.add(static_cast<uint64_t>(load->getOrdering()));
+			hasher.add(load->getSyncScopeID());
+		}
+		else if(auto *store = llvm::dyn_cast<llvm::StoreInst>(&inst))
+		{
+			hasher.add(AlignmentValue(store->getAlign()));
+			hasher.add(store->isVolatile());
+			hasher.add(static_cast<uint64_t>(store->getOrdering()));
+			hasher.add(store->getSyncScopeID());
+		}
+		else if(auto *gep = llvm::dyn_cast<llvm::GetElementPtrInst>(&inst))
+		{
+			addType(gep->getSourceElementType());
+		}
+		else if(auto *call = llvm::dyn_cast<llvm::CallInst>(&inst))
+		{
+			if(call->hasOperandBundles())
+			{
+				return false;
+			}
+
+			addType(call->getFunctionType());
+			hasher.add(call->getCallingConv());
+			hasher.add(call->getTailCallKind());
+			addAttributes(call->getAttributes(), call->arg_size());
+		}
+		else if(auto *shuffle = llvm::dyn_cast<llvm::ShuffleVectorInst>(&inst))
+		{
+#if LLVM_VERSION_MAJOR >= 11
+			llvm::ArrayRef<int> mask = shuffle->getShuffleMask();
+			hasher.add(mask.size());
+			hasher.add(mask.data(), mask.size() * sizeof(int));
+#else
+			(void)shuffle;  // The mask is an operand.
+#endif
+		}
+		else if(auto *extract = llvm::dyn_cast<llvm::ExtractValueInst>(&inst))
+		{
+			hasher.add(extract->getNumIndices());
+			hasher.add(extract->idx_begin(), extract->getNumIndices() * sizeof(unsigned));
+		}
+		else if(auto *insert = llvm::dyn_cast<llvm::InsertValueInst>(&inst))
+		{
+			hasher.add(insert->getNumIndices());
+			hasher.add(insert->idx_begin(), insert->getNumIndices() * sizeof(unsigned));
+		}
+		else if(auto *rmw = llvm::dyn_cast<llvm::AtomicRMWInst>(&inst))
+		{
+			hasher.add(rmw->getOperation());
+			hasher.add(rmw->isVolatile());
+			hasher.add(static_cast<uint64_t>(rmw->getOrdering()));
+			hasher.add(rmw->getSyncScopeID());
+#if LLVM_VERSION_MAJOR >= 11
+			hasher.add(AlignmentValue(rmw->getAlign()));
+#endif
+		}
+		else if(auto *cmpxchg = llvm::dyn_cast<llvm::AtomicCmpXchgInst>(&inst))
+		{
+			hasher.add(static_cast<uint64_t>(cmpxchg->getSuccessOrdering()));
+			hasher.add(static_cast<uint64_t>(cmpxchg->getFailureOrdering()));
+			hasher.add(cmpxchg->isWeak());
+			hasher.add(cmpxchg->isVolatile());
+			hasher.add(cmpxchg->getSyncScopeID());
+#if LLVM_VERSION_MAJOR >= 11
+			hasher.add(AlignmentValue(cmpxchg->getAlign()));
+#endif
+		}
+		else if(auto *fence = llvm::dyn_cast<llvm::FenceInst>(&inst))
+		{
+			hasher.add(static_cast<uint64_t>(fence->getOrdering()));
+			hasher.add(fence->getSyncScopeID());
+		}
+		else if(auto *phi = llvm::dyn_cast<llvm::PHINode>(&inst))
+		{
+			for(const llvm::BasicBlock *block : phi->blocks())
+			{
+				hasher.add(locals.at(block));
+			}
+		}
+		else if(!llvm::isa<llvm::BinaryOperator>(inst) &&
+		        !llvm::isa<llvm::UnaryOperator>(inst) &&
+		        !llvm::isa<llvm::CastInst>(inst) &&
+		        !llvm::isa<llvm::SelectInst>(inst) &&
+		        !llvm::isa<llvm::ExtractElementInst>(inst) &&
+		        !llvm::isa<llvm::InsertElementInst>(inst) &&
+		        !llvm::isa<llvm::BranchInst>(inst) &&
+		        !llvm::isa<llvm::SwitchInst>(inst) &&
+		        !llvm::isa<llvm::ReturnInst>(inst) &&
+		        !llvm::isa<llvm::UnreachableInst>(inst) &&
+		        !llvm::isa<llvm::FreezeInst>(inst))
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	bool addOperand(const llvm::Value *value)
+	{
+		auto local = locals.find(value);
+		if(local != locals.end())
+		{
+			hasher.add(LocalOperand);
+			hasher.add(local->second);
+			return true;
+		}
+
+		if(auto *function = llvm::dyn_cast<llvm::Function>(value))
+		{
+			hasher.add(FunctionOperand);
+			addString(function->getName());
+			return true;
+		}
+
+		if(auto *constant = llvm::dyn_cast<llvm::Constant>(value))
+		{
+			hasher.add(ConstantOperand);
+			return addConstant(constant);
+		}
+
+		return false;
+	}
+
+	void addAPInt(const llvm::APInt &value)
+	{
+		hasher.add(value.getBitWidth());
+		hasher.add(value.getRawData(), value.getNumWords() * sizeof(uint64_t));
+	}
+
+	bool addConstant(const llvm::Constant *constant)
+	{
+		hasher.add(constant->getValueID());
+		addType(constant->getType());
+
+		if(auto *constantInt = llvm::dyn_cast<llvm::ConstantInt>(constant))
+		{
+			addAPInt(constantInt->getValue());
+		}
+		else if(auto *constantFP = llvm::dyn_cast<llvm::ConstantFP>(constant))
+		{
+			addAPInt(constantFP->getValueAPF().bitcastToAPInt());
+		}
+		else if(auto *data = llvm::dyn_cast<llvm::ConstantDataSequential>(constant))
+		{
+			llvm::StringRef raw = data->getRawDataValues();
+			addString(raw);
+		}
+		else if(auto *aggregate = llvm::dyn_cast<llvm::ConstantAggregate>(constant))
+		{
+			hasher.add(aggregate->getNumOperands());
+			for(const llvm::Use &element : aggregate->operands())
+			{
+				if(!addConstant(llvm::cast<llvm::Constant>(element.get())))
+				{
+					return false;
+				}
+			}
+		}
+		else if(auto *expr = llvm::dyn_cast<llvm::ConstantExpr>(constant))
+		{
+			hasher.add(expr->getOpcode());
+			hasher.add(expr->getRawSubclassOptionalData());
+
+			if(auto *gep = llvm::dyn_cast<llvm::GEPOperator>(expr))
+			{
+				addType(gep->getSourceElementType());
+			}
+			else if(expr->isCompare())
+			{
+				hasher.add(expr->getPredicate());
+			}
+			else if(expr->getOpcode() == llvm::Instruction::ExtractValue ||
+			        expr->getOpcode() == llvm::Instruction::InsertValue)
+			{
+				return false;
+			}
+
+			hasher.add(expr->getNumOperands());
+			for(const llvm::Use &operand : expr->operands())
+			{
+				if(!addOperand(operand.get()))
+				{
+					return false;
+				}
+			}
+		}
+		else if(!llvm::isa<llvm::ConstantPointerNull>(constant) &&
+		        !llvm::isa<llvm::ConstantAggregateZero>(constant) &&
+		        !llvm::isa<llvm::UndefValue>(constant) &&  // Includes poison.
+		        !llvm::isa<llvm::ConstantTokenNone>(constant))
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	IRHasher &hasher;
+	std::unordered_map<const llvm::Value *, uint64_t> locals;
+};
+
+}  // namespace
+
+// Adds the unoptimized module to the hasher, along with the passes and other state which
+// affect its code generation. Returns false if the module can't be deduplicated.
+static bool hashModule(rr::JITBuilder *jit, size_t count, IRHasher &hasher)
+{
+#ifdef ENABLE_RR_DEBUG_INFO
+	if(jit->debugInfo != nullptr)
+	{
+		return false;  // Debug info refers to the source location of the routine's construction.
+	}
+#endif  // ENABLE_RR_DEBUG_INFO
+
+	hasher.add(count);
+	hasher.add(getPragmaState(OptimizationLevel));
+	hasher.add(jit->passes());
+
+	return ModuleHasher(hasher).addModule(*jit->module);
+}
+
 std::shared_ptr<Routine> Nucleus::acquireRoutine(const char *name)
 {
 	if(jit->builder->GetInsertBlock()->empty() || !jit->builder->GetInsertBlock()->back().isTerminator())
@@ -576,6 +1010,19 @@ std::shared_ptr<Routine> Nucleus::acquireRoutine(const char *name)
 			jit->module->print(file, 0);
 		}
 
+		// Reuse the routine compiled from identical IR, if there is one.
+		IRHasher hasher;
+		bool hashable = hashModule(jit, 1, hasher);
+
+		if(hashable)
+		{
+			routine = RoutineDeduplicator::find(hasher);
+			if(routine)
+			{
+				return;
+			}
+		}
+
 		jit->runPasses();
 
 		if(false)
@@ -586,6 +1033,11 @@ std::shared_ptr<Routine> Nucleus::acquireRoutine(const char *name)
 		}
 
 		routine = jit->acquireRoutine(name, &jit->function, 1);
+
+		if(hashable)
+		{
+			RoutineDeduplicator::add(hasher, routine);
+		}
 	};
 
 #ifdef JIT_IN_SEPARATE_THREAD
@@ -4025,7 +4477,7 @@ void promoteFunctionToCoroutine()
 	jit->builder->restoreIP(oldInsertionPoint);
 }
 
-}  // anonymous namespace
+}  // namespace
 
 namespace rr {
 
@@ -4142,6 +4594,21 @@ std::shared_ptr<Routine> Nucleus::acquireCoroutine(const char *name)
 		jit->module->print(file, 0);
 	}
 
+	// Reuse the coroutine compiled from identical IR, if there is one.
+	IRHasher hasher;
+	bool hashable = hashModule(jit, Nucleus::CoroutineEntryCount, hasher);
+
+	if(hashable)
+	{
+		if(auto existing = RoutineDeduplicator::find(hasher))
+		{
+			delete jit;
+			jit = nullptr;
+
+			return existing;
+		}
+	}
+
 	jit->runPasses();
 
 	if(false)
@@ -4158,6 +4625,11 @@ std::shared_ptr<Routine> Nucleus::acquireCoroutine(const char *name)
 
 	auto routine = jit->acquireRoutine(name, funcs, Nucleus::CoroutineEntryCount);
 
+	if(hashable)
+	{
+		RoutineDeduplicator::add(hasher, routine);
+	}
+
 	delete jit;
 	jit = nullptr;
 
@@ -89,6 +89,17 @@ class JITBuilder
 public:
 	JITBuilder();
 
+	// The optimization and instrumentation passes which runPasses() applies.
+	enum Pass : uint32_t
+	{
+		CoroutinePasses = 1 << 0,
+		SROAPass = 1 << 1,
+		InstCombinePass = 1 << 2,
+		MemorySanitizerPass = 1 << 3,
+		AddressSanitizerPass = 1 << 4,
+	};
+
+	uint32_t passes() const;
 	void runPasses();
 
 	std::shared_ptr<rr::Routine> acquireRoutine(const char *name, llvm::Function **funcs, size_t count);
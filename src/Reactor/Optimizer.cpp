@@ -16,8 +16,11 @@
 
 #include "src/IceCfg.h"
 #include "src/IceCfgNode.h"
+#include "src/IceClFlags.h"
 
+#include <algorithm>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace {
@@ -34,12 +37,24 @@ public:
 
 private:
 	void analyzeUses(Ice::Cfg *function);
+	void analyzeUses(Ice::Inst *instruction);
+	void analyzeControlFlow();
 
 	void eliminateDeadCode();
 	void eliminateUnitializedLoads();
 	void propagateAlloca();
 	void performScalarReplacementOfAggregates();
 	void optimizeSingleBasicBlockLoadsStores();
+	void unrollLoops();
+	void mergeBasicBlocks();
+	void eliminateCommonSubexpressions();
+	void hoistLoopInvariants();
+
+	struct Loop;
+	bool unrollLoop(const Loop &loop);
+	Ice::Inst *clone(const Ice::Inst *instruction, const std::unordered_map<Ice::Variable *, Ice::Variable *> &variables);
+	Ice::Constant *foldConstants(const Ice::Inst *instruction);
+	bool dominates(const Ice::CfgNode *a, const Ice::CfgNode *b) const;
 
 	void replace(Ice::Inst *instruction, Ice::Operand *newValue);
 	void deleteInstruction(Ice::Inst *instruction);
@@ -51,6 +66,9 @@ private:
 	static const Ice::InstIntrinsic *asStoreSubVector(const Ice::Inst *instruction);
 	static bool isLoad(const Ice::Inst &instruction);
 	static bool isStore(const Ice::Inst &instruction);
+	static bool isSpeculatable(const Ice::Inst &instruction);
+	static bool isClonable(const Ice::Inst &instruction);
+	static Ice::Inst *terminator(Ice::CfgNode *node);
 	static bool loadTypeMatchesStore(const Ice::Inst *load, const Ice::Inst *store);
 	static bool storeTypeMatchesStore(const Ice::Inst *store1, const Ice::Inst *store2);
 
@@ -92,6 +110,35 @@ private:
 
 	std::vector<Ice::Operand *> operandsWithUses;
 
+	// Natural loop, identified by the back edges to its header.
+	struct Loop
+	{
+		Ice::CfgNode *header = nullptr;
+		Ice::CfgNode *preheader = nullptr;  // Sole predecessor from outside the loop, if it only branches to the header.
+		Ice::CfgNode *latch = nullptr;      // Sole node branching back to the header, if there's only one.
+		std::vector<Ice::CfgNode *> nodes;  // In reverse post-order, so starting with the header.
+		std::vector<bool> contains;         // Indexed by node index.
+
+		bool includes(const Ice::CfgNode *node) const
+		{
+			return contains[node->getIndex()];
+		}
+	};
+
+	// Control flow analysis results, indexed by node index where applicable.
+	// They're invalidated by any change to the nodes or their edges.
+	std::vector<Ice::CfgNode *> reversePostOrder;
+	std::vector<Ice::CfgNode *> immediateDominator;
+	std::vector<std::vector<Ice::CfgNode *>> dominatedNodes;  // Children in the dominator tree.
+	std::vector<uint32_t> dominatorTreeEntry;
+	std::vector<uint32_t> dominatorTreeExit;
+	std::vector<Loop> loops;  // Inner loops precede the loops containing them.
+
+	// Loops are only fully unrolled if they don't iterate more than this many
+	// times, and the unrolled code doesn't exceed this many instructions.
+	static constexpr uint32_t maxUnrollTripCount = 16;
+	static constexpr size_t maxUnrolledInstructions = 256;
+
 	rr::Nucleus::OptimizerReport *report = nullptr;
 };
 
@@ -116,6 +163,22 @@ void Optimizer::run(Ice::Cfg *function)
 	// Iterate through basic blocks to propagate loads following stores.
 	optimizeSingleBasicBlockLoadsStores();
 
+	// The control flow based optimizations improve the performance of the generated
+	// code, but take more time to compile, so they're only used when optimizing.
+	if(Ice::getFlags().getOptLevel() >= Ice::Opt_2)
+	{
+		// Replace small loops with a constant trip count by straight-line code.
+		unrollLoops();
+
+		// Reuse the results of redundant computations.
+		eliminateCommonSubexpressions();
+
+		// Move computations which don't change between iterations out of loops.
+		hoistLoopInvariants();
+
+		eliminateDeadCode();
+	}
+
 	for(auto operand : operandsWithUses)
 	{
 		// Deletes the Uses instance on the operand
@@ -478,28 +541,7 @@ void Optimizer::analyzeUses(Ice::Cfg *function)
 				continue;
 			}
 
-			if(instruction.getDest())
-			{
-				setDefinition(instruction.getDest(), &instruction);
-			}
-
-			for(Ice::SizeT i = 0; i < instruction.getSrcSize(); i++)
-			{
-				Ice::SizeT unique = 0;
-				for(; unique < i; unique++)
-				{
-					if(instruction.getSrc(i) == instruction.getSrc(unique))
-					{
-						break;
-					}
-				}
-
-				if(i == unique)
-				{
-					Ice::Operand *src = instruction.getSrc(i);
-					getUses(src)->insert(src, &instruction);
-				}
-			}
+			analyzeUses(&instruction);
 		}
 	}
 }
@@ -753,6 +795,1117 @@ bool Optimizer::storeTypeMatchesStore(const Ice::Inst *store1, const Ice::Inst *
 	return true;
 }
 
+// Fully unrolls loops with a small, constant trip count. Reactor keeps loop induction
+// variables in stack variables, so once the iterations form straight-line code, their
+// loads and stores get propagated, and the induction variable becomes a constant.
+void Optimizer::unrollLoops()
+{
+	bool unrolled = false;
+
+	for(bool modified = true; modified;)
+	{
+		modified = false;
+		analyzeControlFlow();
+
+		for(const Loop &loop : loops)
+		{
+			if(unrollLoop(loop))
+			{
+				// The control flow has changed, so the loops have to be analyzed again.
+				unrolled = modified = true;
+				break;
+			}
+		}
+	}
+
+	if(unrolled)
+	{
+		mergeBasicBlocks();
+		optimizeSingleBasicBlockLoadsStores();
+	}
+}
+
+// Unrolls a loop of the form produced by Reactor's For() construct, when the trip count
+// can be determined at compile time. That is, the header compares a stack variable to a
+// constant to decide whether to exit the loop, the variable is initialized to a constant
+// in the preheader, and it's only incremented by a constant right before branching back
+// to the header.
+bool Optimizer::unrollLoop(const Loop &loop)
+{
+	if(!loop.preheader || !loop.latch || loop.latch == loop.header)
+	{
+		return false;
+	}
+
+	auto *exitBranch = llvm::dyn_cast<Ice::InstBr>(terminator(loop.header));
+	auto *backBranch = llvm::dyn_cast<Ice::InstBr>(terminator(loop.latch));
+
+	if(!exitBranch || exitBranch->isUnconditional() || !backBranch || !backBranch->isUnconditional())
+	{
+		return false;
+	}
+
+	bool continueOnTrue = loop.includes(exitBranch->getTargetTrue());
+	Ice::CfgNode *bodyEntry = continueOnTrue ? exitBranch->getTargetTrue() : exitBranch->getTargetFalse();
+	Ice::CfgNode *exit = continueOnTrue ? exitBranch->getTargetFalse() : exitBranch->getTargetTrue();
+
+	if(!loop.includes(bodyEntry) || loop.includes(exit))
+	{
+		return false;
+	}
+
+	// Only the header may exit the loop (or the function may return from within it).
+	size_t loopSize = 0;
+	std::unordered_set<const Ice::Inst *> loopInstructions;
+
+	for(Ice::CfgNode *node : loop.nodes)
+	{
+		if(node != loop.header)
+		{
+			for(Ice::CfgNode *successor : node->getOutEdges())
+			{
+				if(!loop.includes(successor))
+				{
+					return false;
+				}
+			}
+		}
+
+		for(Ice::Inst &inst : node->getInsts())
+		{
+			if(inst.isDeleted())
+			{
+				continue;
+			}
+
+			if(!isClonable(inst))
+			{
+				return false;
+			}
+
+			loopInstructions.insert(&inst);
+			loopSize++;
+		}
+	}
+
+	auto definedIn = [&](Ice::Operand *operand, Ice::CfgNode *node) -> Ice::Inst * {
+		auto *variable = llvm::dyn_cast<Ice::Variable>(operand);
+		Ice::Inst *definition = variable ? getDefinition(variable) : nullptr;
+
+		if(definition && !definition->isDeleted())
+		{
+			for(Ice::Inst &inst : node->getInsts())
+			{
+				if(&inst == definition)
+				{
+					return definition;
+				}
+			}
+		}
+
+		return nullptr;
+	};
+
+	// The exit condition must compare the induction variable against a constant.
+	auto *compare = llvm::dyn_cast_or_null<Ice::InstIcmp>(definedIn(exitBranch->getCondition(), loop.header));
+
+	if(!compare)
+	{
+		return false;
+	}
+
+	bool counterIsFirst = llvm::isa<Ice::ConstantInteger32>(compare->getSrc(1));
+	auto *limit = llvm::dyn_cast<Ice::ConstantInteger32>(compare->getSrc(counterIsFirst ? 1 : 0));
+	auto *counter = llvm::dyn_cast_or_null<Ice::InstLoad>(definedIn(compare->getSrc(counterIsFirst ? 0 : 1), loop.header));
+
+	if(!limit || !counter || counter->getDest()->getType() != Ice::IceType_i32)
+	{
+		return false;
+	}
+
+	Ice::Operand *address = counter->getLoadAddress();
+
+	if(!allocaOf(address) || !getUses(address)->areOnlyLoadStore())
+	{
+		return false;
+	}
+
+	// The only store to the induction variable in the loop must be its increment,
+	// at the end of the latch.
+	Ice::Inst *increment = nullptr;
+
+	for(Ice::CfgNode *node : loop.nodes)
+	{
+		for(Ice::Inst &inst : node->getInsts())
+		{
+			if(!inst.isDeleted() && isStore(inst) && inst.getStoreAddress() == address)
+			{
+				if(increment || node != loop.latch || !llvm::isa<Ice::InstStore>(&inst))
+				{
+					return false;
+				}
+
+				increment = &inst;
+			}
+		}
+	}
+
+	auto *add = increment ? llvm::dyn_cast_or_null<Ice::InstArithmetic>(definedIn(increment->getData(), loop.latch)) : nullptr;
+
+	if(!add || (add->getOp() != Ice::InstArithmetic::Add && add->getOp() != Ice::InstArithmetic::Sub))
+	{
+		return false;
+	}
+
+	bool stepIsSecond = llvm::isa<Ice::ConstantInteger32>(add->getSrc(1));
+	auto *step = llvm::dyn_cast<Ice::ConstantInteger32>(add->getSrc(stepIsSecond ? 1 : 0));
+	auto *previous = llvm::dyn_cast_or_null<Ice::InstLoad>(definedIn(add->getSrc(stepIsSecond ? 0 : 1), loop.latch));
+
+	if(!step || !previous || previous->getLoadAddress() != address ||
+	   (add->getOp() == Ice::InstArithmetic::Sub && !stepIsSecond))
+	{
+		return false;
+	}
+
+	// The loaded value must precede the increment's store.
+	for(Ice::Inst &inst : loop.latch->getInsts())
+	{
+		if(&inst == increment)
+		{
+			return false;
+		}
+
+		if(&inst == previous)
+		{
+			break;
+		}
+	}
+
+	// The initial value is the last one stored in the preheader.
+	Ice::Inst *initialization = nullptr;
+
+	for(Ice::Inst &inst : loop.preheader->getInsts())
+	{
+		if(!inst.isDeleted() && isStore(inst) && inst.getStoreAddress() == address)
+		{
+			initialization = &inst;
+		}
+	}
+
+	auto *initial = initialization ? llvm::dyn_cast<Ice::ConstantInteger32>(initialization->getData()) : nullptr;
+
+	if(!initial || !llvm::isa<Ice::InstStore>(initialization))
+	{
+		return false;
+	}
+
+	// Determine the trip count by evaluating the exit condition for each iteration.
+	auto iterate = [&](uint32_t value) {
+		uint32_t a = counterIsFirst ? value : limit->getValue();
+		uint32_t b = counterIsFirst ? limit->getValue() : value;
+		bool condition = false;
+
+		switch(compare->getCondition())
+		{
+		case Ice::InstIcmp::Eq: condition = (a == b); break;
+		case Ice::InstIcmp::Ne: condition = (a != b); break;
+		case Ice::InstIcmp::Ugt: condition = (a > b); break;
+		case Ice::InstIcmp::Uge: condition = (a >= b); break;
+		case Ice::InstIcmp::Ult: condition = (a < b); break;
+		case Ice::InstIcmp::Ule: condition = (a <= b); break;
+		case Ice::InstIcmp::Sgt: condition = (int32_t(a) > int32_t(b)); break;
+		case Ice::InstIcmp::Sge: condition = (int32_t(a) >= int32_t(b)); break;
+		case Ice::InstIcmp::Slt: condition = (int32_t(a) < int32_t(b)); break;
+		case Ice::InstIcmp::Sle: condition = (int32_t(a) <= int32_t(b)); break;
+		default: break;
+		}
+
+		return condition == continueOnTrue;
+	};
+
+	uint32_t stride = (add->getOp() == Ice::InstArithmetic::Add) ? step->getValue() : -uint32_t(step->getValue());
+	uint32_t tripCount = 0;
+
+	for(uint32_t value = initial->getValue(); iterate(value); value += stride)
+	{
+		if(++tripCount > maxUnrollTripCount)
+		{
+			return false;
+		}
+	}
+
+	if(tripCount == 0 || tripCount * loopSize > maxUnrolledInstructions)
+	{
+		return false;
+	}
+
+	// Iteration 0 uses the original nodes, and iterations 1 to tripCount - 1 use copies of
+	// them. A final copy of the header evaluates the values used after the loop.
+	const size_t nodeCount = function->getNumNodes();
+	std::vector<std::vector<Ice::CfgNode *>> nodeCopies(tripCount + 1, std::vector<Ice::CfgNode *>(nodeCount, nullptr));
+	std::vector<std::unordered_map<Ice::Variable *, Ice::Variable *>> variableCopies(tripCount + 1);
+	Ice::NodeList copies;
+
+	for(uint32_t i = 0; i <= tripCount; i++)
+	{
+		for(Ice::CfgNode *node : loop.nodes)
+		{
+			if(i == tripCount && node != loop.header)
+			{
+				break;  // The header is the first node.
+			}
+
+			Ice::CfgNode *copy = (i == 0) ? node : function->makeNode();
+			nodeCopies[i][node->getIndex()] = copy;
+
+			if(i != 0)
+			{
+				copies.push_back(copy);
+
+				for(Ice::Inst &inst : node->getInsts())
+				{
+					if(!inst.isDeleted() && inst.getDest())
+					{
+						variableCopies[i][inst.getDest()] = function->makeVariable(inst.getDest()->getType());
+					}
+				}
+			}
+		}
+	}
+
+	for(uint32_t i = 1; i <= tripCount; i++)
+	{
+		for(Ice::CfgNode *node : loop.nodes)
+		{
+			Ice::CfgNode *copy = nodeCopies[i][node->getIndex()];
+
+			if(!copy)
+			{
+				continue;
+			}
+
+			for(Ice::Inst &inst : node->getInsts())
+			{
+				if(inst.isDeleted())
+				{
+					continue;
+				}
+
+				Ice::Inst *instCopy = nullptr;
+
+				if(&inst == exitBranch)
+				{
+					// The exit condition is known for each iteration.
+					Ice::CfgNode *target = (i == tripCount) ? exit : nodeCopies[i][bodyEntry->getIndex()];
+					instCopy = Ice::InstBr::create(function, target);
+				}
+				else
+				{
+					instCopy = clone(&inst, variableCopies[i]);
+
+					for(Ice::CfgNode *target : node->getOutEdges())
+					{
+						// Branches to the header start the next iteration.
+						uint32_t iteration = (target == loop.header) ? i + 1 : i;
+						instCopy->repointEdges(target, nodeCopies[iteration][target->getIndex()]);
+					}
+				}
+
+				copy->appendInst(instCopy);
+				analyzeUses(instCopy);
+			}
+		}
+	}
+
+	// Values computed by the header are available after the loop, so uses of them
+	// outside of the loop have to refer to the final copy of the header.
+	for(Ice::Inst &inst : loop.header->getInsts())
+	{
+		Ice::Variable *value = inst.getDest();
+
+		if(inst.isDeleted() || !value || !hasUses(value))
+		{
+			continue;
+		}
+
+		Ice::Variable *finalValue = variableCopies[tripCount][value];
+		Uses uses = *getUses(value);  // Hard copy
+
+		for(Ice::Inst *use : uses)
+		{
+			if(loopInstructions.count(use) == 0)
+			{
+				for(Ice::SizeT i = 0; i < use->getSrcSize(); i++)
+				{
+					if(use->getSrc(i) == value)
+					{
+						use->replaceSource(i, finalValue);
+					}
+				}
+
+				getUses(value)->erase(use);
+				getUses(finalValue)->insert(finalValue, use);
+			}
+		}
+	}
+
+	// Turn the original nodes into the first iteration.
+	deleteInstruction(exitBranch);
+	loop.header->appendInst(Ice::InstBr::create(function, bodyEntry));
+	backBranch->repointEdges(loop.header, nodeCopies[1][loop.header->getIndex()]);
+
+	// Place the copies right after the original loop, in iteration order.
+	Ice::CfgNode *last = *std::max_element(loop.nodes.begin(), loop.nodes.end(), [](Ice::CfgNode *a, Ice::CfgNode *b) {
+		return a->getIndex() < b->getIndex();
+	});
+
+	Ice::NodeList nodes;
+
+	for(Ice::CfgNode *node : function->getNodes())
+	{
+		if(node->getIndex() < nodeCount)
+		{
+			nodes.push_back(node);
+		}
+
+		if(node == last)
+		{
+			nodes.insert(nodes.end(), copies.begin(), copies.end());
+		}
+	}
+
+	function->swapNodes(nodes);
+
+	return true;
+}
+
+// Merges nodes which unconditionally branch to a node that has no other predecessors.
+void Optimizer::mergeBasicBlocks()
+{
+	function->computeInOutEdges();
+
+	Ice::CfgNode *entry = function->getEntryNode();
+
+	for(Ice::CfgNode *node : function->getNodes())
+	{
+		while(auto *branch = llvm::dyn_cast_or_null<Ice::InstBr>(terminator(node)))
+		{
+			if(!branch->isUnconditional())
+			{
+				break;
+			}
+
+			Ice::CfgNode *successor = branch->getTargetUnconditional();
+
+			if(successor == node || successor == entry || successor->getInEdges().size() != 1 || !successor->getPhis().empty())
+			{
+				break;
+			}
+
+			deleteInstruction(branch);
+			node->getInsts().splice(node->getInsts().end(), successor->getInsts());
+
+			node->removeAllOutEdges();
+			for(Ice::CfgNode *next : successor->getOutEdges())
+			{
+				node->addOutEdge(next);
+				next->replaceInEdge(successor, node);
+			}
+
+			// Leave the successor unreachable, so it gets removed.
+			successor->removeAllOutEdges();
+			successor->appendInst(Ice::InstUnreachable::create(function));
+		}
+	}
+
+	function->computeInOutEdges();
+}
+
+// Global value numbering. Replaces computations which are redundant with a computation
+// in a dominating node, and folds integer arithmetic on constants.
+void Optimizer::eliminateCommonSubexpressions()
+{
+	analyzeControlFlow();
+
+	using Key = std::vector<uintptr_t>;
+
+	struct KeyHash
+	{
+		size_t operator()(const Key &key) const
+		{
+			size_t hash = 0;
+			for(uintptr_t element : key)
+			{
+				hash = hash * 31 + std::hash<uintptr_t>()(element);
+			}
+			return hash;
+		}
+	};
+
+	std::unordered_map<Key, Ice::Variable *, KeyHash> available;
+
+	// Values made available by a node, and the ones they superseded.
+	struct Scope
+	{
+		Ice::CfgNode *node;
+		size_t child;
+		std::vector<std::pair<Key, Ice::Variable *>> values;
+	};
+
+	auto process = [&](Scope &scope) {
+		for(Ice::Inst &inst : scope.node->getInsts())
+		{
+			if(inst.isDeleted())
+			{
+				continue;
+			}
+
+			if(Ice::Constant *constant = foldConstants(&inst))
+			{
+				replace(&inst, constant);
+				continue;
+			}
+
+			if(!isSpeculatable(inst) || getDefinition(inst.getDest()) != &inst)
+			{
+				continue;
+			}
+
+			Key key = { inst.getKind(), inst.getDest()->getType() };
+
+			if(auto *arithmetic = llvm::dyn_cast<Ice::InstArithmetic>(&inst))
+			{
+				key.push_back(arithmetic->getOp());
+			}
+			else if(auto *cast = llvm::dyn_cast<Ice::InstCast>(&inst))
+			{
+				key.push_back(cast->getCastKind());
+			}
+			else if(auto *icmp = llvm::dyn_cast<Ice::InstIcmp>(&inst))
+			{
+				key.push_back(icmp->getCondition());
+			}
+			else if(auto *fcmp = llvm::dyn_cast<Ice::InstFcmp>(&inst))
+			{
+				key.push_back(fcmp->getCondition());
+			}
+			else if(auto *shuffle = llvm::dyn_cast<Ice::InstShuffleVector>(&inst))
+			{
+				for(Ice::SizeT i = 0; i < shuffle->getNumIndexes(); i++)
+				{
+					key.push_back(shuffle->getIndexValue(i));
+				}
+			}
+
+			size_t firstSource = key.size();
+			for(Ice::SizeT i = 0; i < inst.getSrcSize(); i++)
+			{
+				key.push_back(reinterpret_cast<uintptr_t>(inst.getSrc(i)));
+			}
+
+			auto *arithmetic = llvm::dyn_cast<Ice::InstArithmetic>(&inst);
+			if(arithmetic && arithmetic->isCommutative() && key[firstSource] > key[firstSource + 1])
+			{
+				std::swap(key[firstSource], key[firstSource + 1]);
+			}
+
+			auto entry = available.find(key);
+			Ice::Variable *value = (entry != available.end()) ? entry->second : nullptr;
+
+			// The available value may have been eliminated as dead code since.
+			if(value && !getDefinition(value)->isDeleted())
+			{
+				replace(&inst, value);
+			}
+			else
+			{
+				scope.values.push_back({ key, value });
+				available[key] = inst.getDest();
+			}
+		}
+	};
+
+	// Traverse the dominator tree, so that values computed by the dominating nodes are available.
+	std::vector<Scope> stack;
+	stack.push_back({ function->getEntryNode(), 0 });
+	process(stack.back());
+
+	while(!stack.empty())
+	{
+		Scope &scope = stack.back();
+		const auto &children = dominatedNodes[scope.node->getIndex()];
+
+		if(scope.child < children.size())
+		{
+			Ice::CfgNode *child = children[scope.child++];
+			stack.push_back({ child, 0 });
+			process(stack.back());
+		}
+		else
+		{
+			for(auto &value : scope.values)
+			{
+				if(value.second)
+				{
+					available[value.first] = value.second;
+				}
+				else
+				{
+					available.erase(value.first);
+				}
+			}
+
+			stack.pop_back();
+		}
+	}
+}
+
+// Moves instructions which compute the same value in every iteration of a loop to its
+// preheader. This includes loads of stack variables which aren't stored to in the loop.
+void Optimizer::hoistLoopInvariants()
+{
+	analyzeControlFlow();
+
+	for(const Loop &loop : loops)
+	{
+		if(!loop.preheader)
+		{
+			continue;
+		}
+
+		std::unordered_set<Ice::Operand *> variant;  // Values defined in the loop.
+		std::unordered_set<Ice::Operand *> storedTo;
+
+		for(Ice::CfgNode *node : loop.nodes)
+		{
+			for(Ice::Inst &inst : node->getInsts())
+			{
+				if(inst.isDeleted())
+				{
+					continue;
+				}
+
+				if(inst.getDest())
+				{
+					variant.insert(inst.getDest());
+				}
+
+				if(isStore(inst))
+				{
+					storedTo.insert(inst.getStoreAddress());
+				}
+			}
+		}
+
+		Ice::InstList &preheader = loop.preheader->getInsts();
+		Ice::InstList::iterator branch = std::prev(preheader.end());
+
+		// Definitions are visited before their uses, so chains of invariant
+		// computations get hoisted in a single pass.
+		for(Ice::CfgNode *node : loop.nodes)
+		{
+			Ice::InstList &instructions = node->getInsts();
+
+			for(auto i = instructions.begin(); i != instructions.end();)
+			{
+				Ice::Inst &inst = *i++;
+
+				if(inst.isDeleted())
+				{
+					continue;
+				}
+
+				bool invariant = false;
+
+				if(isSpeculatable(inst))
+				{
+					invariant = (getDefinition(inst.getDest()) == &inst);
+				}
+				else if(isLoad(inst))
+				{
+					Ice::Operand *address = inst.getLoadAddress();
+
+					invariant = allocaOf(address) && getUses(address)->areOnlyLoadStore() &&
+					            storedTo.count(address) == 0;
+				}
+
+				for(Ice::SizeT j = 0; invariant && j < inst.getSrcSize(); j++)
+				{
+					invariant = (variant.count(inst.getSrc(j)) == 0);
+				}
+
+				if(invariant)
+				{
+					instructions.remove(inst);
+					preheader.insert(branch, &inst);
+					variant.erase(inst.getDest());
+				}
+			}
+		}
+	}
+}
+
+void Optimizer::analyzeUses(Ice::Inst *instruction)
+{
+	if(instruction->getDest())
+	{
+		setDefinition(instruction->getDest(), instruction);
+	}
+
+	for(Ice::SizeT i = 0; i < instruction->getSrcSize(); i++)
+	{
+		Ice::SizeT unique = 0;
+		for(; unique < i; unique++)
+		{
+			if(instruction->getSrc(i) == instruction->getSrc(unique))
+			{
+				break;
+			}
+		}
+
+		if(i == unique)
+		{
+			Ice::Operand *src = instruction->getSrc(i);
+			getUses(src)->insert(src, instruction);
+		}
+	}
+}
+
+// Computes the dominator tree, and finds the natural loops.
+void Optimizer::analyzeControlFlow()
+{
+	// This also removes unreachable nodes, and renumbers the remaining ones.
+	function->computeInOutEdges();
+
+	const size_t nodeCount = function->getNumNodes();
+	Ice::CfgNode *entry = function->getEntryNode();
+
+	reversePostOrder.clear();
+	std::vector<bool> visited(nodeCount, false);
+	std::vector<std::pair<Ice::CfgNode *, size_t>> stack = { { entry, 0 } };
+	visited[entry->getIndex()] = true;
+
+	while(!stack.empty())
+	{
+		Ice::CfgNode *node = stack.back().first;
+		const Ice::NodeList &successors = node->getOutEdges();
+
+		if(stack.back().second < successors.size())
+		{
+			Ice::CfgNode *successor = successors[stack.back().second++];
+
+			if(!visited[successor->getIndex()])
+			{
+				visited[successor->getIndex()] = true;
+				stack.push_back({ successor, 0 });
+			}
+		}
+		else
+		{
+			reversePostOrder.push_back(node);
+			stack.pop_back();
+		}
+	}
+
+	std::reverse(reversePostOrder.begin(), reversePostOrder.end());
+
+	std::vector<uint32_t> order(nodeCount);
+	for(uint32_t i = 0; i < reversePostOrder.size(); i++)
+	{
+		order[reversePostOrder[i]->getIndex()] = i;
+	}
+
+	// "A Simple, Fast Dominance Algorithm" by Cooper, Harvey and Kennedy.
+	immediateDominator.assign(nodeCount, nullptr);
+	immediateDominator[entry->getIndex()] = entry;
+
+	for(bool changed = true; changed;)
+	{
+		changed = false;
+
+		for(Ice::CfgNode *node : reversePostOrder)
+		{
+			if(node == entry)
+			{
+				continue;
+			}
+
+			Ice::CfgNode *dominator = nullptr;
+
+			for(Ice::CfgNode *predecessor : node->getInEdges())
+			{
+				if(!immediateDominator[predecessor->getIndex()])
+				{
+					continue;  // Not processed yet.
+				}
+
+				if(!dominator)
+				{
+					dominator = predecessor;
+					continue;
+				}
+
+				Ice::CfgNode *other = predecessor;
+				while(other != dominator)
+				{
+					while(order[other->getIndex()] > order[dominator->getIndex()])
+					{
+						other = immediateDominator[other->getIndex()];
+					}
+
+					while(order[dominator->getIndex()] > order[other->getIndex()])
+					{
+						dominator = immediateDominator[dominator->getIndex()];
+					}
+				}
+			}
+
+			if(immediateDominator[node->getIndex()] != dominator)
+			{
+				immediateDominator[node->getIndex()] = dominator;
+				changed = true;
+			}
+		}
+	}
+
+	// Number the dominator tree nodes in depth-first order, so that dominance
+	// can be determined by the nesting of their entry and exit numbers.
+	dominatedNodes.assign(nodeCount, {});
+	for(Ice::CfgNode *node : reversePostOrder)
+	{
+		if(node != entry)
+		{
+			dominatedNodes[immediateDominator[node->getIndex()]->getIndex()].push_back(node);
+		}
+	}
+
+	dominatorTreeEntry.assign(nodeCount, 0);
+	dominatorTreeExit.assign(nodeCount, 0);
+	uint32_t number = 0;
+
+	stack = { { entry, 0 } };
+	dominatorTreeEntry[entry->getIndex()] = number++;
+
+	while(!stack.empty())
+	{
+		Ice::CfgNode *node = stack.back().first;
+		const auto &children = dominatedNodes[node->getIndex()];
+
+		if(stack.back().second < children.size())
+		{
+			Ice::CfgNode *child = children[stack.back().second++];
+			dominatorTreeEntry[child->getIndex()] = number++;
+			stack.push_back({ child, 0 });
+		}
+		else
+		{
+			dominatorTreeExit[node->getIndex()] = number++;
+			stack.pop_back();
+		}
+	}
+
+	// Each edge to a node which dominates its source is a back edge of a loop.
+	loops.clear();
+
+	for(Ice::CfgNode *header : reversePostOrder)
+	{
+		std::vector<Ice::CfgNode *> latches;
+
+		for(Ice::CfgNode *predecessor : header->getInEdges())
+		{
+			if(dominates(header, predecessor))
+			{
+				latches.push_back(predecessor);
+			}
+		}
+
+		if(latches.empty())
+		{
+			continue;
+		}
+
+		Loop loop;
+		loop.header = header;
+		loop.latch = (latches.size() == 1) ? latches[0] : nullptr;
+		loop.contains.assign(nodeCount, false);
+		loop.contains[header->getIndex()] = true;
+
+		// The loop consists of the nodes which can reach the back edges without passing through the header.
+		while(!latches.empty())
+		{
+			Ice::CfgNode *node = latches.back();
+			latches.pop_back();
+
+			if(!loop.contains[node->getIndex()])
+			{
+				loop.contains[node->getIndex()] = true;
+				latches.insert(latches.end(), node->getInEdges().begin(), node->getInEdges().end());
+			}
+		}
+
+		for(Ice::CfgNode *node : reversePostOrder)
+		{
+			if(loop.contains[node->getIndex()])
+			{
+				loop.nodes.push_back(node);
+			}
+		}
+
+		for(Ice::CfgNode *predecessor : header->getInEdges())
+		{
+			if(!loop.includes(predecessor))
+			{
+				if(loop.preheader)
+				{
+					loop.preheader = nullptr;
+					break;
+				}
+
+				loop.preheader = predecessor;
+			}
+		}
+
+		if(loop.preheader && loop.preheader->getOutEdges().size() != 1)
+		{
+			loop.preheader = nullptr;
+		}
+
+		loops.push_back(std::move(loop));
+	}
+
+	std::stable_sort(loops.begin(), loops.end(), [](const Loop &a, const Loop &b) {
+		return a.nodes.size() < b.nodes.size();
+	});
+}
+
+bool Optimizer::dominates(const Ice::CfgNode *a, const Ice::CfgNode *b) const
+{
+	return dominatorTreeEntry[a->getIndex()] <= dominatorTreeEntry[b->getIndex()] &&
+	       dominatorTreeExit[b->getIndex()] <= dominatorTreeExit[a->getIndex()];
+}
+
+// Returns true for instructions without side effects, which don't access memory and
+// can't trap, so they can be executed unconditionally, or have their result reused.
+bool Optimizer::isSpeculatable(const Ice::Inst &instruction)
+{
+	if(!instruction.getDest() || instruction.hasSideEffects())
+	{
+		return false;
+	}
+
+	switch(instruction.getKind())
+	{
+	case Ice::Inst::Arithmetic:
+		switch(llvm::cast<Ice::InstArithmetic>(&instruction)->getOp())
+		{
+		case Ice::InstArithmetic::Udiv:
+		case Ice::InstArithmetic::Sdiv:
+		case Ice::InstArithmetic::Urem:
+		case Ice::InstArithmetic::Srem:
+			return false;  // Division by zero traps.
+		default:
+			return true;
+		}
+	case Ice::Inst::Cast:
+	case Ice::Inst::ExtractElement:
+	case Ice::Inst::Fcmp:
+	case Ice::Inst::Icmp:
+	case Ice::Inst::InsertElement:
+	case Ice::Inst::Select:
+	case Ice::Inst::ShuffleVector:
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool Optimizer::isClonable(const Ice::Inst &instruction)
+{
+	switch(instruction.getKind())
+	{
+	case Ice::Inst::Arithmetic:
+	case Ice::Inst::Br:
+	case Ice::Inst::Call:
+	case Ice::Inst::Cast:
+	case Ice::Inst::ExtractElement:
+	case Ice::Inst::Fcmp:
+	case Ice::Inst::Icmp:
+	case Ice::Inst::InsertElement:
+	case Ice::Inst::Intrinsic:
+	case Ice::Inst::Load:
+	case Ice::Inst::Ret:
+	case Ice::Inst::Select:
+	case Ice::Inst::ShuffleVector:
+	case Ice::Inst::Store:
+	case Ice::Inst::Switch:
+	case Ice::Inst::Unreachable:
+		return true;
+	default:
+		return false;
+	}
+}
+
+Ice::Inst *Optimizer::terminator(Ice::CfgNode *node)
+{
+	Ice::InstList &instructions = node->getInsts();
+
+	if(instructions.empty() || instructions.back().isDeleted())
+	{
+		return nullptr;
+	}
+
+	return &instructions.back();
+}
+
+// Creates a copy of the instruction, with its variables substituted by the ones in the map.
+// Branch targets are not substituted.
+Ice::Inst *Optimizer::clone(const Ice::Inst *instruction, const std::unordered_map<Ice::Variable *, Ice::Variable *> &variables)
+{
+	auto map = [&](Ice::Operand *operand) -> Ice::Operand * {
+		if(auto *variable = llvm::dyn_cast_or_null<Ice::Variable>(operand))
+		{
+			auto copy = variables.find(variable);
+			if(copy != variables.end())
+			{
+				return copy->second;
+			}
+		}
+
+		return operand;
+	};
+
+	Ice::Variable *dest = llvm::cast_or_null<Ice::Variable>(map(instruction->getDest()));
+	auto src = [&](Ice::SizeT i) { return map(instruction->getSrc(i)); };
+
+	switch(instruction->getKind())
+	{
+	case Ice::Inst::Arithmetic:
+		return Ice::InstArithmetic::create(function, llvm::cast<Ice::InstArithmetic>(instruction)->getOp(), dest, src(0), src(1));
+	case Ice::Inst::Br:
+		{
+			auto *br = llvm::cast<Ice::InstBr>(instruction);
+			if(br->isUnconditional())
+			{
+				return Ice::InstBr::create(function, br->getTargetUnconditional());
+			}
+
+			return Ice::InstBr::create(function, src(0), br->getTargetTrue(), br->getTargetFalse());
+		}
+	case Ice::Inst::Call:
+		{
+			auto *call = llvm::cast<Ice::InstCall>(instruction);
+			auto *copy = Ice::InstCall::create(function, call->getNumArgs(), dest, src(0), call->isTailcall(), call->isTargetHelperCall(), call->isVariadic());
+			for(Ice::SizeT i = 0; i < call->getNumArgs(); i++)
+			{
+				copy->addArg(src(i + 1));
+			}
+			return copy;
+		}
+	case Ice::Inst::Cast:
+		return Ice::InstCast::create(function, llvm::cast<Ice::InstCast>(instruction)->getCastKind(), dest, src(0));
+	case Ice::Inst::ExtractElement:
+		return Ice::InstExtractElement::create(function, dest, src(0), src(1));
+	case Ice::Inst::Fcmp:
+		return Ice::InstFcmp::create(function, llvm::cast<Ice::InstFcmp>(instruction)->getCondition(), dest, src(0), src(1));
+	case Ice::Inst::Icmp:
+		return Ice::InstIcmp::create(function, llvm::cast<Ice::InstIcmp>(instruction)->getCondition(), dest, src(0), src(1));
+	case Ice::Inst::InsertElement:
+		return Ice::InstInsertElement::create(function, dest, src(0), src(1), src(2));
+	case Ice::Inst::Intrinsic:
+		{
+			auto *intrinsic = llvm::cast<Ice::InstIntrinsic>(instruction);
+			auto *copy = Ice::InstIntrinsic::create(function, intrinsic->getNumArgs(), dest, intrinsic->getIntrinsicInfo());
+			for(Ice::SizeT i = 0; i < intrinsic->getNumArgs(); i++)
+			{
+				copy->addArg(src(i));
+			}
+			return copy;
+		}
+	case Ice::Inst::Load:
+		return Ice::InstLoad::create(function, dest, src(0));
+	case Ice::Inst::Ret:
+		return Ice::InstRet::create(function, instruction->getSrcSize() ? src(0) : nullptr);
+	case Ice::Inst::Select:
+		return Ice::InstSelect::create(function, dest, src(0), src(1), src(2));
+	case Ice::Inst::ShuffleVector:
+		{
+			auto *shuffle = llvm::cast<Ice::InstShuffleVector>(instruction);
+			auto *copy = Ice::InstShuffleVector::create(function, dest, src(0), src(1));
+			for(Ice::SizeT i = 0; i < shuffle->getNumIndexes(); i++)
+			{
+				copy->addIndex(shuffle->getIndex(i));
+			}
+			return copy;
+		}
+	case Ice::Inst::Store:
+		return Ice::InstStore::create(function, src(0), src(1));
+	case Ice::Inst::Switch:
+		{
+			auto *switchInst = llvm::cast<Ice::InstSwitch>(instruction);
+			auto *copy = Ice::InstSwitch::create(function, switchInst->getNumCases(), src(0), switchInst->getLabelDefault());
+			for(Ice::SizeT i = 0; i < switchInst->getNumCases(); i++)
+			{
+				copy->addBranch(i, switchInst->getValue(i), switchInst->getLabel(i));
+			}
+			return copy;
+		}
+	case Ice::Inst::Unreachable:
+		return Ice::InstUnreachable::create(function);
+	default:
+		assert(false && "Unexpected instruction kind");
+		return nullptr;
+	}
+}
+
+// Returns the result of 32-bit integer arithmetic on constant operands, or nullptr.
+Ice::Constant *Optimizer::foldConstants(const Ice::Inst *instruction)
+{
+	auto *arithmetic = llvm::dyn_cast<Ice::InstArithmetic>(instruction);
+
+	if(!arithmetic || arithmetic->getDest()->getType() != Ice::IceType_i32)
+	{
+		return nullptr;
+	}
+
+	auto *lhs = llvm::dyn_cast<Ice::ConstantInteger32>(arithmetic->getSrc(0));
+	auto *rhs = llvm::dyn_cast<Ice::ConstantInteger32>(arithmetic->getSrc(1));
+
+	if(!lhs || !rhs)
+	{
+		return nullptr;
+	}
+
+	uint32_t a = lhs->getValue();
+	uint32_t b = rhs->getValue();
+	uint32_t result = 0;
+
+	switch(arithmetic->getOp())
+	{
+	case Ice::InstArithmetic::Add: result = a + b; break;
+	case Ice::InstArithmetic::Sub: result = a - b; break;
+	case Ice::InstArithmetic::Mul: result = a * b; break;
+	case Ice::InstArithmetic::And: result = a & b; break;
+	case Ice::InstArithmetic::Or: result = a | b; break;
+	case Ice::InstArithmetic::Xor: result = a ^ b; break;
+	case Ice::InstArithmetic::Shl:
+	case Ice::InstArithmetic::Lshr:
+	case Ice::InstArithmetic::Ashr:
+		if(b >= 32)
+		{
+			return nullptr;  // Undefined
+		}
+
+		result = (arithmetic->getOp() == Ice::InstArithmetic::Shl) ? a << b :
+		         (arithmetic->getOp() == Ice::InstArithmetic::Lshr) ? a >> b :
+		                                                              uint32_t(int32_t(a) >> b);
+		break;
+	default:
+		return nullptr;
+	}
+
+	return context->getConstantInt32(static_cast<int32_t>(result));
+}
+
 void Optimizer::collectDiagnostics()
 {
 	if(report)
@@ -69,6 +69,7 @@ struct Caps
 	static std::string backendName();
 	static bool coroutinesSupported();  // Support for rr::Coroutine<F>
 	static bool fmaIsFast();            // rr::FMA() is faster than `x * y + z`
+	static bool gatherIsFast();         // rr::Gather() emits a hardware gather instruction
 };
 
 class Bool;
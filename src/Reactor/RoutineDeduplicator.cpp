@@ -0,0 +1,166 @@
+// Copyright 2026 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "RoutineDeduplicator.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+inline uint64_t rotl(uint64_t x, int r)
+{
+	return (x << r) | (x >> (64 - r));
+}
+
+// MurmurHash3's 64-bit finalizer.
+inline uint64_t fmix(uint64_t k)
+{
+	k ^= k >> 33;
+	k *= 0xFF51AFD7ED558CCDull;
+	k ^= k >> 33;
+	k *= 0xC4CEB9FE1A85EC53ull;
+	k ^= k >> 33;
+	return k;
+}
+
+struct DigestHash
+{
+	size_t operator()(const rr::IRDigest &digest) const
+	{
+		return static_cast<size_t>(digest.lo);
+	}
+};
+
+class Routines
+{
+public:
+	std::shared_ptr<rr::Routine> find(const rr::IRHasher &ir)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto it = map.find(ir.digest());
+		if(it == map.end())
+		{
+			return nullptr;
+		}
+
+		// Don't trust the digest alone. A collision must not return code compiled from different IR.
+		if(it->second.serialization != ir.serialization())
+		{
+			return nullptr;
+		}
+
+		return it->second.routine.lock();
+	}
+
+	void add(const rr::IRHasher &ir, const std::shared_ptr<rr::Routine> &routine)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		map[ir.digest()] = { routine, ir.serialization() };
+
+		// Drop the entries of destroyed routines whenever the map has doubled in size.
+		if(map.size() >= pruneSize)
+		{
+			for(auto it = map.begin(); it != map.end();)
+			{
+				it = it->second.routine.expired() ? map.erase(it) : std::next(it);
+			}
+
+			pruneSize = 2 * std::max(map.size(), minPruneSize);
+		}
+	}
+
+private:
+	static constexpr size_t minPruneSize = 256;
+
+	struct Entry
+	{
+		std::weak_ptr<rr::Routine> routine;
+		std::vector<uint64_t> serialization;
+	};
+
+	std::mutex mutex;
+	std::unordered_map<rr::IRDigest, Entry, DigestHash> map;
+	size_t pruneSize = minPruneSize;
+};
+
+Routines &routines()
+{
+	static Routines *routines = new Routines();  // Never destroyed, as routines may outlive static destruction.
+	return *routines;
+}
+
+}  // anonymous namespace
+
+namespace rr {
+
+void IRHasher::add(uint64_t value)
+{
+	// Two independently seeded lanes of a MurmurHash3-like mixing function,
+	// which are cross-coupled so that each depends on all of the input.
+	h1 = rotl(h1 ^ (value * 0x87C37B91114253D5ull), 31) * 0x4CF5AD432745937Full + h2;
+	h2 = rotl(h2 ^ (value * 0x9E3779B97F4A7C15ull), 33) * 0x52DCE729DA3ED5C1ull + h1;
+	words.push_back(value);
+}
+
+void IRHasher::add(const void *data, size_t size)
+{
+	const uint8_t *bytes = static_cast<const uint8_t *>(data);
+
+	add(size);
+
+	while(size >= sizeof(uint64_t))
+	{
+		uint64_t word;
+		memcpy(&word, bytes, sizeof(word));
+		add(word);
+
+		bytes += sizeof(word);
+		size -= sizeof(word);
+	}
+
+	if(size > 0)
+	{
+		uint64_t word = 0;
+		memcpy(&word, bytes, size);
+		add(word);
+	}
+}
+
+IRDigest IRHasher::digest() const
+{
+	uint64_t length = words.size();
+	uint64_t a = fmix(h1 ^ length);
+	uint64_t b = fmix(h2 ^ rotl(length, 32));
+
+	return { a + b, a + 2 * b };
+}
+
+std::shared_ptr<Routine> RoutineDeduplicator::find(const IRHasher &ir)
+{
+	return routines().find(ir);
+}
+
+void RoutineDeduplicator::add(const IRHasher &ir, const std::shared_ptr<Routine> &routine)
+{
+	routines().add(ir, routine);
+}
+
+}  // namespace rr
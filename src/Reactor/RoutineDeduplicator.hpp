@@ -0,0 +1,76 @@
+// Copyright 2026 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef rr_RoutineDeduplicator_hpp
+#define rr_RoutineDeduplicator_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace rr {
+
+class Routine;
+
+// 128-bit digest of a routine's intermediate representation.
+struct IRDigest
+{
+	uint64_t lo = 0;
+	uint64_t hi = 0;
+
+	bool operator==(const IRDigest &other) const
+	{
+		return lo == other.lo && hi == other.hi;
+	}
+};
+
+// IRHasher accumulates the content of a routine's intermediate representation
+// into an IRDigest. The backends feed it everything which affects code
+// generation. The sequence of added words is kept as the canonical
+// serialization of the IR, which is compared on digest matches, so that only
+// routines with identical IR share code.
+class IRHasher
+{
+public:
+	void add(uint64_t value);
+	void add(const void *data, size_t size);
+
+	IRDigest digest() const;
+	const std::vector<uint64_t> &serialization() const { return words; }
+
+private:
+	uint64_t h1 = 0x6A09E667F3BCC908ull;
+	uint64_t h2 = 0xBB67AE8584CAA73Bull;
+	std::vector<uint64_t> words;
+};
+
+// RoutineDeduplicator maps IR digests to the routines compiled from them, so
+// that routines built from different state keys but with identical IR share
+// the code generated for the first of them. Routines are held weakly, so that
+// this does not extend their lifetime beyond that of their users' caches.
+class RoutineDeduplicator
+{
+public:
+	// Returns the live routine which was compiled from the IR accumulated by
+	// the hasher, or nullptr.
+	static std::shared_ptr<Routine> find(const IRHasher &ir);
+
+	// Records that the routine was compiled from the IR accumulated by the hasher.
+	static void add(const IRHasher &ir, const std::shared_ptr<Routine> &routine);
+};
+
+}  // namespace rr
+
+#endif  // rr_RoutineDeduplicator_hpp
@@ -1122,6 +1122,77 @@ bool SIMD::Pointer::hasStaticEqualOffsets() const
 	return true;
 }
 
+SIMD::UInt SIMD::Pointer::Load16(OutOfBoundsBehavior robustness, SIMD::Int mask) const
+{
+	constexpr int alignment = sizeof(uint16_t);
+
+	if(isBasePlusOffset && !isStaticallyInBounds(sizeof(uint16_t), robustness))
+	{
+		switch(robustness)
+		{
+		case OutOfBoundsBehavior::Nullify:
+		case OutOfBoundsBehavior::RobustBufferAccess:
+		case OutOfBoundsBehavior::UndefinedValue:
+			mask &= isInBounds(sizeof(uint16_t), robustness);  // Disable out-of-bounds reads.
+			break;
+		case OutOfBoundsBehavior::UndefinedBehavior:
+			// Nothing to do. Application/compiler must guarantee no out-of-bounds accesses.
+			break;
+		}
+	}
+
+	SIMD::UInt out = SIMD::UInt(0);
+
+	if(isBasePlusOffset && hasStaticEqualOffsets())
+	{
+		// Load one, replicate.
+		If(AnyTrue(mask))
+		{
+			out = SIMD::UInt(scalar::UInt(*scalar::Pointer<UShort>(base + staticOffsets[0], alignment)));
+		}
+		return out;
+	}
+
+	for(int i = 0; i < SIMD::Width; i++)
+	{
+		If(Extract(mask, i) != 0)
+		{
+			auto el = *scalar::Pointer<UShort>(getPointerForLane(i), alignment);
+			out = Insert(out, scalar::UInt(el), i);
+		}
+	}
+
+	return out;
+}
+
+void SIMD::Pointer::Store16(SIMD::UInt val, OutOfBoundsBehavior robustness, SIMD::Int mask) const
+{
+	constexpr int alignment = sizeof(uint16_t);
+
+	if(isBasePlusOffset)
+	{
+		switch(robustness)
+		{
+		case OutOfBoundsBehavior::Nullify:
+		case OutOfBoundsBehavior::RobustBufferAccess:
+		case OutOfBoundsBehavior::UndefinedValue:
+			mask &= isInBounds(sizeof(uint16_t), robustness);  // Disable out-of-bounds writes.
+			break;
+		case OutOfBoundsBehavior::UndefinedBehavior:
+			// Nothing to do. Application/compiler must guarantee no out-of-bounds accesses.
+			break;
+		}
+	}
+
+	for(int i = 0; i < SIMD::Width; i++)
+	{
+		If(Extract(mask, i) != 0)
+		{
+			*scalar::Pointer<UShort>(getPointerForLane(i), alignment) = UShort(Extract(val, i));
+		}
+	}
+}
+
 scalar::Pointer<Byte> SIMD::Pointer::getUniformPointer() const
 {
 #ifndef NDEBUG
@@ -1179,6 +1250,83 @@ void SIMD::Pointer::castTo(SIMD::UInt &lowerBits, SIMD::UInt &upperBits) const
 	}
 }
 
+unsigned int SIMD::Pointer::spillSize() const
+{
+	unsigned int size = 0;
+
+	if(hasDynamicOffsets)
+	{
+		size += sizeof(int32_t) * SIMD::Width;
+	}
+
+	if(hasDynamicLimit)
+	{
+		size += sizeof(int32_t);
+	}
+
+	size += sizeof(void *) * (isBasePlusOffset ? 1 : SIMD::Width);
+
+	return size;
+}
+
+void SIMD::Pointer::spill(scalar::Pointer<Byte> storage) const
+{
+	unsigned int offset = 0;
+
+	if(hasDynamicOffsets)
+	{
+		*scalar::Pointer<SIMD::Int>(storage + offset) = dynamicOffsets;
+		offset += sizeof(int32_t) * SIMD::Width;
+	}
+
+	if(hasDynamicLimit)
+	{
+		*scalar::Pointer<scalar::Int>(storage + offset) = dynamicLimit;
+		offset += sizeof(int32_t);
+	}
+
+	if(isBasePlusOffset)
+	{
+		*scalar::Pointer<scalar::Pointer<Byte>>(storage + offset) = base;
+	}
+	else
+	{
+		for(int i = 0; i < SIMD::Width; i++)
+		{
+			*scalar::Pointer<scalar::Pointer<Byte>>(storage + offset + i * int(sizeof(void *))) = pointers[i];
+		}
+	}
+}
+
+void SIMD::Pointer::reload(scalar::Pointer<Byte> storage)
+{
+	unsigned int offset = 0;
+
+	if(hasDynamicOffsets)
+	{
+		dynamicOffsets = *scalar::Pointer<SIMD::Int>(storage + offset);
+		offset += sizeof(int32_t) * SIMD::Width;
+	}
+
+	if(hasDynamicLimit)
+	{
+		dynamicLimit = *scalar::Pointer<scalar::Int>(storage + offset);
+		offset += sizeof(int32_t);
+	}
+
+	if(isBasePlusOffset)
+	{
+		base = *scalar::Pointer<scalar::Pointer<Byte>>(storage + offset);
+	}
+	else
+	{
+		for(int i = 0; i < SIMD::Width; i++)
+		{
+			pointers[i] = *scalar::Pointer<scalar::Pointer<Byte>>(storage + offset + i * int(sizeof(void *)));
+		}
+	}
+}
+
 SIMD::Pointer SIMD::Pointer::IfThenElse(SIMD::Int condition, const SIMD::Pointer &lhs, const SIMD::Pointer &rhs)
 {
 	std::vector<scalar::Pointer<Byte>> pointers(SIMD::Width);
@@ -186,6 +186,11 @@ public:
 	template<typename T>
 	inline void Store(RValue<T> val, OutOfBoundsBehavior robustness, SIMD::Int mask, bool atomic = false, std::memory_order order = std::memory_order_relaxed);
 
+	// Loads and stores of 16-bit elements. Load16() returns the zero-extended
+	// values, and Store16() writes the low 16 bits of each lane.
+	SIMD::UInt Load16(OutOfBoundsBehavior robustness, SIMD::Int mask) const;
+	void Store16(SIMD::UInt val, OutOfBoundsBehavior robustness, SIMD::Int mask) const;
+
 	scalar::Pointer<Byte> getUniformPointer() const;
 	scalar::Pointer<Byte> getPointerForLane(int lane) const;
 	static Pointer IfThenElse(SIMD::Int condition, const Pointer &lhs, const Pointer &rhs);
@@ -193,6 +198,13 @@ public:
 	void castTo(SIMD::UInt &bits) const;                              // Cast from 32-bit pointers to 32-bit integers
 	void castTo(SIMD::UInt &lowerBits, SIMD::UInt &upperBits) const;  // Cast from 64-bit pointers to pairs of 32-bit integers
 
+	// Saves the dynamic state of the pointer to memory, and restores it from
+	// there, for pointers which must outlive the code they were built in.
+	// spillSize() returns the number of bytes written by spill().
+	unsigned int spillSize() const;
+	void spill(scalar::Pointer<Byte> storage) const;
+	void reload(scalar::Pointer<Byte> storage);
+
 #ifdef ENABLE_RR_PRINT
 	std::vector<rr::Value *> getPrintValues() const;
 #endif
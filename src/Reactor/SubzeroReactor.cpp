@@ -21,6 +21,7 @@
 #include "ExecutableMemory.hpp"
 #include "Optimizer.hpp"
 #include "PragmaInternals.hpp"
+#include "RoutineDeduplicator.hpp"
 
 #include "src/IceCfg.h"
 #include "src/IceCfgNode.h"
@@ -56,6 +57,7 @@
 #include <iostream>
 #include <limits>
 #include <mutex>
+#include <unordered_map>
 
 // Subzero utility functions
 // These functions only accept and return Subzero (Ice) types, and do not access any globals.
@@ -361,6 +363,12 @@ bool Caps::fmaIsFast()
 	return false;
 }
 
+bool Caps::gatherIsFast()
+{
+	// Gathers are emulated with scalar loads.
+	return false;
+}
+
 enum EmulatedType
 {
 	EmulatedShift = 16,
@@ -843,6 +851,7 @@ public:
 
 			if(memcmp(data, alignedPtr, size) == 0)
 			{
+				constantSizes.emplace(alignedPtr, size);
 				return alignedPtr;
 			}
 		}
@@ -854,27 +863,47 @@ public:
 		void *alignedPtr = std::align(alignment, size, ptr, space);
 		ASSERT(alignedPtr);
 		memcpy(alignedPtr, data, size);
-		constantsPool.emplace_back(std::move(buf), space);
+		constantsPool.emplace_back(std::move(buf), space, alignedPtr, size);
+		constantSizes.emplace(alignedPtr, size);
 
 		return alignedPtr;
 	}
 
+	// Adds the constant data at the given address to the hasher, if it was
+	// added by addConstantData(). Returns false otherwise.
+	bool hashConstantData(IRHasher &hasher, const void *ptr) const
+	{
+		auto it = constantSizes.find(ptr);
+		if(it == constantSizes.end())
+		{
+			return false;
+		}
+
+		hasher.add(ptr, it->second);
+		return true;
+	}
+
 private:
 	struct Constant
 	{
-		Constant(std::unique_ptr<uint8_t[]> data, size_t space)
+		Constant(std::unique_ptr<uint8_t[]> data, size_t space, const void *alignedPtr, size_t size)
 		    : data(std::move(data))
 		    , space(space)
+		    , alignedPtr(alignedPtr)
+		    , size(size)
 		{}
 
 		std::unique_ptr<uint8_t[]> data;
 		size_t space;
+		const void *alignedPtr;  // Start of the data as originally added.
+		size_t size;
 	};
 
 	std::array<const void *, Nucleus::CoroutineEntryCount> funcs = {};
 	std::vector<uint8_t, ExecutableAllocator<uint8_t>> buffer;
 	std::size_t position;
 	std::vector<Constant> constantsPool;
+	std::unordered_map<const void *, size_t> constantSizes;  // Sizes of the constants returned by addConstantData(), by address.
 };
 
 #ifdef ENABLE_RR_PRINT
@@ -971,6 +1000,218 @@ Nucleus::~Nucleus()
 	::codegenMutex.unlock();
 }
 
+// Adds the operand to the hasher. Constant data of the routine is hashed by content rather
+// than by address, so that routines with equal constants but separate copies of them
+// compare equal. Returns false for operands which can't be hashed.
+static bool hashOperand(IRHasher &hasher, const Ice::Operand *operand)
+{
+	if(!operand)
+	{
+		hasher.add(~uint64_t(0));
+		return true;
+	}
+
+	hasher.add(operand->getKind());
+	hasher.add(operand->getType());
+
+	switch(operand->getKind())
+	{
+	case Ice::Operand::kConstInteger32:
+		{
+			int32_t value = llvm::cast<Ice::ConstantInteger32>(operand)->getValue();
+			if(sizeof(void *) == 4 && ::routine->hashConstantData(hasher, reinterpret_cast<const void *>(static_cast<intptr_t>(value))))
+			{
+				return true;
+			}
+			hasher.add(static_cast<uint32_t>(value));
+		}
+		return true;
+	case Ice::Operand::kConstInteger64:
+		{
+			int64_t value = llvm::cast<Ice::ConstantInteger64>(operand)->getValue();
+			if(sizeof(void *) == 8 && ::routine->hashConstantData(hasher, reinterpret_cast<const void *>(static_cast<intptr_t>(value))))
+			{
+				return true;
+			}
+			hasher.add(static_cast<uint64_t>(value));
+		}
+		return true;
+	case Ice::Operand::kConstFloat:
+		{
+			float value = llvm::cast<Ice::ConstantFloat>(operand)->getValue();
+			hasher.add(&value, sizeof(value));
+		}
+		return true;
+	case Ice::Operand::kConstDouble:
+		{
+			double value = llvm::cast<Ice::ConstantDouble>(operand)->getValue();
+			hasher.add(&value, sizeof(value));
+		}
+		return true;
+	case Ice::Operand::kConstUndef:
+		return true;
+	default:
+		if(auto *variable = llvm::dyn_cast<Ice::Variable>(operand))
+		{
+			hasher.add(variable->getIndex());
+			return true;
+		}
+		return false;
+	}
+}
+
+// Adds the instruction to the hasher, including the properties which aren't operands.
+// Returns false for instructions which can't be hashed.
+static bool hashInstruction(IRHasher &hasher, const Ice::Inst &inst)
+{
+	hasher.add(inst.getKind());
+	hasher.add(inst.hasSideEffects());
+
+	if(!hashOperand(hasher, inst.getDest()))
+	{
+		return false;
+	}
+
+	hasher.add(inst.getSrcSize());
+	for(Ice::SizeT i = 0; i < inst.getSrcSize(); i++)
+	{
+		if(!hashOperand(hasher, inst.getSrc(i)))
+		{
+			return false;
+		}
+	}
+
+	switch(inst.getKind())
+	{
+	case Ice::Inst::Alloca:
+		{
+			auto *alloca = llvm::cast<Ice::InstAlloca>(&inst);
+			hasher.add(alloca->getAlignInBytes());
+			hasher.add(alloca->getKnownFrameOffset());
+		}
+		return true;
+	case Ice::Inst::Arithmetic:
+		hasher.add(llvm::cast<Ice::InstArithmetic>(&inst)->getOp());
+		return true;
+	case Ice::Inst::Br:
+		{
+			auto *br = llvm::cast<Ice::InstBr>(&inst);
+			hasher.add(br->getTargetFalse()->getIndex());
+			hasher.add(br->isUnconditional() ? ~uint64_t(0) : br->getTargetTrue()->getIndex());
+		}
+		return true;
+	case Ice::Inst::Call:
+		{
+			auto *call = llvm::cast<Ice::InstCall>(&inst);
+			hasher.add(call->isTailcall());
+			hasher.add(call->isTargetHelperCall());
+			hasher.add(call->isVariadic());
+		}
+		return true;
+	case Ice::Inst::Cast:
+		hasher.add(llvm::cast<Ice::InstCast>(&inst)->getCastKind());
+		return true;
+	case Ice::Inst::Fcmp:
+		hasher.add(llvm::cast<Ice::InstFcmp>(&inst)->getCondition());
+		return true;
+	case Ice::Inst::Icmp:
+		hasher.add(llvm::cast<Ice::InstIcmp>(&inst)->getCondition());
+		return true;
+	case Ice::Inst::Intrinsic:
+		{
+			Ice::Intrinsics::IntrinsicInfo info = llvm::cast<Ice::InstIntrinsic>(&inst)->getIntrinsicInfo();
+			hasher.add(info.ID);
+			hasher.add(info.HasSideEffects);
+			hasher.add(info.ReturnsTwice);
+			hasher.add(info.IsMemoryWrite);
+		}
+		return true;
+	case Ice::Inst::Phi:
+		{
+			auto *phi = llvm::cast<Ice::InstPhi>(&inst);
+			for(Ice::SizeT i = 0; i < phi->getSrcSize(); i++)
+			{
+				hasher.add(phi->getLabel(i)->getIndex());
+			}
+		}
+		return true;
+	case Ice::Inst::ShuffleVector:
+		{
+			auto *shuffle = llvm::cast<Ice::InstShuffleVector>(&inst);
+			hasher.add(shuffle->getNumIndexes());
+			for(Ice::SizeT i = 0; i < shuffle->getNumIndexes(); i++)
+			{
+				hasher.add(static_cast<uint32_t>(shuffle->getIndexValue(i)));
+			}
+		}
+		return true;
+	case Ice::Inst::Switch:
+		{
+			auto *sw = llvm::cast<Ice::InstSwitch>(&inst);
+			hasher.add(sw->getLabelDefault()->getIndex());
+			hasher.add(sw->getNumCases());
+			for(Ice::SizeT i = 0; i < sw->getNumCases(); i++)
+			{
+				hasher.add(sw->getValue(i));
+				hasher.add(sw->getLabel(i)->getIndex());
+			}
+		}
+		return true;
+	case Ice::Inst::Unreachable:
+	case Ice::Inst::Assign:
+	case Ice::Inst::ExtractElement:
+	case Ice::Inst::InsertElement:
+	case Ice::Inst::Load:
+	case Ice::Inst::Ret:
+	case Ice::Inst::Select:
+	case Ice::Inst::Store:
+		return true;
+	default:
+		// Lowering-only and target-specific instructions.
+		return false;
+	}
+}
+
+// Adds the complete IR of the function to the hasher. Returns false if it contains
+// anything which can't be hashed, in which case the routine is not deduplicated.
+static bool hashFunction(IRHasher &hasher, const Ice::Cfg *function)
+{
+	hasher.add(function->getReturnType());
+	hasher.add(function->getInternal());
+
+	hasher.add(function->getArgs().size());
+	for(const Ice::Variable *arg : function->getArgs())
+	{
+		hashOperand(hasher, arg);
+	}
+
+	hasher.add(function->getNodes().size());
+	for(const Ice::CfgNode *node : function->getNodes())
+	{
+		hasher.add(node->getIndex());
+
+		for(const Ice::Inst &inst : node->getPhis())
+		{
+			if(!inst.isDeleted() && !hashInstruction(hasher, inst))
+			{
+				return false;
+			}
+		}
+
+		for(const Ice::Inst &inst : node->getInsts())
+		{
+			if(!inst.isDeleted() && !hashInstruction(hasher, inst))
+			{
+				return false;
+			}
+		}
+
+		hasher.add(~uint64_t(0));  // End of node.
+	}
+
+	return true;
+}
+
 // This function lowers and produces executable binary code in memory for the input functions,
 // and returns a Routine with the entry points to these functions.
 template<size_t Count>
@@ -987,7 +1228,7 @@ static std::shared_ptr<Routine> acquireRoutine(Ice::Cfg *const (&functions)[Coun
 
 	::context->emitFileHeader();
 
-	// Translate
+	// Optimize
 
 	for(size_t i = 0; i < Count; ++i)
 	{
@@ -1012,6 +1253,37 @@ static std::shared_ptr<Routine> acquireRoutine(Ice::Cfg *const (&functions)[Coun
 
 		currFunc->computeInOutEdges();
 		ASSERT_MSG(!currFunc->hasError(), "%s", currFunc->getError().c_str());
+	}
+
+	// Reuse the routine compiled from identical IR, if there is one. Function names
+	// only serve to look up the entry points, so they don't need to match.
+
+	IRHasher hasher;
+	bool hashable = (::routine != nullptr) && !subzeroEmitTextAsm;
+	hasher.add(Count);
+	hasher.add(Ice::getFlags().getOptLevel());
+
+	for(size_t i = 0; i < Count && hashable; ++i)
+	{
+		hashable = hashFunction(hasher, functions[i]);
+	}
+
+	if(hashable)
+	{
+		if(auto existing = RoutineDeduplicator::find(hasher))
+		{
+			return existing;
+		}
+	}
+
+	// Translate
+
+	for(size_t i = 0; i < Count; ++i)
+	{
+		Ice::Cfg *currFunc = functions[i];
+
+		// Install function allocator in TLS for Cfg-specific container allocators
+		Ice::CfgLocalAllocatorScope allocScope(currFunc);
 
 		currFunc->translate();
 		ASSERT_MSG(!currFunc->hasError(), "%s", currFunc->getError().c_str());
@@ -1074,7 +1346,14 @@ static std::shared_ptr<Routine> acquireRoutine(Ice::Cfg *const (&functions)[Coun
 	Routine *handoffRoutine = ::routine;
 	::routine = nullptr;
 
-	return std::shared_ptr<Routine>(handoffRoutine);
+	std::shared_ptr<Routine> routine(handoffRoutine);
+
+	if(hashable)
+	{
+		RoutineDeduplicator::add(hasher, routine);
+	}
+
+	return routine;
 }
 
 std::shared_ptr<Routine> Nucleus::acquireRoutine(const char *name)
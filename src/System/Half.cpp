@@ -56,7 +56,13 @@ half::operator float() const
 	int e = (fp16i >> 10) & 0x0000001F;
 	int m = fp16i & 0x000003FF;
 
-	if(e == 0)
+	if(e == 0x1F)  // Infinity or NaN
+	{
+		fp32i = (s << 31) | 0x7F800000 | (m << 13);
+
+		return bit_cast<float>(fp32i);
+	}
+	else if(e == 0)
 	{
 		if(m == 0)
 		{
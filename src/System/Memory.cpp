@@ -30,6 +30,7 @@
 #	include <unistd.h>
 #endif
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 
@@ -121,6 +122,73 @@ void freeMemory(void *memory)
 	}
 }
 
+size_t hugePageSize()
+{
+	return 2 * 1024 * 1024;  // Transparent huge pages on x86-64, and the common case on ARM64.
+}
+
+void *allocatePages(size_t bytes, size_t alignment)
+{
+	ASSERT((alignment & (alignment - 1)) == 0);  // Power of 2 alignment.
+
+#if defined(_WIN32)
+	// VirtualAlloc() returns zeroed pages aligned to the 64 kB allocation granularity.
+	// They're charged against the commit limit, but only backed on first access.
+	ASSERT(alignment <= 0x10000);
+	return VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+	if(bytes < hugePageSize())
+	{
+		ASSERT(alignment <= memoryPageSize());
+		void *mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		return (mapping != MAP_FAILED) ? mapping : nullptr;
+	}
+
+	// Over-reserve so that the start can be aligned to a huge page boundary, then
+	// return the excess address space at both ends.
+	alignment = std::max(alignment, hugePageSize());
+	size_t size = bytes + alignment;
+	void *mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if(mapping == MAP_FAILED)
+	{
+		return nullptr;
+	}
+
+	uintptr_t start = reinterpret_cast<uintptr_t>(mapping);
+	uintptr_t aligned = (start + alignment - 1) & ~(alignment - 1);
+	uintptr_t end = aligned + ((bytes + memoryPageSize() - 1) & ~(memoryPageSize() - 1));
+
+	if(aligned > start)
+	{
+		munmap(mapping, aligned - start);
+	}
+
+	if(start + size > end)
+	{
+		munmap(reinterpret_cast<void *>(end), start + size - end);
+	}
+
+#	if defined(MADV_HUGEPAGE)
+	// Only a hint. Fails harmlessly when transparent huge pages are disabled.
+	madvise(reinterpret_cast<void *>(aligned), end - aligned, MADV_HUGEPAGE);
+#	endif
+
+	return reinterpret_cast<void *>(aligned);
+#endif
+}
+
+void freePages(void *memory, size_t bytes)
+{
+	if(memory)
+	{
+#if defined(_WIN32)
+		VirtualFree(memory, 0, MEM_RELEASE);
+#else
+		munmap(memory, bytes);
+#endif
+	}
+}
+
 void clear(uint16_t *memory, uint16_t element, size_t count)
 {
 #if defined(_MSC_VER) && defined(__x86__) && !defined(MEMORY_SANITIZER)
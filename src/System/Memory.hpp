@@ -27,6 +27,13 @@ void *allocateZeroOrPoison(size_t bytes, size_t alignment = 16);  // Initialized
 
 void freeMemory(void *memory);
 
+// Allocates memory directly from the operating system, bypassing the heap. The memory is
+// zero-initialized, but physical pages only get committed when first touched. Allocations
+// of at least hugePageSize() bytes are aligned to it and marked as eligible for huge pages.
+void *allocatePages(size_t bytes, size_t alignment);
+void freePages(void *memory, size_t bytes);  // 'bytes' must match the allocatePages() call.
+size_t hugePageSize();
+
 void clear(uint16_t *memory, uint16_t element, size_t count);
 void clear(uint32_t *memory, uint32_t element, size_t count);
 
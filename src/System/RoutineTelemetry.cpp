@@ -0,0 +1,329 @@
+// Copyright 2026 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "RoutineTelemetry.hpp"
+
+#include "Debug.hpp"
+
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+// Compile times are binned in microseconds, with four buckets per octave.
+// Bucket 0 holds times below 1 us, and bucket i > 0 holds times up to
+// 2^(i / 4) us. The last bucket also holds everything longer, from about 28 s.
+constexpr int bucketsPerOctave = 4;
+constexpr int histogramBuckets = 100;
+
+int histogramBucket(double seconds)
+{
+	double microseconds = seconds * 1.0e6;
+	if(!(microseconds >= 1.0))  // Also catches NaN.
+	{
+		return 0;
+	}
+
+	int bucket = static_cast<int>(std::ceil(std::log2(microseconds) * bucketsPerOctave));
+	return std::min(std::max(bucket, 1), histogramBuckets - 1);
+}
+
+double bucketUpperBound(int bucket)
+{
+	return std::exp2(static_cast<double>(bucket) / bucketsPerOctave) * 1.0e-6;
+}
+
+// Counters of each kind are on separate cache lines, as they are updated
+// independently by different threads.
+struct alignas(64) Counters
+{
+	std::atomic<uint64_t> compileCount;
+	std::atomic<uint64_t> compileNanoseconds;
+	std::atomic<uint64_t> cacheHits;
+	std::atomic<uint64_t> cacheMisses;
+	std::atomic<uint32_t> histogram[histogramBuckets];
+};
+
+Counters counters[static_cast<int>(sw::RoutineKind::Count)];
+
+Counters &getCounters(sw::RoutineKind kind)
+{
+	ASSERT(kind < sw::RoutineKind::Count);
+	return counters[static_cast<int>(kind)];
+}
+
+// Vertex deduplication counts of one thread. Only the owning thread modifies
+// them, so they are atomic just to be read by other threads.
+struct VertexCounters
+{
+	std::atomic<uint64_t> batchVertices = { 0 };
+	std::atomic<uint64_t> shadedVertices = { 0 };
+};
+
+// The vertex counters of all live threads, and the sums of those of exited threads.
+// Intentionally leaked, as threads may exit during static destruction.
+struct VertexCounterRegistry
+{
+	std::mutex mutex;
+	std::vector<const VertexCounters *> threads;
+	sw::VertexDeduplicationStats exitedThreads;
+};
+
+VertexCounterRegistry &getVertexCounterRegistry()
+{
+	static VertexCounterRegistry *registry = new VertexCounterRegistry();
+	return *registry;
+}
+
+class ThreadVertexCounters
+{
+public:
+	ThreadVertexCounters()
+	{
+		VertexCounterRegistry &registry = getVertexCounterRegistry();
+		std::unique_lock<std::mutex> lock(registry.mutex);
+		registry.threads.push_back(&counters);
+	}
+
+	~ThreadVertexCounters()
+	{
+		VertexCounterRegistry &registry = getVertexCounterRegistry();
+		std::unique_lock<std::mutex> lock(registry.mutex);
+		registry.exitedThreads.batchVertices += counters.batchVertices.load(std::memory_order_relaxed);
+		registry.exitedThreads.shadedVertices += counters.shadedVertices.load(std::memory_order_relaxed);
+		registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), &counters));
+	}
+
+	VertexCounters counters;
+};
+
+// Number of live Reporters. Vertex deduplication is only recorded while non-zero.
+std::atomic<int> reporterCount = { 0 };
+
+}  // anonymous namespace
+
+namespace sw {
+
+const char *RoutineKindName(RoutineKind kind)
+{
+	switch(kind)
+	{
+	case RoutineKind::Vertex:
+		return "Vertex";
+	case RoutineKind::Pixel:
+		return "Pixel";
+	case RoutineKind::Setup:
+		return "Setup";
+	case RoutineKind::Sampler:
+		return "Sampler";
+	case RoutineKind::Blit:
+		return "Blit";
+	case RoutineKind::Resolve:
+		return "Resolve";
+	case RoutineKind::CornerUpdate:
+		return "CornerUpdate";
+	case RoutineKind::Compute:
+		return "Compute";
+	default:
+		UNSUPPORTED("RoutineKind %d", int(kind));
+		return "";
+	}
+}
+
+void RoutineTelemetry::recordCompile(RoutineKind kind, double seconds)
+{
+	Counters &c = getCounters(kind);
+
+	c.compileCount.fetch_add(1, std::memory_order_relaxed);
+	c.compileNanoseconds.fetch_add(static_cast<uint64_t>(std::max(seconds, 0.0) * 1.0e9), std::memory_order_relaxed);
+	c.histogram[histogramBucket(seconds)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void RoutineTelemetry::recordCacheLookup(RoutineKind kind, bool hit)
+{
+	Counters &c = getCounters(kind);
+
+	(hit ? c.cacheHits : c.cacheMisses).fetch_add(1, std::memory_order_relaxed);
+}
+
+RoutineStats RoutineTelemetry::query(RoutineKind kind)
+{
+	const Counters &c = getCounters(kind);
+
+	RoutineStats stats;
+	stats.compileCount = c.compileCount.load(std::memory_order_relaxed);
+	stats.totalCompileSeconds = c.compileNanoseconds.load(std::memory_order_relaxed) * 1.0e-9;
+	stats.cacheHits = c.cacheHits.load(std::memory_order_relaxed);
+	stats.cacheMisses = c.cacheMisses.load(std::memory_order_relaxed);
+
+	// The histogram is read without synchronization with concurrent compiles,
+	// so count its entries instead of relying on compileCount.
+	uint64_t histogram[histogramBuckets];
+	uint64_t total = 0;
+	for(int i = 0; i < histogramBuckets; i++)
+	{
+		histogram[i] = c.histogram[i].load(std::memory_order_relaxed);
+		total += histogram[i];
+	}
+
+	// The 99th percentile is the smallest time at or below which 99% of compiles completed.
+	uint64_t rank = (total * 99 + 99) / 100;
+	uint64_t cumulative = 0;
+	for(int i = 0; i < histogramBuckets && total > 0; i++)
+	{
+		cumulative += histogram[i];
+		if(cumulative >= rank)
+		{
+			stats.p99CompileSeconds = bucketUpperBound(i);
+			break;
+		}
+	}
+
+	return stats;
+}
+
+void RoutineTelemetry::reset()
+{
+	for(Counters &c : counters)
+	{
+		c.compileCount.store(0, std::memory_order_relaxed);
+		c.compileNanoseconds.store(0, std::memory_order_relaxed);
+		c.cacheHits.store(0, std::memory_order_relaxed);
+		c.cacheMisses.store(0, std::memory_order_relaxed);
+
+		for(auto &bucket : c.histogram)
+		{
+			bucket.store(0, std::memory_order_relaxed);
+		}
+	}
+}
+
+void RoutineTelemetry::recordVertexDeduplication(uint32_t batchVertices, uint32_t shadedVertices)
+{
+	if(reporterCount.load(std::memory_order_relaxed) == 0)
+	{
+		return;
+	}
+
+	thread_local ThreadVertexCounters thread;
+	VertexCounters &c = thread.counters;
+
+	c.batchVertices.store(c.batchVertices.load(std::memory_order_relaxed) + batchVertices, std::memory_order_relaxed);
+	c.shadedVertices.store(c.shadedVertices.load(std::memory_order_relaxed) + shadedVertices, std::memory_order_relaxed);
+}
+
+VertexDeduplicationStats RoutineTelemetry::queryVertexDeduplication()
+{
+	VertexCounterRegistry &registry = getVertexCounterRegistry();
+	std::unique_lock<std::mutex> lock(registry.mutex);
+
+	VertexDeduplicationStats stats = registry.exitedThreads;
+	for(const VertexCounters *c : registry.threads)
+	{
+		stats.batchVertices += c->batchVertices.load(std::memory_order_relaxed);
+		stats.shadedVertices += c->shadedVertices.load(std::memory_order_relaxed);
+	}
+
+	return stats;
+}
+
+std::string RoutineTelemetry::report()
+{
+	std::ostringstream s;
+	s << std::left << std::setw(14) << "Kind" << std::right
+	  << std::setw(10) << "Compiles"
+	  << std::setw(14) << "Total (ms)"
+	  << std::setw(12) << "p99 (ms)"
+	  << std::setw(12) << "Hits"
+	  << std::setw(12) << "Misses"
+	  << std::setw(10) << "Hit rate" << std::endl;
+
+	for(int i = 0; i < static_cast<int>(RoutineKind::Count); i++)
+	{
+		RoutineKind kind = static_cast<RoutineKind>(i);
+		RoutineStats stats = query(kind);
+
+		s << std::left << std::setw(14) << RoutineKindName(kind) << std::right
+		  << std::setw(10) << stats.compileCount
+		  << std::fixed << std::setprecision(3)
+		  << std::setw(14) << stats.totalCompileSeconds * 1.0e3
+		  << std::setw(12) << stats.p99CompileSeconds * 1.0e3
+		  << std::setw(12) << stats.cacheHits
+		  << std::setw(12) << stats.cacheMisses
+		  << std::setprecision(1)
+		  << std::setw(9) << stats.cacheHitRate() * 100.0 << "%" << std::endl;
+	}
+
+	return s.str();
+}
+
+RoutineTelemetry::Reporter::Reporter(const Configuration &config)
+    : filePath(config.routineTelemetryReportFile)
+    , vertexStart(queryVertexDeduplication())
+{
+	reporterCount.fetch_add(1, std::memory_order_relaxed);
+
+	auto period = std::chrono::milliseconds(config.routineTelemetryReportPeriodMs);
+
+	thread = std::thread{ [this, period] {
+		std::unique_lock<std::mutex> lock(mutex);
+		while(!stopped.wait_for(lock, period, [this] { return stop; }))
+		{
+			write();
+		}
+	} };
+}
+
+RoutineTelemetry::Reporter::~Reporter()
+{
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		stop = true;
+	}
+	stopped.notify_all();
+	thread.join();
+
+	// Report the compiles since the last periodic report.
+	write();
+
+	reporterCount.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void RoutineTelemetry::Reporter::write()
+{
+	std::ofstream f{ filePath };
+
+	if(!f)
+	{
+		warn("Error writing routine telemetry to file %s: %s\n", filePath.c_str(), strerror(errno));
+		return;
+	}
+
+	VertexDeduplicationStats vertexStats = queryVertexDeduplication();
+	vertexStats.batchVertices -= vertexStart.batchVertices;
+	vertexStats.shadedVertices -= vertexStart.shadedVertices;
+
+	f << report();
+	f << "Vertex deduplication: " << vertexStats.batchVertices << " batch vertices, "
+	  << vertexStats.shadedVertices << " shaded, reuse "
+	  << std::fixed << std::setprecision(3) << vertexStats.reuse() << std::endl;
+}
+
+}  // namespace sw
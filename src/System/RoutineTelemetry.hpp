@@ -0,0 +1,158 @@
+// Copyright 2026 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef sw_RoutineTelemetry_hpp
+#define sw_RoutineTelemetry_hpp
+
+#include "SwiftConfig.hpp"
+#include "Timeline.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace sw {
+
+// Kinds of routines which are generated and JIT-compiled on demand.
+enum class RoutineKind
+{
+	Vertex,
+	Pixel,
+	Setup,
+	Sampler,
+	Blit,
+	Resolve,
+	CornerUpdate,
+	Compute,
+
+	Count
+};
+
+const char *RoutineKindName(RoutineKind kind);
+
+// Statistics of the routines of one kind, accumulated since the start of the
+// process or the last call to RoutineTelemetry::reset().
+struct RoutineStats
+{
+	uint64_t compileCount = 0;
+	double totalCompileSeconds = 0.0;
+	// Upper bound of the 99th percentile compile time. Compile times are
+	// recorded in a histogram with four buckets per octave, so this is
+	// accurate to within 19%.
+	double p99CompileSeconds = 0.0;
+
+	uint64_t cacheHits = 0;
+	uint64_t cacheMisses = 0;
+
+	double cacheHitRate() const
+	{
+		uint64_t lookups = cacheHits + cacheMisses;
+		return (lookups > 0) ? static_cast<double>(cacheHits) / lookups : 0.0;
+	}
+};
+
+// Counts of the vertices of the deduplicated batches of indexed draws, and of
+// the unique vertices among them which got shaded.
+struct VertexDeduplicationStats
+{
+	uint64_t batchVertices = 0;
+	uint64_t shadedVertices = 0;
+
+	// Average number of batch vertices per shaded vertex.
+	double reuse() const
+	{
+		return (shadedVertices > 0) ? static_cast<double>(batchVertices) / shadedVertices : 0.0;
+	}
+};
+
+// RoutineTelemetry keeps process-wide counters of how often each kind of
+// routine gets generated, how long that takes, and how effective the caches
+// holding them are. Recording is lock-free and may be done from any thread.
+class RoutineTelemetry
+{
+public:
+	// Records the time taken to generate and JIT-compile a routine.
+	static void recordCompile(RoutineKind kind, double seconds);
+
+	// Records a lookup of a routine cache, which either found the routine or
+	// will be followed by compiling it.
+	static void recordCacheLookup(RoutineKind kind, bool hit);
+
+	static RoutineStats query(RoutineKind kind);
+	static void reset();
+
+	// Records the vertices of a deduplicated batch. This happens for every batch, so it
+	// is only recorded while a Reporter exists, in counters of the calling thread which
+	// are merged by queryVertexDeduplication().
+	static void recordVertexDeduplication(uint32_t batchVertices, uint32_t shadedVertices);
+	static VertexDeduplicationStats queryVertexDeduplication();
+
+	// Returns a table of the statistics of all kinds of routines, one line per kind.
+	static std::string report();
+
+	// Reporter periodically writes report() to the file given by the configuration's
+	// routineTelemetryReportFile, and once more when it is destroyed. The report ends
+	// with the vertex deduplication statistics recorded since the Reporter was created.
+	class Reporter
+	{
+	public:
+		Reporter(const Configuration &config);
+		~Reporter();
+
+	private:
+		void write();
+
+		const std::string filePath;
+		const VertexDeduplicationStats vertexStart;
+
+		std::mutex mutex;
+		std::condition_variable stopped;
+		bool stop = false;
+		std::thread thread;
+	};
+
+	// Records the time from construction to destruction as a compile of the given kind,
+	// and on the timeline when it is enabled.
+	class ScopedCompile
+	{
+	public:
+		ScopedCompile(RoutineKind kind)
+		    : kind(kind)
+		    , start(std::chrono::steady_clock::now())
+		{}
+
+		~ScopedCompile()
+		{
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			recordCompile(kind, elapsed.count());
+
+			if(Timeline::isEnabled())
+			{
+				int64_t begin = std::chrono::duration_cast<std::chrono::nanoseconds>(start.time_since_epoch()).count();
+				Timeline::record(Timeline::Category::Compile, RoutineKindName(kind), begin);
+			}
+		}
+
+	private:
+		const RoutineKind kind;
+		const std::chrono::steady_clock::time_point start;
+	};
+};
+
+}  // namespace sw
+
+#endif  // sw_RoutineTelemetry_hpp
@@ -20,6 +20,9 @@
 #include "marl/scheduler.h"
 
 #include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
 
 namespace {
 
@@ -68,6 +71,46 @@ marl::Thread::Affinity getAffinityFromMask(uint64_t affinityMask)
 	return marl::Thread::Affinity(cores, marl::Allocator::Default);
 }
 
+// Returns the affinity covering the cores of the given NUMA node which are also in
+// the affinity mask, or an empty affinity if the node's cores cannot be determined.
+marl::Thread::Affinity getAffinityFromNumaNode(int node, uint64_t affinityMask)
+{
+	marl::containers::vector<marl::Thread::Core, 32> cores;
+
+#if defined(__linux__)
+	// The cpulist file holds comma-separated ranges, e.g. "0-15,32-47".
+	std::ifstream cpulist("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+	std::string range;
+	while(std::getline(cpulist, range, ','))
+	{
+		unsigned int first = 0;
+		unsigned int last = 0;
+		int fields = sscanf(range.c_str(), "%u-%u", &first, &last);
+		if(fields < 1) { continue; }
+		if(fields == 1) { last = first; }
+
+		for(unsigned int index = first; index <= last && index <= 0xFFFF; index++)
+		{
+			// Masks can only express the first 64 cores, so cores beyond those are
+			// only excluded when all-cores affinity wasn't requested.
+			bool inMask = (affinityMask == std::numeric_limits<uint64_t>::max()) ||
+			              (index < 64 && (affinityMask & (uint64_t(1) << index)));
+			if(inMask)
+			{
+				marl::Thread::Core core = {};
+				core.pthread.index = static_cast<uint16_t>(index);
+				cores.push_back(core);
+			}
+		}
+	}
+#else
+	(void)node;
+	(void)affinityMask;
+#endif
+
+	return marl::Thread::Affinity(cores, marl::Allocator::Default);
+}
+
 std::shared_ptr<marl::Thread::Affinity::Policy> getAffinityPolicy(marl::Thread::Affinity &&affinity, sw::Configuration::AffinityPolicy affinityPolicy)
 {
 	switch(affinityPolicy)
@@ -108,11 +151,27 @@ Configuration readConfigurationFromFile()
 		// Default.
 		config.affinityPolicy = Configuration::AffinityPolicy::AnyOf;
 	}
+	config.precompileSamplingRoutines = ini.getBoolean("Processor", "PrecompileSamplingRoutines");
+	config.splitComputePhases = ini.getBoolean("Processor", "SplitComputePhases");
+	config.maxAutoThreadCount = ini.getInteger<uint32_t>("Processor", "MaxAutoThreadCount", 16);
+	if(config.maxAutoThreadCount == 0)
+	{
+		warn("MaxAutoThreadCount is 0, using 16\n");
+		config.maxAutoThreadCount = 16;
+	}
+	config.numaNode = ini.getInteger<int32_t>("Processor", "NumaNode", -1);
+	config.clusterCount = ini.getInteger<uint32_t>("Processor", "ClusterCount", 0);
+	config.batchCount = ini.getInteger<uint32_t>("Processor", "BatchCount", 0);
+	config.drawCount = ini.getInteger<uint32_t>("Processor", "DrawCount", 0);
 
 	// Profiling flags.
 	config.enableSpirvProfiling = ini.getBoolean("Profiler", "EnableSpirvProfiling");
 	config.spvProfilingReportPeriodMs = ini.getInteger<uint64_t>("Profiler", "SpirvProfilingReportPeriodMs");
 	config.spvProfilingReportDir = ini.getValue("Profiler", "SpirvProfilingReportDir");
+	config.timelineTraceFile = ini.getValue("Profiler", "TimelineTraceFile");
+	config.timelineEventsPerThread = ini.getInteger<uint32_t>("Profiler", "TimelineEventsPerThread", 16384);
+	config.routineTelemetryReportFile = ini.getValue("Profiler", "RoutineTelemetryReportFile");
+	config.routineTelemetryReportPeriodMs = ini.getInteger<uint64_t>("Profiler", "RoutineTelemetryReportPeriodMs", 1000);
 
 	return config;
 }
@@ -125,9 +184,25 @@ const Configuration &getConfiguration()
 
 marl::Scheduler::Config getSchedulerConfiguration(const Configuration &config)
 {
-	uint32_t threadCount = (config.threadCount == 0) ? std::min<size_t>(marl::Thread::numLogicalCPUs(), 16)
-	                                                 : config.threadCount;
+	size_t coresAvailable = marl::Thread::numLogicalCPUs();
 	auto affinity = getAffinityFromMask(config.affinityMask);
+
+	if(config.numaNode >= 0)
+	{
+		auto nodeAffinity = getAffinityFromNumaNode(config.numaNode, config.affinityMask);
+		if(nodeAffinity.count() > 0)
+		{
+			affinity = std::move(nodeAffinity);
+			coresAvailable = affinity.count();
+		}
+		else
+		{
+			warn("No usable cores found for NUMA node %d, ignoring NumaNode\n", int(config.numaNode));
+		}
+	}
+
+	uint32_t threadCount = (config.threadCount == 0) ? std::min<size_t>(coresAvailable, config.maxAutoThreadCount)
+	                                                 : config.threadCount;
 	auto affinityPolicy = getAffinityPolicy(std::move(affinity), config.affinityPolicy);
 
 	marl::Scheduler::Config cfg;
@@ -34,13 +34,41 @@ struct Configuration
 
 	// -------- [Processor] --------
 	// Number of threads used by the scheduler. A thread count of 0 is
-	// interpreted as min(cpu_cores_available, 16).
+	// interpreted as min(cpu_cores_available, maxAutoThreadCount).
 	uint32_t threadCount = 0;
 
+	// Upper bound for the number of threads used when threadCount is 0.
+	uint32_t maxAutoThreadCount = 16;
+
+	// NUMA node the scheduler's worker threads are restricted to, or -1 to
+	// not restrict them. When set, cpu_cores_available above counts the
+	// cores of that node only. Only supported on Linux.
+	int32_t numaNode = -1;
+
+	// Number of clusters the renderer distributes framebuffer rows over,
+	// rounded down to a power of two. A cluster count of 0 is interpreted as
+	// the scheduler's thread count rounded up to a power of two, and at least 16.
+	uint32_t clusterCount = 0;
+
+	// Maximum number of vertex batches and draw calls the renderer keeps in
+	// flight. A count of 0 is interpreted as max(thread_count, 16).
+	uint32_t batchCount = 0;
+	uint32_t drawCount = 0;
+
 	// Core affinity and affinity policy used by the scheduler.
 	uint64_t affinityMask = 0xFFFFFFFFFFFFFFFFu;
 	AffinityPolicy affinityPolicy = AffinityPolicy::AnyOf;
 
+	// Whether sampling routines are compiled on background tasks when image
+	// descriptors are written, instead of when a shader first samples them.
+	bool precompileSamplingRoutines = false;
+
+	// Whether compute shaders with control barriers are split into phases at
+	// the barriers, which run for all subgroups in turn, instead of running
+	// each subgroup as a coroutine suspended at every barrier. Read again
+	// whenever a device is created.
+	bool splitComputePhases = false;
+
 	// -------- [Profiler] --------
 	// Whether SPIR-V profiling is enabled.
 	bool enableSpirvProfiling = false;
@@ -48,11 +76,28 @@ struct Configuration
 	uint64_t spvProfilingReportPeriodMs = 1000;
 	// Directory where SPIR-V profile reports will be written.
 	std::string spvProfilingReportDir = "";
+	// File the timeline of command buffers, draws, dispatches and routine
+	// compiles is written to as a Chrome trace, when a device is destroyed.
+	// Timeline tracing is disabled when empty.
+	std::string timelineTraceFile = "";
+	// Number of most recent timeline events kept for each thread.
+	uint32_t timelineEventsPerThread = 16384;
+	// File the routine compile and cache statistics, and the vertex deduplication
+	// statistics, are periodically written to. Reporting is disabled when empty.
+	// Read again whenever a device is created.
+	std::string routineTelemetryReportFile = "";
+	// Period controlling how often the routine statistics are reported.
+	uint64_t routineTelemetryReportPeriodMs = 1000;
 };
 
 // Get the configuration as parsed from a configuration file.
 const Configuration &getConfiguration();
 
+// Parse the configuration file again, without caching the result. Used when
+// creating a new scheduler, so that thread settings can change between
+// instances.
+Configuration readConfigurationFromFile();
+
 // Get the scheduler configuration given a configuration.
 marl::Scheduler::Config getSchedulerConfiguration(const Configuration &config);
 
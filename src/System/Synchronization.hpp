@@ -29,8 +29,11 @@
 #include <condition_variable>
 #include <queue>
 
+#include "marl/conditionvariable.h"
+#include "marl/containers.h"
 #include "marl/event.h"
 #include "marl/mutex.h"
+#include "marl/pool.h"
 #include "marl/waitgroup.h"
 
 namespace sw {
@@ -178,6 +181,105 @@ size_t Chan<T>::count()
 	return queue.size();
 }
 
+// CappedPool is a pool of items of type T, with a maximum capacity which is
+// chosen at runtime rather than at compile time like marl::BoundedPool.
+// Items are allocated on demand the first time they are borrowed, and are
+// preserved (not reconstructed) between loans. Loans are marl::Loan<T>, so
+// a CappedPool can be used anywhere a marl::Pool<T> is expected.
+template<typename T>
+class CappedPool : public marl::Pool<T>
+{
+	using Item = typename marl::Pool<T>::Item;
+
+public:
+	using Loan = typename marl::Pool<T>::Loan;
+
+	CappedPool(size_t capacity, marl::Allocator *allocator = marl::Allocator::Default);
+
+	// borrow() borrows a single item from the pool, blocking until an item is
+	// returned if the pool has reached its capacity and all items are loaned.
+	Loan borrow() const;
+
+	// capacity() returns the maximum number of items that can be loaned at
+	// once.
+	size_t capacity() const { return storage->capacity; }
+
+private:
+	class Storage : public marl::Pool<T>::Storage
+	{
+	public:
+		Storage(size_t capacity, marl::Allocator *allocator);
+		~Storage();
+		void return_(Item *item) override;
+
+		const size_t capacity;
+		marl::Allocator *const allocator;
+		marl::mutex mutex;
+		marl::containers::vector<Item *, 16> items GUARDED_BY(mutex);
+		Item *free GUARDED_BY(mutex) = nullptr;
+		marl::ConditionVariable returned;
+	};
+
+	std::shared_ptr<Storage> storage;
+};
+
+template<typename T>
+CappedPool<T>::Storage::Storage(size_t capacity, marl::Allocator *allocator)
+    : capacity(capacity)
+    , allocator(allocator)
+    , items(allocator)
+    , returned(allocator)
+{
+	ASSERT(capacity > 0);
+}
+
+template<typename T>
+CappedPool<T>::Storage::~Storage()
+{
+	marl::lock lock(mutex);
+	for(auto item : items)
+	{
+		item->destruct();
+		allocator->destroy(item);
+	}
+}
+
+template<typename T>
+void CappedPool<T>::Storage::return_(Item *item)
+{
+	{
+		marl::lock lock(mutex);
+		item->next = free;
+		free = item;
+	}
+	returned.notify_one();
+}
+
+template<typename T>
+CappedPool<T>::CappedPool(size_t capacity, marl::Allocator *allocator)
+    : storage(allocator->make_shared<Storage>(capacity, allocator))
+{}
+
+template<typename T>
+typename CappedPool<T>::Loan CappedPool<T>::borrow() const
+{
+	marl::lock lock(storage->mutex);
+	if(storage->free == nullptr && storage->items.size() < storage->capacity)
+	{
+		Item *item = storage->allocator->template create<Item>();
+		item->construct();
+		storage->items.push_back(item);
+		storage->free = item;
+	}
+
+	storage->returned.wait(lock, [this]() REQUIRES(storage->mutex) { return storage->free != nullptr; });
+	Item *item = storage->free;
+	storage->free = item->next;
+	item->next = nullptr;
+
+	return Loan(item, storage);
+}
+
 }  // namespace sw
 
 #endif  // sw_Synchronization_hpp
@@ -0,0 +1,350 @@
+// Copyright 2026 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Timeline.hpp"
+
+#include "Debug.hpp"
+#include "SwiftConfig.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+using Category = sw::Timeline::Category;
+
+struct Event
+{
+	int64_t timestamp;
+	int64_t duration;
+	const char *name;  // Null for labels, which use the text instead.
+	uint64_t id;
+	uint32_t index;
+	Category category;
+	char phase;  // Chrome trace event phase: 'X' for complete events, 'B', 'E' or 'i' for labels.
+	char text[58];
+};
+
+static_assert(sizeof(Event) == 96, "Events should not straddle cache lines");
+
+// Ring buffer of the events recorded by one thread. Only that thread writes to
+// it, and publishes each event by incrementing the count. The count acts as the
+// sequence number of a seqlock: write() copies events without blocking the
+// recording thread, and discards the copies of slots which got reused meanwhile.
+struct ThreadEvents
+{
+	ThreadEvents(uint32_t threadId, size_t capacity)
+	    : threadId(threadId)
+	    , capacity(capacity)
+	    , events(new Event[capacity])
+	{}
+
+	const uint32_t threadId;
+	const size_t capacity;
+	Event *const events;
+
+	std::atomic<uint64_t> count = { 0 };  // Number of events recorded.
+	std::atomic<uint64_t> first = { 0 };  // Number of events discarded by a reset.
+};
+
+struct State
+{
+	State(const sw::Configuration &config)
+	    : enabled(!config.timelineTraceFile.empty())
+	    , path(config.timelineTraceFile)
+	    , capacity(std::max(config.timelineEventsPerThread, 1u))
+	{}
+
+	std::atomic<bool> enabled;
+	const std::string path;
+	const size_t capacity;
+	const int64_t origin = sw::Timeline::now();
+
+	std::mutex mutex;
+	std::vector<ThreadEvents *> threads;  // Guarded by the mutex. Never destroyed, as threads may outlive static destruction.
+};
+
+State &state()
+{
+	static State *state = new State(sw::getConfiguration());
+	return *state;
+}
+
+thread_local ThreadEvents *threadEvents = nullptr;
+
+ThreadEvents &getThreadEvents()
+{
+	if(!threadEvents)
+	{
+		State &s = state();
+		std::unique_lock<std::mutex> lock(s.mutex);
+
+		threadEvents = new ThreadEvents(static_cast<uint32_t>(s.threads.size() + 1), s.capacity);
+		s.threads.push_back(threadEvents);
+	}
+
+	return *threadEvents;
+}
+
+Event &beginEvent(ThreadEvents &t, uint64_t &i)
+{
+	i = t.count.load(std::memory_order_relaxed);
+
+	// Makes the count observed by write() after copying this slot include the
+	// events recorded before, so it can tell that the slot is being overwritten.
+	std::atomic_thread_fence(std::memory_order_release);
+
+	return t.events[i % t.capacity];
+}
+
+void endEvent(ThreadEvents &t, uint64_t i)
+{
+	t.count.store(i + 1, std::memory_order_release);
+}
+
+void recordLabel(char phase, const char *text)
+{
+	ThreadEvents &t = getThreadEvents();
+
+	uint64_t i;
+	Event &event = beginEvent(t, i);
+	event.timestamp = sw::Timeline::now();
+	event.duration = 0;
+	event.name = nullptr;
+	event.id = 0;
+	event.index = 0;
+	event.category = Category::Label;
+	event.phase = phase;
+	strncpy(event.text, text ? text : "", sizeof(event.text) - 1);
+	event.text[sizeof(event.text) - 1] = '\0';
+	endEvent(t, i);
+}
+
+const char *categoryName(Category category)
+{
+	switch(category)
+	{
+	case Category::CommandBuffer:
+		return "CommandBuffer";
+	case Category::Draw:
+		return "Draw";
+	case Category::Batch:
+		return "Batch";
+	case Category::Dispatch:
+		return "Dispatch";
+	case Category::Compile:
+		return "Compile";
+	case Category::Label:
+		return "Label";
+	default:
+		UNSUPPORTED("Timeline::Category %d", int(category));
+		return "";
+	}
+}
+
+void writeString(std::ostream &out, const char *string)
+{
+	out << '"';
+	for(const char *c = string; *c; c++)
+	{
+		switch(*c)
+		{
+		case '"':
+			out << "\\\"";
+			break;
+		case '\\':
+			out << "\\\\";
+			break;
+		default:
+			if(static_cast<unsigned char>(*c) < 0x20)
+			{
+				out << ' ';  // Control characters aren't expected in names or labels.
+			}
+			else
+			{
+				out << *c;
+			}
+			break;
+		}
+	}
+	out << '"';
+}
+
+void writeEvent(std::ostream &out, const Event &event, uint32_t threadId, int64_t origin)
+{
+	out << "{\"name\":";
+	writeString(out, event.name ? event.name : event.text);
+	out << ",\"cat\":\"" << categoryName(event.category) << "\",\"ph\":\"" << event.phase << "\"";
+	out << ",\"ts\":" << (event.timestamp - origin) / 1000.0;
+
+	if(event.phase == 'X')
+	{
+		out << ",\"dur\":" << event.duration / 1000.0;
+	}
+	else if(event.phase == 'i')
+	{
+		out << ",\"s\":\"t\"";
+	}
+
+	out << ",\"pid\":1,\"tid\":" << threadId;
+
+	switch(event.category)
+	{
+	case Category::CommandBuffer:
+		out << ",\"args\":{\"commands\":" << event.id << "}";
+		break;
+	case Category::Draw:
+		out << ",\"args\":{\"draw\":" << event.id << "}";
+		break;
+	case Category::Batch:
+		out << ",\"args\":{\"draw\":" << event.id << ",\"batch\":" << event.index << "}";
+		break;
+	case Category::Dispatch:
+		out << ",\"args\":{\"workgroups\":" << event.id << "}";
+		break;
+	default:
+		break;
+	}
+
+	out << "}";
+}
+
+}  // anonymous namespace
+
+namespace sw {
+
+bool Timeline::isEnabled()
+{
+	return state().enabled.load(std::memory_order_relaxed);
+}
+
+int64_t Timeline::now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Timeline::record(Category category, const char *name, int64_t begin, uint64_t id, uint32_t index)
+{
+	ThreadEvents &t = getThreadEvents();
+
+	uint64_t i;
+	Event &event = beginEvent(t, i);
+	event.timestamp = begin;
+	event.duration = now() - begin;
+	event.name = name;
+	event.id = id;
+	event.index = index;
+	event.category = category;
+	event.phase = 'X';
+	endEvent(t, i);
+}
+
+void Timeline::beginLabel(const char *text)
+{
+	if(isEnabled())
+	{
+		recordLabel('B', text);
+	}
+}
+
+void Timeline::endLabel()
+{
+	if(isEnabled())
+	{
+		recordLabel('E', "");
+	}
+}
+
+void Timeline::insertLabel(const char *text)
+{
+	if(isEnabled())
+	{
+		recordLabel('i', text);
+	}
+}
+
+void Timeline::write()
+{
+	if(isEnabled() && !state().path.empty())
+	{
+		write(state().path);
+	}
+}
+
+bool Timeline::write(const std::string &path)
+{
+	std::ofstream out(path);
+
+	if(!out)
+	{
+		warn("Error writing timeline trace to file %s: %s\n", path.c_str(), strerror(errno));
+		return false;
+	}
+
+	State &s = state();
+	std::unique_lock<std::mutex> lock(s.mutex);
+
+	// Microsecond timestamps, with nanosecond precision.
+	out << std::fixed << std::setprecision(3);
+	out << "{\"traceEvents\":[";
+
+	bool firstEvent = true;
+	for(const ThreadEvents *t : s.threads)
+	{
+		uint64_t count = t->count.load(std::memory_order_acquire);
+		uint64_t first = std::max(t->first.load(std::memory_order_relaxed), (count > t->capacity) ? count - t->capacity : 0);
+
+		for(uint64_t i = first; i < count; i++)
+		{
+			Event event = t->events[i % t->capacity];
+
+			// Event i's slot gets reused by event i + capacity, which is recorded
+			// once the count reaches that value.
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if(t->count.load(std::memory_order_relaxed) >= i + t->capacity)
+			{
+				continue;
+			}
+
+			out << (firstEvent ? "\n" : ",\n");
+			writeEvent(out, event, t->threadId, s.origin);
+			firstEvent = false;
+		}
+	}
+
+	out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+
+	return out.good();
+}
+
+void Timeline::reset(bool enable)
+{
+	State &s = state();
+	std::unique_lock<std::mutex> lock(s.mutex);
+
+	for(ThreadEvents *t : s.threads)
+	{
+		t->first.store(t->count.load(std::memory_order_acquire), std::memory_order_relaxed);
+	}
+
+	s.enabled.store(enable, std::memory_order_relaxed);
+}
+
+}  // namespace sw
@@ -0,0 +1,99 @@
+// Copyright 2026 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef sw_Timeline_hpp
+#define sw_Timeline_hpp
+
+#include <cstdint>
+#include <string>
+
+namespace sw {
+
+// Timeline records the execution of command buffers, draws, batches, dispatches
+// and routine compiles, along with debug labels, into per-thread ring buffers.
+// It is enabled at runtime through the [Profiler] TimelineTraceFile setting,
+// and costs a single flag check per event otherwise. The recorded events are
+// written as a Chrome trace event file, which can be opened with Perfetto or
+// chrome://tracing.
+class Timeline
+{
+public:
+	enum class Category : uint8_t
+	{
+		CommandBuffer,  // id: number of commands
+		Draw,           // id: draw
+		Batch,          // id: draw, index: batch
+		Dispatch,       // id: number of workgroups
+		Compile,
+		Label,
+
+		Count
+	};
+
+	static bool isEnabled();
+
+	// Nanoseconds on the steady clock, which all timestamps are relative to.
+	static int64_t now();
+
+	// Records an event which started at the given time and ends now. The name
+	// must be a string literal, or otherwise outlive the timeline.
+	static void record(Category category, const char *name, int64_t begin, uint64_t id = 0, uint32_t index = 0);
+
+	// Debug label regions and single labels. The text is copied, truncated to
+	// the space available in an event.
+	static void beginLabel(const char *text);
+	static void endLabel();
+	static void insertLabel(const char *text);
+
+	// Writes the events recorded so far to the configured trace file. Events
+	// which are being recorded, or overwritten, concurrently are left out.
+	static void write();
+	static bool write(const std::string &path);
+
+	// Enables or disables recording, overriding the configuration, and discards
+	// all events recorded so far.
+	static void reset(bool enable);
+
+	// Records the time from construction to destruction as an event.
+	class Scope
+	{
+	public:
+		Scope(Category category, const char *name, uint64_t id = 0, uint32_t index = 0)
+		    : category(category)
+		    , name(name)
+		    , id(id)
+		    , index(index)
+		    , begin(isEnabled() ? now() : -1)
+		{}
+
+		~Scope()
+		{
+			if(begin >= 0)
+			{
+				record(category, name, begin, id, index);
+			}
+		}
+
+	private:
+		const Category category;
+		const char *const name;
+		const uint64_t id;
+		const uint32_t index;
+		const int64_t begin;
+	};
+};
+
+}  // namespace sw
+
+#endif  // sw_Timeline_hpp
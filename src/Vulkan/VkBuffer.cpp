@@ -16,6 +16,8 @@
 
 #include "VkConfig.hpp"
 #include "VkDeviceMemory.hpp"
+#include "VkSparseAddressSpace.hpp"
+#include "System/Math.hpp"
 
 #include <algorithm>
 #include <cstring>
@@ -55,6 +57,35 @@ Buffer::Buffer(const VkBufferCreateInfo *pCreateInfo, void *mem)
 void Buffer::destroy(const VkAllocationCallbacks *pAllocator)
 {
 	vk::freeHostMemory(queueFamilyIndices, pAllocator);
+
+	if(sparseAddressSpace)
+	{
+		sparseAddressSpace->~SparseAddressSpace();
+		vk::freeHostMemory(sparseAddressSpace, pAllocator);
+	}
+}
+
+// Sparse buffers have their own address range, into which memory gets mapped by
+// vkQueueBindSparse() instead of vkBindBufferMemory().
+VkResult Buffer::reserveSparseAddressSpace(const VkAllocationCallbacks *pAllocator)
+{
+	ASSERT(flags & VK_BUFFER_CREATE_SPARSE_BINDING_BIT);
+
+	void *mem = vk::allocateHostMemory(sizeof(SparseAddressSpace), alignof(SparseAddressSpace), pAllocator, GetAllocationScope());
+	if(!mem)
+	{
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
+
+	sparseAddressSpace = new(mem) SparseAddressSpace(getMemoryRequirements().size);
+	if(!sparseAddressSpace->data())
+	{
+		return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+	}
+
+	memory = sparseAddressSpace->data();
+
+	return VK_SUCCESS;
 }
 
 size_t Buffer::ComputeRequiredAllocationSize(const VkBufferCreateInfo *pCreateInfo)
@@ -62,7 +93,7 @@ size_t Buffer::ComputeRequiredAllocationSize(const VkBufferCreateInfo *pCreateIn
 	return (pCreateInfo->sharingMode == VK_SHARING_MODE_CONCURRENT) ? sizeof(uint32_t) * pCreateInfo->queueFamilyIndexCount : 0;
 }
 
-const VkMemoryRequirements Buffer::GetMemoryRequirements(VkDeviceSize size, VkBufferUsageFlags usage)
+const VkMemoryRequirements Buffer::GetMemoryRequirements(VkDeviceSize size, VkBufferUsageFlags usage, VkBufferCreateFlags flags)
 {
 	VkMemoryRequirements memoryRequirements = {};
 
@@ -85,13 +116,24 @@ const VkMemoryRequirements Buffer::GetMemoryRequirements(VkDeviceSize size, VkBu
 	}
 
 	memoryRequirements.memoryTypeBits = vk::MEMORY_TYPE_GENERIC_BIT;
+#if SWIFTSHADER_SPARSE_BINDING
+	memoryRequirements.memoryTypeBits |= vk::MEMORY_TYPE_SPARSE_BIT;
+
+	if(flags & VK_BUFFER_CREATE_SPARSE_BINDING_BIT)
+	{
+		// Sparse memory gets mapped at block granularity, from a shared memory object.
+		memoryRequirements.alignment = std::max(memoryRequirements.alignment, vk::SPARSE_BLOCK_SIZE);
+		memoryRequirements.size = sw::align<vk::SPARSE_BLOCK_SIZE>(size);
+		memoryRequirements.memoryTypeBits = vk::MEMORY_TYPE_SPARSE_BIT;
+	}
+#endif
 
 	return memoryRequirements;
 }
 
 const VkMemoryRequirements Buffer::getMemoryRequirements() const
 {
-	return GetMemoryRequirements(size, usage);
+	return GetMemoryRequirements(size, usage, flags);
 }
 
 bool Buffer::canBindToMemory(DeviceMemory *pDeviceMemory) const
@@ -104,6 +146,12 @@ void Buffer::bind(DeviceMemory *pDeviceMemory, VkDeviceSize pMemoryOffset)
 	memory = pDeviceMemory->getOffsetPointer(pMemoryOffset);
 }
 
+VkResult Buffer::bindSparse(const VkSparseMemoryBind &bind)
+{
+	ASSERT(sparseAddressSpace);
+	return sparseAddressSpace->bind(bind);
+}
+
 void Buffer::copyFrom(const void *srcMemory, VkDeviceSize pSize, VkDeviceSize pOffset)
 {
 	ASSERT((pSize + pOffset) <= size);
@@ -20,18 +20,21 @@
 namespace vk {
 
 class DeviceMemory;
+class SparseAddressSpace;
 
 class Buffer : public Object<Buffer, VkBuffer>
 {
 public:
 	Buffer(const VkBufferCreateInfo *pCreateInfo, void *mem);
 	void destroy(const VkAllocationCallbacks *pAllocator);
+	VkResult reserveSparseAddressSpace(const VkAllocationCallbacks *pAllocator);
 
 	static size_t ComputeRequiredAllocationSize(const VkBufferCreateInfo *pCreateInfo);
-	static const VkMemoryRequirements GetMemoryRequirements(VkDeviceSize size, VkBufferUsageFlags usage);
+	static const VkMemoryRequirements GetMemoryRequirements(VkDeviceSize size, VkBufferUsageFlags usage, VkBufferCreateFlags flags);
 
 	const VkMemoryRequirements getMemoryRequirements() const;
 	void bind(DeviceMemory *pDeviceMemory, VkDeviceSize pMemoryOffset);
+	VkResult bindSparse(const VkSparseMemoryBind &bind);
 	void copyFrom(const void *srcMemory, VkDeviceSize size, VkDeviceSize offset);
 	void copyTo(void *dstMemory, VkDeviceSize size, VkDeviceSize offset) const;
 	void copyTo(Buffer *dstBuffer, const VkBufferCopy2KHR &pRegion) const;
@@ -48,6 +51,7 @@ public:
 
 private:
 	void *memory = nullptr;
+	SparseAddressSpace *sparseAddressSpace = nullptr;  // Only for buffers created with VK_BUFFER_CREATE_SPARSE_BINDING_BIT
 	VkBufferCreateFlags flags = 0;
 	VkDeviceSize size = 0;
 	VkBufferUsageFlags usage = 0;
@@ -27,6 +27,7 @@
 #include "VkQueryPool.hpp"
 #include "VkRenderPass.hpp"
 #include "Device/Renderer.hpp"
+#include "System/Timeline.hpp"
 
 #include "./Debug/Context.hpp"
 #include "./Debug/File.hpp"
@@ -105,11 +106,16 @@ public:
 	void execute(vk::CommandBuffer::ExecutionState &executionState) override
 	{
 		bool hasResolveAttachments = (executionState.renderPass->getSubpass(executionState.subpassIndex).pResolveAttachments != nullptr);
-		if(hasResolveAttachments)
+		bool hasDeferredClears = executionState.renderPassFramebuffer->hasDeferredClears();
+		if(hasResolveAttachments || hasDeferredClears)
 		{
 			// TODO(b/197691918): Avoid halt-the-world synchronization.
 			executionState.renderer->synchronize();
 
+			// Subsequent subpasses may read the attachments as input attachments,
+			// which doesn't perform the pending clears.
+			executionState.renderPassFramebuffer->flushDeferredClears(executionState.renderPass, executionState.subpassIndex, false);
+
 			// TODO(b/197691917): Eliminate redundant resolve operations.
 			executionState.renderPassFramebuffer->resolve(executionState.renderPass, executionState.subpassIndex);
 		}
@@ -129,6 +135,8 @@ public:
 		// TODO(b/197691918): Avoid halt-the-world synchronization.
 		executionState.renderer->synchronize();
 
+		executionState.renderPassFramebuffer->flushDeferredClears(executionState.renderPass, executionState.subpassIndex, true);
+
 		// TODO(b/197691917): Eliminate redundant resolve operations.
 		executionState.renderPassFramebuffer->resolve(executionState.renderPass, executionState.subpassIndex);
 
@@ -1326,6 +1334,7 @@ public:
 
 		if(executionState.renderPassFramebuffer)
 		{
+			executionState.renderPassFramebuffer->flushDeferredClears(executionState.renderPass, executionState.subpassIndex, false);
 			executionState.renderPassFramebuffer->clearAttachment(executionState.renderPass, executionState.subpassIndex, attachment, rect);
 		}
 		else if(executionState.dynamicRendering)
@@ -1753,6 +1762,55 @@ private:
 	const VkQueryResultFlags flags;
 };
 
+class CmdBeginDebugUtilsLabel : public vk::CommandBuffer::Command
+{
+public:
+	CmdBeginDebugUtilsLabel(const char *labelName)
+	    : labelName(labelName ? labelName : "")
+	{
+	}
+
+	void execute(vk::CommandBuffer::ExecutionState &executionState) override
+	{
+		sw::Timeline::beginLabel(labelName.c_str());
+	}
+
+	std::string description() override { return "vkCmdBeginDebugUtilsLabelEXT()"; }
+
+private:
+	const std::string labelName;
+};
+
+class CmdEndDebugUtilsLabel : public vk::CommandBuffer::Command
+{
+public:
+	void execute(vk::CommandBuffer::ExecutionState &executionState) override
+	{
+		sw::Timeline::endLabel();
+	}
+
+	std::string description() override { return "vkCmdEndDebugUtilsLabelEXT()"; }
+};
+
+class CmdInsertDebugUtilsLabel : public vk::CommandBuffer::Command
+{
+public:
+	CmdInsertDebugUtilsLabel(const char *labelName)
+	    : labelName(labelName ? labelName : "")
+	{
+	}
+
+	void execute(vk::CommandBuffer::ExecutionState &executionState) override
+	{
+		sw::Timeline::insertLabel(labelName.c_str());
+	}
+
+	std::string description() override { return "vkCmdInsertDebugUtilsLabelEXT()"; }
+
+private:
+	const std::string labelName;
+};
+
 }  // anonymous namespace
 
 namespace vk {
@@ -2367,21 +2425,35 @@ void CommandBuffer::drawIndexedIndirect(Buffer *buffer, VkDeviceSize offset, uin
 
 void CommandBuffer::beginDebugUtilsLabel(const VkDebugUtilsLabelEXT *pLabelInfo)
 {
-	// Optional debug label region
+	// Optional debug label region, only used to annotate the timeline
+	if(sw::Timeline::isEnabled())
+	{
+		addCommand<::CmdBeginDebugUtilsLabel>(pLabelInfo->pLabelName);
+	}
 }
 
 void CommandBuffer::endDebugUtilsLabel()
 {
 	// Close debug label region opened with beginDebugUtilsLabel()
+	if(sw::Timeline::isEnabled())
+	{
+		addCommand<::CmdEndDebugUtilsLabel>();
+	}
 }
 
 void CommandBuffer::insertDebugUtilsLabel(const VkDebugUtilsLabelEXT *pLabelInfo)
 {
 	// Optional single debug label
+	if(sw::Timeline::isEnabled())
+	{
+		addCommand<::CmdInsertDebugUtilsLabel>(pLabelInfo->pLabelName);
+	}
 }
 
 void CommandBuffer::submit(CommandBuffer::ExecutionState &executionState)
 {
+	sw::Timeline::Scope timeline(sw::Timeline::Category::CommandBuffer, "CommandBuffer", commands.size());
+
 	// Perform recorded work
 	state = PENDING;
 
@@ -66,6 +66,13 @@ static_assert(DEVICE_MEMORY_ALLOCATION_ALIGNMENT >= MEMORY_REQUIREMENTS_OFFSET_A
 constexpr VkDeviceSize HOST_MEMORY_ALLOCATION_ALIGNMENT = 16;  // 16 bytes for 128-bit vector types.
 
 constexpr uint32_t MEMORY_TYPE_GENERIC_BIT = 0x1;  // Generic system memory.
+constexpr uint32_t MEMORY_TYPE_SPARSE_BIT = 0x2;   // System memory backed by a shareable file, which sparse resources can map.
+constexpr uint32_t MEMORY_TYPE_SPARSE_INDEX = 1;
+
+// Granularity of sparse memory binding. Also the alignment of sparse resources' memory
+// requirements, so it must be a multiple of the host's page size.
+constexpr VkDeviceSize SPARSE_BLOCK_SIZE = 0x10000;  // 64 KiB
+constexpr VkDeviceSize SPARSE_ADDRESS_SPACE_SIZE = 0x80000000ull;  // 2 GiB, the minimum when sparseBinding is supported
 
 constexpr uint32_t MAX_IMAGE_LEVELS_1D = 15;
 constexpr uint32_t MAX_IMAGE_LEVELS_2D = 15;
@@ -81,6 +88,7 @@ static_assert(MAX_IMAGE_LEVELS_CUBE <= sw::MIPMAP_LEVELS);
 
 constexpr uint32_t MAX_BOUND_DESCRIPTOR_SETS = 4;
 constexpr uint32_t MAX_VERTEX_INPUT_BINDINGS = 16;
+constexpr uint32_t MAX_VERTEX_INPUT_ATTRIBUTE_OFFSET = 2047;
 constexpr uint32_t MAX_PUSH_CONSTANT_SIZE = 128;
 constexpr uint32_t MAX_UPDATE_AFTER_BIND_DESCRIPTORS = 500000;
 
@@ -117,6 +125,7 @@ static_assert(MAX_MEMORY_ALLOCATION_SIZE <= 0x80000000ull, "maxMemoryAllocationS
 #if defined(__linux__) && !defined(__ANDROID__)
 #	define SWIFTSHADER_EXTERNAL_MEMORY_OPAQUE_FD 1
 #	define SWIFTSHADER_EXTERNAL_SEMAPHORE_OPAQUE_FD 1
+#	define SWIFTSHADER_SPARSE_BINDING 1
 #elif defined(__ANDROID__)
 #	define SWIFTSHADER_EXTERNAL_SEMAPHORE_OPAQUE_FD 1
 #endif
@@ -39,6 +39,8 @@ DescriptorPool::DescriptorPool(const VkDescriptorPoolCreateInfo *pCreateInfo, vo
 
 void DescriptorPool::destroy(const VkAllocationCallbacks *pAllocator)
 {
+	reset();
+
 	vk::freeHostMemory(pool, pAllocator);
 }
 
@@ -200,12 +202,17 @@ void DescriptorPool::freeSet(const VkDescriptorSet descriptorSet)
 	auto it = std::find(nodes.begin(), itEnd, asMemory(descriptorSet));
 	if(it != itEnd)
 	{
+		reinterpret_cast<DescriptorSet *>(it->set)->~DescriptorSet();
 		nodes.erase(it);
 	}
 }
 
 VkResult DescriptorPool::reset()
 {
+	for(const auto &node : nodes)
+	{
+		reinterpret_cast<DescriptorSet *>(node.set)->~DescriptorSet();
+	}
 	nodes.clear();
 
 	return VK_SUCCESS;
@@ -36,42 +36,37 @@ void DescriptorSet::ParseDescriptors(const Array &descriptorSets, const Pipeline
 			}
 
 			marl::lock lock(descriptorSet->header.mutex);
-			uint32_t bindingCount = layout->getBindingCount(i);
-			for(uint32_t j = 0; j < bindingCount; ++j)
+
+			if(notificationType == PREPARE_FOR_SAMPLING)
 			{
-				VkDescriptorType type = layout->getDescriptorType(i, j);
-				uint32_t descriptorCount = layout->getDescriptorCount(i, j);
-				uint32_t descriptorSize = layout->getDescriptorSize(i, j);
-				uint8_t *descriptorMemory = descriptorSet->getDataAddress() + layout->getBindingOffset(i, j);
+				// Sampling preparation is only needed again if the tracked views changed, or
+				// if an image requiring preprocessing was written to since the last time.
+				uint32_t version = device->getPreprocessingVersion();
+				if(!descriptorSet->header.trackedImageViewsChanged &&
+				   (descriptorSet->header.preparedVersion == version))
+				{
+					continue;
+				}
 
-				for(uint32_t k = 0; k < descriptorCount; k++)
+				for(const auto &it : descriptorSet->header.trackedImageViews)
 				{
-					ImageView *memoryOwner = nullptr;
-					switch(type)
+					if(it.second.prepareForSampling)
 					{
-					case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
-					case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
-						memoryOwner = reinterpret_cast<SampledImageDescriptor *>(descriptorMemory)->memoryOwner;
-						break;
-					case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
-					case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
-						memoryOwner = reinterpret_cast<StorageImageDescriptor *>(descriptorMemory)->memoryOwner;
-						break;
-					default:
-						break;
+						device->prepareForSampling(it.second.imageView);
 					}
-					if(memoryOwner)
+				}
+
+				descriptorSet->header.preparedVersion = version;
+				descriptorSet->header.trackedImageViewsChanged = false;
+			}
+			else if(notificationType == CONTENTS_CHANGED)
+			{
+				for(const auto &it : descriptorSet->header.trackedImageViews)
+				{
+					if(it.second.notifyStorageWrites)
 					{
-						if(notificationType == PREPARE_FOR_SAMPLING)
-						{
-							device->prepareForSampling(memoryOwner);
-						}
-						else if((notificationType == CONTENTS_CHANGED) && (type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE))
-						{
-							device->contentsChanged(memoryOwner, Image::USING_STORAGE);
-						}
+						device->contentsChanged(it.second.imageView, Image::USING_STORAGE);
 					}
-					descriptorMemory += descriptorSize;
 				}
 			}
 		}
@@ -88,6 +83,50 @@ void DescriptorSet::PrepareForSampling(const Array &descriptorSets, const Pipeli
 	ParseDescriptors(descriptorSets, layout, device, PREPARE_FOR_SAMPLING);
 }
 
+void DescriptorSet::updateTrackedImageViews(const uint8_t *descriptors, size_t descriptorSize, uint32_t count, VkDescriptorType type)
+{
+	bool isStorageImage = (type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
+
+	ImageView *const *memoryOwner = nullptr;
+	switch(type)
+	{
+	case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+	case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+		memoryOwner = &reinterpret_cast<const SampledImageDescriptor *>(descriptors)->memoryOwner;
+		break;
+	case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+	case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+		memoryOwner = &reinterpret_cast<const StorageImageDescriptor *>(descriptors)->memoryOwner;
+		break;
+	default:
+		return;  // No image views to track
+	}
+
+	uint32_t offset = static_cast<uint32_t>(descriptors - getDataAddress());
+
+	marl::lock lock(header.mutex);
+	for(uint32_t i = 0; i < count; i++)
+	{
+		ImageView *imageView = *memoryOwner;
+		bool prepareForSampling = imageView && imageView->requiresPreprocessing();
+		bool notifyStorageWrites = imageView && isStorageImage;
+
+		if(prepareForSampling || notifyStorageWrites)
+		{
+			header.trackedImageViews[offset] = { imageView, prepareForSampling, notifyStorageWrites };
+		}
+		else
+		{
+			header.trackedImageViews.erase(offset);
+		}
+
+		memoryOwner = reinterpret_cast<ImageView *const *>(reinterpret_cast<const uint8_t *>(memoryOwner) + descriptorSize);
+		offset += static_cast<uint32_t>(descriptorSize);
+	}
+
+	header.trackedImageViewsChanged = true;
+}
+
 uint8_t *DescriptorSet::getDataAddress()
 {
 	// Descriptor sets consist of a header followed by a variable amount of descriptor data, depending
@@ -17,21 +17,42 @@
 
 #include "VkObject.hpp"
 #include "marl/mutex.h"
+#include "marl/tsa.h"
 
 #include <array>
 #include <cstdint>
 #include <memory>
+#include <unordered_map>
 
 namespace vk {
 
 class DescriptorSetLayout;
 class Device;
+class ImageView;
 class PipelineLayout;
 
+// Image view referenced by a descriptor which needs to be notified when the set is used.
+struct TrackedImageView
+{
+	ImageView *imageView;
+	bool prepareForSampling;   // The image requires preprocessing (cube or compressed)
+	bool notifyStorageWrites;  // Storage image descriptor
+};
+
 struct alignas(16) DescriptorSetHeader
 {
 	DescriptorSetLayout *layout;
 	marl::mutex mutex;
+
+	// Image views which need notification, keyed by the offset of their descriptor within the
+	// set's payload. Maintained by descriptor writes and copies so that draws only visit these
+	// rather than every descriptor of the set.
+	std::unordered_map<uint32_t, TrackedImageView> trackedImageViews GUARDED_BY(mutex);
+
+	// Device::getPreprocessingVersion() at the time all tracked views were last prepared for
+	// sampling, and whether trackedImageViews was modified since.
+	uint32_t preparedVersion GUARDED_BY(mutex) = 0;
+	bool trackedImageViewsChanged GUARDED_BY(mutex) = true;
 };
 
 class alignas(16) DescriptorSet : public Object<DescriptorSet, VkDescriptorSet>
@@ -46,6 +67,10 @@ public:
 
 	uint8_t *getDataAddress();  // Returns a pointer to the descriptor payload following the header.
 
+	// Updates the tracked image views after 'count' descriptors of the given type, starting
+	// at 'descriptors' within this set's payload, were written or copied.
+	void updateTrackedImageViews(const uint8_t *descriptors, size_t descriptorSize, uint32_t count, VkDescriptorType type);
+
 	DescriptorSetHeader header;
 
 private:
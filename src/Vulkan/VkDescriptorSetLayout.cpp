@@ -17,6 +17,7 @@
 #include "VkBuffer.hpp"
 #include "VkBufferView.hpp"
 #include "VkDescriptorSet.hpp"
+#include "VkDevice.hpp"
 #include "VkImageView.hpp"
 #include "VkSampler.hpp"
 
@@ -191,6 +192,7 @@ void DescriptorSetLayout::initialize(DescriptorSet *descriptorSet, const uint32_
 			for(uint32_t j = 0; j < descriptorCount; j++)
 			{
 				SampledImageDescriptor *imageSamplerDescriptor = reinterpret_cast<SampledImageDescriptor *>(data);
+				imageSamplerDescriptor->imageViewId = 0;  // Not written yet
 				imageSamplerDescriptor->samplerId = bindings[i].immutableSamplers[j]->id;
 				imageSamplerDescriptor->memoryOwner = nullptr;
 				data += descriptorSize;
@@ -207,6 +209,7 @@ void DescriptorSetLayout::initialize(DescriptorSet *descriptorSet, const uint32_
 				for(uint32_t j = 0; j < descriptorCount; j++)
 				{
 					SampledImageDescriptor *imageSamplerDescriptor = reinterpret_cast<SampledImageDescriptor *>(data);
+					imageSamplerDescriptor->imageViewId = 0;  // Not written yet
 					imageSamplerDescriptor->memoryOwner = nullptr;
 					data += descriptorSize;
 				}
@@ -286,6 +289,35 @@ VkDescriptorType DescriptorSetLayout::getDescriptorType(uint32_t bindingNumber)
 	return bindings[bindingNumber].descriptorType;
 }
 
+const Sampler *DescriptorSetLayout::getImmutableSampler(uint32_t bindingNumber) const
+{
+	ASSERT(bindingNumber < bindingsArraySize);
+	const Binding &binding = bindings[bindingNumber];
+
+	if(!binding.immutableSamplers || (binding.descriptorCount == 0))
+	{
+		return nullptr;
+	}
+
+	const Sampler *sampler = binding.immutableSamplers[0];
+	for(uint32_t i = 1; i < binding.descriptorCount; i++)
+	{
+		if(binding.immutableSamplers[i]->id != sampler->id)
+		{
+			return nullptr;
+		}
+	}
+
+	return sampler;
+}
+
+uint32_t DescriptorSetLayout::getImmutableSamplerId(uint32_t bindingNumber) const
+{
+	const Sampler *sampler = getImmutableSampler(bindingNumber);
+
+	return sampler ? sampler->id : 0;
+}
+
 uint8_t *DescriptorSetLayout::getDescriptorPointer(DescriptorSet *descriptorSet, uint32_t bindingNumber, uint32_t arrayElement, uint32_t count, size_t *typeSize) const
 {
 	ASSERT(bindingNumber < bindingsArraySize);
@@ -430,6 +462,8 @@ void DescriptorSetLayout::WriteDescriptorSet(Device *device, DescriptorSet *dstS
 			sampledImage[i].sampleCount = imageView->getSampleCount();
 			sampledImage[i].memoryOwner = imageView;
 
+			device->precompileSamplingRoutines(entry.dstBinding, entry.descriptorType, sampledImage[i].samplerId, imageView->id);
+
 			auto &subresourceRange = imageView->getSubresourceRange();
 
 			if(format.isYcbcrFormat())
@@ -530,6 +564,8 @@ void DescriptorSetLayout::WriteDescriptorSet(Device *device, DescriptorSet *dstS
 			storageImage[i].sizeInBytes = static_cast<int>(imageView->getSizeInBytes());
 			storageImage[i].memoryOwner = imageView;
 
+			device->precompileSamplingRoutines(entry.dstBinding, entry.descriptorType, 0, imageView->id);
+
 			if(imageView->getFormat().isStencil())
 			{
 				storageImage[i].stencilPtr = imageView->getOffsetPointer({ 0, 0, 0 }, VK_IMAGE_ASPECT_STENCIL_BIT, 0, 0);
@@ -585,6 +621,8 @@ void DescriptorSetLayout::WriteDescriptorSet(Device *device, DescriptorSet *dstS
 	{
 		memcpy(memToWrite, src + entry.offset, entry.descriptorCount);
 	}
+
+	dstSet->updateTrackedImageViews(memToWrite, typeSize, entry.descriptorCount, entry.descriptorType);
 }
 
 void DescriptorSetLayout::WriteDescriptorSet(Device *device, const VkWriteDescriptorSet &writeDescriptorSet)
@@ -668,6 +706,8 @@ void DescriptorSetLayout::CopyDescriptorSet(const VkCopyDescriptorSet &descripto
 	ASSERT(srcTypeSize == dstTypeSize);
 	size_t writeSize = dstTypeSize * descriptorCopies.descriptorCount;
 	memcpy(memToWrite, memToRead, writeSize);
+
+	dstSet->updateTrackedImageViews(memToWrite, dstTypeSize, descriptorCopies.descriptorCount, dstLayout->bindings[descriptorCopies.dstBinding].descriptorType);
 }
 
 }  // namespace vk
@@ -130,6 +130,11 @@ public:
 	// Returns the descriptor type for the given binding number.
 	VkDescriptorType getDescriptorType(uint32_t bindingNumber) const;
 
+	// Returns the immutable sampler shared by all descriptors of the given binding
+	// number (or its ID), or null (0) if it doesn't use immutable samplers or they differ.
+	const Sampler *getImmutableSampler(uint32_t bindingNumber) const;
+	uint32_t getImmutableSamplerId(uint32_t bindingNumber) const;
+
 	// Returns the number of entries in the direct-indexed array of bindings.
 	// It equals the highest binding number + 1.
 	uint32_t getBindingsArraySize() const { return bindingsArraySize; }
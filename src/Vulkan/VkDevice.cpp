@@ -24,8 +24,14 @@
 #include "Debug/Context.hpp"
 #include "Debug/Server.hpp"
 #include "Device/Blitter.hpp"
+#include "Pipeline/SpirvShader.hpp"
 #include "System/Debug.hpp"
+#include "System/SwiftConfig.hpp"
+#include "System/Timeline.hpp"
 
+#include "marl/scheduler.h"
+
+#include <algorithm>
 #include <chrono>
 #include <climits>
 #include <new>  // Must #include this to use "placement new"
@@ -155,7 +161,24 @@ Device::Device(const VkDeviceCreateInfo *pCreateInfo, void *mem, PhysicalDevice
 	// TODO(b/119409619): use an allocator here so we can control all memory allocations
 	blitter.reset(new sw::Blitter());
 	samplingRoutineCache.reset(new SamplingRoutineCache());
+	if(sw::getConfiguration().precompileSamplingRoutines)
+	{
+		samplingRoutinePrecompiler.reset(new SamplingRoutinePrecompiler(this, scheduler.get()));
+	}
 	samplerIndexer.reset(new SamplerIndexer());
+	if(sw::getConfiguration().enableSpirvProfiling)
+	{
+		spirvProfiler.reset(new sw::SpirvProfiler(sw::getConfiguration()));
+	}
+
+	// The telemetry and compute phase settings are read again for each device, so that they
+	// apply to devices created after changing the configuration file.
+	const sw::Configuration deviceConfig = sw::readConfigurationFromFile();
+	if(!deviceConfig.routineTelemetryReportFile.empty())
+	{
+		routineTelemetryReporter.reset(new sw::RoutineTelemetry::Reporter(deviceConfig));
+	}
+	splitComputePhases = deviceConfig.splitComputePhases;
 
 #ifdef SWIFTSHADER_DEVICE_MEMORY_REPORT
 	const auto *deviceMemoryReportCreateInfo = GetExtendedStruct<VkDeviceDeviceMemoryReportCreateInfoEXT>(pCreateInfo->pNext, VK_STRUCTURE_TYPE_DEVICE_DEVICE_MEMORY_REPORT_CREATE_INFO_EXT);
@@ -168,12 +191,20 @@ Device::Device(const VkDeviceCreateInfo *pCreateInfo, void *mem, PhysicalDevice
 
 void Device::destroy(const VkAllocationCallbacks *pAllocator)
 {
+	if(samplingRoutinePrecompiler)
+	{
+		samplingRoutinePrecompiler->wait();
+	}
+
 	for(uint32_t i = 0; i < queueCount; i++)
 	{
 		queues[i].~Queue();
 	}
 
 	vk::freeHostMemory(queues, pAllocator);
+
+	// The queues have finished all work, so the timeline is complete up to this point.
+	sw::Timeline::write();
 }
 
 size_t Device::ComputeRequiredAllocationSize(const VkDeviceCreateInfo *pCreateInfo)
@@ -406,6 +437,118 @@ void Device::updateSamplingRoutineSnapshotCache()
 	samplingRoutineCache->updateSnapshot();
 }
 
+Device::SamplingRoutinePrecompiler::SamplingRoutinePrecompiler(const Device *device, marl::Scheduler *scheduler)
+    : device(device)
+    , scheduler(scheduler)
+    , requested(SamplingRoutineCache::Capacity)
+    , written(SamplingRoutineCache::Capacity)
+{
+}
+
+bool Device::SamplingRoutinePrecompiler::Use::operator==(const Use &rhs) const
+{
+	return (signature == rhs.signature) && (samplerId == rhs.samplerId) && (samplerFromDescriptor == rhs.samplerFromDescriptor);
+}
+
+bool Device::SamplingRoutinePrecompiler::Write::operator==(const Write &rhs) const
+{
+	return (binding == rhs.binding) && (descriptorType == rhs.descriptorType) && (samplerId == rhs.samplerId) && (imageViewId == rhs.imageViewId);
+}
+
+std::size_t Device::SamplingRoutinePrecompiler::Write::Hash::operator()(const Write &write) const noexcept
+{
+	uint64_t hash = write.binding;
+	hash = (hash * 2642239) ^ static_cast<uint32_t>(write.descriptorType);
+	hash = (hash * 2642239) ^ write.samplerId;
+	hash = (hash * 2642239) ^ write.imageViewId;
+	return static_cast<std::size_t>(hash);
+}
+
+void Device::SamplingRoutinePrecompiler::add(uint32_t set, uint32_t binding, VkDescriptorType descriptorType, const Use &use)
+{
+	marl::lock lock(mutex);
+
+	auto &bindingUses = uses[BindingKey(set, binding)];
+	bindingUses.descriptorType = descriptorType;  // Pipelines sharing the key have compatible layouts
+	if(std::find(bindingUses.uses.begin(), bindingUses.uses.end(), use) != bindingUses.uses.end())
+	{
+		return;
+	}
+
+	bindingUses.uses.push_back(use);
+
+	// Descriptors are commonly written before the pipelines which use them are created.
+	for(auto it : written)
+	{
+		const Write &write = it.key();
+		if((write.binding == binding) && (write.descriptorType == descriptorType))
+		{
+			request(use, write);
+		}
+	}
+}
+
+void Device::SamplingRoutinePrecompiler::precompile(uint32_t binding, VkDescriptorType descriptorType, uint32_t samplerId, uint32_t imageViewId)
+{
+	marl::lock lock(mutex);
+
+	// Image views and samplers with identical state share their identifiers, so most
+	// descriptor writes repeat earlier ones.
+	Write write = { binding, descriptorType, samplerId, imageViewId };
+	if(written.lookup(write))
+	{
+		return;
+	}
+
+	written.add(write, true);
+
+	// The descriptor set may get bound to any set number.
+	for(uint32_t set = 0; set < MAX_BOUND_DESCRIPTOR_SETS; set++)
+	{
+		auto it = uses.find(BindingKey(set, binding));
+		if((it == uses.end()) || (it->second.descriptorType != descriptorType))
+		{
+			continue;
+		}
+
+		for(const Use &use : it->second.uses)
+		{
+			request(use, write);
+		}
+	}
+}
+
+void Device::SamplingRoutinePrecompiler::request(const Use &use, const Write &write)
+{
+	SamplingRoutineCache::Key key = { use.signature, use.samplerFromDescriptor ? write.samplerId : use.samplerId, write.imageViewId };
+
+	if(requested.lookup(key))
+	{
+		return;
+	}
+
+	requested.add(key, true);
+
+	pending.add();
+	scheduler->enqueue(marl::Task([device = device, key, pending = pending] {
+		sw::SpirvEmitter::PrecompileImageSampler(device, key.instruction, key.sampler, key.imageView);
+		pending.done();
+	}));
+}
+
+void Device::SamplingRoutinePrecompiler::wait()
+{
+	pending.wait();
+}
+
+void Device::precompileSamplingRoutines(uint32_t binding, VkDescriptorType descriptorType, uint32_t samplerId, uint32_t imageViewId) const
+{
+	if(samplingRoutinePrecompiler)
+	{
+		samplingRoutinePrecompiler->precompile(binding, descriptorType, samplerId, imageViewId);
+	}
+}
+
 uint32_t Device::indexSampler(const SamplerState &samplerState)
 {
 	return samplerIndexer->index(samplerState);
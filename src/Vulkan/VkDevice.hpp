@@ -19,12 +19,16 @@
 #include "VkSampler.hpp"
 #include "Device/Blitter.hpp"
 #include "Pipeline/Constants.hpp"
+#include "Pipeline/SpirvProfiler.hpp"
 #include "Reactor/Routine.hpp"
 #include "System/LRUCache.hpp"
+#include "System/RoutineTelemetry.hpp"
 
 #include "marl/mutex.h"
 #include "marl/tsa.h"
+#include "marl/waitgroup.h"
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <unordered_map>
@@ -69,6 +73,11 @@ public:
 	void prepareForSampling(ImageView *imageView);
 	void contentsChanged(ImageView *imageView, Image::ContentsChangedContext context);
 
+	// Incremented whenever an image which requires preprocessing before sampling is written to,
+	// so descriptor sets can tell whether any of their views may need preparation again.
+	uint32_t getPreprocessingVersion() const { return preprocessingVersion.load(std::memory_order_acquire); }
+	void incrementPreprocessingVersion() const { preprocessingVersion.fetch_add(1, std::memory_order_acq_rel); }
+
 	VkResult setPrivateData(VkObjectType objectType, uint64_t objectHandle, const PrivateData *privateDataSlot, uint64_t data);
 	void getPrivateData(VkObjectType objectType, uint64_t objectHandle, const PrivateData *privateDataSlot, uint64_t *data);
 	void removePrivateDataSlot(const PrivateData *privateDataSlot);
@@ -76,8 +85,10 @@ public:
 	class SamplingRoutineCache
 	{
 	public:
+		static constexpr size_t Capacity = 1024;
+
 		SamplingRoutineCache()
-		    : cache(1024)
+		    : cache(Capacity)
 		{}
 		~SamplingRoutineCache() {}
 
@@ -105,15 +116,25 @@ public:
 		std::shared_ptr<rr::Routine> getOrCreate(const Key &key, Function &&createRoutine)
 		{
 			auto it = snapshot.find(key);
-			if(it != snapshot.end()) { return it->second; }
+			if(it != snapshot.end())
+			{
+				sw::RoutineTelemetry::recordCacheLookup(sw::RoutineKind::Sampler, true);
+				return it->second;
+			}
 
 			marl::lock lock(mutex);
-			if(auto existingRoutine = cache.lookup(key))
+			auto existingRoutine = cache.lookup(key);
+			sw::RoutineTelemetry::recordCacheLookup(sw::RoutineKind::Sampler, existingRoutine != nullptr);
+			if(existingRoutine)
 			{
 				return existingRoutine;
 			}
 
-			std::shared_ptr<rr::Routine> newRoutine = createRoutine(key);
+			std::shared_ptr<rr::Routine> newRoutine;
+			{
+				sw::RoutineTelemetry::ScopedCompile compile(sw::RoutineKind::Sampler);
+				newRoutine = createRoutine(key);
+			}
 			cache.add(key, newRoutine);
 			snapshotNeedsUpdate = true;
 
@@ -133,6 +154,85 @@ public:
 	SamplingRoutineCache *getSamplingRoutineCache() const;
 	void updateSamplingRoutineSnapshotCache();
 
+	// Records the sampling routines which the shaders of created pipelines obtain for the image
+	// descriptors of each pipeline layout (set, binding). When a descriptor of the same type is
+	// written to that binding number of a descriptor set, the routines for its image view and
+	// sampler are compiled on background tasks, so that draws don't stall on compiling them when
+	// first sampling the image. Descriptors written before a pipeline gets created are replayed.
+	class SamplingRoutinePrecompiler
+	{
+	public:
+		SamplingRoutinePrecompiler(const Device *device, marl::Scheduler *scheduler);
+
+		struct Use
+		{
+			uint32_t signature;
+			uint32_t samplerId;          // Immutable sampler, or 0 for samplerless instructions
+			bool samplerFromDescriptor;  // Combined image sampler, with samplerId ignored
+
+			bool operator==(const Use &rhs) const;
+		};
+
+		void add(uint32_t set, uint32_t binding, VkDescriptorType descriptorType, const Use &use);
+		void precompile(uint32_t binding, VkDescriptorType descriptorType, uint32_t samplerId, uint32_t imageViewId);
+		void wait();  // Waits for all precompilation tasks to complete
+
+	private:
+		struct Write
+		{
+			uint32_t binding;
+			VkDescriptorType descriptorType;
+			uint32_t samplerId;
+			uint32_t imageViewId;
+
+			bool operator==(const Write &rhs) const;
+
+			struct Hash
+			{
+				std::size_t operator()(const Write &write) const noexcept;
+			};
+		};
+
+		struct BindingUses
+		{
+			VkDescriptorType descriptorType;
+			std::vector<Use> uses;
+		};
+
+		static uint64_t BindingKey(uint32_t set, uint32_t binding)
+		{
+			return (static_cast<uint64_t>(set) << 32) | binding;
+		}
+
+		void request(const Use &use, const Write &write) REQUIRES(mutex);
+
+		const Device *const device;
+		marl::Scheduler *const scheduler;
+
+		marl::mutex mutex;
+		std::unordered_map<uint64_t, BindingUses> uses GUARDED_BY(mutex);
+
+		// Both are bounded by the routine cache's capacity, as routines requested any
+		// longer ago are likely to have been evicted from it.
+		sw::LRUCache<SamplingRoutineCache::Key, bool, SamplingRoutineCache::Key::Hash> requested GUARDED_BY(mutex);
+		sw::LRUCache<Write, bool, Write::Hash> written GUARDED_BY(mutex);
+
+		marl::WaitGroup pending;
+	};
+
+	// Returns nullptr unless sampling routine precompilation is enabled in the configuration.
+	SamplingRoutinePrecompiler *getSamplingRoutinePrecompiler() const { return samplingRoutinePrecompiler.get(); }
+
+	// Returns nullptr unless SPIR-V profiling is enabled in the configuration.
+	sw::SpirvProfiler *getSpirvProfiler() const { return spirvProfiler.get(); }
+
+	// Whether compute programs created for this device split their shaders into phases at barriers.
+	bool splitsComputePhases() const { return splitComputePhases; }
+
+	// Compiles the sampling routines likely to be used with an image descriptor which was just
+	// written to the given binding, if precompilation is enabled.
+	void precompileSamplingRoutines(uint32_t binding, VkDescriptorType descriptorType, uint32_t samplerId, uint32_t imageViewId) const;
+
 	class SamplerIndexer
 	{
 	public:
@@ -180,10 +280,15 @@ private:
 
 	std::shared_ptr<marl::Scheduler> scheduler;
 	std::unique_ptr<SamplingRoutineCache> samplingRoutineCache;
+	std::unique_ptr<SamplingRoutinePrecompiler> samplingRoutinePrecompiler;
 	std::unique_ptr<SamplerIndexer> samplerIndexer;
+	std::unique_ptr<sw::SpirvProfiler> spirvProfiler;
+	std::unique_ptr<sw::RoutineTelemetry::Reporter> routineTelemetryReporter;
+	bool splitComputePhases = false;
 
 	marl::mutex imageViewSetMutex;
 	std::unordered_set<ImageView *> imageViewSet GUARDED_BY(imageViewSetMutex);
+	mutable std::atomic<uint32_t> preprocessingVersion = { 0 };
 
 	struct PrivateDataObject
 	{
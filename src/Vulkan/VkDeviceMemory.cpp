@@ -137,6 +137,12 @@ VkResult DeviceMemory::Allocate(const VkAllocationCallbacks *pAllocator, const V
 	{
 		return ExternalMemoryHost::Create(pAllocator, &allocateInfo, pMemory, extendedAllocationInfo, device);
 	}
+#if SWIFTSHADER_SPARSE_BINDING
+	if(allocateInfo.memoryTypeIndex == MEMORY_TYPE_SPARSE_INDEX)
+	{
+		return vk::DeviceMemorySparseBindable::Create(pAllocator, &allocateInfo, pMemory, extendedAllocationInfo, device);
+	}
+#endif
 
 	return vk::DeviceMemoryInternal::Create(pAllocator, &allocateInfo, pMemory, extendedAllocationInfo, device);
 }
@@ -351,10 +357,36 @@ VkResult DeviceMemory::allocateBuffer()
 // Free previously allocated memory at `buffer`.
 void DeviceMemory::freeBuffer()
 {
-	vk::freeDeviceMemory(buffer);
+	vk::freeDeviceMemory(buffer, allocationSize);
 	buffer = nullptr;
 }
 
+#if SWIFTSHADER_SPARSE_BINDING
+VkResult DeviceMemorySparseBindable::allocateBuffer()
+{
+	if(!memfd.allocate("SwiftShader.SparseBindableMemory", allocationSize))
+	{
+		return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+	}
+
+	// Like anonymous memory, the pages of the memfd are zero-filled and only committed on first access.
+	buffer = memfd.mapReadWrite(0, allocationSize);
+	if(!buffer)
+	{
+		memfd.close();
+		return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+	}
+
+	return VK_SUCCESS;
+}
+
+void DeviceMemorySparseBindable::freeBuffer()
+{
+	memfd.unmap(buffer, allocationSize);
+	memfd.close();
+}
+#endif  // SWIFTSHADER_SPARSE_BINDING
+
 // Return the handle type flag bit supported by this implementation.
 // A value of 0 corresponds to non-external memory.
 VkExternalMemoryHandleTypeFlagBits DeviceMemory::getFlagBit() const
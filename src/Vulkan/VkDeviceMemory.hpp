@@ -18,6 +18,10 @@
 #include "VkConfig.hpp"
 #include "VkObject.hpp"
 
+#if SWIFTSHADER_SPARSE_BINDING
+#	include "System/Linux/MemFd.hpp"
+#endif
+
 namespace vk {
 
 class Device;
@@ -90,6 +94,12 @@ public:
 	bool checkExternalMemoryHandleType(
 	    VkExternalMemoryHandleTypeFlags supportedExternalMemoryHandleType) const;
 
+#if SWIFTSHADER_SPARSE_BINDING
+	// Returns the file descriptor of the shared memory object backing this memory, which
+	// sparse resources map ranges of into their address space, or -1 if there is none.
+	virtual int getSparseBindingFd() const { return -1; }
+#endif
+
 	// Some external device memories, such as Android hardware buffers, store per-plane properties.
 	virtual bool hasExternalImagePlanes() const { return false; }
 	virtual int externalImageRowPitchBytes(VkImageAspectFlagBits aspect) const { return 0; }
@@ -139,6 +149,27 @@ public:
 	{}
 };
 
+#if SWIFTSHADER_SPARSE_BINDING
+// This class represents a DeviceMemory object of the MEMORY_TYPE_SPARSE_INDEX memory type,
+// which is backed by a memfd so that its pages can also be mapped by sparse resources.
+class DeviceMemorySparseBindable : public DeviceMemory, public ObjectBase<DeviceMemorySparseBindable, VkDeviceMemory>
+{
+public:
+	DeviceMemorySparseBindable(const VkMemoryAllocateInfo *pCreateInfo, void *mem, const DeviceMemory::ExtendedAllocationInfo &extendedAllocationInfo, Device *pDevice)
+	    : DeviceMemory(pCreateInfo, extendedAllocationInfo, pDevice)
+	{}
+
+	int getSparseBindingFd() const override { return memfd.fd(); }
+
+protected:
+	VkResult allocateBuffer() override;
+	void freeBuffer() override;
+
+private:
+	LinuxMemFd memfd;
+};
+#endif  // SWIFTSHADER_SPARSE_BINDING
+
 static inline DeviceMemory *Cast(VkDeviceMemory object)
 {
 	return DeviceMemory::Cast(object);
@@ -95,6 +95,13 @@ public:
 		return VK_SUCCESS;
 	}
 
+#if SWIFTSHADER_SPARSE_BINDING
+	int getSparseBindingFd() const override
+	{
+		return memfd.fd();
+	}
+#endif
+
 private:
 	LinuxMemFd memfd;
 	OpaqueFdAllocateInfo allocateInfo;
@@ -72,6 +72,19 @@ void Framebuffer::destroy(const VkAllocationCallbacks *pAllocator)
 	vk::freeHostMemory(attachments, pAllocator);
 }
 
+static bool IsInputAttachment(const VkSubpassDescription &subpass, uint32_t attachment)
+{
+	for(uint32_t i = 0; i < subpass.inputAttachmentCount; i++)
+	{
+		if(subpass.pInputAttachments[i].attachment == attachment)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
 void Framebuffer::executeLoadOp(const RenderPass *renderPass, uint32_t clearValueCount, const VkClearValue *pClearValues, const VkRect2D &renderArea)
 {
 	// This gets called at the start of a renderpass. Logically the `loadOp` gets executed at the
@@ -123,7 +136,79 @@ void Framebuffer::executeLoadOp(const RenderPass *renderPass, uint32_t clearValu
 		}
 
 		uint32_t viewMask = renderPass->isMultiView() ? renderPass->getAttachmentViewMask(i) : 0;
-		attachments[i]->clear(pClearValues[i], clearMask, renderArea, viewMask);
+
+		// Input attachment reads don't perform deferred clears, so they can only be deferred
+		// for attachments which aren't read before the first subpass ends.
+		if(IsInputAttachment(renderPass->getSubpass(0), i))
+		{
+			attachments[i]->clear(pClearValues[i], clearMask, renderArea, viewMask);
+		}
+		else
+		{
+			attachments[i]->deferClear(pClearValues[i], clearMask, renderArea, viewMask);
+		}
+	}
+}
+
+bool Framebuffer::hasDeferredClears() const
+{
+	for(uint32_t i = 0; i < attachmentCount; i++)
+	{
+		if(attachments[i] && attachments[i]->hasDeferredClears())
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void Framebuffer::flushDeferredClears(const RenderPass *renderPass, uint32_t subpassIndex, bool endOfRenderPass)
+{
+	// At the end of the render pass, pending clears of attachments whose contents aren't
+	// stored can be discarded, unless they still have to be resolved.
+	if(endOfRenderPass)
+	{
+		const auto &subpass = renderPass->getSubpass(subpassIndex);
+
+		for(uint32_t i = 0; i < attachmentCount; i++)
+		{
+			if(!attachments[i] || !attachments[i]->hasDeferredClears() ||
+			   (renderPass->getAttachment(i).storeOp != VK_ATTACHMENT_STORE_OP_DONT_CARE))
+			{
+				continue;
+			}
+
+			bool resolved = false;
+
+			if(subpass.pResolveAttachments)
+			{
+				for(uint32_t j = 0; j < subpass.colorAttachmentCount; j++)
+				{
+					resolved = resolved || ((subpass.pColorAttachments[j].attachment == i) &&
+					                        (subpass.pResolveAttachments[j].attachment != VK_ATTACHMENT_UNUSED));
+				}
+			}
+
+			if(renderPass->hasDepthStencilResolve() && subpass.pDepthStencilAttachment &&
+			   (subpass.pDepthStencilAttachment->attachment == i))
+			{
+				resolved = resolved || (renderPass->getSubpassDepthStencilResolve(subpassIndex).pDepthStencilResolveAttachment != nullptr);
+			}
+
+			if(!resolved)
+			{
+				attachments[i]->discardDeferredClears();
+			}
+		}
+	}
+
+	for(uint32_t i = 0; i < attachmentCount; i++)
+	{
+		if(attachments[i])
+		{
+			attachments[i]->flushDeferredClears();
+		}
 	}
 }
 
@@ -36,6 +36,9 @@ public:
 	ImageView *getAttachment(uint32_t index) const;
 	void resolve(const RenderPass *renderPass, uint32_t subpassIndex);
 
+	bool hasDeferredClears() const;
+	void flushDeferredClears(const RenderPass *renderPass, uint32_t subpassIndex, bool endOfRenderPass);
+
 	const VkExtent2D &getExtent() const { return extent; }
 
 private:
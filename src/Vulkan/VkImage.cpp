@@ -18,12 +18,17 @@
 #include "VkDevice.hpp"
 #include "VkDeviceMemory.hpp"
 #include "VkImageView.hpp"
+#include "VkSparseAddressSpace.hpp"
 #include "VkStringify.hpp"
 #include "VkStructConversion.hpp"
 #include "Device/ASTC_Decoder.hpp"
 #include "Device/BC_Decoder.hpp"
 #include "Device/Blitter.hpp"
+#include "Device/Config.hpp"
 #include "Device/ETC_Decoder.hpp"
+#include "Device/HiZ.hpp"
+#include "System/Memory.hpp"
+#include "System/Math.hpp"
 
 #ifdef __ANDROID__
 #	include <vndk/hardware_buffer.h>
@@ -31,6 +36,8 @@
 #	include "VkDeviceMemoryExternalAndroid.hpp"
 #endif
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 
 namespace {
@@ -181,6 +188,156 @@ VkFormat GetImageFormat(const VkImageCreateInfo *pCreateInfo)
 	return pCreateInfo->format;
 }
 
+// Images which can only be sampled or accessed by transfer operations store their texels in
+// TEXEL_TILE_SIZE x TEXEL_TILE_SIZE tiles, so that the texels of a filtering footprint share
+// cache lines regardless of the direction in which the image gets traversed. Attachments and
+// storage images keep the linear layout which the pixel routines and shader image accesses
+// address directly, as do images whose memory can be accessed by external means.
+bool UseTiledLayout(const VkImageCreateInfo *pCreateInfo)
+{
+	constexpr VkImageUsageFlags tiledUsage = VK_IMAGE_USAGE_SAMPLED_BIT |
+	                                         VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+	                                         VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
+	if((pCreateInfo->tiling != VK_IMAGE_TILING_OPTIMAL) ||
+	   (pCreateInfo->imageType != VK_IMAGE_TYPE_2D) ||
+	   (pCreateInfo->samples != VK_SAMPLE_COUNT_1_BIT) ||
+	   (pCreateInfo->usage & ~tiledUsage) ||
+	   (pCreateInfo->flags & ~VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT))
+	{
+		return false;
+	}
+
+	vk::Format format(pCreateInfo->format);
+	if(format.isCompressed() || format.isYcbcrFormat() || format.isDepth() || format.isStencil())
+	{
+		return false;
+	}
+
+	for(const auto *nextInfo = reinterpret_cast<const VkBaseInStructure *>(pCreateInfo->pNext); nextInfo; nextInfo = nextInfo->pNext)
+	{
+		switch(nextInfo->sType)
+		{
+		case VK_STRUCTURE_TYPE_IMAGE_FORMAT_LIST_CREATE_INFO:
+		case VK_STRUCTURE_TYPE_IMAGE_STENCIL_USAGE_CREATE_INFO:
+		case VK_STRUCTURE_TYPE_MAX_ENUM:
+			break;
+		default:
+			// External memory, swapchain images, etc.
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Byte offset of texel (x, y) within a slice of an image with a tiled layout. Tiles are
+// stored in row-major order, and each tile's texels are too.
+size_t TiledTexelOffset(int x, int y, size_t rowPitchBytes, int bytesPerTexel)
+{
+	constexpr int mask = sw::TEXEL_TILE_SIZE - 1;
+	return (y & ~mask) * rowPitchBytes +
+	       (((x & ~mask) + (y & mask)) * sw::TEXEL_TILE_SIZE + (x & mask)) * bytesPerTexel;
+}
+
+// Addresses the texels of a single slice, stored either linearly or in tiles.
+struct SliceAddressing
+{
+	uint8_t *slice;
+	size_t rowPitchBytes;
+	int bytesPerTexel;
+	bool tiled;
+
+	uint8_t *texel(int x, int y) const
+	{
+		return slice + (tiled ? TiledTexelOffset(x, y, rowPitchBytes, bytesPerTexel) : (y * rowPitchBytes + x * bytesPerTexel));
+	}
+
+	// Number of texels which are consecutive in memory, starting at column x.
+	uint32_t contiguousTexels(int x, uint32_t width) const
+	{
+		return tiled ? std::min(width, static_cast<uint32_t>(sw::TEXEL_TILE_SIZE - (x & (sw::TEXEL_TILE_SIZE - 1)))) : width;
+	}
+};
+
+void CopyTexels(const SliceAddressing &src, VkOffset2D srcOffset, const SliceAddressing &dst, VkOffset2D dstOffset, VkExtent2D extent)
+{
+	ASSERT(src.bytesPerTexel == dst.bytesPerTexel);
+
+	for(uint32_t y = 0; y < extent.height; y++)
+	{
+		for(uint32_t x = 0; x < extent.width;)
+		{
+			int srcX = srcOffset.x + x;
+			int dstX = dstOffset.x + x;
+			uint32_t count = std::min(src.contiguousTexels(srcX, extent.width - x),
+			                          dst.contiguousTexels(dstX, extent.width - x));
+
+			memcpy(dst.texel(dstX, dstOffset.y + y), src.texel(srcX, srcOffset.y + y), count * src.bytesPerTexel);
+
+			x += count;
+		}
+	}
+}
+
+// Upper limit on the host memory used for the attachment metadata of a single image.
+constexpr size_t MAX_ATTACHMENT_METADATA_SIZE = 64 * 1024 * 1024;
+
+// Layout of the per-tile metadata kept for attachments: hierarchical depth tiles for depth
+// images or per-pixel sample equality bits for multisampled color images, followed by
+// per-layer deferred clear values and per-tile deferred clear flags.
+// This is only done for the first mip level of attachments whose memory can't be legally
+// accessed by other means than the commands which keep the metadata up to date.
+struct AttachmentMetadataLayout
+{
+	VkExtent2D tiles = { 0, 0 };
+	size_t hiZSize = 0;
+	size_t sampleEqualitySize = 0;
+	size_t clearValuesSize = 0;
+	size_t clearTilesSize = 0;
+
+	size_t size() const { return hiZSize + sampleEqualitySize + clearValuesSize + clearTilesSize; }
+};
+
+AttachmentMetadataLayout GetAttachmentMetadataLayout(const VkImageCreateInfo *pCreateInfo)
+{
+	AttachmentMetadataLayout layout;
+
+	if(!(pCreateInfo->usage & (VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)) ||
+	   (pCreateInfo->tiling != VK_IMAGE_TILING_OPTIMAL) ||
+	   (pCreateInfo->imageType != VK_IMAGE_TYPE_2D) ||
+	   (pCreateInfo->flags & VK_IMAGE_CREATE_ALIAS_BIT) ||
+	   vk::GetExtendedStruct<VkExternalMemoryImageCreateInfo>(pCreateInfo->pNext, VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO))
+	{
+		return layout;
+	}
+
+	VkExtent2D tiles = {
+		(pCreateInfo->extent.width + sw::HIZ_TILE_WIDTH - 1) / sw::HIZ_TILE_WIDTH,
+		(pCreateInfo->extent.height + sw::HIZ_TILE_HEIGHT - 1) / sw::HIZ_TILE_HEIGHT,
+	};
+	size_t tileCount = static_cast<size_t>(tiles.width) * tiles.height * pCreateInfo->arrayLayers;
+
+	AttachmentMetadataLayout candidate;
+	candidate.tiles = tiles;
+	candidate.hiZSize = vk::Format(pCreateInfo->format).isDepth() ? tileCount * sizeof(sw::HiZTile) : 0;
+
+	// Storage images can be written by shaders without the draws' pixel routines knowing.
+	bool multisampledColor = (pCreateInfo->samples != VK_SAMPLE_COUNT_1_BIT) &&
+	                         (pCreateInfo->usage & VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT) &&
+	                         !(pCreateInfo->usage & VK_IMAGE_USAGE_STORAGE_BIT);
+	candidate.sampleEqualitySize = multisampledColor ? tileCount * sizeof(uint32_t) : 0;
+	candidate.clearValuesSize = pCreateInfo->arrayLayers * sizeof(uint32_t);
+	candidate.clearTilesSize = tileCount * sizeof(uint8_t);
+
+	if(candidate.size() > MAX_ATTACHMENT_METADATA_SIZE)
+	{
+		return layout;
+	}
+
+	return candidate;
+}
+
 }  // anonymous namespace
 
 namespace vk {
@@ -196,12 +353,42 @@ Image::Image(const VkImageCreateInfo *pCreateInfo, void *mem, Device *device)
     , samples(pCreateInfo->samples)
     , tiling(pCreateInfo->tiling)
     , usage(pCreateInfo->usage)
+    , tiledLayout(UseTiledLayout(pCreateInfo))
 {
 	if(format.isCompressed())
 	{
 		VkImageCreateInfo compressedImageCreateInfo = *pCreateInfo;
 		compressedImageCreateInfo.format = format.getDecompressedFormat();
+		compressedImageCreateInfo.flags &= ~VK_IMAGE_CREATE_SPARSE_BINDING_BIT;  // Shares this image's address range
 		decompressedImage = new(mem) Image(&compressedImageCreateInfo, nullptr, device);
+		decompressedImage->tiledLayout = false;  // The decoders write the texels linearly
+	}
+	else if(mem)
+	{
+		AttachmentMetadataLayout layout = GetAttachmentMetadataLayout(pCreateInfo);
+		ASSERT(layout.size() > 0);
+
+		uint8_t *metadata = static_cast<uint8_t *>(mem);
+		attachmentMetadata = mem;
+		attachmentTilesX = layout.tiles.width;
+		attachmentTilesY = layout.tiles.height;
+
+		if(layout.hiZSize > 0)
+		{
+			hiZTiles = reinterpret_cast<sw::HiZTile *>(metadata);
+			invalidateHiZ({ VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, arrayLayers });
+		}
+
+		if(layout.sampleEqualitySize > 0)
+		{
+			sampleEqualityTiles = reinterpret_cast<uint32_t *>(metadata + layout.hiZSize);
+			memset(sampleEqualityTiles, 0, layout.sampleEqualitySize);
+		}
+
+		uint8_t *clearMetadata = metadata + layout.hiZSize + layout.sampleEqualitySize;
+		deferredClearValues = reinterpret_cast<uint32_t *>(clearMetadata);
+		deferredClearTiles = clearMetadata + layout.clearValuesSize;
+		memset(deferredClearTiles, 0, layout.clearTilesSize);
 	}
 
 	const auto *externalInfo = GetExtendedStruct<VkExternalMemoryImageCreateInfo>(pCreateInfo->pNext, VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO);
@@ -217,11 +404,55 @@ void Image::destroy(const VkAllocationCallbacks *pAllocator)
 	{
 		vk::freeHostMemory(decompressedImage, pAllocator);
 	}
+
+	if(attachmentMetadata)
+	{
+		vk::freeHostMemory(attachmentMetadata, pAllocator);
+	}
+
+	if(sparseAddressSpace)
+	{
+		sparseAddressSpace->~SparseAddressSpace();
+		vk::freeHostMemory(sparseAddressSpace, pAllocator);
+	}
+}
+
+// Sparse images have their own address range, into which memory gets mapped by
+// vkQueueBindSparse() instead of vkBindImageMemory(). Only opaque binding is
+// supported, so the image's layout is the same as when bound to a DeviceMemory.
+VkResult Image::reserveSparseAddressSpace(const VkAllocationCallbacks *pAllocator)
+{
+	ASSERT(flags & VK_IMAGE_CREATE_SPARSE_BINDING_BIT);
+
+	void *mem = vk::allocateHostMemory(sizeof(SparseAddressSpace), alignof(SparseAddressSpace), pAllocator, GetAllocationScope());
+	if(!mem)
+	{
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
+
+	sparseAddressSpace = new(mem) SparseAddressSpace(getMemoryRequirements().size);
+	if(!sparseAddressSpace->data())
+	{
+		return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+	}
+
+	if(decompressedImage)
+	{
+		decompressedImage->sparseAddressSpace = sparseAddressSpace;
+		decompressedImage->memoryOffset = getStorageSize(format.getAspects());
+	}
+
+	return VK_SUCCESS;
 }
 
 size_t Image::ComputeRequiredAllocationSize(const VkImageCreateInfo *pCreateInfo)
 {
-	return Format(pCreateInfo->format).isCompressed() ? sizeof(Image) : 0;
+	if(Format(pCreateInfo->format).isCompressed())
+	{
+		return sizeof(Image);
+	}
+
+	return GetAttachmentMetadataLayout(pCreateInfo).size();
 }
 
 const VkMemoryRequirements Image::getMemoryRequirements() const
@@ -231,6 +462,17 @@ const VkMemoryRequirements Image::getMemoryRequirements() const
 	memoryRequirements.memoryTypeBits = vk::MEMORY_TYPE_GENERIC_BIT;
 	memoryRequirements.size = getStorageSize(format.getAspects()) +
 	                          (decompressedImage ? decompressedImage->getStorageSize(decompressedImage->format.getAspects()) : 0);
+#if SWIFTSHADER_SPARSE_BINDING
+	memoryRequirements.memoryTypeBits |= vk::MEMORY_TYPE_SPARSE_BIT;
+
+	if(flags & VK_IMAGE_CREATE_SPARSE_BINDING_BIT)
+	{
+		// Sparse memory gets mapped at block granularity, from a shared memory object.
+		memoryRequirements.alignment = vk::SPARSE_BLOCK_SIZE;
+		memoryRequirements.size = sw::align<vk::SPARSE_BLOCK_SIZE>(memoryRequirements.size);
+		memoryRequirements.memoryTypeBits = vk::MEMORY_TYPE_SPARSE_BIT;
+	}
+#endif
 	return memoryRequirements;
 }
 
@@ -315,6 +557,22 @@ void Image::bind(DeviceMemory *pDeviceMemory, VkDeviceSize pMemoryOffset)
 		decompressedImage->deviceMemory = deviceMemory;
 		decompressedImage->memoryOffset = memoryOffset + getStorageSize(format.getAspects());
 	}
+
+	// The contents of newly bound memory are unknown.
+	invalidateHiZ({ VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, arrayLayers });
+	invalidateSampleEquality({ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, arrayLayers });
+}
+
+VkResult Image::bindSparse(const VkSparseMemoryBind &bind)
+{
+	ASSERT(sparseAddressSpace);
+	VkResult result = sparseAddressSpace->bind(bind);
+
+	// The contents of newly bound memory are unknown.
+	invalidateHiZ({ VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, arrayLayers });
+	invalidateSampleEquality({ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, arrayLayers });
+
+	return result;
 }
 
 #ifdef __ANDROID__
@@ -509,6 +767,31 @@ void Image::copySingleAspectTo(Image *dstImage, const VkImageCopy2KHR &region) c
 	                     (copyExtent.height == dstExtent.height) &&
 	                     (srcDepthPitch == dstDepthPitch);
 
+	if(tiledLayout || dstImage->tiledLayout)
+	{
+		// Images with a tiled layout have a single sample and slice, so only the
+		// rows of each layer need to be copied.
+		ASSERT(sliceCount == 1);
+
+		VkOffset3D srcOffset = imageOffsetInBlocks(region.srcOffset, srcAspect);
+		VkOffset3D dstOffset = dstImage->imageOffsetInBlocks(region.dstOffset, dstAspect);
+		uint8_t *srcSlice = static_cast<uint8_t *>(getTexelPointer({ 0, 0, region.srcOffset.z }, ImageSubresource(region.srcSubresource)));
+		uint8_t *dstSlice = static_cast<uint8_t *>(dstImage->getTexelPointer({ 0, 0, region.dstOffset.z }, ImageSubresource(region.dstSubresource)));
+
+		for(uint32_t layer = 0; layer < layerCount; layer++)
+		{
+			CopyTexels({ srcSlice, static_cast<size_t>(srcRowPitch), bytesPerBlock, tiledLayout }, { srcOffset.x, srcOffset.y },
+			           { dstSlice, static_cast<size_t>(dstRowPitch), bytesPerBlock, dstImage->tiledLayout }, { dstOffset.x, dstOffset.y },
+			           { copyExtent.width, copyExtent.height });
+
+			srcSlice += srcLayerPitch;
+			dstSlice += dstLayerPitch;
+		}
+
+		dstImage->contentsChanged(ImageSubresourceRange(region.dstSubresource));
+		return;
+	}
+
 	const uint8_t *srcLayer = static_cast<const uint8_t *>(getTexelPointer(region.srcOffset, ImageSubresource(region.srcSubresource)));
 	uint8_t *dstLayer = static_cast<uint8_t *>(dstImage->getTexelPointer(region.dstOffset, ImageSubresource(region.dstSubresource)));
 
@@ -628,6 +911,42 @@ void Image::copy(const void *srcCopyMemory,
 	int memorySlicePitchBytes = extent.height * memoryRowPitchBytes;
 	ASSERT(samples == 1);
 
+	const uint32_t layerCount = imageSubresource.layerCount == VK_REMAINING_ARRAY_LAYERS ?
+		arrayLayers - imageSubresource.baseArrayLayer : imageSubresource.layerCount;
+
+	if(tiledLayout)
+	{
+		ASSERT(imageExtent.depth == 1);
+
+		VkImageSubresource subresource = ImageSubresource(imageSubresource);
+		uint8_t *memory = static_cast<uint8_t *>(memoryIsSource ? const_cast<void *>(srcCopyMemory) : dstCopyMemory);
+		VkOffset2D imageOffset = { imageCopyOffset.x, imageCopyOffset.y };
+
+		for(uint32_t i = 0; i < layerCount; i++, subresource.arrayLayer++)
+		{
+			SliceAddressing image = { static_cast<uint8_t *>(getTexelPointer({ 0, 0, 0 }, subresource)), rowPitchBytes(aspect, subresource.mipLevel), bytesPerBlock, true };
+			SliceAddressing linear = { memory, static_cast<size_t>(memoryRowPitchBytes), bytesPerBlock, false };
+
+			if(memoryIsSource)
+			{
+				CopyTexels(linear, { 0, 0 }, image, imageOffset, Extent2D(imageExtent));
+			}
+			else
+			{
+				CopyTexels(image, imageOffset, linear, { 0, 0 }, Extent2D(imageExtent));
+			}
+
+			memory += memorySlicePitchBytes;
+		}
+
+		if(memoryIsSource)
+		{
+			contentsChanged(ImageSubresourceRange(imageSubresource));
+		}
+
+		return;
+	}
+
 	uint8_t *imageMemory = static_cast<uint8_t *>(getTexelPointer(imageCopyOffset, ImageSubresource(imageSubresource)));
 	const uint8_t *srcMemory = memoryIsSource ? static_cast<const uint8_t *>(srcCopyMemory) : imageMemory;
 	uint8_t *dstMemory = memoryIsSource ? imageMemory : static_cast<uint8_t *>(dstCopyMemory);
@@ -645,8 +964,6 @@ void Image::copy(const void *srcCopyMemory,
 	VkDeviceSize srcLayerSize = memoryIsSource ? memorySlicePitchBytes : imageLayerSize;
 	VkDeviceSize dstLayerSize = memoryIsSource ? imageLayerSize : memorySlicePitchBytes;
 
-	const uint32_t layerCount = imageSubresource.layerCount == VK_REMAINING_ARRAY_LAYERS ?
-		arrayLayers - imageSubresource.baseArrayLayer : imageSubresource.layerCount;
 	for(uint32_t i = 0; i < layerCount; i++)
 	{
 		const uint8_t *srcLayerMemory = srcMemory;
@@ -699,9 +1016,9 @@ void Image::copyFromMemory(const VkMemoryToImageCopyEXT &region)
 void *Image::getTexelPointer(const VkOffset3D &offset, const VkImageSubresource &subresource) const
 {
 	VkImageAspectFlagBits aspect = static_cast<VkImageAspectFlagBits>(subresource.aspectMask);
-	return deviceMemory->getOffsetPointer(getMemoryOffset(aspect) +
-	                                      texelOffsetBytesInStorage(offset, subresource) +
-	                                      getSubresourceOffset(aspect, subresource.mipLevel, subresource.arrayLayer));
+	return getMemoryPointer(getMemoryOffset(aspect) +
+	                        texelOffsetBytesInStorage(offset, subresource) +
+	                        getSubresourceOffset(aspect, subresource.mipLevel, subresource.arrayLayer));
 }
 
 VkExtent3D Image::imageExtentInBlocks(const VkExtent3D &extent, VkImageAspectFlagBits aspect) const
@@ -782,6 +1099,13 @@ VkDeviceSize Image::texelOffsetBytesInStorage(const VkOffset3D &offset, const Vk
 {
 	VkImageAspectFlagBits aspect = static_cast<VkImageAspectFlagBits>(subresource.aspectMask);
 	VkOffset3D adjustedOffset = imageOffsetInBlocks(offset, aspect);
+
+	if(tiledLayout)
+	{
+		return adjustedOffset.z * slicePitchBytes(aspect, subresource.mipLevel) +
+		       TiledTexelOffset(adjustedOffset.x, adjustedOffset.y, rowPitchBytes(aspect, subresource.mipLevel), getFormat(aspect).bytes());
+	}
+
 	int border = borderSize();
 	return adjustedOffset.z * slicePitchBytes(aspect, subresource.mipLevel) +
 	       (adjustedOffset.y + border) * rowPitchBytes(aspect, subresource.mipLevel) +
@@ -853,6 +1177,11 @@ size_t Image::rowPitchBytes(VkImageAspectFlagBits aspect, uint32_t mipLevel) con
 		return extentInBlocks.width * usedFormat.bytesPerBlock();
 	}
 
+	if(tiledLayout)
+	{
+		return sw::align<sw::TEXEL_TILE_SIZE>(mipLevelExtent.width) * usedFormat.bytes();
+	}
+
 	return usedFormat.pitchB(mipLevelExtent.width, borderSize());
 }
 
@@ -870,6 +1199,11 @@ size_t Image::slicePitchBytes(VkImageAspectFlagBits aspect, uint32_t mipLevel) c
 		return extentInBlocks.height * extentInBlocks.width * usedFormat.bytesPerBlock();
 	}
 
+	if(tiledLayout)
+	{
+		return rowPitchBytes(aspect, mipLevel) * sw::align<sw::TEXEL_TILE_SIZE>(mipLevelExtent.height);
+	}
+
 	return usedFormat.sliceB(mipLevelExtent.width, mipLevelExtent.height, borderSize());
 }
 
@@ -889,6 +1223,11 @@ bool Image::isCubeCompatible() const
 
 uint8_t *Image::end() const
 {
+	if(sparseAddressSpace)
+	{
+		return static_cast<uint8_t *>(sparseAddressSpace->data()) + sparseAddressSpace->size();
+	}
+
 	return reinterpret_cast<uint8_t *>(deviceMemory->getOffsetPointer(deviceMemory->getCommittedMemoryInBytes() + 1));
 }
 
@@ -902,6 +1241,16 @@ VkDeviceSize Image::getMemoryOffset(VkImageAspectFlagBits aspect) const
 	return memoryOffset;
 }
 
+void *Image::getMemoryPointer(VkDeviceSize offset) const
+{
+	if(sparseAddressSpace)
+	{
+		return static_cast<uint8_t *>(sparseAddressSpace->data()) + offset;
+	}
+
+	return deviceMemory->getOffsetPointer(offset);
+}
+
 VkDeviceSize Image::getAspectOffset(VkImageAspectFlagBits aspect) const
 {
 	switch(format)
@@ -1073,6 +1422,16 @@ uint32_t Image::getLastMipLevel(const VkImageSubresourceRange &subresourceRange)
 void Image::clear(const void *pixelData, VkFormat pixelFormat, const vk::Format &viewFormat, const VkImageSubresourceRange &subresourceRange, const VkRect2D *renderArea)
 {
 	device->getBlitter()->clear(pixelData, pixelFormat, this, viewFormat, subresourceRange, renderArea);
+
+	if(subresourceRange.aspectMask == VK_IMAGE_ASPECT_DEPTH_BIT)
+	{
+		ASSERT(pixelFormat == VK_FORMAT_D32_SFLOAT);
+		clearHiZ(*static_cast<const float *>(pixelData), subresourceRange, renderArea);
+	}
+	else if(subresourceRange.aspectMask == VK_IMAGE_ASPECT_COLOR_BIT)
+	{
+		setSamplesEqual(subresourceRange, renderArea);
+	}
 }
 
 void Image::clear(const VkClearColorValue &color, const VkImageSubresourceRange &subresourceRange)
@@ -1146,6 +1505,13 @@ void Image::contentsChanged(const VkImageSubresourceRange &subresourceRange, Con
 		return;
 	}
 
+	invalidateHiZ(subresourceRange);
+
+	if(contentsChangedContext != RENDERED)
+	{
+		invalidateSampleEquality(subresourceRange);
+	}
+
 	// If this isn't a cube or a compressed image, we'll never need dirtyResources,
 	// so we can skip updating dirtyResources
 	if(!requiresPreprocessing())
@@ -1174,6 +1540,316 @@ void Image::contentsChanged(const VkImageSubresourceRange &subresourceRange, Con
 			dirtySubresources.insert(subresource);
 		}
 	}
+
+	device->incrementPreprocessingVersion();
+}
+
+sw::HiZTile *Image::getHiZTiles(uint32_t layer) const
+{
+	if(!hiZTiles)
+	{
+		return nullptr;
+	}
+
+	ASSERT(layer < arrayLayers);
+	return hiZTiles + static_cast<size_t>(layer) * attachmentTilesX * attachmentTilesY;
+}
+
+uint32_t Image::getHiZPitchBytes() const
+{
+	return hiZTiles ? attachmentTilesX * sizeof(sw::HiZTile) : 0;
+}
+
+void Image::clearHiZ(float depth, const VkImageSubresourceRange &subresourceRange, const VkRect2D *renderArea)
+{
+	if(!hiZTiles || (subresourceRange.baseMipLevel != 0))
+	{
+		return;
+	}
+
+	// Convert to the units the depth test compares in, rounding up to remain an upper bound.
+	float maxZ = depth;
+	if(getFormat(VK_IMAGE_ASPECT_DEPTH_BIT) == VK_FORMAT_D16_UNORM)
+	{
+		maxZ = ceilf(sw::clamp(depth, 0.0f, 1.0f) * 0xFFFF);
+	}
+
+	VkRect2D area = { { 0, 0 }, { extent.width, extent.height } };
+	if(renderArea)
+	{
+		area = *renderArea;
+	}
+
+	int x0 = area.offset.x;
+	int y0 = area.offset.y;
+	int x1 = x0 + area.extent.width;
+	int y1 = y0 + area.extent.height;
+
+	uint32_t lastLayer = getLastLayerIndex(subresourceRange);
+	for(uint32_t layer = subresourceRange.baseArrayLayer; layer <= lastLayer; layer++)
+	{
+		sw::HiZTile *tiles = getHiZTiles(layer);
+
+		for(int ty = y0 / sw::HIZ_TILE_HEIGHT; ty * sw::HIZ_TILE_HEIGHT < y1; ty++)
+		{
+			int tileY0 = ty * sw::HIZ_TILE_HEIGHT;
+			int tileY1 = std::min(tileY0 + sw::HIZ_TILE_HEIGHT, static_cast<int>(extent.height));
+
+			for(int tx = x0 / sw::HIZ_TILE_WIDTH; tx * sw::HIZ_TILE_WIDTH < x1; tx++)
+			{
+				int tileX0 = tx * sw::HIZ_TILE_WIDTH;
+				int tileX1 = std::min(tileX0 + sw::HIZ_TILE_WIDTH, static_cast<int>(extent.width));
+
+				sw::HiZTile &tile = tiles[ty * attachmentTilesX + tx];
+
+				if(tileX0 >= x0 && tileX1 <= x1 && tileY0 >= y0 && tileY1 <= y1)
+				{
+					tile = { maxZ, 0 };
+				}
+				else  // Partially cleared
+				{
+					tile.maxZ = std::max(tile.maxZ, maxZ);
+				}
+			}
+		}
+	}
+}
+
+void Image::invalidateHiZ(const VkImageSubresourceRange &subresourceRange)
+{
+	if(!hiZTiles || !(subresourceRange.aspectMask & VK_IMAGE_ASPECT_DEPTH_BIT) || (subresourceRange.baseMipLevel != 0))
+	{
+		return;
+	}
+
+	uint32_t lastLayer = getLastLayerIndex(subresourceRange);
+	size_t tileCount = static_cast<size_t>(lastLayer - subresourceRange.baseArrayLayer + 1) * attachmentTilesX * attachmentTilesY;
+	std::fill_n(getHiZTiles(subresourceRange.baseArrayLayer), tileCount, sw::HiZTile::Invalid());
+}
+
+uint32_t *Image::getSampleEqualityTiles(uint32_t layer) const
+{
+	if(!sampleEqualityTiles)
+	{
+		return nullptr;
+	}
+
+	ASSERT(layer < arrayLayers);
+	return sampleEqualityTiles + static_cast<size_t>(layer) * attachmentTilesX * attachmentTilesY;
+}
+
+uint32_t Image::getSampleEqualityPitchBytes() const
+{
+	return sampleEqualityTiles ? attachmentTilesX * sizeof(uint32_t) : 0;
+}
+
+void Image::setSamplesEqual(const VkImageSubresourceRange &subresourceRange, const VkRect2D *renderArea)
+{
+	if(!sampleEqualityTiles || (subresourceRange.baseMipLevel != 0))
+	{
+		return;
+	}
+
+	VkRect2D area = { { 0, 0 }, { extent.width, extent.height } };
+	if(renderArea)
+	{
+		area = *renderArea;
+	}
+
+	int x0 = area.offset.x;
+	int y0 = area.offset.y;
+	int x1 = std::min(x0 + static_cast<int>(area.extent.width), static_cast<int>(extent.width));
+	int y1 = std::min(y0 + static_cast<int>(area.extent.height), static_cast<int>(extent.height));
+
+	uint32_t lastLayer = getLastLayerIndex(subresourceRange);
+	for(uint32_t layer = subresourceRange.baseArrayLayer; layer <= lastLayer; layer++)
+	{
+		uint32_t *tiles = getSampleEqualityTiles(layer);
+
+		for(int y = y0; y < y1; y++)
+		{
+			uint32_t *tileRow = tiles + (y / sw::HIZ_TILE_HEIGHT) * attachmentTilesX;
+			int shift = (y % sw::HIZ_TILE_HEIGHT) * sw::HIZ_TILE_WIDTH;
+
+			for(int tx = x0 / sw::HIZ_TILE_WIDTH; tx * sw::HIZ_TILE_WIDTH < x1; tx++)
+			{
+				int tileX0 = std::max(tx * sw::HIZ_TILE_WIDTH, x0) % sw::HIZ_TILE_WIDTH;
+				int tileX1 = std::min(tx * sw::HIZ_TILE_WIDTH + sw::HIZ_TILE_WIDTH, x1) - tx * sw::HIZ_TILE_WIDTH;
+				uint32_t bits = ((1u << (tileX1 - tileX0)) - 1) << tileX0;
+
+				tileRow[tx] |= bits << shift;
+			}
+		}
+	}
+}
+
+void Image::invalidateSampleEquality(const VkImageSubresourceRange &subresourceRange)
+{
+	if(!sampleEqualityTiles || !(subresourceRange.aspectMask & VK_IMAGE_ASPECT_COLOR_BIT) || (subresourceRange.baseMipLevel != 0))
+	{
+		return;
+	}
+
+	uint32_t lastLayer = getLastLayerIndex(subresourceRange);
+	size_t tileCount = static_cast<size_t>(lastLayer - subresourceRange.baseArrayLayer + 1) * attachmentTilesX * attachmentTilesY;
+	std::fill_n(getSampleEqualityTiles(subresourceRange.baseArrayLayer), tileCount, 0);
+}
+
+bool Image::deferClear(const VkClearValue &clearValue, const vk::Format &viewFormat, const VkRect2D &renderArea, const VkImageSubresourceRange &subresourceRange)
+{
+	VkImageAspectFlagBits aspect = static_cast<VkImageAspectFlagBits>(subresourceRange.aspectMask);
+
+	// Only clears of the entire first mip level are deferred.
+	if(!deferredClearTiles ||
+	   ((aspect != VK_IMAGE_ASPECT_COLOR_BIT) && (aspect != VK_IMAGE_ASPECT_DEPTH_BIT)) ||
+	   (subresourceRange.baseMipLevel != 0) ||
+	   (renderArea.offset.x != 0) || (renderArea.offset.y != 0) ||
+	   (renderArea.extent.width < extent.width) || (renderArea.extent.height < extent.height))
+	{
+		return false;
+	}
+
+	int bytes = viewFormat.getAspectFormat(aspect).bytes();
+	if((bytes != 2) && (bytes != 4))
+	{
+		return false;
+	}
+
+	uint32_t packed = 0;
+	bool packable = (aspect == VK_IMAGE_ASPECT_COLOR_BIT)
+	                    ? sw::Blitter::GetClearPattern(clearValue.color.float32, viewFormat.getClearFormat(), viewFormat, aspect, packed)
+	                    : sw::Blitter::GetClearPattern(&clearValue.depthStencil.depth, VK_FORMAT_D32_SFLOAT, viewFormat, aspect, packed);
+	if(!packable)
+	{
+		return false;
+	}
+
+	if(bytes == 2)
+	{
+		packed = (packed & 0xFFFF) * 0x00010001;  // Replicate for writing pairs of texels
+	}
+
+	contentsChanged(subresourceRange);
+
+	uint32_t lastLayer = getLastLayerIndex(subresourceRange);
+	for(uint32_t layer = subresourceRange.baseArrayLayer; layer <= lastLayer; layer++)
+	{
+		deferredClearValues[layer] = packed;
+		memset(getDeferredClearTiles(layer), 1, attachmentTilesX * attachmentTilesY);
+	}
+
+	deferredClears = true;
+
+	if(aspect == VK_IMAGE_ASPECT_DEPTH_BIT)
+	{
+		clearHiZ(clearValue.depthStencil.depth, subresourceRange, &renderArea);
+	}
+	else
+	{
+		setSamplesEqual(subresourceRange, &renderArea);
+	}
+
+	return true;
+}
+
+void Image::flushDeferredClears()
+{
+	if(!deferredClears)
+	{
+		return;
+	}
+
+	VkImageAspectFlagBits aspect = format.isDepth() ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+	int bytes = getFormat(aspect).bytes();
+	int rowPitch = rowPitchBytes(aspect, 0);
+	int slicePitch = slicePitchBytes(aspect, 0);
+
+	for(uint32_t layer = 0; layer < arrayLayers; layer++)
+	{
+		uint8_t *tiles = getDeferredClearTiles(layer);
+		uint32_t value = deferredClearValues[layer];
+
+		for(uint32_t ty = 0; ty < attachmentTilesY; ty++)
+		{
+			uint8_t *tileRow = tiles + ty * attachmentTilesX;
+
+			uint32_t tx = 0;
+			while(tx < attachmentTilesX)
+			{
+				if(!tileRow[tx])
+				{
+					tx++;
+					continue;
+				}
+
+				// Clear runs of adjacent tiles at once.
+				uint32_t txEnd = tx + 1;
+				while((txEnd < attachmentTilesX) && tileRow[txEnd])
+				{
+					txEnd++;
+				}
+
+				memset(tileRow + tx, 0, txEnd - tx);
+
+				int x0 = tx * sw::HIZ_TILE_WIDTH;
+				int y0 = ty * sw::HIZ_TILE_HEIGHT;
+				uint32_t width = std::min(txEnd * sw::HIZ_TILE_WIDTH, extent.width) - x0;
+				uint32_t height = std::min(y0 + sw::HIZ_TILE_HEIGHT, static_cast<int>(extent.height)) - y0;
+
+				uint8_t *slice = static_cast<uint8_t *>(getTexelPointer({ x0, y0, 0 }, { static_cast<VkImageAspectFlags>(aspect), 0, layer }));
+
+				for(int sample = 0; sample < samples; sample++)
+				{
+					uint8_t *row = slice;
+
+					for(uint32_t y = 0; y < height; y++)
+					{
+						if(bytes == 4)
+						{
+							sw::clear(reinterpret_cast<uint32_t *>(row), value, width);
+						}
+						else
+						{
+							sw::clear(reinterpret_cast<uint16_t *>(row), static_cast<uint16_t>(value), width);
+						}
+
+						row += rowPitch;
+					}
+
+					slice += slicePitch;
+				}
+
+				tx = txEnd;
+			}
+		}
+	}
+
+	deferredClears = false;
+}
+
+void Image::discardDeferredClears(const VkImageSubresourceRange &subresourceRange)
+{
+	if(!deferredClears || (subresourceRange.baseMipLevel != 0))
+	{
+		return;
+	}
+
+	// The tiles' contents become undefined, so their hierarchical depth is no longer known either.
+	// Note that other layers may still have pending clears, so 'deferredClears' remains set.
+	invalidateHiZ(subresourceRange);
+	invalidateSampleEquality(subresourceRange);
+
+	uint32_t lastLayer = getLastLayerIndex(subresourceRange);
+	for(uint32_t layer = subresourceRange.baseArrayLayer; layer <= lastLayer; layer++)
+	{
+		memset(getDeferredClearTiles(layer), 0, attachmentTilesX * attachmentTilesY);
+	}
+}
+
+uint8_t *Image::getDeferredClearTiles(uint32_t layer) const
+{
+	ASSERT(deferredClearTiles && (layer < arrayLayers));
+	return deferredClearTiles + static_cast<size_t>(layer) * attachmentTilesX * attachmentTilesY;
 }
 
 void Image::prepareForSampling(const VkImageSubresourceRange &subresourceRange) const
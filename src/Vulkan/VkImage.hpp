@@ -26,12 +26,19 @@
 
 #include <unordered_set>
 
+namespace sw {
+
+struct HiZTile;
+
+}  // namespace sw
+
 namespace vk {
 
 class Buffer;
 class Device;
 class DeviceMemory;
 class ImageView;
+class SparseAddressSpace;
 
 #ifdef __ANDROID__
 struct BackingMemory
@@ -47,6 +54,7 @@ class Image : public Object<Image, VkImage>
 public:
 	Image(const VkImageCreateInfo *pCreateInfo, void *mem, Device *device);
 	void destroy(const VkAllocationCallbacks *pAllocator);
+	VkResult reserveSparseAddressSpace(const VkAllocationCallbacks *pAllocator);
 
 #ifdef __ANDROID__
 	VkResult prepareForExternalUseANDROID() const;
@@ -59,6 +67,7 @@ public:
 	size_t getSizeInBytes(const VkImageSubresourceRange &subresourceRange) const;
 	void getSubresourceLayout(const VkImageSubresource *pSubresource, VkSubresourceLayout *pLayout) const;
 	void bind(DeviceMemory *pDeviceMemory, VkDeviceSize pMemoryOffset);
+	VkResult bindSparse(const VkSparseMemoryBind &bind);
 	void copyTo(Image *dstImage, const VkImageCopy2KHR &region) const;
 	void copyTo(Buffer *dstBuffer, const VkBufferImageCopy2KHR &region);
 	void copyFrom(Buffer *srcBuffer, const VkBufferImageCopy2KHR &region);
@@ -96,20 +105,52 @@ public:
 	void *getTexelPointer(const VkOffset3D &offset, const VkImageSubresource &subresource) const;
 	bool isCubeCompatible() const;
 	bool is3DSlice() const;
+
+	// Images with a tiled layout store their texels in sw::TEXEL_TILE_SIZE x sw::TEXEL_TILE_SIZE
+	// tiles, in row-major order. The row pitch is that of a single row of texels, so a row of tiles
+	// spans sw::TEXEL_TILE_SIZE times the row pitch.
+	bool hasTiledLayout() const { return tiledLayout; }
 	uint8_t *end() const;
 	VkDeviceSize getLayerSize(VkImageAspectFlagBits aspect) const;
 	VkDeviceSize getMipLevelSize(VkImageAspectFlagBits aspect, uint32_t mipLevel) const;
 	bool canBindToMemory(DeviceMemory *pDeviceMemory) const;
 
+	// Cube and compressed images must be processed after they're written to, before they can be sampled.
+	bool requiresPreprocessing() const;
 	void prepareForSampling(const VkImageSubresourceRange &subresourceRange) const;
 	enum ContentsChangedContext
 	{
 		DIRECT_MEMORY_ACCESS = 0,
-		USING_STORAGE = 1
+		USING_STORAGE = 1,
+		RENDERED = 2  // Written by draws, which maintain the attachment metadata themselves
 	};
 	void contentsChanged(const VkImageSubresourceRange &subresourceRange, ContentsChangedContext contentsChangedContext = DIRECT_MEMORY_ACCESS);
 	const Image *getSampledImage(const vk::Format &imageViewFormat) const;
 
+	// Hierarchical depth tiles of the depth aspect's first mip level, or nullptr if this
+	// image does not maintain them. See sw::HiZTile.
+	sw::HiZTile *getHiZTiles(uint32_t layer) const;
+	uint32_t getHiZPitchBytes() const;
+
+	// Render pass load operations can defer clearing the color or depth aspect of the first mip
+	// level. Pending clears are tracked per tile, and are performed by the pixel routines when they
+	// first access a tile, or by flushDeferredClears() for the tiles which haven't been accessed.
+	bool deferClear(const VkClearValue &clearValue, const vk::Format &viewFormat, const VkRect2D &renderArea, const VkImageSubresourceRange &subresourceRange);
+	void flushDeferredClears();
+	void discardDeferredClears(const VkImageSubresourceRange &subresourceRange);
+	bool hasDeferredClears() const { return deferredClears; }
+	uint8_t *getDeferredClearTiles(uint32_t layer) const;
+	uint32_t getDeferredClearTilesPitchBytes() const { return attachmentTilesX; }
+	uint32_t getDeferredClearValue(uint32_t layer) const { return deferredClearValues[layer]; }
+
+	// Multisampled color attachments keep one bit per pixel of the first mip level which, when
+	// set, indicates that all of the pixel's samples hold the same value. Each 32-bit word covers
+	// a tile, with bit (y % HIZ_TILE_HEIGHT) * HIZ_TILE_WIDTH + (x % HIZ_TILE_WIDTH) for pixel
+	// (x, y). The bits are set by clears and maintained by draws, which allows resolves to read a
+	// single sample of such pixels. Returns nullptr if this image does not maintain them.
+	uint32_t *getSampleEqualityTiles(uint32_t layer) const;
+	uint32_t getSampleEqualityPitchBytes() const;
+
 #ifdef __ANDROID__
 	void setBackingMemory(BackingMemory &bm)
 	{
@@ -135,6 +176,7 @@ private:
 	VkDeviceSize getMultiSampledLevelSize(VkImageAspectFlagBits aspect, uint32_t mipLevel) const;
 	VkDeviceSize getLayerOffset(VkImageAspectFlagBits aspect, uint32_t mipLevel) const;
 	VkDeviceSize getMemoryOffset(VkImageAspectFlagBits aspect) const;
+	void *getMemoryPointer(VkDeviceSize offset) const;
 	VkDeviceSize getAspectOffset(VkImageAspectFlagBits aspect) const;
 	VkDeviceSize getSubresourceOffset(VkImageAspectFlagBits aspect, uint32_t mipLevel, uint32_t layer) const;
 	VkDeviceSize texelOffsetBytesInStorage(const VkOffset3D &offset, const VkImageSubresource &subresource) const;
@@ -144,7 +186,11 @@ private:
 	void clear(const void *pixelData, VkFormat pixelFormat, const vk::Format &viewFormat, const VkImageSubresourceRange &subresourceRange, const VkRect2D *renderArea);
 	int borderSize() const;
 
-	bool requiresPreprocessing() const;
+	void clearHiZ(float depth, const VkImageSubresourceRange &subresourceRange, const VkRect2D *renderArea);
+	void invalidateHiZ(const VkImageSubresourceRange &subresourceRange);
+	void setSamplesEqual(const VkImageSubresourceRange &subresourceRange, const VkRect2D *renderArea);
+	void invalidateSampleEquality(const VkImageSubresourceRange &subresourceRange);
+
 	void decompress(const VkImageSubresource &subresource) const;
 	void decodeETC2(const VkImageSubresource &subresource) const;
 	void decodeBC(const VkImageSubresource &subresource) const;
@@ -161,7 +207,17 @@ private:
 	VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
 	VkImageTiling tiling = VK_IMAGE_TILING_OPTIMAL;
 	VkImageUsageFlags usage = (VkImageUsageFlags)0;
+	bool tiledLayout = false;
 	Image *decompressedImage = nullptr;
+	SparseAddressSpace *sparseAddressSpace = nullptr;  // Shared with the decompressed image, if any
+	void *attachmentMetadata = nullptr;
+	uint32_t attachmentTilesX = 0;
+	uint32_t attachmentTilesY = 0;
+	sw::HiZTile *hiZTiles = nullptr;
+	uint32_t *sampleEqualityTiles = nullptr;
+	uint32_t *deferredClearValues = nullptr;  // Packed texel value, per layer
+	uint8_t *deferredClearTiles = nullptr;    // Non-zero for tiles with a pending clear
+	bool deferredClears = false;
 #ifdef __ANDROID__
 	BackingMemory backingMemory = {};
 #endif
@@ -91,13 +91,14 @@ Identifier::Identifier(const VkImageViewCreateInfo *pCreateInfo)
 	vk::Format samplingFormat = (image == sampledImage) ? viewFormat : sampledImage->getFormat().getAspectFormat(subresource.aspectMask);
 	pack({ pCreateInfo->viewType, samplingFormat, ResolveComponentMapping(pCreateInfo->components, viewFormat),
 	       static_cast<uint8_t>(subresource.baseMipLevel),
-	       static_cast<uint8_t>(subresource.baseMipLevel + subresource.levelCount), subresource.levelCount <= 1u });
+	       static_cast<uint8_t>(subresource.baseMipLevel + subresource.levelCount), subresource.levelCount <= 1u,
+	       sampledImage->hasTiledLayout() });
 }
 
 Identifier::Identifier(VkFormat bufferFormat)
 {
 	constexpr VkComponentMapping identityMapping = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_A };
-	pack({ VK_IMAGE_VIEW_TYPE_1D, bufferFormat, ResolveComponentMapping(identityMapping, bufferFormat), 0, 1, true });
+	pack({ VK_IMAGE_VIEW_TYPE_1D, bufferFormat, ResolveComponentMapping(identityMapping, bufferFormat), 0, 1, true, false });
 }
 
 void Identifier::pack(const State &state)
@@ -110,7 +111,8 @@ void Identifier::pack(const State &state)
 	a = static_cast<uint32_t>(state.mapping.a);
 	minLod = state.minLod;
 	maxLod = state.maxLod;
-	singleMipLevel = state.singleMipLevel;
+	ASSERT(state.singleMipLevel == ((state.maxLod - state.minLod) <= 1));
+	tiledLayout = state.tiledLayout;
 }
 
 Identifier::State Identifier::getState() const
@@ -123,7 +125,8 @@ Identifier::State Identifier::getState() const
 		       static_cast<VkComponentSwizzle>(a) },
 		     static_cast<uint8_t>(minLod),
 		     static_cast<uint8_t>(maxLod),
-		     static_cast<bool>(singleMipLevel) };
+		     (maxLod - minLod) <= 1,
+		     static_cast<bool>(tiledLayout) };
 }
 
 ImageView::ImageView(const VkImageViewCreateInfo *pCreateInfo, void *mem, const vk::SamplerYcbcrConversion *ycbcrConversion)
@@ -239,6 +242,48 @@ void ImageView::clear(const VkClearValue &clearValue, const VkImageAspectFlags a
 	}
 }
 
+void ImageView::deferClear(const VkClearValue &clearValue, VkImageAspectFlags aspectMask, const VkRect2D &renderArea, uint32_t layerMask)
+{
+	// Clears of the color or depth aspect may be deferred, while the stencil aspect is cleared immediately.
+	VkImageAspectFlags deferrableAspect = aspectMask & (VK_IMAGE_ASPECT_COLOR_BIT | VK_IMAGE_ASPECT_DEPTH_BIT);
+
+	if(deferrableAspect)
+	{
+		VkImageSubresourceRange sr = subresourceRange;
+		sr.aspectMask = deferrableAspect;
+
+		bool deferred = true;
+
+		if(layerMask == 0)
+		{
+			deferred = image->deferClear(clearValue, format, renderArea, sr);
+		}
+		else
+		{
+			uint32_t layers = layerMask;
+			while(layers && deferred)
+			{
+				uint32_t layer = sw::log2i(layers);
+				layers &= ~(1 << layer);
+
+				sr.baseArrayLayer = subresourceRange.baseArrayLayer + layer;
+				sr.layerCount = 1;
+				deferred = image->deferClear(clearValue, format, renderArea, sr);
+			}
+		}
+
+		if(deferred)
+		{
+			aspectMask &= ~deferrableAspect;
+		}
+	}
+
+	if(aspectMask)
+	{
+		clear(clearValue, aspectMask, renderArea, layerMask);
+	}
+}
+
 void ImageView::clearWithLayerMask(const VkClearValue &clearValue, VkImageAspectFlags aspectMask, const VkRect2D &renderArea, uint32_t layerMask)
 {
 	while(layerMask)
@@ -425,4 +470,15 @@ void *ImageView::getOffsetPointer(const VkOffset3D &offset, VkImageAspectFlagBit
 	return getImage(usage)->getTexelPointer(offset, imageSubresource);
 }
 
+sw::HiZTile *ImageView::getHiZTiles(uint32_t layer) const
+{
+	// Hierarchical depth information is only maintained for the first mip level.
+	if(subresourceRange.baseMipLevel != 0)
+	{
+		return nullptr;
+	}
+
+	return image->getHiZTiles(subresourceRange.baseArrayLayer + layer);
+}
+
 }  // namespace vk
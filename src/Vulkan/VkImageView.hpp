@@ -56,6 +56,7 @@ union Identifier
 		uint8_t minLod;
 		uint8_t maxLod;
 		bool singleMipLevel;
+		bool tiledLayout;  // See vk::Image::hasTiledLayout()
 	};
 	State getState() const;
 
@@ -74,7 +75,7 @@ private:
 		uint32_t a : 3;
 		uint32_t minLod : 4;
 		uint32_t maxLod : 4;
-		uint32_t singleMipLevel : 1;
+		uint32_t tiledLayout : 1;  // Whether there's a single mip level is implied by minLod and maxLod
 	};
 
 	uint32_t id = 0;
@@ -99,6 +100,7 @@ public:
 
 	void clear(const VkClearValue &clearValues, VkImageAspectFlags aspectMask, const VkRect2D &renderArea, uint32_t layerMask);
 	void clear(const VkClearValue &clearValue, VkImageAspectFlags aspectMask, const VkClearRect &renderArea, uint32_t layerMask);
+	void deferClear(const VkClearValue &clearValue, VkImageAspectFlags aspectMask, const VkRect2D &renderArea, uint32_t layerMask);
 	void resolve(ImageView *resolveAttachment, uint32_t layerMask);
 	void resolveDepthStencil(ImageView *resolveAttachment, VkResolveModeFlagBits depthResolveMode, VkResolveModeFlagBits stencilResolveMode);
 
@@ -126,12 +128,28 @@ public:
 	}
 
 	void *getOffsetPointer(const VkOffset3D &offset, VkImageAspectFlagBits aspect, uint32_t mipLevel, uint32_t layer, Usage usage = RAW) const;
+	bool hasDeferredClears() const { return (subresourceRange.baseMipLevel == 0) && image->hasDeferredClears(); }
+	uint8_t *getDeferredClearTiles(uint32_t layer) const { return image->getDeferredClearTiles(subresourceRange.baseArrayLayer + layer); }
+	uint32_t getDeferredClearTilesPitchBytes() const { return image->getDeferredClearTilesPitchBytes(); }
+	uint32_t getDeferredClearValue(uint32_t layer) const { return image->getDeferredClearValue(subresourceRange.baseArrayLayer + layer); }
+	void flushDeferredClears() { image->flushDeferredClears(); }
+	void discardDeferredClears() { image->discardDeferredClears(subresourceRange); }
+
+	bool hasHiZ() const { return (subresourceRange.baseMipLevel == 0) && (image->getHiZPitchBytes() != 0); }
+	sw::HiZTile *getHiZTiles(uint32_t layer) const;
+	uint32_t getHiZPitchBytes() const { return image->getHiZPitchBytes(); }
+
+	bool hasSampleEquality() const { return (subresourceRange.baseMipLevel == 0) && (image->getSampleEqualityPitchBytes() != 0); }
+	uint32_t *getSampleEqualityTiles(uint32_t layer) const { return image->getSampleEqualityTiles(subresourceRange.baseArrayLayer + layer); }
+	uint32_t getSampleEqualityPitchBytes() const { return image->getSampleEqualityPitchBytes(); }
+
 	bool hasDepthAspect() const { return (subresourceRange.aspectMask & VK_IMAGE_ASPECT_DEPTH_BIT) != 0; }
 	bool hasStencilAspect() const { return (subresourceRange.aspectMask & VK_IMAGE_ASPECT_STENCIL_BIT) != 0; }
 
 	void contentsChanged(Image::ContentsChangedContext context) { image->contentsChanged(subresourceRange, context); }
 
 	void prepareForSampling() { image->prepareForSampling(subresourceRange); }
+	bool requiresPreprocessing() const { return image->requiresPreprocessing(); }
 
 	const VkComponentMapping &getComponentMapping() const { return components; }
 	const VkImageSubresourceRange &getSubresourceRange() const { return subresourceRange; }
@@ -20,10 +20,25 @@
 
 namespace vk {
 
+namespace {
+
+// Allocations at least this large are mapped directly from the operating system. This
+// gives zero-initialized memory without having to touch it, lets pages remain uncommitted
+// until the application uses them, and allows large allocations to use huge pages.
+// Smaller ones come from the heap, to avoid a system call and page rounding each.
+constexpr size_t MIN_PAGE_ALLOCATION_SIZE = 64 * 1024;
+
+}  // anonymous namespace
+
 void *allocateDeviceMemory(size_t bytes, size_t alignment)
 {
 	ASSERT(bytes <= vk::MAX_MEMORY_ALLOCATION_SIZE);
 
+	if(bytes >= MIN_PAGE_ALLOCATION_SIZE)
+	{
+		return sw::allocatePages(bytes, alignment);
+	}
+
 #if defined(SWIFTSHADER_ZERO_INITIALIZE_DEVICE_MEMORY)
 	return sw::allocateZeroOrPoison(bytes, alignment);
 #else
@@ -31,9 +46,16 @@ void *allocateDeviceMemory(size_t bytes, size_t alignment)
 #endif
 }
 
-void freeDeviceMemory(void *ptr)
+void freeDeviceMemory(void *ptr, size_t bytes)
 {
-	sw::freeMemory(ptr);
+	if(bytes >= MIN_PAGE_ALLOCATION_SIZE)
+	{
+		sw::freePages(ptr, bytes);
+	}
+	else
+	{
+		sw::freeMemory(ptr);
+	}
 }
 
 void *allocateHostMemory(size_t bytes, size_t alignment, const VkAllocationCallbacks *pAllocator, VkSystemAllocationScope allocationScope)
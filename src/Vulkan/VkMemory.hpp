@@ -22,7 +22,7 @@ namespace vk {
 // TODO(b/192449828): Pass VkDeviceDeviceMemoryReportCreateInfoEXT into these functions to
 // centralize device memory report callback usage.
 void *allocateDeviceMemory(size_t bytes, size_t alignment);
-void freeDeviceMemory(void *ptr);
+void freeDeviceMemory(void *ptr, size_t bytes);  // 'bytes' must match the allocation size.
 
 // TODO(b/201798871): Fix host allocation callback usage. Uses of this symbolic constant indicate
 // places where we should use an allocator instead of unaccounted memory allocations.
@@ -80,11 +80,19 @@ const VkPhysicalDeviceFeatures &PhysicalDevice::getFeatures() const
 		VK_TRUE,   // shaderCullDistance
 		VK_FALSE,  // shaderFloat64
 		VK_FALSE,  // shaderInt64
-		VK_FALSE,  // shaderInt16
-		VK_FALSE,  // shaderResourceResidency
+		VK_TRUE,   // shaderInt16
+		VK_FALSE,  // shaderResourceResidency (requires sparse residency images)
 		VK_FALSE,  // shaderResourceMinLod
+#if SWIFTSHADER_SPARSE_BINDING
+		VK_TRUE,  // sparseBinding
+		VK_TRUE,  // sparseResidencyBuffer
+#else
 		VK_FALSE,  // sparseBinding
 		VK_FALSE,  // sparseResidencyBuffer
+#endif
+		// Images are stored pitch-linear, so the standard sparse block shapes aren't
+		// contiguous in memory, and can't be bound as a unit. Sparse images are limited
+		// to opaque binding.
 		VK_FALSE,  // sparseResidencyImage2D
 		VK_FALSE,  // sparseResidencyImage3D
 		VK_FALSE,  // sparseResidency2Samples
@@ -108,10 +116,10 @@ static void getPhysicalDeviceSamplerYcbcrConversionFeatures(T *features)
 template<typename T>
 static void getPhysicalDevice16BitStorageFeatures(T *features)
 {
-	features->storageBuffer16BitAccess = VK_FALSE;
-	features->storageInputOutput16 = VK_FALSE;
-	features->storagePushConstant16 = VK_FALSE;
-	features->uniformAndStorageBuffer16BitAccess = VK_FALSE;
+	features->storageBuffer16BitAccess = VK_TRUE;
+	features->storageInputOutput16 = VK_TRUE;
+	features->storagePushConstant16 = VK_TRUE;
+	features->uniformAndStorageBuffer16BitAccess = VK_TRUE;
 }
 
 template<typename T>
@@ -289,7 +297,7 @@ static void getPhysicalDeviceShaderAtomicInt64Features(T *features)
 template<typename T>
 static void getPhysicalDeviceShaderFloat16Int8Features(T *features)
 {
-	features->shaderFloat16 = VK_FALSE;
+	features->shaderFloat16 = VK_TRUE;
 	features->shaderInt8 = VK_FALSE;
 }
 
@@ -729,7 +737,11 @@ const VkPhysicalDeviceLimits &PhysicalDevice::getLimits()
 		4096,                                        // maxMemoryAllocationCount
 		vk::MAX_SAMPLER_ALLOCATION_COUNT,            // maxSamplerAllocationCount
 		4096,                                        // bufferImageGranularity
-		0,                                           // sparseAddressSpaceSize (unsupported)
+#if SWIFTSHADER_SPARSE_BINDING
+		vk::SPARSE_ADDRESS_SPACE_SIZE,  // sparseAddressSpaceSize
+#else
+		0,  // sparseAddressSpaceSize (unsupported)
+#endif
 		MAX_BOUND_DESCRIPTOR_SETS,                   // maxBoundDescriptorSets
 		64,                                          // maxPerStageDescriptorSamplers
 		15,                                          // maxPerStageDescriptorUniformBuffers
@@ -748,7 +760,7 @@ const VkPhysicalDeviceLimits &PhysicalDevice::getLimits()
 		sw::MAX_COLOR_BUFFERS,                       // maxDescriptorSetInputAttachments
 		16,                                          // maxVertexInputAttributes
 		vk::MAX_VERTEX_INPUT_BINDINGS,               // maxVertexInputBindings
-		2047,                                        // maxVertexInputAttributeOffset
+		vk::MAX_VERTEX_INPUT_ATTRIBUTE_OFFSET,       // maxVertexInputAttributeOffset
 		2048,                                        // maxVertexInputBindingStride
 		sw::MAX_INTERFACE_COMPONENTS,                // maxVertexOutputComponents
 		0,                                           // maxTessellationGenerationLevel (unsupported)
@@ -830,6 +842,25 @@ const VkPhysicalDeviceLimits &PhysicalDevice::getLimits()
 	return limits;
 }
 
+VkPhysicalDeviceSparseProperties PhysicalDevice::getSparseProperties()
+{
+	VkPhysicalDeviceSparseProperties properties = {
+		VK_FALSE,  // residencyStandard2DBlockShape
+		VK_FALSE,  // residencyStandard2DMultisampleBlockShape
+		VK_FALSE,  // residencyStandard3DBlockShape
+		VK_FALSE,  // residencyAlignedMipSize
+#if SWIFTSHADER_SPARSE_BINDING
+		// Unbound ranges are backed by anonymous pages which read as zero. Writes to them
+		// are kept until the range is next bound or unbound.
+		VK_TRUE,  // residencyNonResidentStrict
+#else
+		VK_FALSE,  // residencyNonResidentStrict
+#endif
+	};
+
+	return properties;
+}
+
 const VkPhysicalDeviceProperties &PhysicalDevice::getProperties() const
 {
 	auto getProperties = [&]() -> VkPhysicalDeviceProperties {
@@ -842,7 +873,7 @@ const VkPhysicalDeviceProperties &PhysicalDevice::getProperties() const
 			"",                           // deviceName
 			SWIFTSHADER_UUID,             // pipelineCacheUUID
 			getLimits(),                  // limits
-			{}                            // sparseProperties
+			getSparseProperties()         // sparseProperties
 		};
 
 		// Append Reactor JIT backend name and version
@@ -1927,6 +1958,19 @@ bool vk::PhysicalDevice::isFormatSupported(vk::Format format, VkImageType type,
 	VkFormatProperties3 properties = {};
 	vk::PhysicalDevice::GetFormatProperties(format, &properties);
 
+	// Only opaque sparse binding is supported, not sparse residency or aliasing.
+	if(flags & (VK_IMAGE_CREATE_SPARSE_RESIDENCY_BIT | VK_IMAGE_CREATE_SPARSE_ALIASED_BIT))
+	{
+		return false;
+	}
+
+#if !SWIFTSHADER_SPARSE_BINDING
+	if(flags & VK_IMAGE_CREATE_SPARSE_BINDING_BIT)
+	{
+		return false;
+	}
+#endif
+
 	if(flags & VK_IMAGE_CREATE_EXTENDED_USAGE_BIT)
 	{
 		for(vk::Format f : format.getCompatibleFormats())
@@ -2591,6 +2635,9 @@ VkQueueFamilyProperties PhysicalDevice::getQueueFamilyProperties() const
 	properties.minImageTransferGranularity.depth = 1;
 	properties.queueCount = 1;
 	properties.queueFlags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT;
+#if SWIFTSHADER_SPARSE_BINDING
+	properties.queueFlags |= VK_QUEUE_SPARSE_BINDING_BIT;
+#endif
 	properties.timestampValidBits = 64;
 
 	return properties;
@@ -2655,7 +2702,11 @@ void PhysicalDevice::getQueueFamilyProperties(uint32_t pQueueFamilyPropertyCount
 const VkPhysicalDeviceMemoryProperties &PhysicalDevice::GetMemoryProperties()
 {
 	static const VkPhysicalDeviceMemoryProperties properties{
+#if SWIFTSHADER_SPARSE_BINDING
+		2,  // memoryTypeCount
+#else
 		1,  // memoryTypeCount
+#endif
 		{
 		    // vk::MEMORY_TYPE_GENERIC_BIT
 		    {
@@ -2665,6 +2716,14 @@ const VkPhysicalDeviceMemoryProperties &PhysicalDevice::GetMemoryProperties()
 		         VK_MEMORY_PROPERTY_HOST_CACHED_BIT),  // propertyFlags
 		        0                                      // heapIndex
 		    },
+		    // vk::MEMORY_TYPE_SPARSE_BIT
+		    {
+		        (VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+		         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+		         VK_MEMORY_PROPERTY_HOST_COHERENT_BIT |
+		         VK_MEMORY_PROPERTY_HOST_CACHED_BIT),  // propertyFlags
+		        0                                      // heapIndex
+		    },
 		},
 		1,  // memoryHeapCount
 		{
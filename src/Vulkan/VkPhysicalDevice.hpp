@@ -130,6 +130,7 @@ public:
 
 private:
 	static VkSampleCountFlags getSampleCounts();
+	static VkPhysicalDeviceSparseProperties getSparseProperties();
 	VkQueueFamilyProperties getQueueFamilyProperties() const;
 
 	template<typename T>
@@ -23,6 +23,7 @@
 #include "VkStringify.hpp"
 #include "Pipeline/ComputeProgram.hpp"
 #include "Pipeline/SpirvShader.hpp"
+#include "System/RoutineTelemetry.hpp"
 
 #include "marl/trace.h"
 
@@ -115,8 +116,9 @@ sw::SpirvBinary optimizeSpirv(const vk::PipelineCache::SpirvBinaryKey &key)
 std::shared_ptr<sw::ComputeProgram> createProgram(vk::Device *device, std::shared_ptr<sw::SpirvShader> shader, const vk::PipelineLayout *layout)
 {
 	MARL_SCOPED_EVENT("createProgram");
+	sw::RoutineTelemetry::ScopedCompile compile(sw::RoutineKind::Compute);
 
-	vk::DescriptorSet::Bindings descriptorSets;  // TODO(b/129523279): Delay code generation until dispatch time.
+	vk::DescriptorSet::Bindings descriptorSets = {};  // TODO(b/129523279): Delay code generation until dispatch time.
 	// TODO(b/119409619): use allocator.
 	auto program = std::make_shared<sw::ComputeProgram>(device, shader, layout, descriptorSets);
 	program->generate();
@@ -305,6 +307,53 @@ bool getPipelineStageRobustBufferAccess(const void *pNext, vk::Device *device, b
 	return getRobustBufferAccess(overrideRobustness, deviceRobustBufferAccess, pipelineRobustBufferAccess);
 }
 
+// Records the sampling routines the shader obtains for each image descriptor binding, so that
+// they can be compiled as soon as such descriptors are written.
+void registerSamplingRoutineUses(vk::Device *device, const vk::PipelineLayout *layout, const sw::SpirvShader &shader)
+{
+	auto *precompiler = device->getSamplingRoutinePrecompiler();
+	if(!precompiler || !layout)
+	{
+		return;
+	}
+
+	auto isValidBinding = [layout](int32_t set, int32_t binding) {
+		return (set >= 0) && (static_cast<uint32_t>(set) < layout->getDescriptorSetCount()) &&
+		       (binding >= 0) && (static_cast<uint32_t>(binding) < layout->getBindingCount(set));
+	};
+
+	for(const auto &use : sw::SpirvEmitter::GetSamplingRoutineUses(shader))
+	{
+		if(!isValidBinding(use.imageSet, use.imageBinding))
+		{
+			continue;
+		}
+
+		vk::Device::SamplingRoutinePrecompiler::Use routineUse = { use.signature, 0, false };
+
+		if((use.samplerSet == use.imageSet) && (use.samplerBinding == use.imageBinding))
+		{
+			routineUse.samplerFromDescriptor = true;  // Combined image sampler
+		}
+		else if(use.samplerSet >= 0)
+		{
+			// Separate samplers can only be anticipated when they're immutable.
+			if(!isValidBinding(use.samplerSet, use.samplerBinding))
+			{
+				continue;
+			}
+
+			routineUse.samplerId = layout->getImmutableSamplerId(use.samplerSet, use.samplerBinding);
+			if(routineUse.samplerId == 0)
+			{
+				continue;
+			}
+		}
+
+		precompiler->add(use.imageSet, use.imageBinding, layout->getDescriptorType(use.imageSet, use.imageBinding), routineUse);
+	}
+}
+
 }  // anonymous namespace
 
 namespace vk {
@@ -591,7 +640,13 @@ VkResult GraphicsPipeline::compileShaders(const VkAllocationCallbacks *pAllocato
 		auto shader = std::make_shared<sw::SpirvShader>(stageInfo.stage, stageInfo.pName, spirv,
 		                                                vk::Cast(pCreateInfo->renderPass), pCreateInfo->subpass, inputAttachmentMapping, stageRobustBufferAccess);
 
+		if(sw::SpirvProfiler *profiler = device->getSpirvProfiler())
+		{
+			shader->enableProfiling(*profiler);
+		}
+
 		setShader(stageInfo.stage, shader);
+		registerSamplingRoutineUses(device, layout, *shader);
 
 		pipelineCreationFeedback.stageCreationEnds(stageIndex);
 
@@ -686,6 +741,13 @@ VkResult ComputePipeline::compileShaders(const VkAllocationCallbacks *pAllocator
 	shader = std::make_shared<sw::SpirvShader>(stage.stage, stage.pName, spirv,
 	                                           nullptr, 0, nullptr, stageRobustBufferAccess);
 
+	if(sw::SpirvProfiler *profiler = device->getSpirvProfiler())
+	{
+		shader->enableProfiling(*profiler);
+	}
+
+	registerSamplingRoutineUses(device, layout, *shader);
+
 	const PipelineCache::ComputeProgramKey programKey(shader->getIdentifier(), layout->identifier);
 
 	if(pPipelineCache)
@@ -18,6 +18,7 @@
 #include "VkObject.hpp"
 #include "VkSpecializationInfo.hpp"
 #include "Pipeline/SpirvBinary.hpp"
+#include "System/RoutineTelemetry.hpp"
 
 #include "marl/mutex.h"
 #include "marl/tsa.h"
@@ -137,6 +138,7 @@ std::shared_ptr<sw::ComputeProgram> PipelineCache::getOrCreateComputeProgram(con
 	marl::lock lock(computeProgramsMutex);
 
 	auto it = computePrograms.find(key);
+	sw::RoutineTelemetry::recordCacheLookup(sw::RoutineKind::Compute, it != computePrograms.end());
 	if(it != computePrograms.end())
 	{
 		return it->second;
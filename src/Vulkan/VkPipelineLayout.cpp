@@ -27,6 +27,7 @@ PipelineLayout::PipelineLayout(const VkPipelineLayoutCreateInfo *pCreateInfo, vo
     , pushConstantRangeCount(pCreateInfo->pushConstantRangeCount)
 {
 	Binding *bindingStorage = reinterpret_cast<Binding *>(mem);
+	SamplerState *samplerStateStorage = reinterpret_cast<SamplerState *>(bindingStorage + GetBindingsCount(pCreateInfo));
 	uint32_t dynamicOffsetIndex = 0;
 
 	descriptorSets[0].bindings = bindingStorage;  // Used in destroy() for deallocation.
@@ -49,6 +50,14 @@ PipelineLayout::PipelineLayout(const VkPipelineLayoutCreateInfo *pCreateInfo, vo
 			descriptorSets[i].bindings[j].offset = setLayout->getBindingOffset(j);
 			descriptorSets[i].bindings[j].dynamicOffsetIndex = dynamicOffsetIndex;
 			descriptorSets[i].bindings[j].descriptorCount = setLayout->getDescriptorCount(j);
+			descriptorSets[i].bindings[j].immutableSamplerId = setLayout->getImmutableSamplerId(j);
+			descriptorSets[i].bindings[j].immutableSamplerState = nullptr;
+
+			if(const Sampler *sampler = setLayout->getImmutableSampler(j))
+			{
+				descriptorSets[i].bindings[j].immutableSamplerState = new(samplerStateStorage) SamplerState(*sampler);
+				samplerStateStorage++;
+			}
 
 			if(DescriptorSetLayout::IsDescriptorDynamic(descriptorSets[i].bindings[j].descriptorType))
 			{
@@ -57,7 +66,7 @@ PipelineLayout::PipelineLayout(const VkPipelineLayoutCreateInfo *pCreateInfo, vo
 		}
 	}
 
-	pushConstantRanges = reinterpret_cast<VkPushConstantRange *>(bindingStorage);
+	pushConstantRanges = reinterpret_cast<VkPushConstantRange *>(samplerStateStorage);
 	std::copy(pCreateInfo->pPushConstantRanges, pCreateInfo->pPushConstantRanges + pCreateInfo->pushConstantRangeCount, pushConstantRanges);
 
 	incRefCount();
@@ -65,20 +74,20 @@ PipelineLayout::PipelineLayout(const VkPipelineLayoutCreateInfo *pCreateInfo, vo
 
 void PipelineLayout::destroy(const VkAllocationCallbacks *pAllocator)
 {
-	vk::freeHostMemory(descriptorSets[0].bindings, pAllocator);  // pushConstantRanges are in the same allocation
+	vk::freeHostMemory(descriptorSets[0].bindings, pAllocator);  // Sampler states and pushConstantRanges are in the same allocation
 }
 
 bool PipelineLayout::release(const VkAllocationCallbacks *pAllocator)
 {
 	if(decRefCount() == 0)
 	{
-		vk::freeHostMemory(descriptorSets[0].bindings, pAllocator);  // pushConstantRanges are in the same allocation
+		vk::freeHostMemory(descriptorSets[0].bindings, pAllocator);  // Sampler states and pushConstantRanges are in the same allocation
 		return true;
 	}
 	return false;
 }
 
-size_t PipelineLayout::ComputeRequiredAllocationSize(const VkPipelineLayoutCreateInfo *pCreateInfo)
+uint32_t PipelineLayout::GetBindingsCount(const VkPipelineLayoutCreateInfo *pCreateInfo)
 {
 	uint32_t bindingsCount = 0;
 	for(uint32_t i = 0; i < pCreateInfo->setLayoutCount; i++)
@@ -90,7 +99,30 @@ size_t PipelineLayout::ComputeRequiredAllocationSize(const VkPipelineLayoutCreat
 		bindingsCount += vk::Cast(pCreateInfo->pSetLayouts[i])->getBindingsArraySize();
 	}
 
-	return bindingsCount * sizeof(Binding) +                                   // descriptorSets[]
+	return bindingsCount;
+}
+
+size_t PipelineLayout::ComputeRequiredAllocationSize(const VkPipelineLayoutCreateInfo *pCreateInfo)
+{
+	uint32_t samplerStateCount = 0;
+	for(uint32_t i = 0; i < pCreateInfo->setLayoutCount; i++)
+	{
+		if(pCreateInfo->pSetLayouts[i] == VK_NULL_HANDLE)
+		{
+			continue;
+		}
+		const vk::DescriptorSetLayout *setLayout = vk::Cast(pCreateInfo->pSetLayouts[i]);
+		for(uint32_t j = 0; j < setLayout->getBindingsArraySize(); j++)
+		{
+			if(setLayout->getImmutableSampler(j))
+			{
+				samplerStateCount++;
+			}
+		}
+	}
+
+	return GetBindingsCount(pCreateInfo) * sizeof(Binding) +                   // descriptorSets[]
+	       samplerStateCount * sizeof(SamplerState) +                          // Immutable sampler states
 	       pCreateInfo->pushConstantRangeCount * sizeof(VkPushConstantRange);  // pushConstantRanges[]
 }
 
@@ -138,6 +170,18 @@ bool PipelineLayout::isDescriptorDynamic(uint32_t setNumber, uint32_t bindingNum
 	return DescriptorSetLayout::IsDescriptorDynamic(getDescriptorType(setNumber, bindingNumber));
 }
 
+uint32_t PipelineLayout::getImmutableSamplerId(uint32_t setNumber, uint32_t bindingNumber) const
+{
+	ASSERT(setNumber < descriptorSetCount && bindingNumber < descriptorSets[setNumber].bindingCount);
+	return descriptorSets[setNumber].bindings[bindingNumber].immutableSamplerId;
+}
+
+const SamplerState *PipelineLayout::getImmutableSamplerState(uint32_t setNumber, uint32_t bindingNumber) const
+{
+	ASSERT(setNumber < descriptorSetCount && bindingNumber < descriptorSets[setNumber].bindingCount);
+	return descriptorSets[setNumber].bindings[bindingNumber].immutableSamplerState;
+}
+
 uint32_t PipelineLayout::incRefCount()
 {
 	return ++refCount;
@@ -41,18 +41,30 @@ public:
 	uint32_t getDescriptorSize(uint32_t setNumber, uint32_t bindingNumber) const;
 	bool isDescriptorDynamic(uint32_t setNumber, uint32_t bindingNumber) const;
 
+	// Returns the ID of the immutable sampler shared by all descriptors of the
+	// binding, or 0 if the sampler is only known once the descriptor is written.
+	uint32_t getImmutableSamplerId(uint32_t setNumber, uint32_t bindingNumber) const;
+
+	// Returns the state of the immutable sampler identified by getImmutableSamplerId(),
+	// or null. The layout holds a copy, since the sampler object may be destroyed first.
+	const SamplerState *getImmutableSamplerState(uint32_t setNumber, uint32_t bindingNumber) const;
+
 	const uint32_t identifier;
 
 	uint32_t incRefCount();
 	uint32_t decRefCount();
 
 private:
+	static uint32_t GetBindingsCount(const VkPipelineLayoutCreateInfo *pCreateInfo);
+
 	struct Binding
 	{
 		VkDescriptorType descriptorType;
 		uint32_t offset;  // Offset in bytes in the descriptor set data.
 		uint32_t dynamicOffsetIndex;
 		uint32_t descriptorCount;
+		uint32_t immutableSamplerId;
+		const SamplerState *immutableSamplerState;
 	};
 
 	struct DescriptorSet
@@ -14,13 +14,16 @@
 
 #include "VkQueue.hpp"
 
+#include "VkBuffer.hpp"
 #include "VkCommandBuffer.hpp"
 #include "VkFence.hpp"
+#include "VkImage.hpp"
 #include "VkSemaphore.hpp"
 #include "VkStringify.hpp"
 #include "VkStructConversion.hpp"
 #include "VkTimelineSemaphore.hpp"
 #include "Device/Renderer.hpp"
+#include "System/Timeline.hpp"
 #include "WSI/VkSwapchainKHR.hpp"
 
 #include "marl/defer.h"
@@ -68,6 +71,73 @@ VkResult Queue::submit(uint32_t submitCount, SubmitInfo *pSubmits, Fence *fence)
 	return VK_SUCCESS;
 }
 
+VkResult Queue::bindSparse(uint32_t bindInfoCount, const VkBindSparseInfo *pBindInfo, Fence *fence)
+{
+	auto sparseBinds = std::make_shared<std::vector<SparseBindInfo>>(bindInfoCount);
+
+	for(uint32_t i = 0; i < bindInfoCount; i++)
+	{
+		const VkBindSparseInfo &bindInfo = pBindInfo[i];
+		const auto *timelineInfo = GetExtendedStruct<VkTimelineSemaphoreSubmitInfo>(bindInfo.pNext, VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO);
+		SparseBindInfo &sparseBind = (*sparseBinds)[i];
+
+		for(uint32_t j = 0; j < bindInfo.waitSemaphoreCount; j++)
+		{
+			bool hasValue = timelineInfo && (j < timelineInfo->waitSemaphoreValueCount);
+			sparseBind.waitSemaphores.push_back({ bindInfo.pWaitSemaphores[j], hasValue ? timelineInfo->pWaitSemaphoreValues[j] : 0 });
+		}
+
+		for(uint32_t j = 0; j < bindInfo.bufferBindCount; j++)
+		{
+			const VkSparseBufferMemoryBindInfo &bufferBind = bindInfo.pBufferBinds[j];
+			for(uint32_t k = 0; k < bufferBind.bindCount; k++)
+			{
+				SparseBindInfo::MemoryBind memoryBind;
+				memoryBind.buffer = Cast(bufferBind.buffer);
+				memoryBind.bind = bufferBind.pBinds[k];
+				sparseBind.binds.push_back(memoryBind);
+			}
+		}
+
+		for(uint32_t j = 0; j < bindInfo.imageOpaqueBindCount; j++)
+		{
+			const VkSparseImageOpaqueMemoryBindInfo &imageBind = bindInfo.pImageOpaqueBinds[j];
+			for(uint32_t k = 0; k < imageBind.bindCount; k++)
+			{
+				SparseBindInfo::MemoryBind memoryBind;
+				memoryBind.image = Cast(imageBind.image);
+				memoryBind.bind = imageBind.pBinds[k];
+				sparseBind.binds.push_back(memoryBind);
+			}
+		}
+
+		if(bindInfo.imageBindCount > 0)
+		{
+			// Requires one of the sparseResidencyImage* features.
+			UNSUPPORTED("VkBindSparseInfo::imageBindCount %d", int(bindInfo.imageBindCount));
+		}
+
+		for(uint32_t j = 0; j < bindInfo.signalSemaphoreCount; j++)
+		{
+			bool hasValue = timelineInfo && (j < timelineInfo->signalSemaphoreValueCount);
+			sparseBind.signalSemaphores.push_back({ bindInfo.pSignalSemaphores[j], hasValue ? timelineInfo->pSignalSemaphoreValues[j] : 0 });
+		}
+	}
+
+	Task task;
+	task.type = Task::BIND_SPARSE;
+	task.sparseBinds = sparseBinds;
+	if(fence)
+	{
+		task.events = fence->getCountedEvent();
+		task.events->add();
+	}
+
+	pending.put(task);
+
+	return VK_SUCCESS;
+}
+
 void Queue::submitQueue(const Task &task)
 {
 	if(renderer == nullptr)
@@ -137,6 +207,68 @@ void Queue::submitQueue(const Task &task)
 	}
 }
 
+void Queue::bindSparseQueue(const Task &task)
+{
+	// Remapping pages under previously submitted work would affect its results, so
+	// the binding operations wait for the renderer to complete it.
+	if(renderer)
+	{
+		renderer->synchronize();
+	}
+
+	for(const SparseBindInfo &bindInfo : *task.sparseBinds)
+	{
+		for(const auto &wait : bindInfo.waitSemaphores)
+		{
+			if(auto *sem = DynamicCast<TimelineSemaphore>(wait.semaphore))
+			{
+				sem->wait(wait.value);
+			}
+			else if(auto *sem = DynamicCast<BinarySemaphore>(wait.semaphore))
+			{
+				sem->wait();
+			}
+			else
+			{
+				UNSUPPORTED("Unknown semaphore type");
+			}
+		}
+
+		for(const auto &memoryBind : bindInfo.binds)
+		{
+			// Failures can no longer be returned from vkQueueBindSparse(). The
+			// range is left unbound, which reads as zero.
+			VkResult result = memoryBind.buffer ? memoryBind.buffer->bindSparse(memoryBind.bind)
+			                                    : memoryBind.image->bindSparse(memoryBind.bind);
+			if(result != VK_SUCCESS)
+			{
+				WARN("Sparse binding failed: %d", int(result));
+			}
+		}
+
+		for(const auto &signal : bindInfo.signalSemaphores)
+		{
+			if(auto *sem = DynamicCast<TimelineSemaphore>(signal.semaphore))
+			{
+				sem->signal(signal.value);
+			}
+			else if(auto *sem = DynamicCast<BinarySemaphore>(signal.semaphore))
+			{
+				sem->signal();
+			}
+			else
+			{
+				UNSUPPORTED("Unknown semaphore type");
+			}
+		}
+	}
+
+	if(task.events)
+	{
+		task.events->done();
+	}
+}
+
 void Queue::taskLoop(marl::Scheduler *scheduler)
 {
 	marl::Thread::setName("Queue<%p>", this);
@@ -155,6 +287,18 @@ void Queue::taskLoop(marl::Scheduler *scheduler)
 		case Task::SUBMIT_QUEUE:
 			submitQueue(task);
 			break;
+		case Task::BIND_SPARSE:
+			bindSparseQueue(task);
+			break;
+		case Task::BEGIN_LABEL:
+			sw::Timeline::beginLabel(task.labelName.c_str());
+			break;
+		case Task::END_LABEL:
+			sw::Timeline::endLabel();
+			break;
+		case Task::INSERT_LABEL:
+			sw::Timeline::insertLabel(task.labelName.c_str());
+			break;
 		default:
 			UNREACHABLE("task.type %d", static_cast<int>(task.type));
 			break;
@@ -241,19 +385,44 @@ VkResult Queue::present(const VkPresentInfoKHR *presentInfo)
 }
 #endif
 
+// Debug labels only annotate the timeline. They're recorded by the queue thread, so that
+// they appear in the same order as the work submitted around them gets executed.
 void Queue::beginDebugUtilsLabel(const VkDebugUtilsLabelEXT *pLabelInfo)
 {
-	// Optional debug label region
+	if(!sw::Timeline::isEnabled())
+	{
+		return;
+	}
+
+	Task task;
+	task.type = Task::BEGIN_LABEL;
+	task.labelName = pLabelInfo->pLabelName;
+	pending.put(task);
 }
 
 void Queue::endDebugUtilsLabel()
 {
-	// Close debug label region opened with beginDebugUtilsLabel()
+	if(!sw::Timeline::isEnabled())
+	{
+		return;
+	}
+
+	Task task;
+	task.type = Task::END_LABEL;
+	pending.put(task);
 }
 
 void Queue::insertDebugUtilsLabel(const VkDebugUtilsLabelEXT *pLabelInfo)
 {
-	// Optional single debug label
+	if(!sw::Timeline::isEnabled())
+	{
+		return;
+	}
+
+	Task task;
+	task.type = Task::INSERT_LABEL;
+	task.labelName = pLabelInfo->pLabelName;
+	pending.put(task);
 }
 
 }  // namespace vk
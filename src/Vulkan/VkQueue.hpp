@@ -19,7 +19,9 @@
 #include "Device/Renderer.hpp"
 #include "System/Synchronization.hpp"
 
+#include <string>
 #include <thread>
+#include <vector>
 
 namespace marl {
 class Scheduler;
@@ -34,8 +36,10 @@ class Renderer;
 
 namespace vk {
 
+class Buffer;
 class Device;
 class Fence;
+class Image;
 struct SubmitInfo;
 
 class Queue
@@ -52,6 +56,7 @@ public:
 	}
 
 	VkResult submit(uint32_t submitCount, SubmitInfo *pSubmits, Fence *fence);
+	VkResult bindSparse(uint32_t bindInfoCount, const VkBindSparseInfo *pBindInfo, Fence *fence);
 	VkResult waitIdle();
 #ifndef __ANDROID__
 	VkResult present(const VkPresentInfoKHR *presentInfo);
@@ -62,16 +67,43 @@ public:
 	void insertDebugUtilsLabel(const VkDebugUtilsLabelEXT *pLabelInfo);
 
 private:
+	// Copy of a VkBindSparseInfo, whose arrays are only valid during vkQueueBindSparse()
+	struct SparseBindInfo
+	{
+		struct SemaphoreValue
+		{
+			VkSemaphore semaphore;
+			uint64_t value;
+		};
+
+		struct MemoryBind
+		{
+			Buffer *buffer = nullptr;  // Either the buffer or the image is set
+			Image *image = nullptr;
+			VkSparseMemoryBind bind;
+		};
+
+		std::vector<SemaphoreValue> waitSemaphores;
+		std::vector<MemoryBind> binds;
+		std::vector<SemaphoreValue> signalSemaphores;
+	};
+
 	struct Task
 	{
 		uint32_t submitCount = 0;
 		SubmitInfo *pSubmits = nullptr;
+		std::shared_ptr<std::vector<SparseBindInfo>> sparseBinds;
+		std::string labelName;
 		std::shared_ptr<sw::CountedEvent> events;
 
 		enum Type
 		{
 			KILL_THREAD,
-			SUBMIT_QUEUE
+			SUBMIT_QUEUE,
+			BIND_SPARSE,
+			BEGIN_LABEL,
+			END_LABEL,
+			INSERT_LABEL
 		};
 		Type type = SUBMIT_QUEUE;
 	};
@@ -79,6 +111,7 @@ private:
 	void taskLoop(marl::Scheduler *scheduler);
 	void garbageCollect();
 	void submitQueue(const Task &task);
+	void bindSparseQueue(const Task &task);
 
 	Device *device;
 	std::unique_ptr<sw::Renderer> renderer;
@@ -0,0 +1,120 @@
+// Copyright 2026 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "VkSparseAddressSpace.hpp"
+
+#include "VkDeviceMemory.hpp"
+#include "System/Debug.hpp"
+#include "System/Math.hpp"
+
+#if SWIFTSHADER_SPARSE_BINDING
+#	include <errno.h>
+#	include <string.h>
+#	include <sys/mman.h>
+#endif
+
+namespace vk {
+
+SparseAddressSpace::SparseAddressSpace(VkDeviceSize size)
+{
+#if SWIFTSHADER_SPARSE_BINDING
+	// MAP_NORESERVE avoids charging the whole range against the commit limit, since
+	// typically only a fraction of it gets bound, and the bound pages are accounted
+	// for by the DeviceMemory.
+	size_t length = static_cast<size_t>(sw::align<SPARSE_BLOCK_SIZE>(size));
+	void *mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if(mapping != MAP_FAILED)
+	{
+		base = mapping;
+		reservedSize = length;
+	}
+	else
+	{
+		TRACE("mmap() of %zu bytes failed: %s", length, strerror(errno));
+	}
+#else
+	UNSUPPORTED("Sparse binding");
+#endif
+}
+
+SparseAddressSpace::~SparseAddressSpace()
+{
+#if SWIFTSHADER_SPARSE_BINDING
+	if(base)
+	{
+		munmap(base, static_cast<size_t>(reservedSize));
+	}
+#endif
+}
+
+void SparseAddressSpace::unbind(void *address, size_t length)
+{
+#if SWIFTSHADER_SPARSE_BINDING
+	void *mapping = mmap(address, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+	if(mapping == MAP_FAILED)
+	{
+		// The range may now be inaccessible, which resource accesses can't recover from.
+		DABORT("mmap() of %zu bytes failed: %s", length, strerror(errno));
+	}
+#else
+	UNSUPPORTED("Sparse binding");
+#endif
+}
+
+VkResult SparseAddressSpace::bind(const VkSparseMemoryBind &bind)
+{
+#if SWIFTSHADER_SPARSE_BINDING
+	ASSERT(base);
+	ASSERT((bind.resourceOffset % SPARSE_BLOCK_SIZE) == 0);
+	ASSERT((bind.memoryOffset % SPARSE_BLOCK_SIZE) == 0);
+
+	// The size must be a multiple of the block size, except for the tail of the resource.
+	size_t length = static_cast<size_t>(sw::align<SPARSE_BLOCK_SIZE>(bind.size));
+	ASSERT(bind.resourceOffset + length <= reservedSize);
+
+	void *address = static_cast<uint8_t *>(base) + bind.resourceOffset;
+
+	if(bind.memory != VK_NULL_HANDLE)
+	{
+		int fd = Cast(bind.memory)->getSparseBindingFd();
+		if(fd < 0)
+		{
+			// The memory requirements of sparse resources only allow MEMORY_TYPE_SPARSE_BIT.
+			UNSUPPORTED("Sparse binding of memory without a shared memory object");
+			return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+		}
+
+		void *mapping = mmap(address, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, static_cast<off_t>(bind.memoryOffset));
+		if(mapping != MAP_FAILED)
+		{
+			return VK_SUCCESS;
+		}
+
+		TRACE("mmap() of %zu bytes failed: %s", length, strerror(errno));
+
+		// A failed MAP_FIXED mmap() may have removed the previous mapping, so the range
+		// gets unbound instead, to keep it accessible.
+		unbind(address, length);
+		return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+	}
+
+	unbind(address, length);
+	return VK_SUCCESS;
+#else
+	UNSUPPORTED("Sparse binding");
+	return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+#endif
+}
+
+}  // namespace vk
@@ -0,0 +1,57 @@
+// Copyright 2026 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VK_SPARSE_ADDRESS_SPACE_HPP_
+#define VK_SPARSE_ADDRESS_SPACE_HPP_
+
+#include "VkConfig.hpp"
+
+namespace vk {
+
+class DeviceMemory;
+
+// The virtual address range of a buffer or image created with sparse binding flags.
+// Binding memory to a part of it maps the corresponding pages of the DeviceMemory's
+// shared memory object at that location, so that accesses through the resource and
+// through the memory (or other resources it's bound to) observe the same data.
+// Unbound ranges are backed by anonymous pages which read as zero, and only consume
+// physical memory if they get written to.
+class SparseAddressSpace
+{
+public:
+	explicit SparseAddressSpace(VkDeviceSize size);
+	~SparseAddressSpace();
+
+	SparseAddressSpace(const SparseAddressSpace &) = delete;
+	SparseAddressSpace &operator=(const SparseAddressSpace &) = delete;
+
+	// Returns null if the address range could not be reserved.
+	void *data() const { return base; }
+	VkDeviceSize size() const { return reservedSize; }
+
+	// Binds 'bind.size' bytes of 'bind.memory' starting at 'bind.memoryOffset' to this
+	// address range at 'bind.resourceOffset', or unbinds the range if the memory is null.
+	// If the memory can't be mapped, the range is left unbound.
+	VkResult bind(const VkSparseMemoryBind &bind);
+
+private:
+	void unbind(void *address, size_t length);
+
+	void *base = nullptr;
+	VkDeviceSize reservedSize = 0;
+};
+
+}  // namespace vk
+
+#endif  // VK_SPARSE_ADDRESS_SPACE_HPP_
@@ -48,6 +48,7 @@
 #include "Reactor/Nucleus.hpp"
 #include "System/CPUID.hpp"
 #include "System/Debug.hpp"
+#include "System/RoutineTelemetry.hpp"
 #include "System/SwiftConfig.hpp"
 #include "WSI/HeadlessSurfaceKHR.hpp"
 #include "WSI/VkSwapchainKHR.hpp"
@@ -127,7 +128,9 @@ std::shared_ptr<marl::Scheduler> getOrCreateScheduler()
 	auto sptr = scheduler.weakptr.lock();
 	if(!sptr)
 	{
-		const sw::Configuration &config = sw::getConfiguration();
+		// Re-read the configuration, so that a scheduler created after all previous
+		// instances were destroyed picks up changes to the thread settings.
+		const sw::Configuration config = sw::readConfigurationFromFile();
 		marl::Scheduler::Config cfg = sw::getSchedulerConfiguration(config);
 		sptr = std::make_shared<marl::Scheduler>(cfg);
 		scheduler.weakptr = sptr;
@@ -272,6 +275,27 @@ VK_EXPORT VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vk_icdGetPhysicalDeviceProcAd
 	return vk::GetPhysicalDeviceProcAddr(vk::Cast(instance), pName);
 }
 
+// SwiftShader-specific entry point, which lets tests and benchmarks read the process-wide
+// sw::RoutineTelemetry counters. pStats receives the compile count, the total and 99th
+// percentile compile time in nanoseconds, and the cache hit and miss counts of the given
+// kind of routines. Returns the name of the kind, or null if there's no such kind.
+VK_EXPORT VKAPI_ATTR const char *VKAPI_CALL vk_swiftshaderGetRoutineStats(uint32_t kind, uint64_t pStats[5])
+{
+	if(kind >= static_cast<uint32_t>(sw::RoutineKind::Count))
+	{
+		return nullptr;
+	}
+
+	sw::RoutineStats stats = sw::RoutineTelemetry::query(static_cast<sw::RoutineKind>(kind));
+	pStats[0] = stats.compileCount;
+	pStats[1] = static_cast<uint64_t>(stats.totalCompileSeconds * 1.0e9);
+	pStats[2] = static_cast<uint64_t>(stats.p99CompileSeconds * 1.0e9);
+	pStats[3] = stats.cacheHits;
+	pStats[4] = stats.cacheMisses;
+
+	return sw::RoutineKindName(static_cast<sw::RoutineKind>(kind));
+}
+
 #if VK_USE_PLATFORM_WIN32_KHR
 
 VKAPI_ATTR VkResult VKAPI_CALL vk_icdEnumerateAdapterPhysicalDevices(VkInstance instance, LUID adapterLUID, uint32_t *pPhysicalDeviceCount, VkPhysicalDevice *pPhysicalDevices)
@@ -830,19 +854,6 @@ VKAPI_ATTR VkResult VKAPI_CALL vkCreateDevice(VkPhysicalDevice physicalDevice, c
 				(void)samplerYcbcrConversionFeatures->samplerYcbcrConversion;
 			}
 			break;
-		case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_16BIT_STORAGE_FEATURES:
-			{
-				const VkPhysicalDevice16BitStorageFeatures *storage16BitFeatures = reinterpret_cast<const VkPhysicalDevice16BitStorageFeatures *>(extensionCreateInfo);
-
-				if(storage16BitFeatures->storageBuffer16BitAccess != VK_FALSE ||
-				   storage16BitFeatures->uniformAndStorageBuffer16BitAccess != VK_FALSE ||
-				   storage16BitFeatures->storagePushConstant16 != VK_FALSE ||
-				   storage16BitFeatures->storageInputOutput16 != VK_FALSE)
-				{
-					return VK_ERROR_FEATURE_NOT_PRESENT;
-				}
-			}
-			break;
 		case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VARIABLE_POINTER_FEATURES:
 			{
 				const VkPhysicalDeviceVariablePointerFeatures *variablePointerFeatures = reinterpret_cast<const VkPhysicalDeviceVariablePointerFeatures *>(extensionCreateInfo);
@@ -1227,6 +1238,7 @@ VKAPI_ATTR VkResult VKAPI_CALL vkCreateDevice(VkPhysicalDevice physicalDevice, c
 			}
 			break;
 		// These structs are supported, but no behavior changes based on their feature flags
+		case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_16BIT_STORAGE_FEATURES:
 		case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_8BIT_STORAGE_FEATURES:
 		case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_FLOAT16_INT8_FEATURES:
 		case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_ATOMIC_INT64_FEATURES:
@@ -1527,11 +1539,8 @@ VKAPI_ATTR VkResult VKAPI_CALL vkGetMemoryHostPointerPropertiesEXT(VkDevice devi
 		return VK_ERROR_INVALID_EXTERNAL_HANDLE;
 	}
 
-	const VkPhysicalDeviceMemoryProperties &memoryProperties =
-	    vk::PhysicalDevice::GetMemoryProperties();
-
-	// All SwiftShader memory types support this!
-	pMemoryHostPointerProperties->memoryTypeBits = (1U << memoryProperties.memoryTypeCount) - 1U;
+	// Host allocations can't be mapped by sparse resources, so only the generic memory type supports this.
+	pMemoryHostPointerProperties->memoryTypeBits = vk::MEMORY_TYPE_GENERIC_BIT;
 
 	return VK_SUCCESS;
 }
@@ -1661,7 +1670,7 @@ VKAPI_ATTR void VKAPI_CALL vkGetImageSparseMemoryRequirements(VkDevice device, V
 	TRACE("(VkDevice device = %p, VkImage image = %p, uint32_t* pSparseMemoryRequirementCount = %p, VkSparseImageMemoryRequirements* pSparseMemoryRequirements = %p)",
 	      device, static_cast<void *>(image), pSparseMemoryRequirementCount, pSparseMemoryRequirements);
 
-	// The 'sparseBinding' feature is not supported, so images can not be created with the VK_IMAGE_CREATE_SPARSE_RESIDENCY_BIT flag.
+	// The 'sparseResidencyImage*' features are not supported, so images can not be created with the VK_IMAGE_CREATE_SPARSE_RESIDENCY_BIT flag.
 	// "If the image was not created with VK_IMAGE_CREATE_SPARSE_RESIDENCY_BIT then pSparseMemoryRequirementCount will be set to zero and pSparseMemoryRequirements will not be written to."
 	*pSparseMemoryRequirementCount = 0;
 }
@@ -1677,9 +1686,10 @@ VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceSparseImageFormatProperties(VkPhys
 
 VKAPI_ATTR VkResult VKAPI_CALL vkQueueBindSparse(VkQueue queue, uint32_t bindInfoCount, const VkBindSparseInfo *pBindInfo, VkFence fence)
 {
-	TRACE("()");
-	UNSUPPORTED("vkQueueBindSparse");
-	return VK_SUCCESS;
+	TRACE("(VkQueue queue = %p, uint32_t bindInfoCount = %d, const VkBindSparseInfo* pBindInfo = %p, VkFence fence = %p)",
+	      queue, bindInfoCount, pBindInfo, static_cast<void *>(fence));
+
+	return vk::Cast(queue)->bindSparse(bindInfoCount, pBindInfo, vk::Cast(fence));
 }
 
 VKAPI_ATTR VkResult VKAPI_CALL vkCreateFence(VkDevice device, const VkFenceCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkFence *pFence)
@@ -1999,7 +2009,19 @@ VKAPI_ATTR VkResult VKAPI_CALL vkCreateBuffer(VkDevice device, const VkBufferCre
 		nextInfo = nextInfo->pNext;
 	}
 
-	return vk::Buffer::Create(pAllocator, pCreateInfo, pBuffer);
+	VkResult result = vk::Buffer::Create(pAllocator, pCreateInfo, pBuffer);
+
+	if((result == VK_SUCCESS) && (pCreateInfo->flags & VK_BUFFER_CREATE_SPARSE_BINDING_BIT))
+	{
+		result = vk::Cast(*pBuffer)->reserveSparseAddressSpace(pAllocator);
+		if(result != VK_SUCCESS)
+		{
+			vk::destroy(*pBuffer, pAllocator);
+			*pBuffer = VK_NULL_HANDLE;
+		}
+	}
+
+	return result;
 }
 
 VKAPI_ATTR void VKAPI_CALL vkDestroyBuffer(VkDevice device, VkBuffer buffer, const VkAllocationCallbacks *pAllocator)
@@ -2144,6 +2166,16 @@ VKAPI_ATTR VkResult VKAPI_CALL vkCreateImage(VkDevice device, const VkImageCreat
 
 	VkResult result = vk::Image::Create(pAllocator, pCreateInfo, pImage, vk::Cast(device));
 
+	if((result == VK_SUCCESS) && (pCreateInfo->flags & VK_IMAGE_CREATE_SPARSE_BINDING_BIT))
+	{
+		result = vk::Cast(*pImage)->reserveSparseAddressSpace(pAllocator);
+		if(result != VK_SUCCESS)
+		{
+			vk::destroy(*pImage, pAllocator);
+			*pImage = VK_NULL_HANDLE;
+		}
+	}
+
 #ifdef __ANDROID__
 	if(swapchainImage)
 	{
@@ -3754,7 +3786,7 @@ VKAPI_ATTR void VKAPI_CALL vkGetImageSparseMemoryRequirements2(VkDevice device,
 		}
 	}
 
-	// The 'sparseBinding' feature is not supported, so images can not be created with the VK_IMAGE_CREATE_SPARSE_RESIDENCY_BIT flag.
+	// The 'sparseResidencyImage*' features are not supported, so images can not be created with the VK_IMAGE_CREATE_SPARSE_RESIDENCY_BIT flag.
 	// "If the image was not created with VK_IMAGE_CREATE_SPARSE_RESIDENCY_BIT then pSparseMemoryRequirementCount will be set to zero and pSparseMemoryRequirements will not be written to."
 	*pSparseMemoryRequirementCount = 0;
 }
@@ -4387,7 +4419,7 @@ VKAPI_ATTR void VKAPI_CALL vkGetDeviceBufferMemoryRequirements(VkDevice device,
 	      device, pInfo, pMemoryRequirements);
 
 	pMemoryRequirements->memoryRequirements =
-	    vk::Buffer::GetMemoryRequirements(pInfo->pCreateInfo->size, pInfo->pCreateInfo->usage);
+	    vk::Buffer::GetMemoryRequirements(pInfo->pCreateInfo->size, pInfo->pCreateInfo->usage, pInfo->pCreateInfo->flags);
 }
 
 VKAPI_ATTR void VKAPI_CALL vkGetDeviceImageMemoryRequirements(VkDevice device, const VkDeviceImageMemoryRequirements *pInfo, VkMemoryRequirements2 *pMemoryRequirements)
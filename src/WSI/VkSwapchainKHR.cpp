@@ -90,8 +90,14 @@ VkResult SwapchainKHR::createImages(VkDevice device, const VkSwapchainCreateInfo
 {
 	resetImages();
 
+	// Presentable images are accessed directly by the surfaces, so they must use the linear layout.
+	VkImageSwapchainCreateInfoKHR swapchainInfo = {};
+	swapchainInfo.sType = VK_STRUCTURE_TYPE_IMAGE_SWAPCHAIN_CREATE_INFO_KHR;
+	swapchainInfo.swapchain = *this;
+
 	VkImageCreateInfo imageInfo = {};
 	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.pNext = &swapchainInfo;
 
 	if(pCreateInfo->flags & VK_SWAPCHAIN_CREATE_SPLIT_INSTANCE_BIND_REGIONS_BIT_KHR)
 	{
@@ -13,10 +13,13 @@
 // limitations under the License.
 
 #include "Coroutine.hpp"
+#include "Pragma.hpp"
 #include "Reactor.hpp"
 
 #include "benchmark/benchmark.h"
 
+#include <vector>
+
 using namespace rr;
 
 BENCHMARK_MAIN();
@@ -140,3 +143,166 @@ BENCHMARK_CAPTURE(Transcedental1, rr_Exp, Exp);
 BENCHMARK_CAPTURE(Transcedental1, rr_Log, Log);
 BENCHMARK_CAPTURE(Transcedental1, rr_Exp2, LIFT(Exp2));
 BENCHMARK_CAPTURE(Transcedental1, rr_Log2, LIFT(Log2));
+
+// Builds a routine with the loop structure typical of generated shader code: an outer
+// loop with a runtime trip count, containing loop-invariant computations and an inner
+// loop with a small constant trip count. The backend's loop unrolling, common
+// subexpression elimination and loop-invariant code motion determine its performance.
+static RoutineT<void(void *, const void *, float, float, int)> LoopRoutine(const char *name)
+{
+	FunctionT<void(void *, const void *, float, float, int)> function;
+	{
+		Pointer<Byte> out = function.Arg<0>();
+		Pointer<Byte> in = function.Arg<1>();
+		Float a = function.Arg<2>();
+		Float b = function.Arg<3>();
+		Int count = function.Arg<4>();
+
+		For(Int i = 0, i < count, i++)
+		{
+			Float4 scale = Float4(a * b + a);
+			Float4 bias = Float4(a * b - b);
+			Float4 value = *Pointer<Float4>(in + i * 16);
+
+			For(Int j = 0, j < 4, j++)
+			{
+				value = value * scale + bias * Float4(Float(j));
+			}
+
+			*Pointer<Float4>(out + i * 16) = value;
+		}
+	}
+
+	return function(name);
+}
+
+// Measures the time it takes to build and compile a routine containing loops.
+static void Loops_Compile(benchmark::State &state)
+{
+	state.SetLabel(Caps::backendName());
+
+	for(auto _ : state)
+	{
+		auto routine = LoopRoutine("loops");
+		benchmark::DoNotOptimize(routine);
+	}
+}
+
+BENCHMARK(Loops_Compile);
+
+// Measures the execution time of the generated code. Run with different
+// REACTOR_BACKEND builds to compare the code quality of Subzero against LLVM.
+static void Loops_Execute(benchmark::State &state)
+{
+	state.SetLabel(Caps::backendName());
+
+	auto routine = LoopRoutine("loops");
+
+	const int count = static_cast<int>(state.range(0));
+	std::vector<float> in(count * 4, 1.0f);
+	std::vector<float> out(count * 4);
+
+	for(auto _ : state)
+	{
+		routine(out.data(), in.data(), 0.5f, 0.25f, count);
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK(Loops_Execute)->RangeMultiplier(16)->Range(16, 4096)->ArgName("count");
+
+// Builds a long straight-line routine, like the unrolled SIMD code generated for a pixel
+// shader's arithmetic. Its compile time is dominated by register allocation and
+// instruction selection.
+static RoutineT<void(void *, const void *)> ArithmeticRoutine(const char *name)
+{
+	FunctionT<void(void *, const void *)> function;
+	{
+		Pointer<Byte> out = function.Arg<0>();
+		Pointer<Byte> in = function.Arg<1>();
+
+		Float4 x = *Pointer<Float4>(in + 0);
+		Float4 y = *Pointer<Float4>(in + 16);
+		Float4 z = *Pointer<Float4>(in + 32);
+		Float4 w = *Pointer<Float4>(in + 48);
+
+		for(int i = 0; i < 64; i++)
+		{
+			Float4 dot = x * y + z * w;
+			x = Max(dot * Float4(0.5f), z);
+			y = Min(y + dot, Float4(1.0f));
+			z = Sqrt(Abs(z * x)) + w;
+			w = Float4(1.0f) / Sqrt(dot * dot + Float4(1.0f));
+		}
+
+		*Pointer<Float4>(out + 0) = x;
+		*Pointer<Float4>(out + 16) = y;
+		*Pointer<Float4>(out + 32) = z;
+		*Pointer<Float4>(out + 48) = w;
+	}
+
+	return function(name);
+}
+
+// Builds a routine with nested data-dependent branches, like the control flow of
+// shaders with conditionals and early exits. Its compile time is dominated by the
+// analyses operating on the control flow graph.
+static RoutineT<int(const void *, int)> BranchRoutine(const char *name)
+{
+	FunctionT<int(const void *, int)> function;
+	{
+		Pointer<Byte> in = function.Arg<0>();
+		Int count = function.Arg<1>();
+
+		Int sum = 0;
+
+		For(Int i = 0, i < count, i++)
+		{
+			Int value = *Pointer<Int>(in + i * 4);
+
+			for(int bit = 0; bit < 16; bit++)
+			{
+				If((value & (1 << bit)) != 0)
+				{
+					sum += value >> bit;
+				}
+				Else If(value < bit)
+				{
+					sum -= bit;
+				}
+			}
+
+			If(sum > 0x10000)
+			{
+				Return(sum);
+			}
+		}
+
+		Return(sum);
+	}
+
+	return function(name);
+}
+
+// Measures the time it takes to build and JIT-compile a routine of the given shape, at the
+// optimization level given by the benchmark argument. Run with different REACTOR_BACKEND
+// builds to compare the backends.
+template<typename Builder>
+static void Compile(benchmark::State &state, Builder builder)
+{
+	state.SetLabel(Caps::backendName());
+
+	ScopedPragma optimizationLevel(OptimizationLevel, static_cast<int>(state.range(0)));
+
+	for(auto _ : state)
+	{
+		auto routine = builder("compile");
+		benchmark::DoNotOptimize(routine);
+	}
+}
+
+BENCHMARK_CAPTURE(Compile, Loops, LoopRoutine)->DenseRange(0, 3)->ArgName("O")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(Compile, Arithmetic, ArithmeticRoutine)->DenseRange(0, 3)->ArgName("O")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(Compile, Branches, BranchRoutine)->DenseRange(0, 3)->ArgName("O")->Unit(benchmark::kMillisecond);
@@ -206,3 +206,47 @@ TEST(ReactorSIMD, Intrinsics_Gather)
 		EXPECT_EQ(result[i], val[i]);
 	}
 }
+
+TEST(ReactorSIMD, Pointer_SpillReload)
+{
+	Function<Void(Pointer<Float> base, Pointer<SIMD::Int> offsets, Pointer<Byte> storage, Pointer<SIMD::Float> result)> function;
+	{
+		Pointer<Float> base = function.Arg<0>();
+		Pointer<SIMD::Int> offsets = function.Arg<1>();
+		Pointer<Byte> storage = function.Arg<2>();
+		Pointer<SIMD::Float> result = function.Arg<3>();
+
+		SIMD::Pointer pointer(base, 64 * sizeof(float), *offsets);
+		pointer.spill(storage);
+
+		pointer += SIMD::Int(4 * sizeof(float));
+		pointer.reload(storage);
+
+		*result = pointer.Load<SIMD::Float>(OutOfBoundsBehavior::Nullify, SIMD::Int(~0));
+	}
+
+	std::vector<float> buffer(64);
+	std::vector<int> offsets(SIMD::Width);
+
+	for(int i = 0; i < 64; i++)
+	{
+		buffer[i] = float(i);
+	}
+
+	for(int i = 0; i < SIMD::Width; i++)
+	{
+		offsets[i] = (5 * i + 1) * sizeof(float);
+	}
+
+	auto routine = function(testName().c_str());
+	auto entry = (void (*)(float *, int *, void *, float *))routine->getEntry();
+
+	std::vector<uint8_t> storage(64 * sizeof(void *));
+	std::vector<float> result(SIMD::Width);
+	entry(buffer.data(), offsets.data(), storage.data(), result.data());
+
+	for(int i = 0; i < SIMD::Width; i++)
+	{
+		EXPECT_EQ(result[i], float(5 * i + 1));
+	}
+}
@@ -140,6 +140,35 @@ TEST(ReactorUnitTests, Trampoline)
 	EXPECT_EQ(result, 80);
 }
 
+// Routines generated from identical IR share their code, even when their
+// constant data was emitted separately.
+TEST(ReactorUnitTests, Deduplication)
+{
+	auto generate = [](float scale) {
+		FunctionT<void(float4 *)> function;
+		{
+			Pointer<Float4> p = function.Arg<0>();
+			*p = *p * Float4(scale, 2.0f, 3.0f, 4.0f) + Float4(0.5f);
+		}
+
+		return function(testName().c_str());
+	};
+
+	auto first = generate(1.0f);
+	auto second = generate(1.0f);
+	auto third = generate(-1.0f);
+
+	EXPECT_EQ(first.getEntry(), second.getEntry());
+	EXPECT_NE(first.getEntry(), third.getEntry());
+
+	alignas(16) float4 data = { 1.0f, 1.0f, 1.0f, 1.0f };
+	third(&data);
+	EXPECT_EQ(data[0], -0.5f);
+	EXPECT_EQ(data[1], 2.5f);
+	EXPECT_EQ(data[2], 3.5f);
+	EXPECT_EQ(data[3], 4.5f);
+}
+
 TEST(ReactorUnitTests, Uninitialized)
 {
 #if __has_feature(memory_sanitizer)
@@ -679,6 +708,136 @@ TEST(ReactorUnitTests, StoreBeforeIndirectStore)
 	EXPECT_EQ(result, 4);
 }
 
+// Loops with a small constant trip count get fully unrolled, after which the
+// loads and stores of the induction variable and the accumulator are eliminated.
+TEST(ReactorUnitTests, UnrollConstantTripCountLoop)
+{
+	FunctionT<int(int)> function;
+	{
+		Int a = function.Arg<0>();
+		Int sum = 0;
+
+		For(Int i = 0, i < 4, i++)
+		{
+			sum += a * 3 + i;
+		}
+
+		Return(sum);
+	}
+
+	Nucleus::setOptimizerCallback([](const Nucleus::OptimizerReport *report) {
+		EXPECT_EQ(report->allocas, 0);
+		EXPECT_EQ(report->loads, 0);
+		EXPECT_EQ(report->stores, 0);
+	});
+
+	auto routine = function(testName().c_str());
+
+	int result = routine(5);
+	EXPECT_EQ(result, 66);
+}
+
+TEST(ReactorUnitTests, UnrollNestedLoops)
+{
+	FunctionT<int(int)> function;
+	{
+		Int a = function.Arg<0>();
+		Int sum = 0;
+
+		For(Int i = 0, i < 3, i++)
+		{
+			For(Int j = 4, j > 0, j--)
+			{
+				If((i + j) % 2 == 0)
+				{
+					sum += a * i;
+				}
+				Else
+				{
+					sum -= j;
+				}
+			}
+		}
+
+		Return(sum);
+	}
+
+	auto routine = function(testName().c_str());
+
+	for(int a = -3; a <= 3; a++)
+	{
+		int sum = 0;
+		for(int i = 0; i < 3; i++)
+		{
+			for(int j = 4; j > 0; j--)
+			{
+				if((i + j) % 2 == 0)
+				{
+					sum += a * i;
+				}
+				else
+				{
+					sum -= j;
+				}
+			}
+		}
+
+		int result = routine(a);
+		EXPECT_EQ(result, sum);
+	}
+}
+
+// The induction variable remains accessible after an unrolled loop, and returning
+// from within it must still work.
+TEST(ReactorUnitTests, UnrollLoopWithEarlyReturn)
+{
+	FunctionT<int(int)> function;
+	{
+		Int a = function.Arg<0>();
+		Int i = 0;
+
+		For(i = 0, i < 6, i++)
+		{
+			If(i == a)
+			{
+				Return(100 + i);
+			}
+		}
+
+		Return(i);
+	}
+
+	auto routine = function(testName().c_str());
+
+	EXPECT_EQ(routine(3), 103);
+	EXPECT_EQ(routine(9), 6);
+}
+
+// Loop-invariant code motion must not hoist a division out of a loop which doesn't
+// execute, since it could divide by zero.
+TEST(ReactorUnitTests, LoopInvariantDivision)
+{
+	FunctionT<int(int, int, int)> function;
+	{
+		Int a = function.Arg<0>();
+		Int b = function.Arg<1>();
+		Int n = function.Arg<2>();
+		Int sum = 0;
+
+		For(Int i = 0, i < n, i++)
+		{
+			sum += a * 3 + b / a + i;
+		}
+
+		Return(sum);
+	}
+
+	auto routine = function(testName().c_str());
+
+	EXPECT_EQ(routine(0, 5, 0), 0);
+	EXPECT_EQ(routine(2, 7, 100), 100 * (6 + 3) + 4950);
+}
+
 TEST(ReactorUnitTests, AssertTrue)
 {
 	FunctionT<int()> function;
@@ -0,0 +1,110 @@
+// Copyright 2026 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "System/RoutineTelemetry.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <sstream>
+
+using namespace sw;
+
+TEST(RoutineTelemetry, Empty)
+{
+	RoutineTelemetry::reset();
+
+	RoutineStats stats = RoutineTelemetry::query(RoutineKind::Pixel);
+	ASSERT_EQ(stats.compileCount, 0u);
+	ASSERT_EQ(stats.totalCompileSeconds, 0.0);
+	ASSERT_EQ(stats.p99CompileSeconds, 0.0);
+	ASSERT_EQ(stats.cacheHitRate(), 0.0);
+}
+
+TEST(RoutineTelemetry, CompileTimes)
+{
+	RoutineTelemetry::reset();
+
+	// 99 compiles of 1 ms, and one outlier of 100 ms.
+	for(int i = 0; i < 99; i++)
+	{
+		RoutineTelemetry::recordCompile(RoutineKind::Vertex, 0.001);
+	}
+	RoutineTelemetry::recordCompile(RoutineKind::Vertex, 0.1);
+
+	RoutineStats stats = RoutineTelemetry::query(RoutineKind::Vertex);
+	ASSERT_EQ(stats.compileCount, 100u);
+	ASSERT_NEAR(stats.totalCompileSeconds, 0.199, 1.0e-6);
+	ASSERT_GE(stats.p99CompileSeconds, 0.001);
+	ASSERT_LT(stats.p99CompileSeconds, 0.0012);
+
+	// Another outlier moves the 99th percentile to it.
+	RoutineTelemetry::recordCompile(RoutineKind::Vertex, 0.1);
+
+	stats = RoutineTelemetry::query(RoutineKind::Vertex);
+	ASSERT_GE(stats.p99CompileSeconds, 0.1);
+	ASSERT_LT(stats.p99CompileSeconds, 0.12);
+
+	// Other kinds are unaffected.
+	ASSERT_EQ(RoutineTelemetry::query(RoutineKind::Pixel).compileCount, 0u);
+}
+
+TEST(RoutineTelemetry, CacheHitRate)
+{
+	RoutineTelemetry::reset();
+
+	for(int i = 0; i < 3; i++)
+	{
+		RoutineTelemetry::recordCacheLookup(RoutineKind::Sampler, true);
+	}
+	RoutineTelemetry::recordCacheLookup(RoutineKind::Sampler, false);
+
+	RoutineStats stats = RoutineTelemetry::query(RoutineKind::Sampler);
+	ASSERT_EQ(stats.cacheHits, 3u);
+	ASSERT_EQ(stats.cacheMisses, 1u);
+	ASSERT_EQ(stats.cacheHitRate(), 0.75);
+
+	RoutineTelemetry::reset();
+	ASSERT_EQ(RoutineTelemetry::query(RoutineKind::Sampler).cacheHits, 0u);
+}
+
+TEST(RoutineTelemetry, Report)
+{
+	RoutineTelemetry::reset();
+
+	RoutineTelemetry::recordCompile(RoutineKind::Blit, 0.002);
+	RoutineTelemetry::recordCacheLookup(RoutineKind::Blit, false);
+	RoutineTelemetry::recordCacheLookup(RoutineKind::Blit, true);
+
+	std::string report = RoutineTelemetry::report();
+
+	// A header, and a line for each kind.
+	ASSERT_EQ(std::count(report.begin(), report.end(), '\n'), 1 + static_cast<int>(RoutineKind::Count));
+
+	size_t line = report.find("\nBlit ");
+	ASSERT_NE(line, std::string::npos);
+
+	std::istringstream blit(report.substr(line + 1));
+	std::string name;
+	uint64_t compiles = 0, hits = 0, misses = 0;
+	double totalMs = 0.0, p99Ms = 0.0, hitRate = 0.0;
+	blit >> name >> compiles >> totalMs >> p99Ms >> hits >> misses >> hitRate;
+	ASSERT_EQ(name, "Blit");
+	ASSERT_EQ(compiles, 1u);
+	ASSERT_NEAR(totalMs, 2.0, 1.0e-3);
+	ASSERT_GE(p99Ms, 2.0);
+	ASSERT_EQ(hits, 1u);
+	ASSERT_EQ(misses, 1u);
+	ASSERT_EQ(hitRate, 50.0);
+}
@@ -17,6 +17,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <thread>
 
 TEST(EventCounter, ConstructUnsignalled)
@@ -91,3 +92,40 @@ TEST(EventCounter, WaitTimeout)
 	ev.add();
 	ASSERT_FALSE(ev.wait(std::chrono::system_clock::now() + std::chrono::milliseconds(1)));
 }
+
+TEST(CappedPool, BorrowPreservesItems)
+{
+	sw::CappedPool<int> pool(2);
+	ASSERT_EQ(pool.capacity(), 2u);
+
+	int *first = nullptr;
+	{
+		auto loan = pool.borrow();
+		*loan = 42;
+		first = loan.get();
+	}
+
+	auto loan = pool.borrow();
+	ASSERT_EQ(loan.get(), first);
+	ASSERT_EQ(*loan, 42);
+}
+
+TEST(CappedPool, BorrowBlocksAtCapacity)
+{
+	sw::CappedPool<int> pool(1);
+	auto loan = pool.borrow();
+	int *item = loan.get();
+
+	std::atomic<bool> borrowed = { false };
+	auto t = std::thread([&] {
+		auto other = pool.borrow();
+		borrowed = true;
+		ASSERT_EQ(other.get(), item);
+	});
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	ASSERT_FALSE(borrowed);
+	loan.reset();
+	t.join();
+	ASSERT_TRUE(borrowed);
+}
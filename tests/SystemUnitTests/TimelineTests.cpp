@@ -0,0 +1,140 @@
+// Copyright 2026 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "System/Timeline.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace sw;
+
+static std::string writeTimeline()
+{
+	std::string path = testing::TempDir() + "timeline.json";
+	EXPECT_TRUE(Timeline::write(path));
+
+	std::ifstream file(path);
+	std::stringstream contents;
+	contents << file.rdbuf();
+	std::remove(path.c_str());
+
+	return contents.str();
+}
+
+static size_t countOf(const std::string &string, const std::string &substring)
+{
+	size_t count = 0;
+	for(size_t i = string.find(substring); i != std::string::npos; i = string.find(substring, i + 1))
+	{
+		count++;
+	}
+	return count;
+}
+
+TEST(Timeline, Disabled)
+{
+	Timeline::reset(false);
+
+	{
+		Timeline::Scope scope(Timeline::Category::Draw, "Draw", 1);
+	}
+	Timeline::insertLabel("Label");
+
+	std::string trace = writeTimeline();
+	ASSERT_EQ(countOf(trace, "\"ph\""), 0u);
+}
+
+TEST(Timeline, Events)
+{
+	Timeline::reset(true);
+
+	Timeline::beginLabel("Frame \"1\"");
+	{
+		Timeline::Scope scope(Timeline::Category::Batch, "Pixels", 7, 3);
+	}
+	Timeline::endLabel();
+
+	std::thread thread([] {
+		Timeline::Scope scope(Timeline::Category::Dispatch, "Dispatch", 64);
+	});
+	thread.join();
+
+	std::string trace = writeTimeline();
+	Timeline::reset(false);
+
+	ASSERT_EQ(countOf(trace, "\"ph\""), 4u);
+	ASSERT_EQ(countOf(trace, "\"name\":\"Frame \\\"1\\\"\",\"cat\":\"Label\",\"ph\":\"B\""), 1u);
+	ASSERT_EQ(countOf(trace, "\"ph\":\"E\""), 1u);
+	ASSERT_EQ(countOf(trace, "\"args\":{\"draw\":7,\"batch\":3}"), 1u);
+	ASSERT_EQ(countOf(trace, "\"args\":{\"workgroups\":64}"), 1u);
+
+	// The dispatch was recorded on another thread.
+	size_t pixels = trace.find("\"Pixels\"");
+	size_t dispatch = trace.find("\"Dispatch\"");
+	ASSERT_NE(pixels, std::string::npos);
+	ASSERT_NE(dispatch, std::string::npos);
+	ASSERT_NE(trace.substr(trace.find("\"tid\":", pixels), 8), trace.substr(trace.find("\"tid\":", dispatch), 8));
+}
+
+TEST(Timeline, ConcurrentWrite)
+{
+	Timeline::reset(true);
+
+	// Label the events with their sequence number, so that events which got
+	// overwritten while being written out would appear out of order.
+	std::atomic<uint64_t> recorded = { 0 };
+	std::atomic<bool> done = { false };
+
+	std::thread thread([&] {
+		for(uint64_t i = 0; !done.load(); i++)
+		{
+			Timeline::insertLabel(std::to_string(i).c_str());
+			recorded.store(i + 1);
+		}
+	});
+
+	while(recorded.load() == 0)
+	{
+		std::this_thread::yield();
+	}
+
+	size_t labels = 0;
+	size_t outOfOrder = 0;
+	for(int i = 0; i < 16; i++)
+	{
+		std::string trace = writeTimeline();
+		labels += countOf(trace, "\"ph\":\"i\"");
+
+		int64_t previous = -1;
+		for(size_t name = trace.find("{\"name\":\""); name != std::string::npos; name = trace.find("{\"name\":\"", name + 1))
+		{
+			int64_t sequence = std::stoll(trace.substr(name + 9));
+			outOfOrder += (sequence <= previous) ? 1 : 0;
+			previous = sequence;
+		}
+	}
+
+	done = true;
+	thread.join();
+	Timeline::reset(false);
+
+	ASSERT_GT(labels, 0u);
+	ASSERT_EQ(outOfOrder, 0u);
+}
@@ -91,3 +91,31 @@ TEST(MemFd, ExportImportFd)
 	ASSERT_TRUE(memfd2.unmap(addr, kRegionSize));
 }
 #endif  // __linux__
+
+TEST(Memory, AllocatePagesIsZeroInitialized)
+{
+	for(size_t size : { sw::memoryPageSize() * 3, sw::hugePageSize() + sw::memoryPageSize() })
+	{
+		auto *addr = reinterpret_cast<uint8_t *>(sw::allocatePages(size, 256));
+		ASSERT_TRUE(addr);
+		ASSERT_EQ(reinterpret_cast<uintptr_t>(addr) % 256, 0u);
+		for(size_t n = 0; n < size; n += 997)
+		{
+			ASSERT_EQ(addr[n], 0) << "# " << n;
+		}
+		addr[0] = 1;
+		addr[size - 1] = 1;
+		sw::freePages(addr, size);
+	}
+}
+
+TEST(Memory, AllocatePagesHugePageAlignment)
+{
+	const size_t kRegionSize = sw::hugePageSize() * 2;
+	void *addr = sw::allocatePages(kRegionSize, 256);
+	ASSERT_TRUE(addr);
+#if !defined(_WIN32)
+	ASSERT_EQ(reinterpret_cast<uintptr_t>(addr) % sw::hugePageSize(), 0u);
+#endif
+	sw::freePages(addr, kRegionSize);
+}
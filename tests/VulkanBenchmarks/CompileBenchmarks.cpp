@@ -0,0 +1,383 @@
+// Copyright 2026 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "DrawTester.hpp"
+#include "Util.hpp"
+#include "VulkanTester.hpp"
+
+#include "benchmark/benchmark.h"
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+
+// Latency of the code generation which happens on demand, rather than steady-state
+// throughput. Compute routines are generated when the pipeline is created, while vertex,
+// setup and pixel routines are generated by the first draw which uses a new state.
+
+// Counts the routines generated by the driver, and the lookups of its routine caches,
+// through SwiftShader's vk_swiftshaderGetRoutineStats() entry point. They are reported
+// per kind of routine as benchmark counters: the compiles and compile time per iteration,
+// the 99th percentile compile time of the process, and the cache hit rate.
+class RoutineCounters
+{
+public:
+	// Starts counting, until end(). The driver's counters are process-wide, and the
+	// library may be unloaded along with the tester, so each tester is counted separately.
+	void begin(VulkanTester &tester)
+	{
+		getRoutineStats = reinterpret_cast<GetRoutineStats>(tester.getDriverProcAddress("vk_swiftshaderGetRoutineStats"));
+		start = read();
+	}
+
+	void end()
+	{
+		for(const auto &[name, stats] : read())
+		{
+			Stats &total = totals[name];
+			for(int i = 0; i < StatCount; i++)
+			{
+				total[i] = (i == P99CompileNanoseconds) ? std::max(total[i], stats[i]) : total[i] + (stats[i] - start[name][i]);
+			}
+		}
+	}
+
+	void report(benchmark::State &state) const
+	{
+		for(const auto &[name, total] : totals)
+		{
+			uint64_t lookups = total[CacheHits] + total[CacheMisses];
+			if(total[CompileCount] == 0 && lookups == 0)
+			{
+				continue;
+			}
+
+			state.counters[name + "Compiles"] = benchmark::Counter(static_cast<double>(total[CompileCount]), benchmark::Counter::kAvgIterations);
+			state.counters[name + "CompileMs"] = benchmark::Counter(total[TotalCompileNanoseconds] * 1.0e-6, benchmark::Counter::kAvgIterations);
+			state.counters[name + "P99Ms"] = total[P99CompileNanoseconds] * 1.0e-6;
+			state.counters[name + "HitRate"] = (lookups > 0) ? static_cast<double>(total[CacheHits]) / lookups : 0.0;
+		}
+	}
+
+private:
+	// The statistics in the order vk_swiftshaderGetRoutineStats() returns them.
+	enum
+	{
+		CompileCount,
+		TotalCompileNanoseconds,
+		P99CompileNanoseconds,
+		CacheHits,
+		CacheMisses,
+
+		StatCount
+	};
+
+	using Stats = std::array<uint64_t, StatCount>;
+	using GetRoutineStats = const char *(VKAPI_PTR *)(uint32_t kind, uint64_t *pStats);
+
+	std::map<std::string, Stats> read() const
+	{
+		std::map<std::string, Stats> snapshot;
+		if(!getRoutineStats)
+		{
+			return snapshot;  // Not SwiftShader.
+		}
+
+		Stats stats;
+		for(uint32_t kind = 0; const char *name = getRoutineStats(kind, stats.data()); kind++)
+		{
+			snapshot[name] = stats;
+		}
+
+		return snapshot;
+	}
+
+	GetRoutineStats getRoutineStats = nullptr;
+	std::map<std::string, Stats> start;
+	std::map<std::string, Stats> totals;
+};
+
+// Representative compute shaders, from a trivial copy to shaders with loops and
+// workgroup barriers.
+static const char *computeCopy = R"(#version 450
+	layout(local_size_x = 128) in;
+	layout(binding = 0, std430) readonly buffer InBuffer { float inData[]; };
+	layout(binding = 1, std430) writeonly buffer OutBuffer { float outData[]; };
+
+	void main()
+	{
+		outData[gl_GlobalInvocationID.x] = inData[gl_GlobalInvocationID.x];
+	})";
+
+static const char *computeLoops = R"(#version 450
+	layout(local_size_x = 128) in;
+	layout(binding = 0, std430) readonly buffer InBuffer { float inData[]; };
+	layout(binding = 1, std430) writeonly buffer OutBuffer { float outData[]; };
+
+	void main()
+	{
+		float x = inData[gl_GlobalInvocationID.x];
+		float sum = 0.0;
+		for(int i = 0; i < 16; i++)
+		{
+			for(int j = 0; j < 4; j++)
+			{
+				sum += sin(x * float(i)) * cos(x + float(j));
+			}
+			if(sum > 100.0) break;
+		}
+		outData[gl_GlobalInvocationID.x] = sum;
+	})";
+
+static const char *computeReduction = R"(#version 450
+	layout(local_size_x = 128) in;
+	layout(binding = 0, std430) readonly buffer InBuffer { float inData[]; };
+	layout(binding = 1, std430) writeonly buffer OutBuffer { float outData[]; };
+
+	shared float partial[128];
+
+	void main()
+	{
+		uint i = gl_LocalInvocationID.x;
+		partial[i] = inData[gl_GlobalInvocationID.x];
+		barrier();
+
+		for(uint stride = 64u; stride > 0u; stride >>= 1u)
+		{
+			if(i < stride)
+			{
+				partial[i] += partial[i + stride];
+			}
+			barrier();
+		}
+
+		if(i == 0u)
+		{
+			outData[gl_WorkGroupID.x] = partial[0];
+		}
+	})";
+
+// Measures the creation of a compute pipeline, which includes SPIR-V optimization and
+// generating the compute routine. No pipeline cache is used, so each creation compiles.
+static void ComputePipelineCompile(benchmark::State &state, const char *glslShader)
+{
+	VulkanTester tester;
+	tester.initialize();
+	auto &device = tester.getDevice();
+
+	auto code = Util::compileGLSLtoSPIRV(glslShader, EShLanguage::EShLangCompute);
+
+	vk::ShaderModuleCreateInfo moduleCreateInfo;
+	moduleCreateInfo.codeSize = code.size() * sizeof(uint32_t);
+	moduleCreateInfo.pCode = (uint32_t *)code.data();
+	vk::ShaderModule shaderModule = device.createShaderModule(moduleCreateInfo);
+
+	std::vector<vk::DescriptorSetLayoutBinding> setLayoutBindings(2);
+	for(uint32_t binding = 0; binding < setLayoutBindings.size(); binding++)
+	{
+		setLayoutBindings[binding].binding = binding;
+		setLayoutBindings[binding].descriptorCount = 1;
+		setLayoutBindings[binding].descriptorType = vk::DescriptorType::eStorageBuffer;
+		setLayoutBindings[binding].stageFlags = vk::ShaderStageFlagBits::eCompute;
+	}
+
+	vk::DescriptorSetLayoutCreateInfo layoutInfo;
+	layoutInfo.bindingCount = static_cast<uint32_t>(setLayoutBindings.size());
+	layoutInfo.pBindings = setLayoutBindings.data();
+	vk::DescriptorSetLayout descriptorSetLayout = device.createDescriptorSetLayout(layoutInfo);
+
+	vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo;
+	pipelineLayoutCreateInfo.setLayoutCount = 1;
+	pipelineLayoutCreateInfo.pSetLayouts = &descriptorSetLayout;
+	vk::PipelineLayout pipelineLayout = device.createPipelineLayout(pipelineLayoutCreateInfo);
+
+	vk::ComputePipelineCreateInfo computePipelineCreateInfo;
+	computePipelineCreateInfo.layout = pipelineLayout;
+	computePipelineCreateInfo.stage.stage = vk::ShaderStageFlagBits::eCompute;
+	computePipelineCreateInfo.stage.module = shaderModule;
+	computePipelineCreateInfo.stage.pName = "main";
+
+	RoutineCounters routineCounters;
+	routineCounters.begin(tester);
+
+	for(auto _ : state)
+	{
+		vk::Pipeline pipeline = device.createComputePipeline({}, computePipelineCreateInfo).value;
+
+		state.PauseTiming();
+		device.destroyPipeline(pipeline);
+		state.ResumeTiming();
+	}
+
+	routineCounters.end();
+	routineCounters.report(state);
+
+	device.destroyPipelineLayout(pipelineLayout);
+	device.destroyDescriptorSetLayout(descriptorSetLayout);
+	device.destroyShaderModule(shaderModule);
+}
+
+// Representative fragment shaders, from a constant color to per-pixel lighting with
+// data-dependent branches.
+static const char *fragmentSolidColor = R"(#version 310 es
+	precision highp float;
+
+	layout(location = 0) in vec3 inNormal;
+	layout(location = 1) in vec2 inTexCoord;
+	layout(location = 0) out vec4 outColor;
+
+	void main()
+	{
+		outColor = vec4(1.0, 1.0, 1.0, 1.0);
+	})";
+
+static const char *fragmentLighting = R"(#version 310 es
+	precision highp float;
+
+	layout(location = 0) in vec3 inNormal;
+	layout(location = 1) in vec2 inTexCoord;
+	layout(location = 0) out vec4 outColor;
+
+	void main()
+	{
+		vec3 n = normalize(inNormal);
+		vec3 color = vec3(0.1);
+		for(int i = 0; i < 4; i++)
+		{
+			vec3 l = normalize(vec3(float(i) - 1.5, 1.0, 0.5));
+			vec3 h = normalize(l + vec3(0.0, 0.0, 1.0));
+			float diffuse = max(dot(n, l), 0.0);
+			float specular = pow(max(dot(n, h), 0.0), 32.0);
+			color += vec3(diffuse) * vec3(inTexCoord, 0.5) + vec3(specular);
+		}
+		outColor = vec4(color, 1.0);
+	})";
+
+static const char *fragmentBranches = R"(#version 310 es
+	precision highp float;
+
+	layout(location = 0) in vec3 inNormal;
+	layout(location = 1) in vec2 inTexCoord;
+	layout(location = 0) out vec4 outColor;
+
+	void main()
+	{
+		vec2 p = inTexCoord * 8.0;
+		if(fract(p.x) < 0.1 || fract(p.y) < 0.1)
+		{
+			discard;
+		}
+
+		vec4 color = vec4(0.0);
+		if(inNormal.x > 0.5)
+		{
+			color = vec4(inNormal, 1.0);
+		}
+		else if(inNormal.y > 0.0)
+		{
+			color = vec4(inTexCoord, 0.0, 1.0);
+		}
+		else
+		{
+			color = vec4(abs(inNormal.zzz), 1.0);
+		}
+		outColor = color;
+	})";
+
+// Measures the first frame drawn with a new device, which generates the vertex, setup and
+// pixel routines for the draw. The device is created anew for each iteration, outside of
+// the timed region, so that none of the routines are cached.
+static void GraphicsFirstDrawCompile(benchmark::State &state, const char *fragmentShader)
+{
+	RoutineCounters routineCounters;
+
+	for(auto _ : state)
+	{
+		state.PauseTiming();
+
+		{
+			DrawTester tester;
+
+			tester.onCreateVertexBuffers([](DrawTester &tester) {
+				struct Vertex
+				{
+					float position[3];
+					float normal[3];
+					float texCoord[2];
+				};
+
+				Vertex vertexBufferData[] = {
+					{ { 1.0f, 1.0f, 0.5f }, { 1.0f, 0.0f, 0.0f }, { 1.0f, 0.0f } },
+					{ { -1.0f, 1.0f, 0.5f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 1.0f } },
+					{ { 0.0f, -1.0f, 0.5f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f } }
+				};
+
+				std::vector<vk::VertexInputAttributeDescription> inputAttributes;
+				inputAttributes.push_back(vk::VertexInputAttributeDescription(0, 0, vk::Format::eR32G32B32Sfloat, offsetof(Vertex, position)));
+				inputAttributes.push_back(vk::VertexInputAttributeDescription(1, 0, vk::Format::eR32G32B32Sfloat, offsetof(Vertex, normal)));
+				inputAttributes.push_back(vk::VertexInputAttributeDescription(2, 0, vk::Format::eR32G32Sfloat, offsetof(Vertex, texCoord)));
+
+				tester.addVertexBuffer(vertexBufferData, sizeof(vertexBufferData), std::move(inputAttributes));
+			});
+
+			tester.onCreateVertexShader([](DrawTester &tester) {
+				const char *vertexShader = R"(#version 310 es
+					layout(location = 0) in vec3 inPos;
+					layout(location = 1) in vec3 inNormal;
+					layout(location = 2) in vec2 inTexCoord;
+
+					layout(location = 0) out vec3 outNormal;
+					layout(location = 1) out vec2 outTexCoord;
+
+					void main()
+					{
+						outNormal = inNormal;
+						outTexCoord = inTexCoord;
+						gl_Position = vec4(inPos.xyz, 1.0);
+					})";
+
+				return tester.createShaderModule(vertexShader, EShLanguage::EShLangVertex);
+			});
+
+			tester.onCreateFragmentShader([fragmentShader](DrawTester &tester) {
+				return tester.createShaderModule(fragmentShader, EShLanguage::EShLangFragment);
+			});
+
+			tester.initialize();
+			routineCounters.begin(tester);
+
+			state.ResumeTiming();
+
+			tester.renderFrame();
+			tester.getQueue().waitIdle();
+
+			state.PauseTiming();
+
+			routineCounters.end();
+		}  // The tester is destroyed outside of the timed region.
+
+		state.ResumeTiming();
+	}
+
+	routineCounters.report(state);
+}
+
+BENCHMARK_CAPTURE(ComputePipelineCompile, Copy, computeCopy)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(ComputePipelineCompile, Loops, computeLoops)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(ComputePipelineCompile, Reduction, computeReduction)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(GraphicsFirstDrawCompile, SolidColor, fragmentSolidColor)->Unit(benchmark::kMillisecond)->Iterations(20);
+BENCHMARK_CAPTURE(GraphicsFirstDrawCompile, Lighting, fragmentLighting)->Unit(benchmark::kMillisecond)->Iterations(20);
+BENCHMARK_CAPTURE(GraphicsFirstDrawCompile, Branches, fragmentBranches)->Unit(benchmark::kMillisecond)->Iterations(20);
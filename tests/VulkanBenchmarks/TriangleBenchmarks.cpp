@@ -16,7 +16,12 @@
 #include "DrawTester.hpp"
 #include "benchmark/benchmark.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
 #include <vector>
 
 template<typename T>
@@ -145,10 +150,25 @@ static void TriangleInterpolateColor(benchmark::State &state, Multisample multis
 	RunBenchmark(state, tester);
 }
 
-static void TriangleSampleTexture(benchmark::State &state, Multisample multisample)
+// When immutableSampler is true, the sampler is part of the descriptor set layout and thus
+// known when the pipeline is compiled.
+static void TriangleSampleTexture(benchmark::State &state, Multisample multisample, bool immutableSampler)
 {
 	DrawTester tester(multisample);
 
+	vk::SamplerCreateInfo samplerInfo;
+	samplerInfo.magFilter = vk::Filter::eLinear;
+	samplerInfo.minFilter = vk::Filter::eLinear;
+	samplerInfo.addressModeU = vk::SamplerAddressMode::eRepeat;
+	samplerInfo.addressModeV = vk::SamplerAddressMode::eRepeat;
+	samplerInfo.addressModeW = vk::SamplerAddressMode::eRepeat;
+	samplerInfo.anisotropyEnable = VK_FALSE;
+	samplerInfo.unnormalizedCoordinates = VK_FALSE;
+	samplerInfo.mipmapMode = vk::SamplerMipmapMode::eLinear;
+	samplerInfo.mipLodBias = 0.0f;
+	samplerInfo.minLod = 0.0f;
+	samplerInfo.maxLod = 0.0f;
+
 	tester.onCreateVertexBuffers([](DrawTester &tester) {
 		struct Vertex
 		{
@@ -200,7 +220,7 @@ static void TriangleSampleTexture(benchmark::State &state, Multisample multisamp
 		return tester.createShaderModule(fragmentShader, EShLanguage::EShLangFragment);
 	});
 
-	tester.onCreateDescriptorSetLayouts([](DrawTester &tester) -> std::vector<vk::DescriptorSetLayoutBinding> {
+	tester.onCreateDescriptorSetLayouts([samplerInfo, immutableSampler](DrawTester &tester) -> std::vector<vk::DescriptorSetLayoutBinding> {
 		vk::DescriptorSetLayoutBinding samplerLayoutBinding;
 		samplerLayoutBinding.binding = 1;
 		samplerLayoutBinding.descriptorCount = 1;
@@ -208,10 +228,16 @@ static void TriangleSampleTexture(benchmark::State &state, Multisample multisamp
 		samplerLayoutBinding.pImmutableSamplers = nullptr;
 		samplerLayoutBinding.stageFlags = vk::ShaderStageFlagBits::eFragment;
 
+		if(immutableSampler)
+		{
+			auto sampler = tester.addSampler(samplerInfo);
+			samplerLayoutBinding.pImmutableSamplers = &sampler.obj;
+		}
+
 		return { samplerLayoutBinding };
 	});
 
-	tester.onUpdateDescriptorSet([](DrawTester &tester, vk::CommandPool &commandPool, vk::DescriptorSet &descriptorSet) {
+	tester.onUpdateDescriptorSet([samplerInfo, immutableSampler](DrawTester &tester, vk::CommandPool &commandPool, vk::DescriptorSet &descriptorSet) {
 		auto &device = tester.getDevice();
 		auto &physicalDevice = tester.getPhysicalDevice();
 		auto &queue = tester.getQueue();
@@ -246,15 +272,152 @@ static void TriangleSampleTexture(benchmark::State &state, Multisample multisamp
 		Util::copyBufferToImage(device, commandPool, queue, buffer.getBuffer(), texture.getImage(), 16, 16);
 		Util::transitionImageLayout(device, commandPool, queue, texture.getImage(), vk::Format::eR8G8B8A8Unorm, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
 
+		vk::DescriptorImageInfo imageInfo;
+		imageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+		imageInfo.imageView = texture.getImageView();
+
+		if(!immutableSampler)
+		{
+			imageInfo.sampler = tester.addSampler(samplerInfo).obj;
+		}
+
+		std::array<vk::WriteDescriptorSet, 1> descriptorWrites = {};
+
+		descriptorWrites[0].dstSet = descriptorSet;
+		descriptorWrites[0].dstBinding = 1;
+		descriptorWrites[0].dstArrayElement = 0;
+		descriptorWrites[0].descriptorType = vk::DescriptorType::eCombinedImageSampler;
+		descriptorWrites[0].descriptorCount = 1;
+		descriptorWrites[0].pImageInfo = &imageInfo;
+
+		device.updateDescriptorSets(static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+	});
+
+	RunBenchmark(state, tester);
+}
+
+// Samples a texture much larger than the caches with bilinear filtering, mapping texels to
+// pixels approximately 1:1. When the texture coordinates are rotated by 90 degrees, adjacent
+// pixels sample adjacent rows of the texture, which for a linear layout means each pixel's
+// filter footprint touches different cache lines and pages than its neighbors'.
+static void SampleLargeTexture(benchmark::State &state, vk::ImageTiling tiling, bool rotated)
+{
+	constexpr uint32_t textureSize = 2048;
+
+	DrawTester tester;
+
+	tester.onCreateVertexBuffers([rotated](DrawTester &tester) {
+		struct Vertex
+		{
+			float position[2];
+			float texCoord[2];
+		};
+
+		// Cover the 1280x720 framebuffer with a region of the texture of the same size.
+		const float s = 1280.0f / textureSize;
+		const float t = 720.0f / textureSize;
+
+		Vertex vertexBufferData[] = {
+			{ { -1.0f, -1.0f }, { 0.0f, 0.0f } },
+			{ { 1.0f, -1.0f }, { s, 0.0f } },
+			{ { -1.0f, 1.0f }, { 0.0f, t } },
+			{ { -1.0f, 1.0f }, { 0.0f, t } },
+			{ { 1.0f, -1.0f }, { s, 0.0f } },
+			{ { 1.0f, 1.0f }, { s, t } },
+		};
+
+		if(rotated)
+		{
+			for(auto &vertex : vertexBufferData)
+			{
+				std::swap(vertex.texCoord[0], vertex.texCoord[1]);
+			}
+		}
+
+		std::vector<vk::VertexInputAttributeDescription> inputAttributes;
+		inputAttributes.push_back(vk::VertexInputAttributeDescription(0, 0, vk::Format::eR32G32Sfloat, offsetof(Vertex, position)));
+		inputAttributes.push_back(vk::VertexInputAttributeDescription(1, 0, vk::Format::eR32G32Sfloat, offsetof(Vertex, texCoord)));
+
+		tester.addVertexBuffer(vertexBufferData, sizeof(vertexBufferData), std::move(inputAttributes));
+	});
+
+	tester.onCreateVertexShader([](DrawTester &tester) {
+		const char *vertexShader = R"(#version 310 es
+			layout(location = 0) in vec2 inPos;
+			layout(location = 1) in vec2 inTexCoord;
+			layout(location = 0) out vec2 outTexCoord;
+
+			void main()
+			{
+				gl_Position = vec4(inPos, 0.5, 1.0);
+				outTexCoord = inTexCoord;
+			})";
+
+		return tester.createShaderModule(vertexShader, EShLanguage::EShLangVertex);
+	});
+
+	tester.onCreateFragmentShader([](DrawTester &tester) {
+		const char *fragmentShader = R"(#version 310 es
+			precision highp float;
+
+			layout(location = 0) in vec2 inTexCoord;
+			layout(location = 0) out vec4 outColor;
+			layout(binding = 0) uniform sampler2D texSampler;
+
+			void main()
+			{
+				outColor = texture(texSampler, inTexCoord);
+			})";
+
+		return tester.createShaderModule(fragmentShader, EShLanguage::EShLangFragment);
+	});
+
+	tester.onCreateDescriptorSetLayouts([](DrawTester &tester) -> std::vector<vk::DescriptorSetLayoutBinding> {
+		vk::DescriptorSetLayoutBinding samplerLayoutBinding;
+		samplerLayoutBinding.binding = 1;
+		samplerLayoutBinding.descriptorCount = 1;
+		samplerLayoutBinding.descriptorType = vk::DescriptorType::eCombinedImageSampler;
+		samplerLayoutBinding.pImmutableSamplers = nullptr;
+		samplerLayoutBinding.stageFlags = vk::ShaderStageFlagBits::eFragment;
+
+		return { samplerLayoutBinding };
+	});
+
+	tester.onUpdateDescriptorSet([tiling](DrawTester &tester, vk::CommandPool &commandPool, vk::DescriptorSet &descriptorSet) {
+		auto &device = tester.getDevice();
+		auto &physicalDevice = tester.getPhysicalDevice();
+		auto &queue = tester.getQueue();
+
+		auto usage = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst;
+		auto &texture = tester.addImage(device, physicalDevice, textureSize, textureSize, vk::Format::eR8G8B8A8Unorm, vk::SampleCountFlagBits::e1, usage, tiling).obj;
+
+		vk::DeviceSize bufferSize = textureSize * textureSize * 4;
+		Buffer buffer(device, bufferSize, vk::BufferUsageFlagBits::eTransferSrc);
+		uint32_t *data = static_cast<uint32_t *>(buffer.mapMemory());
+
+		for(uint32_t y = 0; y < textureSize; y++)
+		{
+			for(uint32_t x = 0; x < textureSize; x++)
+			{
+				data[x + textureSize * y] = 0xFF000000 | ((x * 7) & 0xFF) | (((y * 13) & 0xFF) << 8) | (((x ^ y) & 0xFF) << 16);
+			}
+		}
+
+		buffer.unmapMemory();
+
+		Util::transitionImageLayout(device, commandPool, queue, texture.getImage(), vk::Format::eR8G8B8A8Unorm, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal);
+		Util::copyBufferToImage(device, commandPool, queue, buffer.getBuffer(), texture.getImage(), textureSize, textureSize);
+		Util::transitionImageLayout(device, commandPool, queue, texture.getImage(), vk::Format::eR8G8B8A8Unorm, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
+
 		vk::SamplerCreateInfo samplerInfo;
 		samplerInfo.magFilter = vk::Filter::eLinear;
 		samplerInfo.minFilter = vk::Filter::eLinear;
-		samplerInfo.addressModeU = vk::SamplerAddressMode::eRepeat;
-		samplerInfo.addressModeV = vk::SamplerAddressMode::eRepeat;
-		samplerInfo.addressModeW = vk::SamplerAddressMode::eRepeat;
+		samplerInfo.addressModeU = vk::SamplerAddressMode::eClampToEdge;
+		samplerInfo.addressModeV = vk::SamplerAddressMode::eClampToEdge;
+		samplerInfo.addressModeW = vk::SamplerAddressMode::eClampToEdge;
 		samplerInfo.anisotropyEnable = VK_FALSE;
 		samplerInfo.unnormalizedCoordinates = VK_FALSE;
-		samplerInfo.mipmapMode = vk::SamplerMipmapMode::eLinear;
+		samplerInfo.mipmapMode = vk::SamplerMipmapMode::eNearest;
 		samplerInfo.mipLodBias = 0.0f;
 		samplerInfo.minLod = 0.0f;
 		samplerInfo.maxLod = 0.0f;
@@ -281,9 +444,322 @@ static void TriangleSampleTexture(benchmark::State &state, Multisample multisamp
 	RunBenchmark(state, tester);
 }
 
+// Fill-rate of alpha blended full-screen quads. Each frame draws a stack of overlapping quads,
+// so that every pixel is read, blended, and written once per layer. The swapchain's 8-bit
+// normalized format is blended in fixed-point arithmetic by SwiftShader.
+static void BlendedQuadFillRate(benchmark::State &state, Multisample multisample, vk::BlendFactor srcFactor, vk::BlendFactor dstFactor)
+{
+	constexpr int layers = 16;
+
+	DrawTester tester(multisample);
+
+	tester.onCreateVertexBuffers([](DrawTester &tester) {
+		struct Vertex
+		{
+			float position[2];
+			float color[4];
+		};
+
+		const float corners[6][2] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { -1.0f, 1.0f }, { -1.0f, 1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f } };
+
+		std::vector<Vertex> vertexBufferData;
+		for(int i = 0; i < layers; i++)
+		{
+			float r = static_cast<float>(i) / layers;
+
+			for(auto &corner : corners)
+			{
+				vertexBufferData.push_back({ { corner[0], corner[1] }, { r, 1.0f - r, 0.5f, 0.25f + 0.5f * r } });
+			}
+		}
+
+		std::vector<vk::VertexInputAttributeDescription> inputAttributes;
+		inputAttributes.push_back(vk::VertexInputAttributeDescription(0, 0, vk::Format::eR32G32Sfloat, offsetof(Vertex, position)));
+		inputAttributes.push_back(vk::VertexInputAttributeDescription(1, 0, vk::Format::eR32G32B32A32Sfloat, offsetof(Vertex, color)));
+
+		tester.addVertexBuffer(vertexBufferData.data(), vertexBufferData.size() * sizeof(Vertex), std::move(inputAttributes));
+	});
+
+	tester.onCreateVertexShader([](DrawTester &tester) {
+		const char *vertexShader = R"(#version 310 es
+			layout(location = 0) in vec2 inPos;
+			layout(location = 1) in vec4 inColor;
+
+			layout(location = 0) out vec4 outColor;
+
+			void main()
+			{
+				outColor = inColor;
+				gl_Position = vec4(inPos, 0.5, 1.0);
+			})";
+
+		return tester.createShaderModule(vertexShader, EShLanguage::EShLangVertex);
+	});
+
+	tester.onCreateFragmentShader([](DrawTester &tester) {
+		const char *fragmentShader = R"(#version 310 es
+			precision highp float;
+
+			layout(location = 0) in vec4 inColor;
+
+			layout(location = 0) out vec4 outColor;
+
+			void main()
+			{
+				outColor = inColor;
+			})";
+
+		return tester.createShaderModule(fragmentShader, EShLanguage::EShLangFragment);
+	});
+
+	tester.onCreateColorBlendAttachmentState([srcFactor, dstFactor](DrawTester &tester, vk::PipelineColorBlendAttachmentState &blendAttachmentState) {
+		blendAttachmentState.blendEnable = VK_TRUE;
+		blendAttachmentState.srcColorBlendFactor = srcFactor;
+		blendAttachmentState.dstColorBlendFactor = dstFactor;
+		blendAttachmentState.colorBlendOp = vk::BlendOp::eAdd;
+		blendAttachmentState.srcAlphaBlendFactor = vk::BlendFactor::eOne;
+		blendAttachmentState.dstAlphaBlendFactor = dstFactor;
+		blendAttachmentState.alphaBlendOp = vk::BlendOp::eAdd;
+	});
+
+	RunBenchmark(state, tester);
+
+	// 1280x720 framebuffer.
+	state.counters["Pixels"] = benchmark::Counter(1280.0 * 720.0 * layers, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+struct MeshVertex
+{
+	float position[3];
+	float color[3];
+};
+
+// A grid of quads, drawn row by row. Vertices are shared with the neighboring quads in both
+// directions, but the distance between rows exceeds what a small vertex cache can exploit.
+static void SetupTriangleMesh(DrawTester &tester, uint32_t gridSize, std::vector<MeshVertex> &vertices, std::vector<uint32_t> &indices)
+{
+	tester.onCreateVertexBuffers([gridSize, &vertices, &indices](DrawTester &tester) {
+		for(uint32_t y = 0; y <= gridSize; y++)
+		{
+			for(uint32_t x = 0; x <= gridSize; x++)
+			{
+				float u = static_cast<float>(x) / gridSize;
+				float v = static_cast<float>(y) / gridSize;
+				vertices.push_back({ { 2.0f * u - 1.0f, 2.0f * v - 1.0f, 0.5f }, { u, v, 1.0f - u } });
+			}
+		}
+
+		for(uint32_t y = 0; y < gridSize; y++)
+		{
+			for(uint32_t x = 0; x < gridSize; x++)
+			{
+				uint32_t i = y * (gridSize + 1) + x;
+				uint32_t quad[6] = { i, i + 1, i + gridSize + 1, i + 1, i + gridSize + 2, i + gridSize + 1 };
+				indices.insert(indices.end(), std::begin(quad), std::end(quad));
+			}
+		}
+
+		std::vector<vk::VertexInputAttributeDescription> inputAttributes;
+		inputAttributes.push_back(vk::VertexInputAttributeDescription(0, 0, vk::Format::eR32G32B32Sfloat, offsetof(MeshVertex, position)));
+		inputAttributes.push_back(vk::VertexInputAttributeDescription(1, 0, vk::Format::eR32G32B32Sfloat, offsetof(MeshVertex, color)));
+
+		tester.addVertexBuffer(vertices.data(), vertices.size() * sizeof(MeshVertex), std::move(inputAttributes));
+		tester.addIndexBuffer(indices.data(), indices.size());
+	});
+
+	tester.onCreateVertexShader([](DrawTester &tester) {
+		const char *vertexShader = R"(#version 310 es
+			layout(location = 0) in vec3 inPos;
+			layout(location = 1) in vec3 inColor;
+
+			layout(location = 0) out vec3 outColor;
+
+			void main()
+			{
+				outColor = inColor;
+				gl_Position = vec4(inPos.xyz, 1.0);
+			})";
+
+		return tester.createShaderModule(vertexShader, EShLanguage::EShLangVertex);
+	});
+
+	tester.onCreateFragmentShader([](DrawTester &tester) {
+		const char *fragmentShader = R"(#version 310 es
+			precision highp float;
+
+			layout(location = 0) in vec3 inColor;
+
+			layout(location = 0) out vec4 outColor;
+
+			void main()
+			{
+				outColor = vec4(inColor, 1.0);
+			})";
+
+		return tester.createShaderModule(fragmentShader, EShLanguage::EShLangFragment);
+	});
+}
+
+// Reports the ratio of vertex shader invocations avoided by deduplicating the indices of each
+// batch, as the number of batch vertices per shaded vertex. It is measured over one frame of a
+// separate device, for which SwiftShader's telemetry report is enabled through the configuration.
+static void ReportVertexReuse(benchmark::State &state, Multisample multisample)
+{
+	constexpr const char *reportFile = "VertexReuseTelemetry.txt";
+
+	{
+		Util::ScopedConfiguration configuration(std::string("[Profiler]\nRoutineTelemetryReportFile=") + reportFile);
+
+		DrawTester tester(multisample);
+		std::vector<MeshVertex> vertices;
+		std::vector<uint32_t> indices;
+		SetupTriangleMesh(tester, 256, vertices, indices);
+
+		tester.initialize();
+		tester.renderFrame();
+		tester.getQueue().waitIdle();
+	}  // The report is written when the device is destroyed.
+
+	std::ifstream report(reportFile);
+	std::string line;
+	while(std::getline(report, line))
+	{
+		unsigned long long batchVertices = 0;
+		unsigned long long shadedVertices = 0;
+		if(std::sscanf(line.c_str(), "Vertex deduplication: %llu batch vertices, %llu shaded", &batchVertices, &shadedVertices) == 2 && shadedVertices > 0)
+		{
+			state.counters["VertexReuse"] = static_cast<double>(batchVertices) / shadedVertices;
+		}
+	}
+	report.close();
+
+	std::remove(reportFile);  // Not written by other drivers.
+}
+
+static void TriangleMeshIndexed(benchmark::State &state, Multisample multisample)
+{
+	{
+		DrawTester tester(multisample);
+		std::vector<MeshVertex> vertices;
+		std::vector<uint32_t> indices;
+		SetupTriangleMesh(tester, 256, vertices, indices);
+
+		RunBenchmark(state, tester);
+	}
+
+	ReportVertexReuse(state, multisample);
+}
+
+// Fraction of the SIMD lanes which process covered pixels, when each 2x2 pixel quad touched by
+// a triangle is shaded as one group of four lanes. Pixel centers on an edge count as covered,
+// which overestimates coverage by a negligible amount.
+static double QuadLaneUtilization(const std::vector<MeshVertex> &vertices, const std::vector<uint32_t> &indices, int width, int height)
+{
+	size_t coveredPixels = 0;
+	size_t shadedQuads = 0;
+
+	for(size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		float x[3];
+		float y[3];
+		for(int j = 0; j < 3; j++)
+		{
+			x[j] = (vertices[indices[i + j]].position[0] + 1.0f) * 0.5f * width;
+			y[j] = (vertices[indices[i + j]].position[1] + 1.0f) * 0.5f * height;
+		}
+
+		float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+		if(area == 0.0f)
+		{
+			continue;
+		}
+
+		int xBegin = static_cast<int>(std::floor(std::min({ x[0], x[1], x[2] }))) & ~1;
+		int yBegin = static_cast<int>(std::floor(std::min({ y[0], y[1], y[2] }))) & ~1;
+		int xEnd = static_cast<int>(std::ceil(std::max({ x[0], x[1], x[2] })));
+		int yEnd = static_cast<int>(std::ceil(std::max({ y[0], y[1], y[2] })));
+
+		for(int qy = yBegin; qy < yEnd; qy += 2)
+		{
+			for(int qx = xBegin; qx < xEnd; qx += 2)
+			{
+				int covered = 0;
+
+				for(int p = 0; p < 4; p++)
+				{
+					float px = qx + (p & 1) + 0.5f;
+					float py = qy + (p >> 1) + 0.5f;
+					bool inside = true;
+
+					for(int j = 0; j < 3; j++)
+					{
+						int k = (j + 1) % 3;
+						float e = (x[k] - x[j]) * (py - y[j]) - (y[k] - y[j]) * (px - x[j]);
+						inside = inside && (area > 0.0f ? e >= 0.0f : e <= 0.0f);
+					}
+
+					covered += inside ? 1 : 0;
+				}
+
+				coveredPixels += covered;
+				shadedQuads += (covered > 0) ? 1 : 0;
+			}
+		}
+	}
+
+	return static_cast<double>(coveredPixels) / (4 * shadedQuads);
+}
+
+// A mesh of triangles which each cover about one pixel, like distant or highly tessellated
+// geometry. The cost is dominated by the per-triangle setup and rasterization overhead, and
+// most of the SIMD lanes of the shaded quads don't correspond to covered pixels.
+static void TriangleMeshDense(benchmark::State &state, Multisample multisample)
+{
+	constexpr uint32_t gridSize = 720;
+
+	DrawTester tester(multisample);
+	std::vector<MeshVertex> vertices;
+	std::vector<uint32_t> indices;
+	SetupTriangleMesh(tester, gridSize, vertices, indices);
+
+	RunBenchmark(state, tester);
+
+	// 1280x720 framebuffer.
+	state.counters["Triangles"] = benchmark::Counter(2.0 * gridSize * gridSize, benchmark::Counter::kIsIterationInvariantRate);
+	state.counters["LaneUtilization"] = QuadLaneUtilization(vertices, indices, 1280, 720);
+}
+
+// Measures how rendering scales with the number of worker threads. The renderer's cluster,
+// batch and draw counts follow the thread count unless they are set explicitly.
+static void TriangleMeshThreadScaling(benchmark::State &state)
+{
+	Util::ScopedConfiguration configuration("[Processor]\nThreadCount=" + std::to_string(state.range(0)));
+
+	DrawTester tester(Multisample::False);
+	std::vector<MeshVertex> vertices;
+	std::vector<uint32_t> indices;
+	SetupTriangleMesh(tester, 256, vertices, indices);
+
+	RunBenchmark(state, tester);
+}
+
 BENCHMARK_CAPTURE(TriangleSolidColor, TriangleSolidColor, Multisample::False)->Unit(benchmark::kMillisecond)->MeasureProcessCPUTime();
 BENCHMARK_CAPTURE(TriangleInterpolateColor, TriangleInterpolateColor, Multisample::False)->Unit(benchmark::kMillisecond)->MeasureProcessCPUTime();
-BENCHMARK_CAPTURE(TriangleSampleTexture, TriangleSampleTexture, Multisample::False)->Unit(benchmark::kMillisecond)->MeasureProcessCPUTime();
+BENCHMARK_CAPTURE(TriangleSampleTexture, TriangleSampleTexture, Multisample::False, false)->Unit(benchmark::kMillisecond)->MeasureProcessCPUTime();
 BENCHMARK_CAPTURE(TriangleSolidColor, TriangleSolidColor_Multisample, Multisample::True)->Unit(benchmark::kMillisecond)->MeasureProcessCPUTime();
 BENCHMARK_CAPTURE(TriangleInterpolateColor, TriangleInterpolateColor_Multisample, Multisample::True)->Unit(benchmark::kMillisecond)->MeasureProcessCPUTime();
-BENCHMARK_CAPTURE(TriangleSampleTexture, TriangleSampleTexture_Multisample, Multisample::True)->Unit(benchmark::kMillisecond)->MeasureProcessCPUTime();
+BENCHMARK_CAPTURE(TriangleSampleTexture, TriangleSampleTexture_Multisample, Multisample::True, false)->Unit(benchmark::kMillisecond)->MeasureProcessCPUTime();
+BENCHMARK_CAPTURE(TriangleSampleTexture, TriangleSampleTexture_ImmutableSampler, Multisample::False, true)->Unit(benchmark::kMillisecond)->MeasureProcessCPUTime();
+BENCHMARK_CAPTURE(SampleLargeTexture, SampleLargeTexture_Linear, vk::ImageTiling::eLinear, false)->Unit(benchmark::kMillisecond)->MeasureProcessCPUTime();
+BENCHMARK_CAPTURE(SampleLargeTexture, SampleLargeTexture_Linear_Rotated, vk::ImageTiling::eLinear, true)->Unit(benchmark::kMillisecond)->MeasureProcessCPUTime();
+BENCHMARK_CAPTURE(SampleLargeTexture, SampleLargeTexture_Optimal, vk::ImageTiling::eOptimal, false)->Unit(benchmark::kMillisecond)->MeasureProcessCPUTime();
+BENCHMARK_CAPTURE(SampleLargeTexture, SampleLargeTexture_Optimal_Rotated, vk::ImageTiling::eOptimal, true)->Unit(benchmark::kMillisecond)->MeasureProcessCPUTime();
+BENCHMARK_CAPTURE(TriangleMeshIndexed, TriangleMeshIndexed, Multisample::False)->Unit(benchmark::kMillisecond)->MeasureProcessCPUTime();
+BENCHMARK_CAPTURE(TriangleMeshIndexed, TriangleMeshIndexed_Multisample, Multisample::True)->Unit(benchmark::kMillisecond)->MeasureProcessCPUTime();
+BENCHMARK_CAPTURE(TriangleMeshDense, TriangleMeshDense, Multisample::False)->Unit(benchmark::kMillisecond)->MeasureProcessCPUTime();
+BENCHMARK_CAPTURE(TriangleMeshDense, TriangleMeshDense_Multisample, Multisample::True)->Unit(benchmark::kMillisecond)->MeasureProcessCPUTime();
+BENCHMARK_CAPTURE(BlendedQuadFillRate, BlendedQuadFillRate_Alpha, Multisample::False, vk::BlendFactor::eSrcAlpha, vk::BlendFactor::eOneMinusSrcAlpha)->Unit(benchmark::kMillisecond)->MeasureProcessCPUTime();
+BENCHMARK_CAPTURE(BlendedQuadFillRate, BlendedQuadFillRate_Additive, Multisample::False, vk::BlendFactor::eOne, vk::BlendFactor::eOne)->Unit(benchmark::kMillisecond)->MeasureProcessCPUTime();
+BENCHMARK_CAPTURE(BlendedQuadFillRate, BlendedQuadFillRate_Multiply, Multisample::False, vk::BlendFactor::eDstColor, vk::BlendFactor::eZero)->Unit(benchmark::kMillisecond)->MeasureProcessCPUTime();
+BENCHMARK_CAPTURE(BlendedQuadFillRate, BlendedQuadFillRate_Alpha_Multisample, Multisample::True, vk::BlendFactor::eSrcAlpha, vk::BlendFactor::eOneMinusSrcAlpha)->Unit(benchmark::kMillisecond)->MeasureProcessCPUTime();
+BENCHMARK(TriangleMeshThreadScaling)->RangeMultiplier(2)->Range(1, 128)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -14,14 +14,20 @@
 
 #include "Device.hpp"
 #include "Driver.hpp"
+#include "Util.hpp"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
 #include "spirv-tools/libspirv.hpp"
 
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
+#include <functional>
 #include <sstream>
+#include <string>
+#include <vector>
 
 namespace {
 size_t alignUp(size_t val, size_t alignment)
@@ -61,6 +67,10 @@ protected:
 	{
 		driver.unload();
 	}
+
+	// Runs the compute shader on a new device, with the input in the storage buffer at binding 0,
+	// and returns the contents of the storage buffer of the same length at binding 1.
+	static void dispatch(const std::vector<uint32_t> &code, const std::vector<uint32_t> &input, uint32_t groupCount, std::vector<uint32_t> &output);
 };
 
 Driver ComputeTest::driver;
@@ -124,13 +134,8 @@ public:
 	          std::function<uint32_t(uint32_t idx)> expected);
 };
 
-void SwiftShaderVulkanBufferToBufferComputeTest::test(
-    const std::string &shader,
-    std::function<uint32_t(uint32_t idx)> input,
-    std::function<uint32_t(uint32_t idx)> expected)
+void ComputeTest::dispatch(const std::vector<uint32_t> &code, const std::vector<uint32_t> &input, uint32_t groupCount, std::vector<uint32_t> &output)
 {
-	auto code = compileSpirv(shader.c_str());
-
 	const VkInstanceCreateInfo createInfo = {
 		VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,  // sType
 		nullptr,                                 // pNext
@@ -166,7 +171,7 @@ void SwiftShaderVulkanBufferToBufferComputeTest::test(
 	static constexpr uint32_t magic1 = 0x89abcdef;
 	static constexpr uint32_t magic2 = 0xfedcba99;
 	static constexpr uint32_t magic3 = 0x87654321;
-	size_t numElements = GetParam().numElements;
+	size_t numElements = input.size();
 	size_t alignElements = 0x100 / sizeof(uint32_t);
 	size_t magic0Offset = alignElements - 1;
 	size_t inOffset = 1 + magic0Offset;
@@ -194,7 +199,7 @@ void SwiftShaderVulkanBufferToBufferComputeTest::test(
 
 	for(size_t i = 0; i < numElements; i++)
 	{
-		buffers[inOffset + i] = input((uint32_t)i);
+		buffers[inOffset + i] = input[i];
 	}
 
 	device->UnmapMemory(memory);
@@ -274,7 +279,7 @@ void SwiftShaderVulkanBufferToBufferComputeTest::test(
 	driver.vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSet,
 	                               0, nullptr);
 
-	driver.vkCmdDispatch(commandBuffer, (uint32_t)(numElements / GetParam().localSizeX), 1, 1);
+	driver.vkCmdDispatch(commandBuffer, groupCount, 1, 1);
 
 	VK_ASSERT(driver.vkEndCommandBuffer(commandBuffer));
 
@@ -282,11 +287,7 @@ void SwiftShaderVulkanBufferToBufferComputeTest::test(
 
 	VK_ASSERT(device->MapMemory(memory, 0, buffersSize, 0, (void **)&buffers));
 
-	for(size_t i = 0; i < numElements; ++i)
-	{
-		auto got = buffers[i + outOffset];
-		EXPECT_EQ(expected((uint32_t)i), got) << "Unexpected output at " << i;
-	}
+	output.assign(buffers + outOffset, buffers + outOffset + numElements);
 
 	// Check for writes outside of bounds.
 	EXPECT_EQ(buffers[magic0Offset], magic0);
@@ -311,6 +312,31 @@ void SwiftShaderVulkanBufferToBufferComputeTest::test(
 	driver.vkDestroyInstance(instance, nullptr);
 }
 
+void SwiftShaderVulkanBufferToBufferComputeTest::test(
+    const std::string &shader,
+    std::function<uint32_t(uint32_t idx)> input,
+    std::function<uint32_t(uint32_t idx)> expected)
+{
+	auto code = compileSpirv(shader.c_str());
+
+	size_t numElements = GetParam().numElements;
+	std::vector<uint32_t> inputs(numElements);
+	for(size_t i = 0; i < numElements; i++)
+	{
+		inputs[i] = input((uint32_t)i);
+	}
+
+	std::vector<uint32_t> outputs;
+	dispatch(code, inputs, (uint32_t)(numElements / GetParam().localSizeX), outputs);
+	ASSERT_EQ(outputs.size(), numElements);
+
+	for(size_t i = 0; i < numElements; ++i)
+	{
+		auto got = outputs[i];
+		EXPECT_EQ(expected((uint32_t)i), got) << "Unexpected output at " << i;
+	}
+}
+
 INSTANTIATE_TEST_SUITE_P(ComputeParams, SwiftShaderVulkanBufferToBufferComputeTest, testing::Values(ComputeParams{ 512, 1, 1, 1 }, ComputeParams{ 512, 2, 1, 1 }, ComputeParams{ 512, 4, 1, 1 }, ComputeParams{ 512, 8, 1, 1 }, ComputeParams{ 512, 16, 1, 1 }, ComputeParams{ 512, 32, 1, 1 },
 
                                                                                                     // Non-multiple of SIMD-lane.
@@ -1481,3 +1507,353 @@ TEST_P(SwiftShaderVulkanBufferToBufferComputeTest, LoopDivergentMergePhi)
 	test(
 	    src.str(), [](uint32_t i) { return i; }, [](uint32_t i) { return i; });
 }
+
+// Returns a shader which converts each input to a 16-bit integer of the given
+// signedness, applies a GLSL.std.450 instruction to it and the constants -100
+// (%18) and 100 (%19), and writes out the zero-extended 16-bit result.
+static std::string glsl450Int16Shader(const ComputeParams &params, bool signedOperands, const char *instruction)
+{
+	std::stringstream src;
+	// clang-format off
+    src <<
+        "OpCapability Shader\n"
+        "OpCapability Int16\n"
+        "%1 = OpExtInstImport \"GLSL.std.450\"\n"
+        "OpMemoryModel Logical GLSL450\n"
+        "OpEntryPoint GLCompute %2 \"main\" %3\n"
+        "OpExecutionMode %2 LocalSize " <<
+        params.localSizeX << " " <<
+        params.localSizeY << " " <<
+        params.localSizeZ << "\n" <<
+        "OpDecorate %3 BuiltIn GlobalInvocationId\n"
+        "OpDecorate %4 ArrayStride 4\n"
+        "OpMemberDecorate %5 0 Offset 0\n"
+        "OpDecorate %5 BufferBlock\n"
+        "OpDecorate %6 DescriptorSet 0\n"
+        "OpDecorate %6 Binding 0\n"
+        "OpDecorate %7 DescriptorSet 0\n"
+        "OpDecorate %7 Binding 1\n"
+        "%8 = OpTypeVoid\n"
+        "%9 = OpTypeFunction %8\n"
+        "%10 = OpTypeInt 32 0\n"
+        "%11 = OpTypeVector %10 3\n"
+        "%12 = OpTypePointer Input %11\n"
+        "%3 = OpVariable %12 Input\n"
+        "%13 = OpConstant %10 0\n"
+        "%14 = OpTypePointer Input %10\n"
+        "%4 = OpTypeRuntimeArray %10\n"
+        "%5 = OpTypeStruct %4\n"
+        "%15 = OpTypePointer Uniform %5\n"
+        "%6 = OpVariable %15 Uniform\n"                 // struct{ uint32[] }* in
+        "%7 = OpVariable %15 Uniform\n"                 // struct{ uint32[] }* out
+        "%16 = OpTypePointer Uniform %10\n"
+        "%17 = OpTypeInt 16 " << (signedOperands ? 1 : 0) << "\n" <<
+        "%18 = OpConstant %17 " << (signedOperands ? "-100" : "65436") << "\n" <<
+        "%19 = OpConstant %17 100\n"
+        "%2 = OpFunction %8 None %9\n"
+        "%20 = OpLabel\n"
+        "%21 = OpAccessChain %14 %3 %13\n"
+        "%22 = OpLoad %10 %21\n"
+        "%23 = OpAccessChain %16 %6 %13 %22\n"
+        "%24 = OpLoad %10 %23\n"
+        "%25 = " << (signedOperands ? "OpSConvert" : "OpUConvert") << " %17 %24\n" <<
+        "%26 = OpExtInst %17 %1 " << instruction << "\n" <<
+        "%27 = OpUConvert %10 %26\n"
+        "%28 = OpAccessChain %16 %7 %13 %22\n"
+        "OpStore %28 %27\n"
+        "OpReturn\n"
+        "OpFunctionEnd\n";
+	// clang-format on
+
+	return src.str();
+}
+
+// Covers the full range of 16-bit values, with both signs.
+static uint32_t int16Input(uint32_t i)
+{
+	return i * 0x8123;
+}
+
+static int16_t asInt16(uint32_t i)
+{
+	return static_cast<int16_t>(static_cast<uint16_t>(int16Input(i)));
+}
+
+// Signed instructions must interpret unsigned 16-bit operands as signed too.
+TEST_P(SwiftShaderVulkanBufferToBufferComputeTest, Int16SAbs)
+{
+	for(bool signedOperands : { true, false })
+	{
+		test(
+		    glsl450Int16Shader(GetParam(), signedOperands, "SAbs %25"), int16Input,
+		    [](uint32_t i) { return static_cast<uint16_t>(std::abs(asInt16(i))); });
+	}
+}
+
+TEST_P(SwiftShaderVulkanBufferToBufferComputeTest, Int16SMinSMax)
+{
+	for(bool signedOperands : { true, false })
+	{
+		test(
+		    glsl450Int16Shader(GetParam(), signedOperands, "SMin %25 %19"), int16Input,
+		    [](uint32_t i) { return static_cast<uint16_t>(std::min<int16_t>(asInt16(i), 100)); });
+		test(
+		    glsl450Int16Shader(GetParam(), signedOperands, "SMax %25 %18"), int16Input,
+		    [](uint32_t i) { return static_cast<uint16_t>(std::max<int16_t>(asInt16(i), -100)); });
+	}
+}
+
+TEST_P(SwiftShaderVulkanBufferToBufferComputeTest, Int16SClamp)
+{
+	for(bool signedOperands : { true, false })
+	{
+		test(
+		    glsl450Int16Shader(GetParam(), signedOperands, "SClamp %25 %18 %19"), int16Input,
+		    [](uint32_t i) { return static_cast<uint16_t>(std::min<int16_t>(std::max<int16_t>(asInt16(i), -100), 100)); });
+	}
+}
+
+TEST_P(SwiftShaderVulkanBufferToBufferComputeTest, Int16SSign)
+{
+	for(bool signedOperands : { true, false })
+	{
+		test(
+		    glsl450Int16Shader(GetParam(), signedOperands, "SSign %25"), int16Input,
+		    [](uint32_t i) { return static_cast<uint16_t>((asInt16(i) > 0) - (asInt16(i) < 0)); });
+	}
+}
+
+// Base class for tests of compute shaders with workgroup barriers. SwiftShader can split such shaders
+// into phases at the barriers, which run for all subgroups in turn, instead of running each subgroup
+// as a coroutine which is suspended at every barrier. Values used after a barrier are saved to the
+// subgroup's phase state. Each shader is run with the SplitComputePhases setting off and on, on
+// separate devices, and both outputs are compared with the reference.
+class SwiftShaderVulkanComputePhasesTest : public ComputeTest
+{
+public:
+	// The shader's source follows the #version directive, and can use LOCAL_SIZE and LOG2_LOCAL_SIZE.
+	void test(const char *shaderSource,
+	          std::function<std::vector<uint32_t>(const std::vector<uint32_t> &input, uint32_t localSize)> reference);
+};
+
+void SwiftShaderVulkanComputePhasesTest::test(
+    const char *shaderSource,
+    std::function<std::vector<uint32_t>(const std::vector<uint32_t> &input, uint32_t localSize)> reference)
+{
+	const uint32_t localSize = GetParam().localSizeX;
+	uint32_t log2LocalSize = 0;
+	while((2u << log2LocalSize) <= localSize)
+	{
+		log2LocalSize++;
+	}
+
+	std::string source = "#version 450\n"
+	                     "#extension GL_EXT_control_flow_attributes : require\n"
+	                     "#define LOCAL_SIZE " +
+	                     std::to_string(localSize) + "\n" +
+	                     "#define LOG2_LOCAL_SIZE " + std::to_string(log2LocalSize) + "\n" +
+	                     shaderSource;
+	auto code = Util::compileGLSLtoSPIRV(source.c_str(), EShLanguage::EShLangCompute);
+
+	std::vector<uint32_t> input(GetParam().numElements);
+	for(size_t i = 0; i < input.size(); i++)
+	{
+		input[i] = (static_cast<uint32_t>(i) * 2654435761u) >> 20;
+	}
+
+	const std::vector<uint32_t> expected = reference(input, localSize);
+	const uint32_t groupCount = static_cast<uint32_t>(input.size() / localSize);
+
+	std::vector<uint32_t> coroutineOutput;
+	{
+		Util::ScopedConfiguration configuration("[Processor]\nSplitComputePhases=0");
+		dispatch(code, input, groupCount, coroutineOutput);
+	}
+
+	std::vector<uint32_t> phaseOutput;
+	{
+		Util::ScopedConfiguration configuration("[Processor]\nSplitComputePhases=1");
+		dispatch(code, input, groupCount, phaseOutput);
+	}
+
+	ASSERT_EQ(coroutineOutput.size(), expected.size());
+	ASSERT_EQ(phaseOutput.size(), expected.size());
+
+	for(size_t i = 0; i < expected.size(); i++)
+	{
+		EXPECT_EQ(expected[i], coroutineOutput[i]) << "Unexpected output at " << i << " without phases";
+		EXPECT_EQ(expected[i], phaseOutput[i]) << "Unexpected output at " << i << " with phases";
+	}
+}
+
+INSTANTIATE_TEST_SUITE_P(ComputeParams, SwiftShaderVulkanComputePhasesTest, testing::Values(ComputeParams{ 512, 64, 1, 1 }, ComputeParams{ 512, 32, 1, 1 }, ComputeParams{ 512, 4, 1, 1 }));
+
+// Sums the workgroup's values in shared memory. The unrolled loop has a barrier after each step,
+// so the shader is split into phases. The invocation's index and its own value are used after all
+// the barriers.
+TEST_P(SwiftShaderVulkanComputePhasesTest, Reduction)
+{
+	const char *shader = R"(
+		layout(local_size_x = LOCAL_SIZE) in;
+		layout(binding = 0, std430) buffer InBuffer { uint data[]; } inBuffer;
+		layout(binding = 1, std430) buffer OutBuffer { uint data[]; } outBuffer;
+
+		shared uint partial[LOCAL_SIZE];
+
+		void main()
+		{
+			uint local = gl_LocalInvocationID.x;
+			uint value = inBuffer.data[gl_GlobalInvocationID.x];
+
+			partial[local] = value;
+			barrier();
+
+			[[unroll]] for(int i = 0; i < LOG2_LOCAL_SIZE; i++)
+			{
+				uint stride = uint(LOCAL_SIZE >> (i + 1));
+				if(local < stride)
+				{
+					partial[local] += partial[local + stride];
+				}
+				barrier();
+			}
+
+			outBuffer.data[gl_GlobalInvocationID.x] = partial[0] * 3u + value * local;
+		})";
+
+	test(shader, [](const std::vector<uint32_t> &input, uint32_t localSize) {
+		std::vector<uint32_t> output(input.size());
+		for(size_t group = 0; group < input.size(); group += localSize)
+		{
+			uint32_t sum = 0;
+			for(uint32_t i = 0; i < localSize; i++)
+			{
+				sum += input[group + i];
+			}
+
+			for(uint32_t i = 0; i < localSize; i++)
+			{
+				output[group + i] = sum * 3u + input[group + i] * i;
+			}
+		}
+		return output;
+	});
+}
+
+// Computes the inclusive prefix sum of the workgroup's values in shared memory, with two barriers
+// in each step of an unrolled loop. Odd workgroups then reverse the result, with barriers in a
+// branch which is uniform across the workgroup.
+TEST_P(SwiftShaderVulkanComputePhasesTest, PrefixSum)
+{
+	const char *shader = R"(
+		layout(local_size_x = LOCAL_SIZE) in;
+		layout(binding = 0, std430) buffer InBuffer { uint data[]; } inBuffer;
+		layout(binding = 1, std430) buffer OutBuffer { uint data[]; } outBuffer;
+
+		shared uint scan[LOCAL_SIZE];
+
+		void main()
+		{
+			uint local = gl_LocalInvocationID.x;
+			uint value = inBuffer.data[gl_GlobalInvocationID.x];
+
+			scan[local] = value;
+			barrier();
+
+			[[unroll]] for(int i = 0; i < LOG2_LOCAL_SIZE; i++)
+			{
+				uint offset = 1u << i;
+				uint addend = (local >= offset) ? scan[local - offset] : 0u;
+				barrier();
+				scan[local] += addend;
+				barrier();
+			}
+
+			uint inclusive = scan[local];
+
+			if((gl_WorkGroupID.x & 1u) != 0u)
+			{
+				uint reversed = scan[uint(LOCAL_SIZE - 1) - local];
+				barrier();
+				scan[local] = reversed;
+				barrier();
+			}
+
+			outBuffer.data[gl_GlobalInvocationID.x] = scan[local] * 2u + inclusive - value;
+		})";
+
+	test(shader, [](const std::vector<uint32_t> &input, uint32_t localSize) {
+		std::vector<uint32_t> output(input.size());
+		for(size_t group = 0; group < input.size(); group += localSize)
+		{
+			std::vector<uint32_t> inclusive(localSize);
+			uint32_t sum = 0;
+			for(uint32_t i = 0; i < localSize; i++)
+			{
+				sum += input[group + i];
+				inclusive[i] = sum;
+			}
+
+			bool reversed = ((group / localSize) & 1) != 0;
+			for(uint32_t i = 0; i < localSize; i++)
+			{
+				uint32_t scan = reversed ? inclusive[localSize - 1 - i] : inclusive[i];
+				output[group + i] = scan * 2u + inclusive[i] - input[group + i];
+			}
+		}
+		return output;
+	});
+}
+
+// Repeatedly adds each invocation's neighbor in shared memory, with barriers in a loop whose trip
+// count is only known at run time. Such shaders can't be split into phases, so they must still run
+// as coroutines when the setting is on.
+TEST_P(SwiftShaderVulkanComputePhasesTest, BarrierInLoop)
+{
+	const char *shader = R"(
+		layout(local_size_x = LOCAL_SIZE) in;
+		layout(binding = 0, std430) buffer InBuffer { uint data[]; } inBuffer;
+		layout(binding = 1, std430) buffer OutBuffer { uint data[]; } outBuffer;
+
+		shared uint values[LOCAL_SIZE];
+
+		void main()
+		{
+			uint local = gl_LocalInvocationID.x;
+			values[local] = inBuffer.data[gl_GlobalInvocationID.x];
+
+			uint rounds = inBuffer.data[gl_WorkGroupID.x * uint(LOCAL_SIZE)] % 4u + 1u;
+
+			[[dont_unroll]] for(uint iteration = 0u; iteration < rounds; iteration++)
+			{
+				barrier();
+				uint neighbor = values[(local + 1u) % uint(LOCAL_SIZE)];
+				barrier();
+				values[local] += neighbor;
+			}
+
+			outBuffer.data[gl_GlobalInvocationID.x] = values[local];
+		})";
+
+	test(shader, [](const std::vector<uint32_t> &input, uint32_t localSize) {
+		std::vector<uint32_t> output(input.size());
+		for(size_t group = 0; group < input.size(); group += localSize)
+		{
+			std::vector<uint32_t> values(input.begin() + group, input.begin() + group + localSize);
+			uint32_t rounds = input[group] % 4 + 1;
+
+			for(uint32_t round = 0; round < rounds; round++)
+			{
+				std::vector<uint32_t> next(localSize);
+				for(uint32_t i = 0; i < localSize; i++)
+				{
+					next[i] = values[i] + values[(i + 1) % localSize];
+				}
+				values = next;
+			}
+
+			std::copy(values.begin(), values.end(), output.begin() + group);
+		}
+		return output;
+	});
+}
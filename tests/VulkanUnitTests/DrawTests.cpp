@@ -17,6 +17,14 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
 class DrawTest : public testing::Test
 {
 };
@@ -74,3 +82,1206 @@ TEST_F(DrawTest, VertexShaderNoPositionOutput)
 	tester.initialize();
 	tester.renderFrame();
 }
+
+// Test that indexed draws, whose batches of vertices are deduplicated before shading, give
+// each triangle the outputs of its own vertices. The screen is tiled with quads whose two
+// triangles share the provoking vertex, and the fragment shader records its flat index per
+// pixel. The quads are drawn row by row, so each batch references many vertices repeatedly.
+TEST_F(DrawTest, IndexedVertexDeduplication)
+{
+	// DrawTester renders to a 1280x720 framebuffer, tiled with 16x16 pixel quads.
+	constexpr uint32_t width = 1280;
+	constexpr uint32_t height = 720;
+	constexpr uint32_t quadSize = 16;
+	constexpr uint32_t columns = width / quadSize;
+	constexpr uint32_t rows = height / quadSize;
+
+	DrawTester tester;
+	std::unique_ptr<Buffer> resultBuffer;
+
+	tester.onCreateVertexBuffers([](DrawTester &tester) {
+		struct Vertex
+		{
+			float position[2];
+		};
+
+		std::vector<Vertex> vertexBufferData;
+		for(uint32_t y = 0; y <= rows; y++)
+		{
+			for(uint32_t x = 0; x <= columns; x++)
+			{
+				vertexBufferData.push_back({ { 2.0f * x / columns - 1.0f, 2.0f * y / rows - 1.0f } });
+			}
+		}
+
+		std::vector<uint32_t> indices;
+		for(uint32_t y = 0; y < rows; y++)
+		{
+			for(uint32_t x = 0; x < columns; x++)
+			{
+				uint32_t i = y * (columns + 1) + x;
+				uint32_t quad[6] = { i, i + 1, i + columns + 2, i, i + columns + 2, i + columns + 1 };
+				indices.insert(indices.end(), std::begin(quad), std::end(quad));
+			}
+		}
+
+		std::vector<vk::VertexInputAttributeDescription> inputAttributes;
+		inputAttributes.push_back(vk::VertexInputAttributeDescription(0, 0, vk::Format::eR32G32Sfloat, offsetof(Vertex, position)));
+
+		tester.addVertexBuffer(vertexBufferData.data(), vertexBufferData.size() * sizeof(Vertex), std::move(inputAttributes));
+		tester.addIndexBuffer(indices.data(), indices.size());
+	});
+
+	tester.onCreateDescriptorSetLayouts([](DrawTester &tester) -> std::vector<vk::DescriptorSetLayoutBinding> {
+		vk::DescriptorSetLayoutBinding resultBinding;
+		resultBinding.binding = 0;
+		resultBinding.descriptorCount = 1;
+		resultBinding.descriptorType = vk::DescriptorType::eStorageBuffer;
+		resultBinding.stageFlags = vk::ShaderStageFlagBits::eFragment;
+
+		return { resultBinding };
+	});
+
+	tester.onCreateVertexShader([](DrawTester &tester) {
+		const char *vertexShader = R"(#version 310 es
+			layout(location = 0) in vec2 inPos;
+
+			layout(location = 0) flat out uint outIndex;
+
+			void main()
+			{
+				outIndex = uint(gl_VertexIndex);
+				gl_Position = vec4(inPos, 0.5, 1.0);
+			})";
+
+		return tester.createShaderModule(vertexShader, EShLanguage::EShLangVertex);
+	});
+
+	tester.onCreateFragmentShader([](DrawTester &tester) {
+		const char *fragmentShader = R"(#version 310 es
+			precision highp float;
+
+			layout(location = 0) flat in uint inIndex;
+
+			layout(location = 0) out vec4 outColor;
+
+			layout(std430, binding = 0) buffer Result
+			{
+				uint index[];
+			} result;
+
+			void main()
+			{
+				result.index[uint(gl_FragCoord.y) * 1280u + uint(gl_FragCoord.x)] = inIndex + 1u;
+				outColor = vec4(1.0, 1.0, 1.0, 1.0);
+			})";
+
+		return tester.createShaderModule(fragmentShader, EShLanguage::EShLangFragment);
+	});
+
+	tester.onUpdateDescriptorSet([&resultBuffer](DrawTester &tester, vk::CommandPool &commandPool, vk::DescriptorSet &descriptorSet) {
+		vk::DeviceSize size = width * height * sizeof(uint32_t);
+		resultBuffer = std::make_unique<Buffer>(tester.getDevice(), size, vk::BufferUsageFlagBits::eStorageBuffer);
+
+		vk::DescriptorBufferInfo bufferInfo(resultBuffer->getBuffer(), 0, size);
+
+		vk::WriteDescriptorSet descriptorWrite;
+		descriptorWrite.dstSet = descriptorSet;
+		descriptorWrite.dstBinding = 0;
+		descriptorWrite.descriptorCount = 1;
+		descriptorWrite.descriptorType = vk::DescriptorType::eStorageBuffer;
+		descriptorWrite.pBufferInfo = &bufferInfo;
+
+		tester.getDevice().updateDescriptorSets(1, &descriptorWrite, 0, nullptr);
+	});
+
+	tester.initialize();
+	tester.renderFrame();
+	tester.getQueue().waitIdle();
+
+	// Each pixel must have been shaded with the flat index of its quad's top left vertex.
+	const uint32_t *result = static_cast<const uint32_t *>(resultBuffer->mapMemory());
+	uint32_t mismatches = 0;
+
+	for(uint32_t y = 0; y < height; y++)
+	{
+		for(uint32_t x = 0; x < width; x++)
+		{
+			uint32_t expected = (y / quadSize) * (columns + 1) + (x / quadSize) + 1;
+			mismatches += (result[y * width + x] != expected) ? 1 : 0;
+		}
+	}
+
+	resultBuffer->unmapMemory();
+
+	EXPECT_EQ(mismatches, 0u);
+}
+
+namespace {
+
+struct BlendEquation
+{
+	vk::BlendOp colorOp;
+	vk::BlendFactor srcColorFactor;
+	vk::BlendFactor dstColorFactor;
+	vk::BlendOp alphaOp;
+	vk::BlendFactor srcAlphaFactor;
+	vk::BlendFactor dstAlphaFactor;
+};
+
+// Source color of each layer of the blending tests, as 8-bit normalized components. Must match the fragment shader.
+void blendTestSourceColor(uint32_t x, uint32_t y, uint32_t layer, uint32_t color[4])
+{
+	color[0] = (x * 7 + layer * 31) & 255;
+	color[1] = (y * 13 + layer * 17) & 255;
+	color[2] = (x + y + layer * 101) & 255;
+	color[3] = (x * 3 + y * 5 + layer * 53) & 255;
+}
+
+uint32_t referenceBlendFactor(vk::BlendFactor factor, const uint32_t src[4], const uint32_t dst[4], int component)
+{
+	switch(factor)
+	{
+	case vk::BlendFactor::eZero: return 0;
+	case vk::BlendFactor::eOne: return 255;
+	case vk::BlendFactor::eSrcColor: return src[component];
+	case vk::BlendFactor::eOneMinusSrcColor: return 255 - src[component];
+	case vk::BlendFactor::eDstColor: return dst[component];
+	case vk::BlendFactor::eOneMinusDstColor: return 255 - dst[component];
+	case vk::BlendFactor::eSrcAlpha: return src[3];
+	case vk::BlendFactor::eOneMinusSrcAlpha: return 255 - src[3];
+	case vk::BlendFactor::eDstAlpha: return dst[3];
+	case vk::BlendFactor::eOneMinusDstAlpha: return 255 - dst[3];
+	case vk::BlendFactor::eSrcAlphaSaturate: return (component == 3) ? 255 : std::min(src[3], 255 - dst[3]);
+	default:
+		ADD_FAILURE() << "Unexpected blend factor";
+		return 0;
+	}
+}
+
+// Blends 8-bit normalized values exactly, and rounds the result to 8-bit.
+uint32_t referenceBlend(vk::BlendOp op, vk::BlendFactor srcFactor, vk::BlendFactor dstFactor, const uint32_t src[4], const uint32_t dst[4], int component)
+{
+	int64_t s = src[component] * referenceBlendFactor(srcFactor, src, dst, component);
+	int64_t d = dst[component] * referenceBlendFactor(dstFactor, src, dst, component);
+	int64_t blended = (op == vk::BlendOp::eAdd) ? s + d : (op == vk::BlendOp::eSubtract) ? s - d : d - s;
+	blended = std::min(std::max(blended, int64_t(0)), int64_t(255 * 255));
+
+	// The exact result is never halfway between two 8-bit values.
+	return static_cast<uint32_t>((blended + 127) / 255);
+}
+
+// Draws several full-screen layers with the given blend equation onto an 8-bit normalized color
+// attachment, and compares each pixel with the exactly blended 8-bit components.
+void TestBlendEquation(const BlendEquation &equation)
+{
+	constexpr uint32_t size = 256;
+	constexpr uint32_t layers = 4;
+	const uint32_t clearColor[4] = { 64, 128, 192, 160 };
+
+	DrawTester tester;
+	tester.setOffscreenTarget(vk::Extent2D(size, size), vk::Format::eR8G8B8A8Unorm,
+	                          vk::ClearColorValue(std::array<float, 4>{ clearColor[0] / 255.0f, clearColor[1] / 255.0f, clearColor[2] / 255.0f, clearColor[3] / 255.0f }));
+
+	tester.onCreateVertexBuffers([](DrawTester &tester) {
+		struct Vertex
+		{
+			float position[2];
+			int32_t layer;
+		};
+
+		const float corners[6][2] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { -1.0f, 1.0f }, { -1.0f, 1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f } };
+
+		std::vector<Vertex> vertexBufferData;
+		for(int32_t layer = 0; layer < int32_t(layers); layer++)
+		{
+			for(auto &corner : corners)
+			{
+				vertexBufferData.push_back({ { corner[0], corner[1] }, layer });
+			}
+		}
+
+		std::vector<vk::VertexInputAttributeDescription> inputAttributes;
+		inputAttributes.push_back(vk::VertexInputAttributeDescription(0, 0, vk::Format::eR32G32Sfloat, offsetof(Vertex, position)));
+		inputAttributes.push_back(vk::VertexInputAttributeDescription(1, 0, vk::Format::eR32Sint, offsetof(Vertex, layer)));
+
+		tester.addVertexBuffer(vertexBufferData.data(), vertexBufferData.size() * sizeof(Vertex), std::move(inputAttributes));
+	});
+
+	tester.onCreateVertexShader([](DrawTester &tester) {
+		const char *vertexShader = R"(#version 310 es
+			layout(location = 0) in vec2 inPos;
+			layout(location = 1) in int inLayer;
+
+			layout(location = 0) flat out int outLayer;
+
+			void main()
+			{
+				outLayer = inLayer;
+				gl_Position = vec4(inPos, 0.5, 1.0);
+			})";
+
+		return tester.createShaderModule(vertexShader, EShLanguage::EShLangVertex);
+	});
+
+	tester.onCreateFragmentShader([](DrawTester &tester) {
+		const char *fragmentShader = R"(#version 310 es
+			precision highp float;
+
+			layout(location = 0) flat in int inLayer;
+
+			layout(location = 0) out vec4 outColor;
+
+			void main()
+			{
+				uvec2 p = uvec2(gl_FragCoord.xy);
+				uint layer = uint(inLayer);
+				uvec4 c = (uvec4(p.x * 7u, p.y * 13u, p.x + p.y, p.x * 3u + p.y * 5u) + layer * uvec4(31u, 17u, 101u, 53u)) & 255u;
+				outColor = vec4(c) / 255.0;
+			})";
+
+		return tester.createShaderModule(fragmentShader, EShLanguage::EShLangFragment);
+	});
+
+	tester.onCreateColorBlendAttachmentState([&equation](DrawTester &tester, vk::PipelineColorBlendAttachmentState &blendAttachmentState) {
+		blendAttachmentState.blendEnable = VK_TRUE;
+		blendAttachmentState.srcColorBlendFactor = equation.srcColorFactor;
+		blendAttachmentState.dstColorBlendFactor = equation.dstColorFactor;
+		blendAttachmentState.colorBlendOp = equation.colorOp;
+		blendAttachmentState.srcAlphaBlendFactor = equation.srcAlphaFactor;
+		blendAttachmentState.dstAlphaBlendFactor = equation.dstAlphaFactor;
+		blendAttachmentState.alphaBlendOp = equation.alphaOp;
+	});
+
+	tester.initialize();
+	tester.renderFrame();
+
+	std::vector<uint32_t> pixels = tester.readPixels();
+	uint32_t mismatches = 0;
+
+	for(uint32_t y = 0; y < size; y++)
+	{
+		for(uint32_t x = 0; x < size; x++)
+		{
+			uint32_t dst[4] = { clearColor[0], clearColor[1], clearColor[2], clearColor[3] };
+
+			for(uint32_t layer = 0; layer < layers; layer++)
+			{
+				uint32_t src[4];
+				blendTestSourceColor(x, y, layer, src);
+
+				uint32_t blended[4];
+				for(int c = 0; c < 3; c++)
+				{
+					blended[c] = referenceBlend(equation.colorOp, equation.srcColorFactor, equation.dstColorFactor, src, dst, c);
+				}
+				blended[3] = referenceBlend(equation.alphaOp, equation.srcAlphaFactor, equation.dstAlphaFactor, src, dst, 3);
+
+				std::copy(std::begin(blended), std::end(blended), std::begin(dst));
+			}
+
+			uint32_t expected = dst[0] | (dst[1] << 8) | (dst[2] << 16) | (dst[3] << 24);
+			mismatches += (pixels[y * size + x] != expected) ? 1 : 0;
+		}
+	}
+
+	EXPECT_EQ(mismatches, 0u);
+}
+
+}  // anonymous namespace
+
+// Test that blending 8-bit normalized color attachments, which SwiftShader performs in fixed-point
+// arithmetic for these equations, gives the exactly rounded result of the floating-point equations
+// when the source colors are multiples of 1/255.
+TEST_F(DrawTest, BlendUnorm8AlphaBlending)
+{
+	TestBlendEquation({ vk::BlendOp::eAdd, vk::BlendFactor::eSrcAlpha, vk::BlendFactor::eOneMinusSrcAlpha,
+	                    vk::BlendOp::eAdd, vk::BlendFactor::eOne, vk::BlendFactor::eOneMinusSrcAlpha });
+}
+
+TEST_F(DrawTest, BlendUnorm8Additive)
+{
+	TestBlendEquation({ vk::BlendOp::eAdd, vk::BlendFactor::eOne, vk::BlendFactor::eOne,
+	                    vk::BlendOp::eAdd, vk::BlendFactor::eOne, vk::BlendFactor::eOne });
+}
+
+TEST_F(DrawTest, BlendUnorm8Subtract)
+{
+	TestBlendEquation({ vk::BlendOp::eSubtract, vk::BlendFactor::eSrcColor, vk::BlendFactor::eOneMinusDstAlpha,
+	                    vk::BlendOp::eSubtract, vk::BlendFactor::eOne, vk::BlendFactor::eDstAlpha });
+}
+
+TEST_F(DrawTest, BlendUnorm8ReverseSubtract)
+{
+	TestBlendEquation({ vk::BlendOp::eReverseSubtract, vk::BlendFactor::eDstColor, vk::BlendFactor::eOneMinusSrcColor,
+	                    vk::BlendOp::eReverseSubtract, vk::BlendFactor::eSrcAlpha, vk::BlendFactor::eOne });
+}
+
+TEST_F(DrawTest, BlendUnorm8AlphaSaturate)
+{
+	TestBlendEquation({ vk::BlendOp::eAdd, vk::BlendFactor::eSrcAlphaSaturate, vk::BlendFactor::eOneMinusDstColor,
+	                    vk::BlendOp::eAdd, vk::BlendFactor::eSrcAlphaSaturate, vk::BlendFactor::eZero });
+}
+
+// Test that 16-bit values are passed between shader stages. The vertex shader outputs half-floats,
+// which get interpolated, and flat 16-bit integers whose sign or zero extension is observable. The
+// fragment shader writes them to a storage buffer, and outputs the half-floats as its color.
+TEST_F(DrawTest, InputOutput16Bit)
+{
+	constexpr uint32_t size = 256;
+	const int32_t integers[4] = { -12345, -1, 65535, 40000 };
+
+	struct Texel
+	{
+		float color[4];
+		int32_t signedValues[2];
+		uint32_t unsignedValues[2];
+	};
+
+	DrawTester tester;
+	std::unique_ptr<Buffer> resultBuffer;
+
+	tester.setOffscreenTarget(vk::Extent2D(size, size), vk::Format::eR8G8B8A8Unorm,
+	                          vk::ClearColorValue(std::array<float, 4>{ 0.0f, 0.0f, 0.0f, 0.0f }));
+
+	tester.onCreateVertexBuffers([&integers](DrawTester &tester) {
+		struct Vertex
+		{
+			float position[2];
+			int32_t integers[4];
+		};
+
+		const float corners[6][2] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { -1.0f, 1.0f }, { -1.0f, 1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f } };
+
+		std::vector<Vertex> vertexBufferData;
+		for(auto &corner : corners)
+		{
+			vertexBufferData.push_back({ { corner[0], corner[1] }, { integers[0], integers[1], integers[2], integers[3] } });
+		}
+
+		std::vector<vk::VertexInputAttributeDescription> inputAttributes;
+		inputAttributes.push_back(vk::VertexInputAttributeDescription(0, 0, vk::Format::eR32G32Sfloat, offsetof(Vertex, position)));
+		inputAttributes.push_back(vk::VertexInputAttributeDescription(1, 0, vk::Format::eR32G32B32A32Sint, offsetof(Vertex, integers)));
+
+		tester.addVertexBuffer(vertexBufferData.data(), vertexBufferData.size() * sizeof(Vertex), std::move(inputAttributes));
+	});
+
+	tester.onCreateDescriptorSetLayouts([](DrawTester &tester) -> std::vector<vk::DescriptorSetLayoutBinding> {
+		vk::DescriptorSetLayoutBinding resultBinding;
+		resultBinding.binding = 0;
+		resultBinding.descriptorCount = 1;
+		resultBinding.descriptorType = vk::DescriptorType::eStorageBuffer;
+		resultBinding.stageFlags = vk::ShaderStageFlagBits::eFragment;
+
+		return { resultBinding };
+	});
+
+	tester.onCreateVertexShader([](DrawTester &tester) {
+		const char *vertexShader = R"(#version 450
+			#extension GL_EXT_shader_explicit_arithmetic_types : require
+
+			layout(location = 0) in vec2 inPos;
+			layout(location = 1) in ivec4 inIntegers;
+
+			layout(location = 0) out f16vec4 outColor;
+			layout(location = 1) flat out i16vec2 outSigned;
+			layout(location = 2) flat out u16vec2 outUnsigned;
+
+			void main()
+			{
+				outColor = f16vec4(inPos * 0.5 + 0.5, -0.75, 1.0);
+				outSigned = i16vec2(inIntegers.xy);
+				outUnsigned = u16vec2(inIntegers.zw);
+				gl_Position = vec4(inPos, 0.5, 1.0);
+			})";
+
+		return tester.createShaderModule(vertexShader, EShLanguage::EShLangVertex);
+	});
+
+	tester.onCreateFragmentShader([](DrawTester &tester) {
+		const char *fragmentShader = R"(#version 450
+			#extension GL_EXT_shader_explicit_arithmetic_types : require
+
+			layout(location = 0) in f16vec4 inColor;
+			layout(location = 1) flat in i16vec2 inSigned;
+			layout(location = 2) flat in u16vec2 inUnsigned;
+
+			layout(location = 0) out f16vec4 outColor;
+
+			struct Texel
+			{
+				vec4 color;
+				ivec2 signedValues;
+				uvec2 unsignedValues;
+			};
+
+			layout(std430, binding = 0) buffer Result
+			{
+				Texel texel[];
+			} result;
+
+			void main()
+			{
+				uint i = uint(gl_FragCoord.y) * 256u + uint(gl_FragCoord.x);
+				result.texel[i].color = vec4(inColor);
+				result.texel[i].signedValues = ivec2(inSigned);
+				result.texel[i].unsignedValues = uvec2(inUnsigned);
+				outColor = inColor;
+			})";
+
+		return tester.createShaderModule(fragmentShader, EShLanguage::EShLangFragment);
+	});
+
+	tester.onUpdateDescriptorSet([&resultBuffer](DrawTester &tester, vk::CommandPool &commandPool, vk::DescriptorSet &descriptorSet) {
+		vk::DeviceSize bufferSize = size * size * sizeof(Texel);
+		resultBuffer = std::make_unique<Buffer>(tester.getDevice(), bufferSize, vk::BufferUsageFlagBits::eStorageBuffer);
+
+		vk::DescriptorBufferInfo bufferInfo(resultBuffer->getBuffer(), 0, bufferSize);
+
+		vk::WriteDescriptorSet descriptorWrite;
+		descriptorWrite.dstSet = descriptorSet;
+		descriptorWrite.dstBinding = 0;
+		descriptorWrite.descriptorCount = 1;
+		descriptorWrite.descriptorType = vk::DescriptorType::eStorageBuffer;
+		descriptorWrite.pBufferInfo = &bufferInfo;
+
+		tester.getDevice().updateDescriptorSets(1, &descriptorWrite, 0, nullptr);
+	});
+
+	tester.initialize();
+	tester.renderFrame();
+
+	std::vector<uint32_t> pixels = tester.readPixels();
+	const Texel *result = static_cast<const Texel *>(resultBuffer->mapMemory());
+	uint32_t mismatches = 0;
+
+	for(uint32_t y = 0; y < size; y++)
+	{
+		for(uint32_t x = 0; x < size; x++)
+		{
+			// The interpolated position, with the precision of half-floats in [0, 1].
+			const float expected[2] = { (x + 0.5f) / size, (y + 0.5f) / size };
+			const float tolerance = 1.0f / 1024.0f;
+
+			const Texel &texel = result[y * size + x];
+			bool match = std::abs(texel.color[0] - expected[0]) <= tolerance &&
+			             std::abs(texel.color[1] - expected[1]) <= tolerance &&
+			             std::abs(texel.color[2] - -0.75f) <= tolerance &&
+			             std::abs(texel.color[3] - 1.0f) <= tolerance &&
+			             texel.signedValues[0] == integers[0] &&
+			             texel.signedValues[1] == integers[1] &&
+			             texel.unsignedValues[0] == uint32_t(integers[2]) &&
+			             texel.unsignedValues[1] == uint32_t(integers[3]);
+
+			// The 16-bit color output is stored to the 8-bit normalized attachment, which clamps the blue component to zero.
+			uint32_t pixel = pixels[y * size + x];
+			for(int c = 0; c < 2; c++)
+			{
+				int component = (pixel >> (8 * c)) & 0xFF;
+				match = match && std::abs(component - int(expected[c] * 255.0f + 0.5f)) <= 1;
+			}
+			match = match && (pixel >> 16) == 0xFF00;
+
+			mismatches += match ? 0 : 1;
+		}
+	}
+
+	resultBuffer->unmapMemory();
+
+	EXPECT_EQ(mismatches, 0u);
+}
+
+namespace {
+
+// Vertex coordinates of the rasterization tests are in units of 1/16th of a pixel, which both the
+// legacy and the default subpixel precision represent exactly.
+constexpr int32_t rasterSubpixels = 16;
+
+struct RasterTriangle
+{
+	int32_t x[3];
+	int32_t y[3];
+};
+
+// Returns whether the center of pixel (x, y) is covered by the triangle. Samples exactly on an edge
+// are covered when it is a left edge, or a horizontal top edge.
+bool referenceCoverage(const RasterTriangle &triangle, int64_t x, int64_t y)
+{
+	int64_t px = x * rasterSubpixels + rasterSubpixels / 2;
+	int64_t py = y * rasterSubpixels + rasterSubpixels / 2;
+
+	auto edge = [&triangle](int a, int b, int64_t sx, int64_t sy) {
+		return int64_t(triangle.y[b] - triangle.y[a]) * (sx - triangle.x[a]) -
+		       int64_t(triangle.x[b] - triangle.x[a]) * (sy - triangle.y[a]);
+	};
+
+	int64_t area = edge(0, 1, triangle.x[2], triangle.y[2]);
+	if(area == 0)
+	{
+		return false;
+	}
+
+	// Orient the edges so that the inside of the triangle is on their positive side.
+	int order[3] = { 0, 1, 2 };
+	if(area < 0)
+	{
+		std::swap(order[1], order[2]);
+	}
+
+	for(int i = 0; i < 3; i++)
+	{
+		int a = order[i];
+		int b = order[(i + 1) % 3];
+		int32_t dx = triangle.x[b] - triangle.x[a];
+		int32_t dy = triangle.y[b] - triangle.y[a];
+		bool inclusive = (dy > 0) || (dy == 0 && dx < 0);
+
+		int64_t e = edge(a, b, px, py);
+		if(e < 0 || (e == 0 && !inclusive))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Fragment color of the rasterization tests, as 8-bit normalized components. Must match the fragment shader.
+void rasterTestColor(uint32_t x, uint32_t y, uint32_t triangle, uint32_t color[4])
+{
+	color[0] = 1;
+	color[1] = triangle + 1;
+	color[2] = (x + y) & 255;
+	color[3] = (y >> 6) & 255;
+}
+
+// Draws the triangles with additive blending onto a cleared 8-bit normalized color attachment, so
+// that each pixel holds the sum of the colors of the fragments covering it, and returns the pixels.
+// The extent must be a power of two, so the vertex coordinates are exact in normalized device coordinates.
+std::vector<uint32_t> drawRasterTest(vk::Extent2D extent, const std::vector<RasterTriangle> &triangles)
+{
+	EXPECT_LT(triangles.size(), 255u);
+
+	DrawTester tester;
+	tester.setOffscreenTarget(extent, vk::Format::eR8G8B8A8Unorm,
+	                          vk::ClearColorValue(std::array<float, 4>{ 0.0f, 0.0f, 0.0f, 0.0f }));
+
+	tester.onCreateVertexBuffers([extent, &triangles](DrawTester &tester) {
+		struct Vertex
+		{
+			float position[2];
+			int32_t triangle;
+		};
+
+		const float scaleX = 2.0f / float(extent.width * rasterSubpixels);
+		const float scaleY = 2.0f / float(extent.height * rasterSubpixels);
+
+		std::vector<Vertex> vertexBufferData;
+		for(int32_t i = 0; i < int32_t(triangles.size()); i++)
+		{
+			for(int v = 0; v < 3; v++)
+			{
+				vertexBufferData.push_back({ { float(triangles[i].x[v]) * scaleX - 1.0f, float(triangles[i].y[v]) * scaleY - 1.0f }, i });
+			}
+		}
+
+		std::vector<vk::VertexInputAttributeDescription> inputAttributes;
+		inputAttributes.push_back(vk::VertexInputAttributeDescription(0, 0, vk::Format::eR32G32Sfloat, offsetof(Vertex, position)));
+		inputAttributes.push_back(vk::VertexInputAttributeDescription(1, 0, vk::Format::eR32Sint, offsetof(Vertex, triangle)));
+
+		tester.addVertexBuffer(vertexBufferData.data(), vertexBufferData.size() * sizeof(Vertex), std::move(inputAttributes));
+	});
+
+	tester.onCreateVertexShader([](DrawTester &tester) {
+		const char *vertexShader = R"(#version 310 es
+			layout(location = 0) in vec2 inPos;
+			layout(location = 1) in int inTriangle;
+
+			layout(location = 0) flat out int outTriangle;
+
+			void main()
+			{
+				outTriangle = inTriangle;
+				gl_Position = vec4(inPos, 0.5, 1.0);
+			})";
+
+		return tester.createShaderModule(vertexShader, EShLanguage::EShLangVertex);
+	});
+
+	tester.onCreateFragmentShader([](DrawTester &tester) {
+		const char *fragmentShader = R"(#version 310 es
+			precision highp float;
+
+			layout(location = 0) flat in int inTriangle;
+
+			layout(location = 0) out vec4 outColor;
+
+			void main()
+			{
+				uvec2 p = uvec2(gl_FragCoord.xy);
+				uvec4 c = uvec4(1u, uint(inTriangle) + 1u, (p.x + p.y) & 255u, (p.y >> 6) & 255u);
+				outColor = vec4(c) / 255.0;
+			})";
+
+		return tester.createShaderModule(fragmentShader, EShLanguage::EShLangFragment);
+	});
+
+	tester.onCreateColorBlendAttachmentState([](DrawTester &tester, vk::PipelineColorBlendAttachmentState &blendAttachmentState) {
+		blendAttachmentState.blendEnable = VK_TRUE;
+		blendAttachmentState.srcColorBlendFactor = vk::BlendFactor::eOne;
+		blendAttachmentState.dstColorBlendFactor = vk::BlendFactor::eOne;
+		blendAttachmentState.colorBlendOp = vk::BlendOp::eAdd;
+		blendAttachmentState.srcAlphaBlendFactor = vk::BlendFactor::eOne;
+		blendAttachmentState.dstAlphaBlendFactor = vk::BlendFactor::eOne;
+		blendAttachmentState.alphaBlendOp = vk::BlendOp::eAdd;
+	});
+
+	tester.initialize();
+	tester.renderFrame();
+
+	return tester.readPixels();
+}
+
+// Counts the pixels which differ from the sum of the colors of the triangles covering them.
+uint32_t countCoverageMismatches(vk::Extent2D extent, const std::vector<RasterTriangle> &triangles, const std::vector<uint32_t> &pixels)
+{
+	uint32_t mismatches = 0;
+
+	for(uint32_t y = 0; y < extent.height; y++)
+	{
+		for(uint32_t x = 0; x < extent.width; x++)
+		{
+			uint32_t sum[4] = { 0, 0, 0, 0 };
+
+			for(uint32_t i = 0; i < triangles.size(); i++)
+			{
+				if(referenceCoverage(triangles[i], x, y))
+				{
+					uint32_t color[4];
+					rasterTestColor(x, y, i, color);
+
+					for(int c = 0; c < 4; c++)
+					{
+						sum[c] = std::min(sum[c] + color[c], 255u);
+					}
+				}
+			}
+
+			uint32_t expected = sum[0] | (sum[1] << 8) | (sum[2] << 16) | (sum[3] << 24);
+			mismatches += (pixels[y * extent.width + x] != expected) ? 1 : 0;
+		}
+	}
+
+	return mismatches;
+}
+
+// Counts the pixels which weren't covered by exactly one fragment.
+uint32_t countOverlapsAndGaps(const std::vector<uint32_t> &pixels)
+{
+	return static_cast<uint32_t>(std::count_if(pixels.begin(), pixels.end(), [](uint32_t pixel) { return (pixel & 0xFF) != 1; }));
+}
+
+// Returns the triangle with the given vertices, in pixel coordinates.
+RasterTriangle pixelTriangle(float x0, float y0, float x1, float y1, float x2, float y2)
+{
+	auto subpixels = [](float coordinate) { return int32_t(coordinate * rasterSubpixels); };
+
+	return { { subpixels(x0), subpixels(x1), subpixels(x2) }, { subpixels(y0), subpixels(y1), subpixels(y2) } };
+}
+
+}  // anonymous namespace
+
+// Test the fill convention of the edge equations, with pairs of triangles whose shared edges and
+// outer edges pass exactly through pixel centers. Samples on a left edge or a horizontal top edge
+// are covered, and those on the shared edges are covered by exactly one triangle of each pair.
+TEST_F(DrawTest, RasterizerTopLeftFillRule)
+{
+	const vk::Extent2D extent(64, 64);
+
+	const std::vector<RasterTriangle> triangles = {
+		// Diagonal from the bottom left to the top right, with both windings.
+		pixelTriangle(0.5f, 0.5f, 8.5f, 0.5f, 0.5f, 8.5f),
+		pixelTriangle(8.5f, 8.5f, 0.5f, 8.5f, 8.5f, 0.5f),
+		pixelTriangle(16.5f, 0.5f, 16.5f, 8.5f, 24.5f, 0.5f),
+		pixelTriangle(24.5f, 8.5f, 24.5f, 0.5f, 16.5f, 8.5f),
+
+		// Diagonal from the top left to the bottom right.
+		pixelTriangle(32.5f, 0.5f, 40.5f, 0.5f, 40.5f, 8.5f),
+		pixelTriangle(32.5f, 0.5f, 40.5f, 8.5f, 32.5f, 8.5f),
+
+		// Vertices on pixel corners, with the diagonal through pixel centers.
+		pixelTriangle(48.0f, 0.0f, 56.0f, 0.0f, 48.0f, 8.0f),
+		pixelTriangle(56.0f, 8.0f, 48.0f, 8.0f, 56.0f, 0.0f),
+
+		// Shallow and steep shared edges.
+		pixelTriangle(0.5f, 16.5f, 16.5f, 24.5f, 0.5f, 24.5f),
+		pixelTriangle(0.5f, 16.5f, 16.5f, 16.5f, 16.5f, 24.5f),
+		pixelTriangle(24.5f, 16.5f, 28.5f, 32.5f, 24.5f, 32.5f),
+		pixelTriangle(24.5f, 16.5f, 28.5f, 16.5f, 28.5f, 32.5f),
+
+		// A fan around a vertex on a pixel center, with edges through pixel centers in all directions.
+		pixelTriangle(48.5f, 48.5f, 40.5f, 40.5f, 48.5f, 40.5f),
+		pixelTriangle(48.5f, 48.5f, 48.5f, 40.5f, 56.5f, 40.5f),
+		pixelTriangle(48.5f, 48.5f, 56.5f, 40.5f, 56.5f, 48.5f),
+		pixelTriangle(48.5f, 48.5f, 56.5f, 48.5f, 56.5f, 56.5f),
+		pixelTriangle(48.5f, 48.5f, 56.5f, 56.5f, 48.5f, 56.5f),
+		pixelTriangle(48.5f, 48.5f, 48.5f, 56.5f, 40.5f, 56.5f),
+		pixelTriangle(48.5f, 48.5f, 40.5f, 56.5f, 40.5f, 48.5f),
+		pixelTriangle(48.5f, 48.5f, 40.5f, 48.5f, 40.5f, 40.5f),
+	};
+
+	std::vector<uint32_t> pixels = drawRasterTest(extent, triangles);
+
+	EXPECT_EQ(countCoverageMismatches(extent, triangles, pixels), 0u);
+}
+
+// Test that a mesh of triangles with shared edges at arbitrary subpixel positions, which covers the
+// whole target, covers every pixel exactly once.
+TEST_F(DrawTest, RasterizerSharedEdges)
+{
+	const vk::Extent2D extent(64, 64);
+	constexpr int32_t cells = 8;
+	constexpr int32_t cellSize = 8 * rasterSubpixels;
+
+	// Grid vertices, with the interior ones moved by up to 3 pixels.
+	int32_t vertexX[cells + 1][cells + 1];
+	int32_t vertexY[cells + 1][cells + 1];
+	uint32_t seed = 1;
+	for(int32_t j = 0; j <= cells; j++)
+	{
+		for(int32_t i = 0; i <= cells; i++)
+		{
+			vertexX[j][i] = i * cellSize;
+			vertexY[j][i] = j * cellSize;
+
+			if(i > 0 && i < cells && j > 0 && j < cells)
+			{
+				seed = seed * 1103515245 + 12345;
+				vertexX[j][i] += int32_t((seed >> 8) % 97) - 48;
+				seed = seed * 1103515245 + 12345;
+				vertexY[j][i] += int32_t((seed >> 8) % 97) - 48;
+			}
+		}
+	}
+
+	std::vector<RasterTriangle> triangles;
+	for(int32_t j = 0; j < cells; j++)
+	{
+		for(int32_t i = 0; i < cells; i++)
+		{
+			// Alternate the diagonal which splits each cell, and the winding of the triangles.
+			static const int32_t splits[2][2][3][2] = {
+				{ { { 0, 0 }, { 1, 0 }, { 1, 1 } }, { { 0, 0 }, { 0, 1 }, { 1, 1 } } },
+				{ { { 1, 0 }, { 0, 1 }, { 0, 0 } }, { { 1, 0 }, { 1, 1 }, { 0, 1 } } },
+			};
+
+			for(auto &corners : splits[(i + j) % 2])
+			{
+				RasterTriangle triangle;
+				for(int k = 0; k < 3; k++)
+				{
+					triangle.x[k] = vertexX[j + corners[k][1]][i + corners[k][0]];
+					triangle.y[k] = vertexY[j + corners[k][1]][i + corners[k][0]];
+				}
+				triangles.push_back(triangle);
+			}
+		}
+	}
+
+	std::vector<uint32_t> pixels = drawRasterTest(extent, triangles);
+
+	EXPECT_EQ(countOverlapsAndGaps(pixels), 0u);
+	EXPECT_EQ(countCoverageMismatches(extent, triangles, pixels), 0u);
+}
+
+// Test sliver triangles, which are narrower than a pixel over their whole length, or smaller than
+// a pixel. Their coverage depends on samples close to or exactly on their edges.
+TEST_F(DrawTest, RasterizerSlivers)
+{
+	const vk::Extent2D extent(64, 64);
+	std::vector<RasterTriangle> triangles;
+
+	for(int32_t k = 0; k < 8; k++)
+	{
+		// Horizontal slivers along rows of pixel centers, up to 7/16th of a pixel wide. The first is degenerate.
+		int32_t y = 2 * k * rasterSubpixels + rasterSubpixels / 2;
+		RasterTriangle horizontal = { { 8, 1016, 1016 }, { y, y + k, y } };
+		if(k % 2 == 1)
+		{
+			std::swap(horizontal.x[1], horizontal.x[2]);
+			std::swap(horizontal.y[1], horizontal.y[2]);
+		}
+		triangles.push_back(horizontal);
+
+		// Vertical slivers along columns of pixel centers.
+		int32_t x = 2 * k * rasterSubpixels + rasterSubpixels / 2;
+		RasterTriangle vertical = { { x, x + k, x }, { 264, 1016, 1016 } };
+		if(k % 2 == 0)
+		{
+			std::swap(vertical.x[1], vertical.x[2]);
+			std::swap(vertical.y[1], vertical.y[2]);
+		}
+		triangles.push_back(vertical);
+	}
+
+	// Diagonal slivers, with one edge through pixel centers.
+	for(int32_t k = 0; k < 4; k++)
+	{
+		int32_t x = 336 + 80 * k;
+		triangles.push_back({ { x, x + 400, x + 400 + 3 * (k + 1) }, { 336, 736, 736 } });
+	}
+
+	// Triangles smaller than a pixel, which may or may not contain its center.
+	for(int32_t k = 0; k < 11; k++)
+	{
+		int32_t x = 320 + 64 * k;
+		int32_t y = 264;
+		triangles.push_back({ { x + k, x + 14, x + 3 }, { y + 2, y + 8, y + 15 - k } });
+	}
+
+	std::vector<uint32_t> pixels = drawRasterTest(extent, triangles);
+
+	EXPECT_EQ(countCoverageMismatches(extent, triangles, pixels), 0u);
+}
+
+// Test rendering to a target of the maximum framebuffer height, well beyond the previous limit of
+// 8192 rows. Two triangles split the target along a long diagonal.
+TEST_F(DrawTest, RasterizerMaximumHeight)
+{
+	const vk::Extent2D extent(16, 16384);
+	const int32_t width = int32_t(extent.width) * rasterSubpixels;
+	const int32_t height = int32_t(extent.height) * rasterSubpixels;
+
+	const std::vector<RasterTriangle> triangles = {
+		{ { 0, width, 0 }, { 0, 0, height } },
+		{ { width, width, 0 }, { 0, height, height } },
+	};
+
+	std::vector<uint32_t> pixels = drawRasterTest(extent, triangles);
+
+	EXPECT_EQ(countOverlapsAndGaps(pixels), 0u);
+	EXPECT_EQ(countCoverageMismatches(extent, triangles, pixels), 0u);
+}
+
+namespace {
+
+// Draws the vertices with a vertex shader which writes its inputs to a storage buffer, indexed by
+// gl_VertexIndex, and returns the contents of that buffer. The primitives are degenerate, so none
+// get rasterized. Without robust buffer access, the attributes of a binding are fetched together
+// from whole vertex records. With it, each attribute is fetched and bounds checked separately.
+template<typename Result, typename Vertex>
+std::vector<Result> fetchVertexAttributes(const std::vector<Vertex> &vertices, const std::vector<vk::VertexInputAttributeDescription> &inputAttributes,
+                                          const char *vertexShader, bool robustBufferAccess, size_t guardSize = 0, uint8_t guardValue = 0)
+{
+	EXPECT_EQ(vertices.size() % 3, 0u);
+
+	DrawTester tester;
+	std::unique_ptr<Buffer> resultBuffer;
+	const vk::DeviceSize bufferSize = vertices.size() * sizeof(Result);
+
+	if(robustBufferAccess)
+	{
+		tester.enableRobustBufferAccess();
+	}
+
+	tester.setOffscreenTarget(vk::Extent2D(16, 16), vk::Format::eR8G8B8A8Unorm,
+	                          vk::ClearColorValue(std::array<float, 4>{ 0.0f, 0.0f, 0.0f, 0.0f }));
+
+	tester.onCreateVertexBuffers([&](DrawTester &tester) {
+		std::vector<Vertex> vertexBufferData = vertices;
+
+		tester.setVertexBufferGuard(guardSize, guardValue);
+		tester.addVertexBuffer(vertexBufferData.data(), vertexBufferData.size() * sizeof(Vertex), inputAttributes);
+	});
+
+	tester.onCreateDescriptorSetLayouts([](DrawTester &tester) -> std::vector<vk::DescriptorSetLayoutBinding> {
+		vk::DescriptorSetLayoutBinding resultBinding;
+		resultBinding.binding = 0;
+		resultBinding.descriptorCount = 1;
+		resultBinding.descriptorType = vk::DescriptorType::eStorageBuffer;
+		resultBinding.stageFlags = vk::ShaderStageFlagBits::eVertex;
+
+		return { resultBinding };
+	});
+
+	tester.onCreateVertexShader([vertexShader](DrawTester &tester) {
+		return tester.createShaderModule(vertexShader, EShLanguage::EShLangVertex);
+	});
+
+	tester.onCreateFragmentShader([](DrawTester &tester) {
+		const char *fragmentShader = R"(#version 310 es
+			precision highp float;
+
+			layout(location = 0) out vec4 outColor;
+
+			void main()
+			{
+				outColor = vec4(1.0);
+			})";
+
+		return tester.createShaderModule(fragmentShader, EShLanguage::EShLangFragment);
+	});
+
+	tester.onUpdateDescriptorSet([&resultBuffer, bufferSize](DrawTester &tester, vk::CommandPool &commandPool, vk::DescriptorSet &descriptorSet) {
+		resultBuffer = std::make_unique<Buffer>(tester.getDevice(), bufferSize, vk::BufferUsageFlagBits::eStorageBuffer);
+
+		vk::DescriptorBufferInfo bufferInfo(resultBuffer->getBuffer(), 0, bufferSize);
+
+		vk::WriteDescriptorSet descriptorWrite;
+		descriptorWrite.dstSet = descriptorSet;
+		descriptorWrite.dstBinding = 0;
+		descriptorWrite.descriptorCount = 1;
+		descriptorWrite.descriptorType = vk::DescriptorType::eStorageBuffer;
+		descriptorWrite.pBufferInfo = &bufferInfo;
+
+		tester.getDevice().updateDescriptorSets(1, &descriptorWrite, 0, nullptr);
+	});
+
+	tester.initialize();
+	tester.renderFrame();
+	tester.readPixels();  // Waits for the frame.
+
+	const Result *result = static_cast<const Result *>(resultBuffer->mapMemory());
+	std::vector<Result> results(result, result + vertices.size());
+	resultBuffer->unmapMemory();
+
+	return results;
+}
+
+// Returns the signed integer in the given bits of the value.
+int32_t signedBits(uint32_t value, int shift, int bits)
+{
+	return static_cast<int32_t>(value << (32 - shift - bits)) >> (32 - bits);
+}
+
+float referenceSnorm(int32_t value, int bits)
+{
+	return std::max(float(value) / float((1 << (bits - 1)) - 1), -1.0f);
+}
+
+// Converts a normal half-float.
+float referenceHalf(uint16_t value)
+{
+	uint32_t bits = (uint32_t(value & 0x8000) << 16) | ((((value >> 10) & 0x1F) + 112) << 23) | (uint32_t(value & 0x3FF) << 13);
+
+	float f;
+	memcpy(&f, &bits, sizeof(f));
+	return f;
+}
+
+}  // anonymous namespace
+
+// Test that packed, half-float and signed normalized vertex attributes of a binding are converted
+// the same when read from whole vertex records, and when read one attribute at a time. The lowest
+// offset isn't the first attribute's.
+TEST_F(DrawTest, VertexInputPackedFormats)
+{
+	struct Vertex
+	{
+		uint16_t halfFloat[4];
+		uint32_t snorm10;
+		uint32_t sint10;
+		uint32_t uint10;
+		uint32_t unorm10;
+		int16_t snorm16[2];
+		int8_t snorm8[4];
+	};
+
+	struct Result
+	{
+		float snorm10[4];
+		int32_t sint10[4];
+		uint32_t uint10[4];
+		float unorm10[4];
+		float halfFloat[4];
+		float snorm8[4];
+		float snorm16[2];
+		float padding[2];
+	};
+
+	std::vector<Vertex> vertices(96);
+	uint32_t seed = 1;
+	auto nextRandom = [&seed]() {
+		seed = seed * 1103515245 + 12345;
+		return (seed >> 16) | (seed << 16);
+	};
+
+	for(auto &vertex : vertices)
+	{
+		for(auto &halfFloat : vertex.halfFloat)
+		{
+			// Normal numbers, with either sign.
+			halfFloat = static_cast<uint16_t>((nextRandom() & 0x83FF) | ((1 + nextRandom() % 30) << 10));
+		}
+
+		vertex.snorm10 = nextRandom();
+		vertex.sint10 = nextRandom();
+		vertex.uint10 = nextRandom();
+		vertex.unorm10 = nextRandom();
+		vertex.snorm16[0] = static_cast<int16_t>(nextRandom());
+		vertex.snorm16[1] = static_cast<int16_t>(nextRandom());
+		for(auto &snorm8 : vertex.snorm8)
+		{
+			snorm8 = static_cast<int8_t>(nextRandom());
+		}
+	}
+
+	// The most negative values get clamped to -1.
+	vertices[0].snorm10 = 0xA0080200;
+	vertices[0].snorm16[0] = -32768;
+	vertices[0].snorm8[0] = -128;
+
+	const std::vector<vk::VertexInputAttributeDescription> inputAttributes = {
+		vk::VertexInputAttributeDescription(0, 0, vk::Format::eA2B10G10R10SnormPack32, offsetof(Vertex, snorm10)),
+		vk::VertexInputAttributeDescription(1, 0, vk::Format::eA2B10G10R10SintPack32, offsetof(Vertex, sint10)),
+		vk::VertexInputAttributeDescription(2, 0, vk::Format::eA2B10G10R10UintPack32, offsetof(Vertex, uint10)),
+		vk::VertexInputAttributeDescription(3, 0, vk::Format::eA2B10G10R10UnormPack32, offsetof(Vertex, unorm10)),
+		vk::VertexInputAttributeDescription(4, 0, vk::Format::eR16G16B16A16Sfloat, offsetof(Vertex, halfFloat)),
+		vk::VertexInputAttributeDescription(5, 0, vk::Format::eR8G8B8A8Snorm, offsetof(Vertex, snorm8)),
+		vk::VertexInputAttributeDescription(6, 0, vk::Format::eR16G16Snorm, offsetof(Vertex, snorm16)),
+	};
+
+	const char *vertexShader = R"(#version 450
+		layout(location = 0) in vec4 inSnorm10;
+		layout(location = 1) in ivec4 inSint10;
+		layout(location = 2) in uvec4 inUint10;
+		layout(location = 3) in vec4 inUnorm10;
+		layout(location = 4) in vec4 inHalfFloat;
+		layout(location = 5) in vec4 inSnorm8;
+		layout(location = 6) in vec2 inSnorm16;
+
+		struct Attributes
+		{
+			vec4 snorm10;
+			ivec4 sint10;
+			uvec4 uint10;
+			vec4 unorm10;
+			vec4 halfFloat;
+			vec4 snorm8;
+			vec2 snorm16;
+		};
+
+		layout(std430, binding = 0) buffer Result
+		{
+			Attributes vertex[];
+		} result;
+
+		void main()
+		{
+			result.vertex[gl_VertexIndex].snorm10 = inSnorm10;
+			result.vertex[gl_VertexIndex].sint10 = inSint10;
+			result.vertex[gl_VertexIndex].uint10 = inUint10;
+			result.vertex[gl_VertexIndex].unorm10 = inUnorm10;
+			result.vertex[gl_VertexIndex].halfFloat = inHalfFloat;
+			result.vertex[gl_VertexIndex].snorm8 = inSnorm8;
+			result.vertex[gl_VertexIndex].snorm16 = inSnorm16;
+			gl_Position = vec4(0.0, 0.0, 0.5, 1.0);
+		})";
+
+	for(bool robustBufferAccess : { false, true })
+	{
+		std::vector<Result> results = fetchVertexAttributes<Result>(vertices, inputAttributes, vertexShader, robustBufferAccess);
+		uint32_t mismatches = 0;
+
+		for(size_t i = 0; i < vertices.size(); i++)
+		{
+			const Vertex &vertex = vertices[i];
+			const Result &result = results[i];
+			const float tolerance = 1.0e-6f;
+			bool match = true;
+
+			for(int c = 0; c < 4; c++)
+			{
+				int bits = (c < 3) ? 10 : 2;
+				match = match && std::abs(result.snorm10[c] - referenceSnorm(signedBits(vertex.snorm10, 10 * c, bits), bits)) <= tolerance;
+				match = match && result.sint10[c] == signedBits(vertex.sint10, 10 * c, bits);
+				match = match && result.uint10[c] == ((vertex.uint10 >> (10 * c)) & ((1u << bits) - 1));
+				match = match && std::abs(result.unorm10[c] - float((vertex.unorm10 >> (10 * c)) & ((1u << bits) - 1)) / float((1 << bits) - 1)) <= tolerance;
+				match = match && result.halfFloat[c] == referenceHalf(vertex.halfFloat[c]);
+				match = match && std::abs(result.snorm8[c] - referenceSnorm(vertex.snorm8[c], 8)) <= tolerance;
+			}
+
+			for(int c = 0; c < 2; c++)
+			{
+				match = match && std::abs(result.snorm16[c] - referenceSnorm(vertex.snorm16[c], 16)) <= tolerance;
+			}
+
+			mismatches += match ? 0 : 1;
+		}
+
+		EXPECT_EQ(mismatches, 0u) << "robustBufferAccess = " << robustBufferAccess;
+	}
+}
+
+// Test that with robust buffer access, a sub-dword attribute which ends exactly at the end of the
+// vertex buffer is read correctly, without the bytes past the buffer, and that attributes which
+// extend past the end read zeros, like SwiftShader returns for out of bounds attributes.
+TEST_F(DrawTest, VertexInputRobustEndOfBuffer)
+{
+	struct Vertex
+	{
+		uint16_t low;
+		uint16_t high;
+	};
+
+	struct Result
+	{
+		uint32_t value[4];
+	};
+
+	std::vector<Vertex> vertices;
+	for(uint16_t i = 0; i < 6; i++)
+	{
+		vertices.push_back({ static_cast<uint16_t>(0x1100 + i), static_cast<uint16_t>(0x2200 + i) });
+	}
+
+	// Attribute offsets may be larger than the stride, so the last vertex reads past the end of the buffer.
+	const std::vector<vk::VertexInputAttributeDescription> inputAttributes = {
+		vk::VertexInputAttributeDescription(0, 0, vk::Format::eR16Uint, 2),
+		vk::VertexInputAttributeDescription(1, 0, vk::Format::eR8Uint, 3),
+		vk::VertexInputAttributeDescription(2, 0, vk::Format::eR16Uint, 4),
+		vk::VertexInputAttributeDescription(3, 0, vk::Format::eR32Uint, 2),
+	};
+
+	const char *vertexShader = R"(#version 450
+		layout(location = 0) in uint inValue0;
+		layout(location = 1) in uint inValue1;
+		layout(location = 2) in uint inValue2;
+		layout(location = 3) in uint inValue3;
+
+		layout(std430, binding = 0) buffer Result
+		{
+			uvec4 vertex[];
+		} result;
+
+		void main()
+		{
+			result.vertex[gl_VertexIndex] = uvec4(inValue0, inValue1, inValue2, inValue3);
+			gl_Position = vec4(0.0, 0.0, 0.5, 1.0);
+		})";
+
+	std::vector<Result> results = fetchVertexAttributes<Result>(vertices, inputAttributes, vertexShader, true, 16, 0xA5);
+
+	const size_t bufferSize = vertices.size() * sizeof(Vertex);
+	const uint8_t *bytes = reinterpret_cast<const uint8_t *>(vertices.data());
+	uint32_t mismatches = 0;
+
+	for(size_t i = 0; i < vertices.size(); i++)
+	{
+		for(size_t a = 0; a < inputAttributes.size(); a++)
+		{
+			size_t offset = i * sizeof(Vertex) + inputAttributes[a].offset;
+			size_t size = (inputAttributes[a].format == vk::Format::eR8Uint) ? 1 : (inputAttributes[a].format == vk::Format::eR16Uint) ? 2 : 4;
+
+			uint32_t expected = 0;
+			if(offset + size <= bufferSize)
+			{
+				memcpy(&expected, bytes + offset, size);
+			}
+
+			mismatches += (results[i].value[a] != expected) ? 1 : 0;
+		}
+	}
+
+	EXPECT_EQ(mismatches, 0u);
+}
@@ -47,6 +47,7 @@ DrawTester::~DrawTester()
 
 	device.freeMemory(vertices.memory, nullptr);
 	device.destroyBuffer(vertices.buffer, nullptr);
+	indexBuffer.reset();
 
 	for(auto &framebuffer : framebuffers)
 	{
@@ -55,6 +56,8 @@ DrawTester::~DrawTester()
 
 	device.destroyRenderPass(renderPass, nullptr);
 
+	readbackBuffer.reset();
+	offscreenImage.reset();
 	swapchain.reset();
 	window.reset();
 }
@@ -63,10 +66,22 @@ void DrawTester::initialize()
 {
 	VulkanTester::initialize();
 
-	window.reset(new Window(instance, windowSize));
-	swapchain.reset(new Swapchain(physicalDevice, device, *window));
+	if(offscreenFormat != vk::Format::eUndefined)
+	{
+		offscreenImage.reset(new Image(device, physicalDevice, extent.width, extent.height, offscreenFormat, vk::SampleCountFlagBits::e1,
+		                               vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc));
+		readbackBuffer.reset(new Buffer(device, vk::DeviceSize(extent.width) * extent.height * sizeof(uint32_t), vk::BufferUsageFlagBits::eTransferDst));
+
+		renderPass = createRenderPass(offscreenFormat);
+	}
+	else
+	{
+		window.reset(new Window(instance, extent));
+		swapchain.reset(new Swapchain(physicalDevice, device, *window));
+
+		renderPass = createRenderPass(swapchain->colorFormat);
+	}
 
-	renderPass = createRenderPass(swapchain->colorFormat);
 	createFramebuffers(renderPass);
 
 	prepareVertices();
@@ -80,6 +95,19 @@ void DrawTester::initialize()
 
 void DrawTester::renderFrame()
 {
+	if(offscreenImage)
+	{
+		device.waitForFences(1, &waitFences[0], VK_TRUE, UINT64_MAX);
+		device.resetFences(1, &waitFences[0]);
+
+		vk::SubmitInfo submitInfo;
+		submitInfo.pCommandBuffers = &commandBuffers[0];
+		submitInfo.commandBufferCount = 1;
+
+		queue.submit(1, &submitInfo, waitFences[0]);
+		return;
+	}
+
 	swapchain->acquireNextImage(presentCompleteSemaphore, currentFrameBuffer);
 
 	device.waitForFences(1, &waitFences[currentFrameBuffer], VK_TRUE, UINT64_MAX);
@@ -106,10 +134,32 @@ void DrawTester::show()
 	window->show();
 }
 
+void DrawTester::setOffscreenTarget(vk::Extent2D extent, vk::Format format, vk::ClearColorValue clearColor)
+{
+	this->extent = extent;
+	this->offscreenFormat = format;
+	this->clearColor = clearColor;
+}
+
+std::vector<uint32_t> DrawTester::readPixels()
+{
+	assert(readbackBuffer);
+	device.waitForFences(1, &waitFences[0], VK_TRUE, UINT64_MAX);
+
+	const uint32_t *texels = static_cast<const uint32_t *>(readbackBuffer->mapMemory());
+	std::vector<uint32_t> pixels(texels, texels + size_t(extent.width) * extent.height);
+	readbackBuffer->unmapMemory();
+
+	return pixels;
+}
+
 vk::RenderPass DrawTester::createRenderPass(vk::Format colorFormat)
 {
 	std::vector<vk::AttachmentDescription> attachments(multisample ? 2 : 1);
 
+	// The offscreen target is copied to the readback buffer after the render pass.
+	vk::ImageLayout finalLayout = offscreenImage ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::ePresentSrcKHR;
+
 	if(multisample)
 	{
 		// Color attachment
@@ -130,18 +180,18 @@ vk::RenderPass DrawTester::createRenderPass(vk::Format colorFormat)
 		attachments[1].stencilLoadOp = vk::AttachmentLoadOp::eDontCare;
 		attachments[1].stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
 		attachments[1].initialLayout = vk::ImageLayout::eUndefined;
-		attachments[1].finalLayout = vk::ImageLayout::ePresentSrcKHR;
+		attachments[1].finalLayout = finalLayout;
 	}
 	else
 	{
 		attachments[0].format = colorFormat;
 		attachments[0].samples = vk::SampleCountFlagBits::e1;
-		attachments[0].loadOp = vk::AttachmentLoadOp::eDontCare;
+		attachments[0].loadOp = offscreenImage ? vk::AttachmentLoadOp::eClear : vk::AttachmentLoadOp::eDontCare;
 		attachments[0].storeOp = vk::AttachmentStoreOp::eStore;
 		attachments[0].stencilLoadOp = vk::AttachmentLoadOp::eDontCare;
 		attachments[0].stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
 		attachments[0].initialLayout = vk::ImageLayout::eUndefined;
-		attachments[0].finalLayout = vk::ImageLayout::ePresentSrcKHR;
+		attachments[0].finalLayout = finalLayout;
 	}
 
 	vk::AttachmentReference attachment0;
@@ -171,9 +221,9 @@ vk::RenderPass DrawTester::createRenderPass(vk::Format colorFormat)
 	dependencies[1].srcSubpass = 0;
 	dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
 	dependencies[1].srcStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput;
-	dependencies[1].dstStageMask = vk::PipelineStageFlagBits::eBottomOfPipe;
+	dependencies[1].dstStageMask = offscreenImage ? vk::PipelineStageFlagBits::eTransfer : vk::PipelineStageFlagBits::eBottomOfPipe;
 	dependencies[1].srcAccessMask = vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite;
-	dependencies[1].dstAccessMask = vk::AccessFlagBits::eMemoryRead;
+	dependencies[1].dstAccessMask = offscreenImage ? vk::AccessFlagBits::eTransferRead : vk::AccessFlagBits::eMemoryRead;
 	dependencies[1].dependencyFlags = vk::DependencyFlagBits::eByRegion;
 
 	vk::RenderPassCreateInfo renderPassInfo;
@@ -189,6 +239,13 @@ vk::RenderPass DrawTester::createRenderPass(vk::Format colorFormat)
 
 void DrawTester::createFramebuffers(vk::RenderPass renderPass)
 {
+	if(offscreenImage)
+	{
+		framebuffers.resize(1);
+		framebuffers[0].reset(new Framebuffer(device, physicalDevice, offscreenImage->getImageView(), offscreenFormat, renderPass, extent, multisample));
+		return;
+	}
+
 	framebuffers.resize(swapchain->imageCount());
 
 	for(size_t i = 0; i < framebuffers.size(); i++)
@@ -204,7 +261,7 @@ void DrawTester::prepareVertices()
 
 vk::Pipeline DrawTester::createGraphicsPipeline(vk::RenderPass renderPass)
 {
-	auto setLayoutBindings = hooks.createDescriptorSetLayout(*this);
+	setLayoutBindings = hooks.createDescriptorSetLayout(*this);
 
 	std::vector<vk::DescriptorSetLayout> setLayouts;
 	if(!setLayoutBindings.empty())
@@ -241,6 +298,7 @@ vk::Pipeline DrawTester::createGraphicsPipeline(vk::RenderPass renderPass)
 	vk::PipelineColorBlendAttachmentState blendAttachmentState;
 	blendAttachmentState.colorWriteMask = vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA;
 	blendAttachmentState.blendEnable = VK_FALSE;
+	hooks.createColorBlendAttachmentState(*this, blendAttachmentState);
 	vk::PipelineColorBlendStateCreateInfo colorBlendState;
 	colorBlendState.attachmentCount = 1;
 	colorBlendState.pAttachments = &blendAttachmentState;
@@ -315,7 +373,7 @@ void DrawTester::createSynchronizationPrimitives()
 
 	vk::FenceCreateInfo fenceCreateInfo;
 	fenceCreateInfo.flags = vk::FenceCreateFlagBits::eSignaled;
-	waitFences.resize(swapchain->imageCount());
+	waitFences.resize(framebuffers.size());
 	for(auto &fence : waitFences)
 	{
 		fence = device.createFence(fenceCreateInfo);
@@ -332,9 +390,11 @@ void DrawTester::createCommandBuffers(vk::RenderPass renderPass)
 	std::vector<vk::DescriptorSet> descriptorSets;
 	if(descriptorSetLayout)
 	{
-		std::array<vk::DescriptorPoolSize, 1> poolSizes = {};
-		poolSizes[0].type = vk::DescriptorType::eCombinedImageSampler;
-		poolSizes[0].descriptorCount = 1;
+		std::vector<vk::DescriptorPoolSize> poolSizes;
+		for(const auto &binding : setLayoutBindings)
+		{
+			poolSizes.push_back(vk::DescriptorPoolSize(binding.descriptorType, binding.descriptorCount));
+		}
 
 		vk::DescriptorPoolCreateInfo poolInfo;
 		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
@@ -356,7 +416,7 @@ void DrawTester::createCommandBuffers(vk::RenderPass renderPass)
 
 	vk::CommandBufferAllocateInfo commandBufferAllocateInfo;
 	commandBufferAllocateInfo.commandPool = commandPool;
-	commandBufferAllocateInfo.commandBufferCount = static_cast<uint32_t>(swapchain->imageCount());
+	commandBufferAllocateInfo.commandBufferCount = static_cast<uint32_t>(framebuffers.size());
 	commandBufferAllocateInfo.level = vk::CommandBufferLevel::ePrimary;
 
 	commandBuffers = device.allocateCommandBuffers(commandBufferAllocateInfo);
@@ -367,23 +427,23 @@ void DrawTester::createCommandBuffers(vk::RenderPass renderPass)
 		commandBuffers[i].begin(commandBufferBeginInfo);
 
 		vk::ClearValue clearValues[1];
-		clearValues[0].color = vk::ClearColorValue(std::array<float, 4>{ 0.5f, 0.5f, 0.5f, 1.0f });
+		clearValues[0].color = clearColor;
 
 		vk::RenderPassBeginInfo renderPassBeginInfo;
 		renderPassBeginInfo.framebuffer = framebuffers[i]->getFramebuffer();
 		renderPassBeginInfo.renderPass = renderPass;
 		renderPassBeginInfo.renderArea.offset.x = 0;
 		renderPassBeginInfo.renderArea.offset.y = 0;
-		renderPassBeginInfo.renderArea.extent = windowSize;
+		renderPassBeginInfo.renderArea.extent = extent;
 		renderPassBeginInfo.clearValueCount = ARRAY_SIZE(clearValues);
 		renderPassBeginInfo.pClearValues = clearValues;
 		commandBuffers[i].beginRenderPass(renderPassBeginInfo, vk::SubpassContents::eInline);
 
 		// Set dynamic state
-		vk::Viewport viewport(0.0f, 0.0f, static_cast<float>(windowSize.width), static_cast<float>(windowSize.height), 0.0f, 1.0f);
+		vk::Viewport viewport(0.0f, 0.0f, static_cast<float>(extent.width), static_cast<float>(extent.height), 0.0f, 1.0f);
 		commandBuffers[i].setViewport(0, 1, &viewport);
 
-		vk::Rect2D scissor(vk::Offset2D(0, 0), windowSize);
+		vk::Rect2D scissor(vk::Offset2D(0, 0), extent);
 		commandBuffers[i].setScissor(0, 1, &scissor);
 
 		if(!descriptorSets.empty())
@@ -397,10 +457,29 @@ void DrawTester::createCommandBuffers(vk::RenderPass renderPass)
 			commandBuffers[i].bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
 			VULKAN_HPP_NAMESPACE::DeviceSize offset = 0;
 			commandBuffers[i].bindVertexBuffers(0, 1, &vertices.buffer, &offset);
-			commandBuffers[i].draw(vertices.numVertices, 1, 0, 0);
+
+			if(indexBuffer)
+			{
+				commandBuffers[i].bindIndexBuffer(indexBuffer->getBuffer(), 0, vk::IndexType::eUint32);
+				commandBuffers[i].drawIndexed(numIndices, 1, 0, 0, 0);
+			}
+			else
+			{
+				commandBuffers[i].draw(vertices.numVertices, 1, 0, 0);
+			}
 		}
 
 		commandBuffers[i].endRenderPass();
+
+		if(offscreenImage)
+		{
+			vk::BufferImageCopy region;
+			region.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+			region.imageSubresource.layerCount = 1;
+			region.imageExtent = vk::Extent3D(extent.width, extent.height, 1);
+			commandBuffers[i].copyImageToBuffer(offscreenImage->getImage(), vk::ImageLayout::eTransferSrcOptimal, readbackBuffer->getBuffer(), 1, &region);
+		}
+
 		commandBuffers[i].end();
 	}
 }
@@ -416,12 +495,13 @@ void DrawTester::addVertexBuffer(void *vertexBufferData, size_t vertexBufferData
 
 	vk::MemoryAllocateInfo memoryAllocateInfo;
 	vk::MemoryRequirements memoryRequirements = device.getBufferMemoryRequirements(vertices.buffer);
-	memoryAllocateInfo.allocationSize = memoryRequirements.size;
+	memoryAllocateInfo.allocationSize = memoryRequirements.size + vertices.guardSize;
 	memoryAllocateInfo.memoryTypeIndex = Util::getMemoryTypeIndex(physicalDevice, memoryRequirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
 	vertices.memory = device.allocateMemory(memoryAllocateInfo);
 
 	void *data = device.mapMemory(vertices.memory, 0, VK_WHOLE_SIZE);
 	memcpy(data, vertexBufferData, vertexBufferDataSize);
+	memset(static_cast<uint8_t *>(data) + vertexBufferDataSize, vertices.guardValue, memoryAllocateInfo.allocationSize - vertexBufferDataSize);
 	device.unmapMemory(vertices.memory);
 	device.bindBufferMemory(vertices.buffer, vertices.memory, 0);
 
@@ -450,3 +530,17 @@ vk::ShaderModule DrawTester::createShaderModule(const char *glslSource, EShLangu
 
 	return device.createShaderModule(moduleCreateInfo);
 }
+
+void DrawTester::addIndexBuffer(const uint32_t *indexBufferData, size_t indexCount)
+{
+	assert(!indexBuffer);  // For now, only support adding once
+
+	vk::DeviceSize size = indexCount * sizeof(uint32_t);
+	indexBuffer = std::make_unique<Buffer>(device, size, vk::BufferUsageFlagBits::eIndexBuffer);
+
+	void *data = indexBuffer->mapMemory();
+	memcpy(data, indexBufferData, size);
+	indexBuffer->unmapMemory();
+
+	numIndices = static_cast<uint32_t>(indexCount);
+}
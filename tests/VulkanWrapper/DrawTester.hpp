@@ -15,6 +15,7 @@
 #ifndef DRAW_TESTER_HPP_
 #define DRAW_TESTER_HPP_
 
+#include "Buffer.hpp"
 #include "Framebuffer.hpp"
 #include "Image.hpp"
 #include "Swapchain.hpp"
@@ -22,8 +23,10 @@
 #include "VulkanTester.hpp"
 #include "Window.hpp"
 
+#include <array>
 #include <functional>
 #include <memory>
+#include <vector>
 
 enum class Multisample
 {
@@ -43,6 +46,14 @@ public:
 	void renderFrame();
 	void show();
 
+	// Renders into an image of the given size and format instead of the window's swapchain, so
+	// that the result can be read back. The image is cleared to clearColor at the start of each
+	// frame. The format must have 32-bit texels. Must be called before initialize().
+	void setOffscreenTarget(vk::Extent2D extent, vk::Format format, vk::ClearColorValue clearColor);
+
+	// Waits for the last frame rendered to the offscreen target, and returns its texels row by row.
+	std::vector<uint32_t> readPixels();
+
 	/////////////////////////
 	// Hooks
 	/////////////////////////
@@ -64,6 +75,10 @@ public:
 	// Callback should call tester.createShaderModule() and return the result.
 	void onCreateFragmentShader(std::function<vk::ShaderModule(ThisType &tester)> callback);
 
+	// Called from createGraphicsPipeline.
+	// Callback may modify the blend state of the color attachment, which defaults to blending disabled.
+	void onCreateColorBlendAttachmentState(std::function<void(ThisType &tester, vk::PipelineColorBlendAttachmentState &blendAttachmentState)> callback);
+
 	// Called from createCommandBuffers.
 	// Callback may create resources (tester.addImage, tester.addSampler, etc.), and make sure to
 	// call tester.device().updateDescriptorSets.
@@ -83,6 +98,18 @@ public:
 		addVertexBuffer(vertexBufferData, vertexBufferDataSize, sizeof(VertexType), std::move(inputAttributes));
 	}
 
+	// Fills memory past the end of the vertex buffer with the given byte, so that tests can detect
+	// reads beyond its range. Call before addVertexBuffer().
+	void setVertexBufferGuard(size_t size, uint8_t value)
+	{
+		vertices.guardSize = size;
+		vertices.guardValue = value;
+	}
+
+	// Call from doCreateVertexBuffers()
+	// When an index buffer is added, the vertices are drawn indexed.
+	void addIndexBuffer(const uint32_t *indexBufferData, size_t indexCount);
+
 	template<typename T>
 	struct Resource
 	{
@@ -129,15 +156,21 @@ private:
 		std::function<std::vector<vk::DescriptorSetLayoutBinding>(ThisType &tester)> createDescriptorSetLayout = [](auto &) { return std::vector<vk::DescriptorSetLayoutBinding>{}; };
 		std::function<vk::ShaderModule(ThisType &tester)> createVertexShader = [](auto &) { return vk::ShaderModule{}; };
 		std::function<vk::ShaderModule(ThisType &tester)> createFragmentShader = [](auto &) { return vk::ShaderModule{}; };
+		std::function<void(ThisType &tester, vk::PipelineColorBlendAttachmentState &blendAttachmentState)> createColorBlendAttachmentState = [](auto &, auto &) {};
 		std::function<void(ThisType &tester, vk::CommandPool &commandPool, vk::DescriptorSet &descriptorSet)> updateDescriptorSet = [](auto &, auto &, auto &) {};
 	} hooks;
 
-	const vk::Extent2D windowSize = { 1280, 720 };
+	vk::Extent2D extent = { 1280, 720 };  // Size of the window or offscreen target
 	const bool multisample;
 
 	std::unique_ptr<Window> window;
 	std::unique_ptr<Swapchain> swapchain;
 
+	vk::Format offscreenFormat = vk::Format::eUndefined;
+	vk::ClearColorValue clearColor = vk::ClearColorValue(std::array<float, 4>{ 0.5f, 0.5f, 0.5f, 1.0f });
+	std::unique_ptr<Image> offscreenImage;
+	std::unique_ptr<Buffer> readbackBuffer;
+
 	vk::RenderPass renderPass;  // Owning handle
 	std::vector<std::unique_ptr<Framebuffer>> framebuffers;
 	uint32_t currentFrameBuffer = 0;
@@ -152,8 +185,15 @@ private:
 		vk::PipelineVertexInputStateCreateInfo inputState;
 
 		uint32_t numVertices = 0;
+
+		size_t guardSize = 0;
+		uint8_t guardValue = 0;
 	} vertices;
 
+	std::unique_ptr<Buffer> indexBuffer;
+	uint32_t numIndices = 0;
+
+	std::vector<vk::DescriptorSetLayoutBinding> setLayoutBindings;
 	vk::DescriptorSetLayout descriptorSetLayout;  // Owning handle
 	vk::PipelineLayout pipelineLayout;            // Owning handle
 	vk::Pipeline pipeline;                        // Owning handle
@@ -192,6 +232,11 @@ inline void DrawTester::onCreateFragmentShader(std::function<vk::ShaderModule(Th
 	hooks.createFragmentShader = std::move(callback);
 }
 
+inline void DrawTester::onCreateColorBlendAttachmentState(std::function<void(ThisType &tester, vk::PipelineColorBlendAttachmentState &blendAttachmentState)> callback)
+{
+	hooks.createColorBlendAttachmentState = std::move(callback);
+}
+
 inline void DrawTester::onUpdateDescriptorSet(std::function<void(ThisType &tester, vk::CommandPool &commandPool, vk::DescriptorSet &descriptorSet)> callback)
 {
 	hooks.updateDescriptorSet = std::move(callback);
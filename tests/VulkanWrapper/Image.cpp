@@ -15,15 +15,16 @@
 #include "Image.hpp"
 #include "Util.hpp"
 
-Image::Image(vk::Device device, vk::PhysicalDevice physicalDevice, uint32_t width, uint32_t height, vk::Format format, vk::SampleCountFlagBits sampleCount /*= vk::SampleCountFlagBits::e1*/)
+Image::Image(vk::Device device, vk::PhysicalDevice physicalDevice, uint32_t width, uint32_t height, vk::Format format, vk::SampleCountFlagBits sampleCount /*= vk::SampleCountFlagBits::e1*/,
+             vk::ImageUsageFlags usage /*= vk::ImageUsageFlagBits::eColorAttachment*/, vk::ImageTiling tiling /*= vk::ImageTiling::eOptimal*/)
     : device(device)
 {
 	vk::ImageCreateInfo imageInfo;
 	imageInfo.imageType = vk::ImageType::e2D;
 	imageInfo.format = format;
-	imageInfo.tiling = vk::ImageTiling::eOptimal;
+	imageInfo.tiling = tiling;
 	imageInfo.initialLayout = vk::ImageLayout::eGeneral;
-	imageInfo.usage = vk::ImageUsageFlagBits::eColorAttachment;
+	imageInfo.usage = usage;
 	imageInfo.samples = sampleCount;
 	imageInfo.extent = vk::Extent3D(width, height, 1);
 	imageInfo.mipLevels = 1;
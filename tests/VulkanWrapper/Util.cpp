@@ -16,6 +16,8 @@
 #include "SPIRV/GlslangToSpv.h"
 #include "glslang/Public/ResourceLimits.h"
 
+#include <cstdio>
+#include <fstream>
 #include <memory>
 
 namespace Util {
@@ -173,4 +175,27 @@ std::vector<uint32_t> compileGLSLtoSPIRV(const char *glslSource, EShLanguage gls
 	return spirv;
 }
 
+ScopedConfiguration::ScopedConfiguration(const std::string &settings)
+{
+	std::ifstream existing(path);
+	hadFile = existing.good();
+	if(hadFile)
+	{
+		original << existing.rdbuf();
+	}
+	std::ofstream(path) << original.str() << "\n" << settings << "\n";
+}
+
+ScopedConfiguration::~ScopedConfiguration()
+{
+	if(hadFile)
+	{
+		std::ofstream(path) << original.str();
+	}
+	else
+	{
+		std::remove(path);
+	}
+}
+
 }  // namespace Util
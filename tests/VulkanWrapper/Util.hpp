@@ -18,6 +18,8 @@
 #include "VulkanHeaders.hpp"
 #include "glslang/Public/ShaderLang.h"
 
+#include <sstream>
+#include <string>
 #include <vector>
 
 namespace Util {
@@ -34,6 +36,21 @@ void copyBufferToImage(vk::Device device, vk::CommandPool commandPool, vk::Queue
 
 std::vector<uint32_t> compileGLSLtoSPIRV(const char *glslSource, EShLanguage glslLanguage);
 
+// Overrides SwiftShader settings for its lifetime, by appending to the SwiftShader.ini configuration
+// file in the working directory. Only the settings which SwiftShader reads again for new schedulers
+// or devices take effect within the same process.
+class ScopedConfiguration
+{
+public:
+	ScopedConfiguration(const std::string &settings);
+	~ScopedConfiguration();
+
+private:
+	static constexpr const char *path = "SwiftShader.ini";
+	std::stringstream original;
+	bool hadFile = false;
+};
+
 }  // namespace Util
 
 #endif  // BENCHMARKS_UTIL_HPP_
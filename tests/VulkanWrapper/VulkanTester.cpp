@@ -263,7 +263,12 @@ void VulkanTester::initialize()
 	PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr = dl->getProcAddress<PFN_vkGetInstanceProcAddr>("vkGetInstanceProcAddr");
 	VULKAN_HPP_DEFAULT_DISPATCHER.init(vkGetInstanceProcAddr);
 
+	// Shaders are compiled for Vulkan 1.1, which also provides vkGetPhysicalDeviceFeatures2().
+	vk::ApplicationInfo applicationInfo;
+	applicationInfo.apiVersion = VK_API_VERSION_1_1;
+
 	vk::InstanceCreateInfo instanceCreateInfo;
+	instanceCreateInfo.pApplicationInfo = &applicationInfo;
 	std::vector<const char *> extensionNames
 	{
 		VK_KHR_SURFACE_EXTENSION_NAME,
@@ -346,11 +351,30 @@ void VulkanTester::initialize()
 		VK_KHR_SWAPCHAIN_EXTENSION_NAME,
 	};
 
+	// Allow vertex and fragment shaders to write to storage buffers, so that tests can read back results.
+	vk::PhysicalDeviceFeatures enabledFeatures;
+	enabledFeatures.vertexPipelineStoresAndAtomics = physicalDevice.getFeatures().vertexPipelineStoresAndAtomics;
+	enabledFeatures.fragmentStoresAndAtomics = physicalDevice.getFeatures().fragmentStoresAndAtomics;
+	enabledFeatures.robustBufferAccess = robustBufferAccess;
+
+	// Allow 16-bit types in shaders and in their interfaces, where supported.
+	auto supportedFeatures = physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDevice16BitStorageFeatures, vk::PhysicalDeviceShaderFloat16Int8Features>();
+	enabledFeatures.shaderInt16 = supportedFeatures.get<vk::PhysicalDeviceFeatures2>().features.shaderInt16;
+
+	vk::PhysicalDeviceShaderFloat16Int8Features float16Int8Features;
+	float16Int8Features.shaderFloat16 = supportedFeatures.get<vk::PhysicalDeviceShaderFloat16Int8Features>().shaderFloat16;
+
+	vk::PhysicalDevice16BitStorageFeatures storage16BitFeatures;
+	storage16BitFeatures.storageInputOutput16 = supportedFeatures.get<vk::PhysicalDevice16BitStorageFeatures>().storageInputOutput16;
+	storage16BitFeatures.pNext = &float16Int8Features;
+
 	vk::DeviceCreateInfo deviceCreateInfo;
+	deviceCreateInfo.pNext = &storage16BitFeatures;
 	deviceCreateInfo.queueCreateInfoCount = 1;
 	deviceCreateInfo.pQueueCreateInfos = &queueCreateInfo;
 	deviceCreateInfo.ppEnabledExtensionNames = deviceExtensions.data();
 	deviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
+	deviceCreateInfo.pEnabledFeatures = &enabledFeatures;
 
 	device = physicalDevice.createDevice(deviceCreateInfo, nullptr);
 
@@ -395,3 +419,20 @@ std::unique_ptr<vk::detail::DynamicLoader> VulkanTester::loadDriver()
 
 	return dl;
 }
+
+PFN_vkVoidFunction VulkanTester::getDriverProcAddress(const char *name)
+{
+	if(LOAD_NATIVE_DRIVER)
+	{
+		return nullptr;
+	}
+
+	// The driver library is already loaded, either directly or by the loader,
+	// so this references the same instance of it.
+	if(!driver)
+	{
+		driver = std::make_unique<vk::detail::DynamicLoader>(findDriverPath());
+	}
+
+	return driver->getProcAddress<PFN_vkVoidFunction>(name);
+}
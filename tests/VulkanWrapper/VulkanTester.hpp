@@ -28,18 +28,27 @@ public:
 	// Call once after construction so that virtual functions may be called during init
 	void initialize();
 
+	// Enables the robustBufferAccess feature on the device. Must be called before initialize().
+	void enableRobustBufferAccess() { robustBufferAccess = true; }
+
 	const vk::detail::DynamicLoader &dynamicLoader() const { return *dl; }
 	vk::PhysicalDevice &getPhysicalDevice() { return physicalDevice; }
 	vk::Device &getDevice() { return device; }
 	vk::Queue &getQueue() { return queue; }
 	uint32_t getQueueFamilyIndex() const { return queueFamilyIndex; }
 
+	// Returns an entry point exported by SwiftShader which isn't part of the Vulkan API,
+	// or null when the native driver is loaded.
+	PFN_vkVoidFunction getDriverProcAddress(const char *name);
+
 private:
 	std::unique_ptr<vk::detail::DynamicLoader> loadDriver();
 
 	std::unique_ptr<class ScopedSetIcdFilenames> setIcdFilenames;
 	std::unique_ptr<vk::detail::DynamicLoader> dl;
+	std::unique_ptr<vk::detail::DynamicLoader> driver;
 	vk::DebugUtilsMessengerEXT debugReport;
+	bool robustBufferAccess = false;
 
 protected:
 	const uint32_t queueFamilyIndex = 0;